@@ -25,6 +25,10 @@
 #include <string.h> /* memcpy */
 #include <sys/types.h>
 
+#ifndef _WIN32
+#  include <pthread.h>
+#endif
+
 #include "MEM_guardedalloc.h"
 
 /* to ensure strict conversions */
@@ -43,8 +47,7 @@ typedef struct MemHeadAligned {
   size_t len;
 } MemHeadAligned;
 
-static unsigned int totblock = 0;
-static size_t mem_in_use = 0, peak_mem = 0;
+static size_t peak_mem = 0;
 static bool malloc_debug_memset = false;
 
 static void (*error_callback)(const char *) = NULL;
@@ -70,6 +73,244 @@ MEM_INLINE void update_maximum(size_t *maximum_value, size_t value)
 #endif
 }
 
+#ifdef _MSC_VER
+#  define MEM_THREAD_LOCAL __declspec(thread)
+#  define MEM_CACHE_LINE_ALIGN __declspec(align(64))
+#else
+#  define MEM_THREAD_LOCAL __thread
+#  define MEM_CACHE_LINE_ALIGN __attribute__((aligned(64)))
+#endif
+
+/* -------------------------------------------------------------------- */
+/** \name Thread Data
+ *
+ * Statistics and caches of freed blocks per thread, so threads allocating at the same time
+ * don't modify the same cache lines.
+ *
+ * Where possible the thread data is released when a thread exits, for other threads to use.
+ * \{ */
+
+#ifndef _WIN32
+#  define USE_THREAD_CACHE
+#endif
+
+#define MEM_STATS_SHARDS 64
+#define MEM_PEAK_UPDATE_INTERVAL (1024 * 1024)
+
+/**
+ * Counters of blocks and memory in use are split in shards, which are summed when queried.
+ *
+ * A thread owns one shard and updates its counters without atomic operations. Only when all
+ * shards are owned, threads share a shard with atomic updates. Memory may be freed by another
+ * thread than the one which allocated it, so the counters of a single shard may wrap around,
+ * only their sum is meaningful.
+ *
+ * The peak memory is updated every #MEM_PEAK_UPDATE_INTERVAL bytes allocated by a thread and
+ * when memory in use is queried, so shorter peaks may be missed.
+ *
+ * Shards are aligned (and so padded) to a cache line, to avoid false sharing between them.
+ */
+typedef struct MEM_CACHE_LINE_ALIGN MemStatsShard {
+  size_t mem_in_use;
+  size_t totblock;
+  /* Set while the shard is owned by a thread. */
+  unsigned int is_owned;
+} MemStatsShard;
+
+static MemStatsShard stats_shards[MEM_STATS_SHARDS];
+static MemStatsShard stats_shard_shared;
+
+static MEM_THREAD_LOCAL MemStatsShard *thread_stats_shard = NULL;
+static MEM_THREAD_LOCAL size_t thread_alloc_since_peak_update = 0;
+
+#ifdef USE_THREAD_CACHE
+
+/**
+ * Small blocks which are freed are kept in a cache of the freeing thread, and reused by the
+ * next allocations of the same size class in that thread, without going through the system
+ * allocator. Blocks are allocated with the full size of their size class for this.
+ */
+
+#  define MEM_THREAD_CACHE_CLASS_SIZE 16
+#  define MEM_THREAD_CACHE_NUM_CLASSES 16
+#  define MEM_THREAD_CACHE_MAX_LEN (MEM_THREAD_CACHE_CLASS_SIZE * MEM_THREAD_CACHE_NUM_CLASSES)
+#  define MEM_THREAD_CACHE_MAX_BLOCKS 64
+
+typedef struct MemThreadCache {
+  /* Singly linked lists of cached blocks, the next block is stored in the block data. */
+  MemHead *blocks[MEM_THREAD_CACHE_NUM_CLASSES];
+  unsigned int num_blocks[MEM_THREAD_CACHE_NUM_CLASSES];
+} MemThreadCache;
+
+static MEM_THREAD_LOCAL MemThreadCache thread_cache = {{NULL}, {0}};
+static MEM_THREAD_LOCAL bool thread_exit_registered = false;
+
+static pthread_key_t thread_exit_key;
+static pthread_once_t thread_exit_key_once = PTHREAD_ONCE_INIT;
+
+#  define THREAD_CACHE_NEXT(memh) (*(MemHead **)PTR_FROM_MEMHEAD(memh))
+
+static void thread_cache_free(void)
+{
+  for (int i = 0; i < MEM_THREAD_CACHE_NUM_CLASSES; i++) {
+    while (thread_cache.blocks[i]) {
+      MemHead *memh = thread_cache.blocks[i];
+      thread_cache.blocks[i] = THREAD_CACHE_NEXT(memh);
+      free(memh);
+    }
+    thread_cache.num_blocks[i] = 0;
+  }
+}
+
+static void thread_exit_func(void *UNUSED(value))
+{
+  thread_cache_free();
+  if (thread_stats_shard != &stats_shard_shared) {
+    atomic_cas_u(&thread_stats_shard->is_owned, 1, 0);
+  }
+  thread_stats_shard = NULL;
+  /* Register again if memory is allocated or freed by other thread exit callbacks. */
+  thread_exit_registered = false;
+}
+
+static void thread_exit_key_create(void)
+{
+  pthread_key_create(&thread_exit_key, thread_exit_func);
+}
+
+/* Release the thread data when the thread exits. */
+static void thread_exit_register(void)
+{
+  if (!thread_exit_registered) {
+    pthread_once(&thread_exit_key_once, thread_exit_key_create);
+    pthread_setspecific(thread_exit_key, &thread_cache);
+    thread_exit_registered = true;
+  }
+}
+
+MEM_INLINE size_t thread_cache_class(size_t len)
+{
+  return (len == 0) ? 0 : (len - 1) / MEM_THREAD_CACHE_CLASS_SIZE;
+}
+
+/* Take a block of the size class of len from the cache, NULL if there is none. */
+MEM_INLINE MemHead *thread_cache_pop(size_t len)
+{
+  if (len > MEM_THREAD_CACHE_MAX_LEN) {
+    return NULL;
+  }
+  const size_t index = thread_cache_class(len);
+  MemHead *memh = thread_cache.blocks[index];
+  if (memh) {
+    thread_cache.blocks[index] = THREAD_CACHE_NEXT(memh);
+    thread_cache.num_blocks[index]--;
+  }
+  return memh;
+}
+
+/* Keep the block for reuse, returns false if it has to be freed. */
+MEM_INLINE bool thread_cache_push(MemHead *memh, size_t len)
+{
+  if (len > MEM_THREAD_CACHE_MAX_LEN) {
+    return false;
+  }
+  const size_t index = thread_cache_class(len);
+  if (thread_cache.num_blocks[index] == MEM_THREAD_CACHE_MAX_BLOCKS) {
+    return false;
+  }
+  thread_exit_register();
+  THREAD_CACHE_NEXT(memh) = thread_cache.blocks[index];
+  thread_cache.blocks[index] = memh;
+  thread_cache.num_blocks[index]++;
+  return true;
+}
+
+#endif /* USE_THREAD_CACHE */
+
+/* Size to allocate for the data of a block of the given length. */
+MEM_INLINE size_t block_alloc_len(size_t len)
+{
+#ifdef USE_THREAD_CACHE
+  if (len <= MEM_THREAD_CACHE_MAX_LEN) {
+    return (thread_cache_class(len) + 1) * MEM_THREAD_CACHE_CLASS_SIZE;
+  }
+#endif
+  return len;
+}
+
+static MemStatsShard *stats_shard_acquire(void)
+{
+  for (int i = 0; i < MEM_STATS_SHARDS; i++) {
+    if (stats_shards[i].is_owned == 0 && atomic_cas_u(&stats_shards[i].is_owned, 0, 1) == 0) {
+#ifdef USE_THREAD_CACHE
+      thread_exit_register();
+#endif
+      return &stats_shards[i];
+    }
+  }
+  return &stats_shard_shared;
+}
+
+MEM_INLINE MemStatsShard *stats_shard_get(void)
+{
+  if (UNLIKELY(thread_stats_shard == NULL)) {
+    thread_stats_shard = stats_shard_acquire();
+  }
+  return thread_stats_shard;
+}
+
+static size_t stats_mem_in_use(void)
+{
+  size_t mem_in_use = stats_shard_shared.mem_in_use;
+  for (int i = 0; i < MEM_STATS_SHARDS; i++) {
+    mem_in_use += stats_shards[i].mem_in_use;
+  }
+  return mem_in_use;
+}
+
+static unsigned int stats_totblock(void)
+{
+  size_t totblock = stats_shard_shared.totblock;
+  for (int i = 0; i < MEM_STATS_SHARDS; i++) {
+    totblock += stats_shards[i].totblock;
+  }
+  return (unsigned int)totblock;
+}
+
+MEM_INLINE void stats_add_block(size_t len)
+{
+  MemStatsShard *shard = stats_shard_get();
+  if (LIKELY(shard != &stats_shard_shared)) {
+    shard->totblock++;
+    shard->mem_in_use += len;
+  }
+  else {
+    atomic_add_and_fetch_z(&shard->totblock, 1);
+    atomic_add_and_fetch_z(&shard->mem_in_use, len);
+  }
+
+  thread_alloc_since_peak_update += len;
+  if (UNLIKELY(thread_alloc_since_peak_update >= MEM_PEAK_UPDATE_INTERVAL)) {
+    thread_alloc_since_peak_update = 0;
+    update_maximum(&peak_mem, stats_mem_in_use());
+  }
+}
+
+MEM_INLINE void stats_remove_block(size_t len)
+{
+  MemStatsShard *shard = stats_shard_get();
+  if (LIKELY(shard != &stats_shard_shared)) {
+    shard->totblock--;
+    shard->mem_in_use -= len;
+  }
+  else {
+    atomic_sub_and_fetch_z(&shard->totblock, 1);
+    atomic_sub_and_fetch_z(&shard->mem_in_use, len);
+  }
+}
+
+/** \} */
+
 #ifdef __GNUC__
 __attribute__((format(printf, 1, 2)))
 #endif
@@ -115,8 +356,7 @@ void MEM_lockfree_freeN(void *vmemh)
     return;
   }
 
-  atomic_sub_and_fetch_u(&totblock, 1);
-  atomic_sub_and_fetch_z(&mem_in_use, len);
+  stats_remove_block(len);
 
   if (UNLIKELY(malloc_debug_memset && len)) {
     memset(memh + 1, 255, len);
@@ -125,6 +365,11 @@ void MEM_lockfree_freeN(void *vmemh)
     MemHeadAligned *memh_aligned = MEMHEAD_ALIGNED_FROM_PTR(vmemh);
     aligned_free(MEMHEAD_REAL_PTR(memh_aligned));
   }
+#ifdef USE_THREAD_CACHE
+  else if (thread_cache_push(memh, len)) {
+    /* Pass. */
+  }
+#endif
   else {
     free(memh);
   }
@@ -232,20 +477,27 @@ void *MEM_lockfree_callocN(size_t len, const char *str)
 
   len = SIZET_ALIGN_4(len);
 
-  memh = (MemHead *)calloc(1, len + sizeof(MemHead));
+#ifdef USE_THREAD_CACHE
+  memh = thread_cache_pop(len);
+  if (memh) {
+    memset(memh + 1, 0, len);
+  }
+  else
+#endif
+  {
+    memh = (MemHead *)calloc(1, block_alloc_len(len) + sizeof(MemHead));
+  }
 
   if (LIKELY(memh)) {
     memh->len = len;
-    atomic_add_and_fetch_u(&totblock, 1);
-    atomic_add_and_fetch_z(&mem_in_use, len);
-    update_maximum(&peak_mem, mem_in_use);
+    stats_add_block(len);
 
     return PTR_FROM_MEMHEAD(memh);
   }
   print_error("Calloc returns null: len=" SIZET_FORMAT " in %s, total %u\n",
               SIZET_ARG(len),
               str,
-              (unsigned int)mem_in_use);
+              (unsigned int)stats_mem_in_use());
   return NULL;
 }
 
@@ -259,7 +511,7 @@ void *MEM_lockfree_calloc_arrayN(size_t len, size_t size, const char *str)
         SIZET_ARG(len),
         SIZET_ARG(size),
         str,
-        (unsigned int)mem_in_use);
+        (unsigned int)stats_mem_in_use());
     abort();
     return NULL;
   }
@@ -273,7 +525,13 @@ void *MEM_lockfree_mallocN(size_t len, const char *str)
 
   len = SIZET_ALIGN_4(len);
 
-  memh = (MemHead *)malloc(len + sizeof(MemHead));
+#ifdef USE_THREAD_CACHE
+  memh = thread_cache_pop(len);
+  if (memh == NULL)
+#endif
+  {
+    memh = (MemHead *)malloc(block_alloc_len(len) + sizeof(MemHead));
+  }
 
   if (LIKELY(memh)) {
     if (UNLIKELY(malloc_debug_memset && len)) {
@@ -281,16 +539,14 @@ void *MEM_lockfree_mallocN(size_t len, const char *str)
     }
 
     memh->len = len;
-    atomic_add_and_fetch_u(&totblock, 1);
-    atomic_add_and_fetch_z(&mem_in_use, len);
-    update_maximum(&peak_mem, mem_in_use);
+    stats_add_block(len);
 
     return PTR_FROM_MEMHEAD(memh);
   }
   print_error("Malloc returns null: len=" SIZET_FORMAT " in %s, total %u\n",
               SIZET_ARG(len),
               str,
-              (unsigned int)mem_in_use);
+              (unsigned int)stats_mem_in_use());
   return NULL;
 }
 
@@ -304,7 +560,7 @@ void *MEM_lockfree_malloc_arrayN(size_t len, size_t size, const char *str)
         SIZET_ARG(len),
         SIZET_ARG(size),
         str,
-        (unsigned int)mem_in_use);
+        (unsigned int)stats_mem_in_use());
     abort();
     return NULL;
   }
@@ -352,16 +608,14 @@ void *MEM_lockfree_mallocN_aligned(size_t len, size_t alignment, const char *str
 
     memh->len = len | (size_t)MEMHEAD_ALIGN_FLAG;
     memh->alignment = (short)alignment;
-    atomic_add_and_fetch_u(&totblock, 1);
-    atomic_add_and_fetch_z(&mem_in_use, len);
-    update_maximum(&peak_mem, mem_in_use);
+    stats_add_block(len);
 
     return PTR_FROM_MEMHEAD(memh);
   }
   print_error("Malloc returns null: len=" SIZET_FORMAT " in %s, total %u\n",
               SIZET_ARG(len),
               str,
-              (unsigned int)mem_in_use);
+              (unsigned int)stats_mem_in_use());
   return NULL;
 }
 
@@ -381,6 +635,7 @@ void MEM_lockfree_callbackmemlist(void (*func)(void *))
 
 void MEM_lockfree_printmemlist_stats(void)
 {
+  const size_t mem_in_use = MEM_lockfree_get_memory_in_use();
   printf("\ntotal memory len: %.3f MB\n", (double)mem_in_use / (double)(1024 * 1024));
   printf("peak memory len: %.3f MB\n", (double)peak_mem / (double)(1024 * 1024));
   printf(
@@ -410,22 +665,25 @@ void MEM_lockfree_set_memory_debug(void)
 
 size_t MEM_lockfree_get_memory_in_use(void)
 {
+  const size_t mem_in_use = stats_mem_in_use();
+  update_maximum(&peak_mem, mem_in_use);
   return mem_in_use;
 }
 
 unsigned int MEM_lockfree_get_memory_blocks_in_use(void)
 {
-  return totblock;
+  return stats_totblock();
 }
 
 /* dummy */
 void MEM_lockfree_reset_peak_memory(void)
 {
-  peak_mem = mem_in_use;
+  peak_mem = stats_mem_in_use();
 }
 
 size_t MEM_lockfree_get_peak_memory(void)
 {
+  MEM_lockfree_get_memory_in_use();
   return peak_mem;
 }
 
@@ -0,0 +1,85 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <thread>
+#include <vector>
+
+#include "MEM_guardedalloc.h"
+#include "intern/mallocn_intern.h"
+
+namespace {
+
+/* Allocations of different sizes, both in and out of the range of the thread cache. */
+const std::vector<size_t> test_sizes = {0, 1, 7, 16, 24, 100, 256, 257, 1000, 5000};
+
+}  // namespace
+
+TEST(guardedalloc, LockfreeReuseFreedBlocks)
+{
+  const unsigned int blocks_start = MEM_lockfree_get_memory_blocks_in_use();
+  const size_t mem_start = MEM_lockfree_get_memory_in_use();
+
+  for (const size_t size : test_sizes) {
+    char *data = (char *)MEM_lockfree_mallocN(size, "test");
+    memset(data, 1, size);
+    EXPECT_EQ(MEM_lockfree_allocN_len(data), (size + 3) & ~(size_t)3);
+    MEM_lockfree_freeN(data);
+
+    /* Freed blocks may be reused, they have to be cleared again. */
+    char *zero_data = (char *)MEM_lockfree_callocN(size, "test");
+    for (size_t i = 0; i < size; i++) {
+      EXPECT_EQ(zero_data[i], 0);
+    }
+    zero_data = (char *)MEM_lockfree_reallocN_id(zero_data, size * 2 + 8, "test");
+    EXPECT_EQ(MEM_lockfree_allocN_len(zero_data), (size * 2 + 8 + 3) & ~(size_t)3);
+    MEM_lockfree_freeN(zero_data);
+  }
+
+  EXPECT_EQ(MEM_lockfree_get_memory_blocks_in_use(), blocks_start);
+  EXPECT_EQ(MEM_lockfree_get_memory_in_use(), mem_start);
+}
+
+TEST(guardedalloc, LockfreeThreadedCounters)
+{
+  const int num_threads = 8;
+  const int num_blocks = 1000;
+  const unsigned int blocks_start = MEM_lockfree_get_memory_blocks_in_use();
+  const size_t mem_start = MEM_lockfree_get_memory_in_use();
+
+  /* Allocate in threads and free in the main thread, so counters are increased and decreased
+   * by different threads. */
+  std::vector<std::vector<void *>> blocks(num_threads);
+  std::vector<std::thread> threads;
+  for (int thread_index = 0; thread_index < num_threads; thread_index++) {
+    threads.emplace_back([&blocks, thread_index]() {
+      for (int i = 0; i < num_blocks; i++) {
+        const size_t size = test_sizes[i % test_sizes.size()];
+        blocks[thread_index].push_back(MEM_lockfree_mallocN(size, "test"));
+        if (i % 2) {
+          /* Blocks freed by the thread itself go to its cache. */
+          MEM_lockfree_freeN(MEM_lockfree_callocN(size, "test"));
+        }
+      }
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+
+  size_t mem_expected = 0;
+  for (int i = 0; i < num_blocks; i++) {
+    mem_expected += (test_sizes[i % test_sizes.size()] + 3) & ~(size_t)3;
+  }
+  EXPECT_EQ(MEM_lockfree_get_memory_blocks_in_use(), blocks_start + num_threads * num_blocks);
+  EXPECT_EQ(MEM_lockfree_get_memory_in_use(), mem_start + num_threads * mem_expected);
+  EXPECT_GE(MEM_lockfree_get_peak_memory(), mem_start + num_threads * mem_expected);
+
+  for (const std::vector<void *> &thread_blocks : blocks) {
+    for (void *block : thread_blocks) {
+      MEM_lockfree_freeN(block);
+    }
+  }
+  EXPECT_EQ(MEM_lockfree_get_memory_blocks_in_use(), blocks_start);
+  EXPECT_EQ(MEM_lockfree_get_memory_in_use(), mem_start);
+}
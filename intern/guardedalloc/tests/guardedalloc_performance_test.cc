@@ -0,0 +1,97 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+#include <vector>
+
+#include "MEM_guardedalloc.h"
+#include "intern/mallocn_intern.h"
+
+#include "PIL_time.h"
+
+#define NUM_RUN_AVERAGED 5
+#define NUM_ITERATIONS 20000
+#define NUM_BLOCKS_PER_ITERATION 64
+
+namespace {
+
+/* Small allocations of varying sizes, like the ones of BMesh operators and modifiers. */
+static size_t block_size(const int index)
+{
+  return 8 + (size_t)((index * 2654435761u) % 249);
+}
+
+static void *system_malloc(size_t len, const char *UNUSED(str))
+{
+  return malloc(len);
+}
+
+static void system_free(void *ptr)
+{
+  free(ptr);
+}
+
+typedef void *(*MallocFn)(size_t len, const char *str);
+typedef void (*FreeFn)(void *ptr);
+
+static void alloc_free_blocks(MallocFn malloc_fn, FreeFn free_fn)
+{
+  void *blocks[NUM_BLOCKS_PER_ITERATION];
+  for (int iter = 0; iter < NUM_ITERATIONS; iter++) {
+    for (int i = 0; i < NUM_BLOCKS_PER_ITERATION; i++) {
+      blocks[i] = malloc_fn(block_size(iter + i), "test");
+      *(char *)blocks[i] = (char)i;
+    }
+    for (int i = 0; i < NUM_BLOCKS_PER_ITERATION; i++) {
+      free_fn(blocks[i]);
+    }
+  }
+}
+
+static double alloc_free_time(const int num_threads, MallocFn malloc_fn, FreeFn free_fn)
+{
+  double time_total = 0.0;
+  for (int run = 0; run < NUM_RUN_AVERAGED; run++) {
+    const double time_start = PIL_check_seconds_timer();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_threads; i++) {
+      threads.emplace_back(alloc_free_blocks, malloc_fn, free_fn);
+    }
+    for (std::thread &thread : threads) {
+      thread.join();
+    }
+    time_total += PIL_check_seconds_timer() - time_start;
+  }
+  return time_total / NUM_RUN_AVERAGED;
+}
+
+static void alloc_free_perf(const int num_threads)
+{
+  const double time_system = alloc_free_time(num_threads, system_malloc, system_free);
+  const double time_lockfree = alloc_free_time(
+      num_threads, MEM_lockfree_mallocN, MEM_lockfree_freeN);
+  const double num_allocs = (double)num_threads * NUM_ITERATIONS * NUM_BLOCKS_PER_ITERATION;
+
+  printf("%2d threads: system %.4fs (%.1f Mallocs/s), lockfree %.4fs (%.1f Mallocs/s)\n",
+         num_threads,
+         time_system,
+         num_allocs / time_system * 1e-6,
+         time_lockfree,
+         num_allocs / time_lockfree * 1e-6);
+}
+
+}  // namespace
+
+TEST(guardedalloc, LockfreeThreadedAllocFree)
+{
+  const int max_threads = (int)std::thread::hardware_concurrency();
+  printf("\n========== STARTING lockfree alloc/free ==========\n");
+  for (int num_threads = 1; num_threads < max_threads; num_threads *= 2) {
+    alloc_free_perf(num_threads);
+  }
+  alloc_free_perf(max_threads);
+  printf("========== ENDED lockfree alloc/free ==========\n\n");
+}
@@ -642,13 +642,18 @@ class NODE_PT_quality(bpy.types.Panel):
         snode = context.space_data
         tree = snode.node_tree
 
+        col = layout.column()
+        col.prop(tree, "execution_mode")
+
         col = layout.column()
         col.prop(tree, "render_quality", text="Render")
         col.prop(tree, "edit_quality", text="Edit")
         col.prop(tree, "chunk_size")
 
         col = layout.column()
-        col.prop(tree, "use_opencl")
+        sub = col.column()
+        sub.active = tree.execution_mode == 'TILED'
+        sub.prop(tree, "use_opencl")
         col.prop(tree, "use_groupnode_buffer")
         col.prop(tree, "use_two_pass")
         col.prop(tree, "use_viewer_border")
@@ -1803,6 +1803,7 @@ class SEQUENCER_PT_cache_settings(SequencerButtonsPanel, Panel):
         col.prop(ed, "use_cache_final", text="Final")
         col.separator()
         col.prop(ed, "recycle_max_cost")
+        col.prop(ed, "use_recycle_by_cost")
 
 
 class SEQUENCER_PT_proxy_settings(SequencerButtonsPanel, Panel):
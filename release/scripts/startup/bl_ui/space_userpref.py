@@ -633,6 +633,7 @@ class USERPREF_PT_system_video_sequencer(SystemPanel, CenterAlignMixIn, Panel):
         edit = prefs.edit
 
         layout.prop(system, "memory_cache_limit")
+        layout.prop(system, "compositor_cache_limit")
 
         layout.separator()
 
@@ -2183,6 +2184,7 @@ class USERPREF_PT_experimental_new_features(ExperimentalPanel, Panel):
                 ({"property": "use_new_particle_system"}, "T73324"),
                 ({"property": "use_sculpt_vertex_colors"}, "T71947"),
                 ({"property": "use_tools_missing_icons"}, "T80331"),
+                ({"property": "use_mmap_file_read"}, None),
             ),
         )
 
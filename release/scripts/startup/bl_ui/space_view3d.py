@@ -2985,6 +2985,7 @@ class VIEW3D_MT_sculpt(Menu):
         layout.separator()
 
         layout.operator("sculpt.optimize")
+        layout.operator("sculpt.sort_by_bvh")
 
 
 class VIEW3D_MT_mask(Menu):
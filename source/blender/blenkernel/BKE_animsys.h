@@ -281,6 +281,14 @@ void BKE_animsys_eval_driver(struct Depsgraph *depsgraph,
 
 void BKE_animsys_update_driver_array(struct ID *id);
 
+/* Evaluated IDs keep the resolved RNA paths of their active action between evaluations,
+ * see anim_sys.c. */
+struct AnimEvalPlan;
+
+void BKE_animsys_eval_plan_free(struct AnimEvalPlan *plan);
+/* Call when evaluated actions or data-blocks changed without updating the IDs they animate. */
+void BKE_animsys_eval_plans_invalidate(void);
+
 /* ************************************* */
 
 #ifdef __cplusplus
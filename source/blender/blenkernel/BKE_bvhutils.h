@@ -259,6 +259,9 @@ bool bvhcache_has_tree(const struct BVHCache *bvh_cache, const BVHTree *tree);
 struct BVHCache *bvhcache_init(void);
 void bvhcache_free(struct BVHCache *bvh_cache);
 
+struct BVHCache *bvhcache_detach_for_reuse(struct Mesh *mesh);
+void bvhcache_reuse(struct Mesh *mesh, struct BVHCache **bvh_cache_reuse_p);
+
 #ifdef __cplusplus
 }
 #endif
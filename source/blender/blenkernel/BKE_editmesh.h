@@ -83,6 +83,14 @@ typedef struct BMEditMesh {
    */
   char needs_flush_to_id;
 
+  /**
+   * The edit-mesh undo state this data was last written to or read from, zero when unknown.
+   * Allows undo steps to be restored without rebuilding the #BMesh, see `editmesh_undo.c`.
+   * Cleared by the functions updating the edit-mesh after changes, since these may not be
+   * followed by an undo push.
+   */
+  uint undo_state_id;
+
 } BMEditMesh;
 
 /* editmesh.c */
@@ -279,6 +279,19 @@ void correct_bezpart(const float v1[2], float v2[2], float v3[2], const float v4
 
 /* -------- Evaluation --------  */
 
+/* State kept between evaluations of the same F-Curve, which makes finding the keyframes around
+ * the evaluation time cheap when it changes gradually (playback, scrubbing).
+ * Zero initialize, and reset whenever the keyframes change. The result of an evaluation doesn't
+ * depend on the hint. */
+typedef struct FCurveEvalHint {
+  /* Index of the keyframe found by the last evaluation, 0 when unknown. */
+  int bezt_index;
+  /* Index of the keyframe ending the Bezier segment stored in #bezier, 0 when unknown. */
+  int bezier_index;
+  /* Points and handles of that segment, already corrected to not overlap. */
+  float bezier[4][2];
+} FCurveEvalHint;
+
 /* evaluate fcurve */
 float evaluate_fcurve(struct FCurve *fcu, float evaltime);
 float evaluate_fcurve_only_curve(struct FCurve *fcu, float evaltime);
@@ -291,6 +304,10 @@ bool BKE_fcurve_is_empty(struct FCurve *fcu);
 float calculate_fcurve(struct PathResolvedRNA *anim_rna,
                        struct FCurve *fcu,
                        const struct AnimationEvalContext *anim_eval_context);
+float calculate_fcurve_hinted(struct PathResolvedRNA *anim_rna,
+                              struct FCurve *fcu,
+                              const struct AnimationEvalContext *anim_eval_context,
+                              FCurveEvalHint *hint);
 
 /* ************* F-Curve Samples API ******************** */
 
@@ -155,7 +155,8 @@ enum {
   G_DEBUG_XR = (1 << 21),                    /* XR/OpenXR messages */
   G_DEBUG_XR_TIME = (1 << 22),               /* XR/OpenXR timing messages */
 
-  G_DEBUG_GHOST = (1 << 23), /* Debug GHOST module. */
+  G_DEBUG_GHOST = (1 << 23),       /* Debug GHOST module. */
+  G_DEBUG_SCULPT_TIME = (1 << 24), /* Sculpt per-dab timing messages. */
 };
 
 #define G_DEBUG_ALL \
@@ -188,6 +188,7 @@ bool BKE_mesh_material_index_used(struct Mesh *me, short index);
 void BKE_mesh_material_index_clear(struct Mesh *me);
 void BKE_mesh_material_remap(struct Mesh *me, const unsigned int *remap, unsigned int remap_len);
 void BKE_mesh_smooth_flag_set(struct Mesh *me, const bool use_smooth);
+void BKE_mesh_remap(struct Mesh *me, const unsigned int *vert_idx, const unsigned int *poly_idx);
 
 const char *BKE_mesh_cmp(struct Mesh *me1, struct Mesh *me2, float thresh);
 
@@ -302,6 +303,14 @@ void BKE_mesh_calc_normals_poly(struct MVert *mverts,
                                 int numPolys,
                                 float (*r_polyNors)[3],
                                 const bool only_face_normals);
+void BKE_mesh_calc_normals_poly_coords(const float (*vert_coords)[3],
+                                       int numVerts,
+                                       const struct MLoop *mloop,
+                                       const struct MPoly *mpolys,
+                                       int numLoops,
+                                       int numPolys,
+                                       float (*r_vertnors)[3],
+                                       float (*r_polyNors)[3]);
 void BKE_mesh_calc_normals(struct Mesh *me);
 void BKE_mesh_ensure_normals(struct Mesh *me);
 void BKE_mesh_ensure_normals_for_display(struct Mesh *mesh);
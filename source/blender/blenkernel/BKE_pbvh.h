@@ -113,6 +113,10 @@ void BKE_pbvh_build_mesh(PBVH *pbvh,
                          struct CustomData *pdata,
                          const struct MLoopTri *looptri,
                          int looptri_num);
+void BKE_pbvh_mesh_leaf_order_calc(const PBVH *pbvh,
+                                   const int totpoly,
+                                   unsigned int *r_vert_idx,
+                                   unsigned int *r_poly_idx);
 void BKE_pbvh_build_grids(PBVH *pbvh,
                           struct CCGElem **grids,
                           int totgrid,
@@ -331,6 +331,17 @@ void BKE_sequencer_proxy_set(struct Sequence *seq, bool value);
 
 #define SEQ_CACHE_COST_MAX 10.0f
 
+typedef struct SeqCacheStats {
+  /** Images found in memory cache. */
+  uint64_t hits;
+  /** Images looked up, but not found in memory cache. */
+  uint64_t misses;
+  /** Frames removed from memory cache to make room for new images. */
+  uint64_t recycled;
+  size_t memory_used;
+  int items_num;
+} SeqCacheStats;
+
 struct ImBuf *BKE_sequencer_cache_get(const SeqRenderData *context,
                                       struct Sequence *seq,
                                       float cfra,
@@ -369,6 +380,7 @@ void BKE_sequencer_cache_iterate(struct Scene *scene,
                                                     int cache_type,
                                                     float cost));
 bool BKE_sequencer_cache_is_full(struct Scene *scene);
+void BKE_sequencer_cache_stats_get(struct Scene *scene, SeqCacheStats *r_stats);
 
 /* **********************************************************************
  * seqprefetch.c
@@ -35,6 +35,7 @@ struct VolumeGridVector;
 /* Module */
 
 void BKE_volumes_init(void);
+void BKE_volumes_exit(void);
 
 /* Datablock Management */
 
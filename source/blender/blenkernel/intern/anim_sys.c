@@ -773,6 +773,176 @@ void animsys_evaluate_action(PointerRNA *ptr,
   animsys_evaluate_action_ex(ptr, act, anim_eval_context, flush_to_original);
 }
 
+/* ----------------------------------------- */
+/* Evaluation Plan
+ *
+ * Evaluating the active action of an ID mostly goes into resolving the RNA paths of the
+ * F-Curves, which give the same result every frame. The plan of an evaluated ID keeps the
+ * resolved properties and the F-Curve evaluation hints between evaluations, it's stored in the
+ * AnimData of the ID.
+ *
+ * The plan points to F-Curves of the evaluated action and data of the evaluated ID. Updating the
+ * copy-on-write of the ID frees its AnimData and with that the plan. Updating the copy of an
+ * action or rebuilding dependency graph relations invalidates all plans, see
+ * #BKE_animsys_eval_plans_invalidate.
+ *
+ * Nothing is cached for the original ID, its data can change without any update of the
+ * dependency graph (removing ID properties from Python for example). Flushing values to the
+ * original is only done for the active dependency graph, so resolving the paths there again
+ * is acceptable.
+ */
+
+typedef enum eAnimEvalChannelState {
+  /** The path didn't resolve yet. */
+  ANIM_EVAL_CHANNEL_UNRESOLVED = 0,
+  /** The resolved property is stored in the channel. */
+  ANIM_EVAL_CHANNEL_RESOLVED = 1,
+  /** The path leads outside of the ID, the data could change without invalidating the plan. */
+  ANIM_EVAL_CHANNEL_UNCACHED = 2,
+} eAnimEvalChannelState;
+
+typedef struct AnimEvalChannel {
+  FCurve *fcu;
+  /** Property of the evaluated ID. */
+  PathResolvedRNA anim_rna;
+  /** #eAnimEvalChannelState of the property. */
+  char state;
+  FCurveEvalHint hint;
+} AnimEvalChannel;
+
+typedef struct AnimEvalPlan {
+  /** The action the plan was made for, with #anim_eval_plan_generation at that time. */
+  bAction *action;
+  uint generation;
+  int channels_num;
+  /** One channel for every F-Curve of the action, in the same order. */
+  AnimEvalChannel *channels;
+} AnimEvalPlan;
+
+static uint anim_eval_plan_generation = 0;
+
+void BKE_animsys_eval_plans_invalidate(void)
+{
+  atomic_add_and_fetch_u(&anim_eval_plan_generation, 1);
+}
+
+void BKE_animsys_eval_plan_free(AnimEvalPlan *plan)
+{
+  MEM_SAFE_FREE(plan->channels);
+  MEM_freeN(plan);
+}
+
+/* Plans are only made for evaluated IDs, since edits of the original data don't tag anything
+ * themselves. The scene is left out because its copy is updated differently (sequencer strips
+ * for example are synchronized during evaluation). */
+static bool animsys_eval_plan_is_supported(const ID *id)
+{
+  return (id->tag & LIB_TAG_COPIED_ON_WRITE) && (GS(id->name) != ID_SCE);
+}
+
+static AnimEvalPlan *animsys_eval_plan_ensure(AnimData *adt)
+{
+  const uint generation = atomic_add_and_fetch_u(&anim_eval_plan_generation, 0);
+  AnimEvalPlan *plan = adt->eval_plan;
+
+  if (plan != NULL) {
+    if ((plan->action == adt->action) && (plan->generation == generation)) {
+      return plan;
+    }
+    BKE_animsys_eval_plan_free(plan);
+  }
+
+  plan = MEM_callocN(sizeof(AnimEvalPlan), "AnimEvalPlan");
+  plan->action = adt->action;
+  plan->generation = generation;
+  plan->channels_num = BLI_listbase_count(&adt->action->curves);
+  if (plan->channels_num > 0) {
+    plan->channels = MEM_calloc_arrayN(
+        plan->channels_num, sizeof(AnimEvalChannel), "AnimEvalPlan channels");
+    int index = 0;
+    LISTBASE_FOREACH (FCurve *, fcu, &adt->action->curves) {
+      plan->channels[index++].fcu = fcu;
+    }
+  }
+
+  adt->eval_plan = plan;
+  return plan;
+}
+
+/* Resolve the path of the F-Curve, only the first time when it's a property of the ID itself.
+ * Paths that don't resolve are tried again, like animsys_evaluate_fcurves() does. */
+static bool animsys_eval_channel_resolve(PointerRNA *ptr,
+                                         const FCurve *fcu,
+                                         char *state,
+                                         PathResolvedRNA *resolved,
+                                         PathResolvedRNA *r_anim_rna)
+{
+  if (*state == ANIM_EVAL_CHANNEL_RESOLVED) {
+    *r_anim_rna = *resolved;
+    return true;
+  }
+  if (!BKE_animsys_store_rna_setting(ptr, fcu->rna_path, fcu->array_index, r_anim_rna)) {
+    return false;
+  }
+  if (*state == ANIM_EVAL_CHANNEL_UNRESOLVED) {
+    if (r_anim_rna->ptr.owner_id == ptr->owner_id) {
+      *resolved = *r_anim_rna;
+      *state = ANIM_EVAL_CHANNEL_RESOLVED;
+    }
+    else {
+      *state = ANIM_EVAL_CHANNEL_UNCACHED;
+    }
+  }
+  return true;
+}
+
+/* Same as animsys_evaluate_action_ex() for the active action, using the plan of the ID. */
+static void animsys_evaluate_action_plan(PointerRNA *ptr,
+                                         AnimData *adt,
+                                         const AnimationEvalContext *anim_eval_context,
+                                         const bool flush_to_original)
+{
+  action_idcode_patch_check(ptr->owner_id, adt->action);
+
+  AnimEvalPlan *plan = animsys_eval_plan_ensure(adt);
+
+  PointerRNA ptr_orig;
+  const bool write_orig = flush_to_original && animsys_construct_orig_pointer_rna(ptr, &ptr_orig);
+
+  for (int index = 0; index < plan->channels_num; index++) {
+    AnimEvalChannel *channel = &plan->channels[index];
+    FCurve *fcu = channel->fcu;
+
+    /* Same checks as animsys_evaluate_fcurves(). */
+    if ((fcu->grp != NULL) && (fcu->grp->flag & AGRP_MUTED)) {
+      continue;
+    }
+    if ((fcu->flag & (FCURVE_MUTED | FCURVE_DISABLED))) {
+      continue;
+    }
+    if (BKE_fcurve_is_empty(fcu)) {
+      continue;
+    }
+
+    PathResolvedRNA anim_rna;
+    if (!animsys_eval_channel_resolve(
+            ptr, fcu, &channel->state, &channel->anim_rna, &anim_rna)) {
+      continue;
+    }
+    const float curval = calculate_fcurve_hinted(
+        &anim_rna, fcu, anim_eval_context, &channel->hint);
+    BKE_animsys_write_rna_setting(&anim_rna, curval);
+
+    if (write_orig) {
+      PathResolvedRNA orig_anim_rna;
+      if (BKE_animsys_store_rna_setting(
+              &ptr_orig, fcu->rna_path, fcu->array_index, &orig_anim_rna)) {
+        BKE_animsys_write_rna_setting(&orig_anim_rna, curval);
+      }
+    }
+  }
+}
+
 /* ***************************************** */
 /* NLA System - Evaluation */
 
@@ -2639,7 +2809,12 @@ void BKE_animsys_evaluate_animdata(ID *id,
     }
     /* evaluate Active Action only */
     else if (adt->action) {
-      animsys_evaluate_action_ex(&id_ptr, adt->action, anim_eval_context, flush_to_original);
+      if (animsys_eval_plan_is_supported(id)) {
+        animsys_evaluate_action_plan(&id_ptr, adt, anim_eval_context, flush_to_original);
+      }
+      else {
+        animsys_evaluate_action_ex(&id_ptr, adt->action, anim_eval_context, flush_to_original);
+      }
     }
   }
 
@@ -61,14 +61,18 @@ static CLG_LogRef LOG = {"bke.armature_deform"};
 /** \name Armature Deform Internal Utilities
  * \{ */
 
-/* Add the effect of one bone or B-Bone segment to the accumulated result. */
+/**
+ * Add the effect of one bone or B-Bone segment to the accumulated result.
+ * With \a mat_accum the matrices are blended instead of accumulating the offset in \a co_accum,
+ * see #armature_vert_task_with_dvert.
+ */
 static void pchan_deform_accumulate(const DualQuat *deform_dq,
                                     const float deform_mat[4][4],
                                     const float co_in[3],
                                     float weight,
                                     float co_accum[3],
                                     DualQuat *dq_accum,
-                                    float mat_accum[3][3])
+                                    float mat_accum[4][4])
 {
   if (weight == 0.0f) {
     return;
@@ -79,19 +83,15 @@ static void pchan_deform_accumulate(const DualQuat *deform_dq,
 
     add_weighted_dq_dq(dq_accum, deform_dq, weight);
   }
+  else if (mat_accum) {
+    madd_m4_m4m4fl(mat_accum, mat_accum, deform_mat, weight);
+  }
   else {
     float tmp[3];
     mul_v3_m4v3(tmp, deform_mat, co_in);
 
     sub_v3_v3(tmp, co_in);
     madd_v3_v3fl(co_accum, tmp, weight);
-
-    if (mat_accum) {
-      float tmpmat[3][3];
-      copy_m3_m4(tmpmat, deform_mat);
-
-      madd_m3_m3m3fl(mat_accum, mat_accum, tmpmat, weight);
-    }
   }
 }
 
@@ -100,7 +100,7 @@ static void b_bone_deform(const bPoseChannel *pchan,
                           float weight,
                           float vec[3],
                           DualQuat *dq,
-                          float defmat[3][3])
+                          float defmat[4][4])
 {
   const DualQuat *quats = pchan->runtime.bbone_dual_quats;
   const Mat4 *mats = pchan->runtime.bbone_deform_mats;
@@ -175,7 +175,7 @@ float distfactor_to_bone(
 }
 
 static float dist_bone_deform(
-    bPoseChannel *pchan, float vec[3], DualQuat *dq, float mat[3][3], const float co[3])
+    bPoseChannel *pchan, float vec[3], DualQuat *dq, float mat[4][4], const float co[3])
 {
   Bone *bone = pchan->bone;
   float fac, contrib = 0.0;
@@ -208,7 +208,7 @@ static void pchan_bone_deform(bPoseChannel *pchan,
                               float weight,
                               float vec[3],
                               DualQuat *dq,
-                              float mat[3][3],
+                              float mat[4][4],
                               const float co[3],
                               float *contrib)
 {
@@ -282,8 +282,8 @@ static void armature_vert_task_with_dvert(const ArmatureUserdata *data,
   DualQuat sumdq, *dq = NULL;
   bPoseChannel *pchan;
   float *co, dco[3];
-  float sumvec[3], summat[3][3];
-  float *vec = NULL, (*smat)[3] = NULL;
+  float sumvec[3], summat[3][3], summat4[4][4];
+  float *vec = NULL, (*smat)[3] = NULL, (*smat4)[4] = NULL;
   float contrib = 0.0f;
   float armature_weight = 1.0f; /* default to 1 if no overall def group */
   float prevco_weight = 1.0f;   /* weight for optional cached vertexcos */
@@ -297,8 +297,9 @@ static void armature_vert_task_with_dvert(const ArmatureUserdata *data,
     vec = sumvec;
 
     if (vert_deform_mats) {
-      zero_m3(summat);
-      smat = summat;
+      /* Blend the bone matrices, the deform matrix is part of the result. */
+      zero_m4(summat4);
+      smat4 = summat4;
     }
   }
 
@@ -344,14 +345,14 @@ static void armature_vert_task_with_dvert(const ArmatureUserdata *data,
               co, bone->arm_head, bone->arm_tail, bone->rad_head, bone->rad_tail, bone->dist);
         }
 
-        pchan_bone_deform(pchan, weight, vec, dq, smat, co, &contrib);
+        pchan_bone_deform(pchan, weight, vec, dq, smat4, co, &contrib);
       }
     }
     /* If there are vertex-groups but not groups with bones (like for soft-body groups). */
     if (deformed == 0 && use_envelope) {
       for (pchan = data->ob_arm->pose->chanbase.first; pchan; pchan = pchan->next) {
         if (!(pchan->bone->flag & BONE_NO_DEFORM)) {
-          contrib += dist_bone_deform(pchan, vec, dq, smat, co);
+          contrib += dist_bone_deform(pchan, vec, dq, smat4, co);
         }
       }
     }
@@ -359,11 +360,20 @@ static void armature_vert_task_with_dvert(const ArmatureUserdata *data,
   else if (use_envelope) {
     for (pchan = data->ob_arm->pose->chanbase.first; pchan; pchan = pchan->next) {
       if (!(pchan->bone->flag & BONE_NO_DEFORM)) {
-        contrib += dist_bone_deform(pchan, vec, dq, smat, co);
+        contrib += dist_bone_deform(pchan, vec, dq, smat4, co);
       }
     }
   }
 
+  if (smat4) {
+    /* Same offset as adding `weight * (mat * co - co)` for every bone,
+     * the weights add up in the last element of the blended matrices. */
+    mul_v3_m4v3(sumvec, summat4, co);
+    madd_v3_v3fl(sumvec, co, -summat4[3][3]);
+    copy_m3_m4(summat, summat4);
+    smat = summat;
+  }
+
   /* actually should be EPSILON? weight values and contrib can be like 10e-39 small */
   if (contrib > 0.0001f) {
     if (use_quaternion) {
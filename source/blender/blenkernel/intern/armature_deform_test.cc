@@ -0,0 +1,258 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation
+ * All rights reserved.
+ */
+
+#include "MEM_guardedalloc.h"
+
+#include "CLG_log.h"
+
+#include "DNA_armature_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_object_types.h"
+
+#include "BLI_listbase.h"
+#include "BLI_math.h"
+#include "BLI_string.h"
+#include "BLI_utildefines.h"
+
+#include "BKE_action.h"
+#include "BKE_armature.h"
+#include "BKE_customdata.h"
+#include "BKE_deform.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+#include "BKE_object.h"
+
+#include "testing/testing.h"
+
+namespace blender::bke::tests {
+
+static const float FLOAT_EPSILON = 1e-6f;
+
+#define VERTS_NUM 64
+
+/* Vertex groups of the target, in #Object.defbase order. */
+enum {
+  DEFGROUP_A = 0,
+  DEFGROUP_B,
+  /** Bone with #BONE_NO_DEFORM. */
+  DEFGROUP_NO_DEFORM,
+  /** Bone with #BONE_MULT_VG_ENV, its deformation depends on the vertex position. */
+  DEFGROUP_ENVELOPE,
+  /** Group without a bone, like a soft-body group. */
+  DEFGROUP_SOFT,
+};
+
+/**
+ * With linear blending, deform matrices are calculated from the blended bone matrices. Without
+ * them the offsets of the bones are added, both must move verts the same way.
+ */
+class ArmatureDeformTest : public testing::Test {
+ public:
+  static void SetUpTestCase()
+  {
+    CLG_init();
+    BKE_idtype_init();
+  }
+
+  static void TearDownTestCase()
+  {
+    CLG_exit();
+  }
+
+ protected:
+  void SetUp() override
+  {
+    bmain = BKE_main_new();
+
+    bArmature *arm = BKE_armature_add(bmain, "Armature");
+    bone_add(arm, "A", 0);
+    bone_add(arm, "B", 0);
+    bone_add(arm, "NoDeform", BONE_NO_DEFORM);
+    bone_add(arm, "Envelope", BONE_MULT_VG_ENV);
+    BKE_armature_where_is(arm);
+
+    ob_arm = BKE_object_add_only_object(bmain, OB_ARMATURE, "Armature");
+    ob_arm->data = arm;
+    BKE_pose_rebuild(NULL, ob_arm, arm, false);
+
+    /* Pose evaluation isn't tested here, set the deform matrices it would calculate. */
+    const float pose_locs[4][3] = {{0.5f, 0, 0}, {0, 0.25f, -1}, {1, 1, 1}, {0, -0.5f, 0}};
+    const float pose_eul[4][3] = {{0.3f, 0, 0}, {0, 0.5f, 0.2f}, {1, 0, 0}, {0, 0, -0.4f}};
+    const float pose_scales[4][3] = {{1, 1, 1}, {1.5f, 1, 0.5f}, {1, 1, 1}, {1, 2, 1}};
+    int i = 0;
+    LISTBASE_FOREACH (bPoseChannel *, pchan, &ob_arm->pose->chanbase) {
+      loc_eul_size_to_mat4(pchan->chan_mat, pose_locs[i], pose_eul[i], pose_scales[i]);
+      mul_m4_m4m4(pchan->pose_mat, pchan->chan_mat, pchan->bone->arm_mat);
+      mat4_to_dquat(&pchan->runtime.deform_dual_quat, pchan->bone->arm_mat, pchan->chan_mat);
+      i++;
+    }
+
+    /* Only translated, so the deform matrices are the blended bone matrices. */
+    ob_target = BKE_object_add_only_object(bmain, OB_MESH, "Mesh");
+    const float target_loc[3] = {0.1f, -0.2f, 0.3f};
+    translate_m4(ob_target->obmat, UNPACK3(target_loc));
+    BKE_object_defgroup_new(ob_target, "A");
+    BKE_object_defgroup_new(ob_target, "B");
+    BKE_object_defgroup_new(ob_target, "NoDeform");
+    BKE_object_defgroup_new(ob_target, "Envelope");
+    BKE_object_defgroup_new(ob_target, "Soft");
+
+    me = BKE_mesh_new_nomain(VERTS_NUM, 0, 0, 0, 0);
+    me->dvert = (MDeformVert *)CustomData_add_layer(
+        &me->vdata, CD_MDEFORMVERT, CD_CALLOC, NULL, VERTS_NUM);
+    for (i = 0; i < VERTS_NUM; i++) {
+      MVert *mv = &me->mvert[i];
+      MDeformVert *dv = &me->dvert[i];
+      mv->co[0] = (float)(i % 4) * 0.5f;
+      mv->co[1] = (float)(i / 4 % 4) * 0.5f;
+      mv->co[2] = (float)(i / 16) * 0.5f;
+
+      const float weight = (float)(i % 5 + 1) / 5.0f;
+      switch (i % 8) {
+        case 0:
+          break;
+        case 1:
+          BKE_defvert_add_index_notest(dv, DEFGROUP_SOFT, 1.0f);
+          break;
+        case 2:
+          BKE_defvert_add_index_notest(dv, DEFGROUP_NO_DEFORM, weight);
+          break;
+        case 3:
+          BKE_defvert_add_index_notest(dv, DEFGROUP_A, weight);
+          BKE_defvert_add_index_notest(dv, DEFGROUP_ENVELOPE, 1.0f);
+          break;
+        case 4:
+          BKE_defvert_add_index_notest(dv, DEFGROUP_A, 1.0f);
+          break;
+        case 5:
+          BKE_defvert_add_index_notest(dv, DEFGROUP_B, weight);
+          BKE_defvert_add_index_notest(dv, DEFGROUP_A, 0.0f);
+          BKE_defvert_add_index_notest(dv, DEFGROUP_SOFT, 0.5f);
+          break;
+        default:
+          BKE_defvert_add_index_notest(dv, DEFGROUP_A, weight);
+          BKE_defvert_add_index_notest(dv, DEFGROUP_NO_DEFORM, 0.5f);
+          BKE_defvert_add_index_notest(dv, DEFGROUP_B, 1.0f - weight);
+          break;
+      }
+    }
+    ob_target->data = me;
+  }
+
+  void TearDown() override
+  {
+    BKE_id_free(NULL, me);
+    BKE_main_free(bmain);
+  }
+
+  void bone_add(bArmature *arm, const char *name, const int flag)
+  {
+    const int bone_index = BLI_listbase_count(&arm->bonebase);
+    Bone *bone = (Bone *)MEM_callocN(sizeof(Bone), "Bone");
+    STRNCPY(bone->name, name);
+    bone->flag = flag;
+    bone->head[0] = (float)bone_index * 0.5f;
+    copy_v3_v3(bone->tail, bone->head);
+    bone->tail[1] += 1.0f;
+    bone->length = 1.0f;
+    unit_m3(bone->bone_mat);
+    bone->weight = 1.0f;
+    bone->dist = 0.25f;
+    bone->rad_head = 0.5f;
+    bone->rad_tail = 0.5f;
+    bone->segments = 1;
+    BLI_addtail(&arm->bonebase, bone);
+  }
+
+  /* Deform with and without deform matrices, the coordinates must be the same. */
+  void deform_with_mats(const int deformflag, float (*r_coords)[3], float (*r_mats)[3][3])
+  {
+    float(*coords)[3] = BKE_mesh_vert_coords_alloc(me, NULL);
+    BKE_mesh_vert_coords_get(me, r_coords);
+    for (int i = 0; i < VERTS_NUM; i++) {
+      unit_m3(r_mats[i]);
+    }
+
+    BKE_armature_deform_coords_with_mesh(
+        ob_arm, ob_target, coords, NULL, VERTS_NUM, deformflag, NULL, NULL, me);
+    BKE_armature_deform_coords_with_mesh(
+        ob_arm, ob_target, r_coords, r_mats, VERTS_NUM, deformflag, NULL, NULL, me);
+
+    for (int i = 0; i < VERTS_NUM; i++) {
+      EXPECT_V3_NEAR(r_coords[i], coords[i], FLOAT_EPSILON);
+    }
+    MEM_freeN(coords);
+  }
+
+  Main *bmain;
+  Object *ob_arm;
+  Object *ob_target;
+  Mesh *me;
+};
+
+TEST_F(ArmatureDeformTest, LinearDeformMats)
+{
+  float coords[VERTS_NUM][3];
+  float mats[VERTS_NUM][3][3];
+  deform_with_mats(ARM_DEF_VGROUP, coords, mats);
+
+  const bPoseChannel *pchan_a = BKE_pose_channel_find_name(ob_arm->pose, "A");
+  const bPoseChannel *pchan_b = BKE_pose_channel_find_name(ob_arm->pose, "B");
+
+  /* A vertex deformed by one bone (the armature is at the origin). */
+  float target_imat[4][4], co[3];
+  invert_m4_m4(target_imat, ob_target->obmat);
+  mul_v3_m4v3(co, ob_target->obmat, me->mvert[4].co);
+  mul_m4_v3(pchan_a->chan_mat, co);
+  mul_m4_v3(target_imat, co);
+  EXPECT_V3_NEAR(coords[4], co, FLOAT_EPSILON);
+
+  for (int i = 0; i < VERTS_NUM; i++) {
+    if (BKE_defvert_find_index(&me->dvert[i], DEFGROUP_ENVELOPE)) {
+      continue;
+    }
+    /* Other groups don't deform. */
+    const float weight_a = BKE_defvert_find_weight(&me->dvert[i], DEFGROUP_A);
+    const float weight_b = BKE_defvert_find_weight(&me->dvert[i], DEFGROUP_B);
+    float mat_expect[3][3], mat_b[3][3];
+    if (weight_a + weight_b == 0.0f) {
+      unit_m3(mat_expect);
+    }
+    else {
+      copy_m3_m4(mat_expect, pchan_a->chan_mat);
+      copy_m3_m4(mat_b, pchan_b->chan_mat);
+      mul_m3_fl(mat_expect, weight_a);
+      madd_m3_m3m3fl(mat_expect, mat_expect, mat_b, weight_b);
+      mul_m3_fl(mat_expect, 1.0f / (weight_a + weight_b));
+    }
+    EXPECT_M3_NEAR(mats[i], mat_expect, FLOAT_EPSILON);
+  }
+}
+
+TEST_F(ArmatureDeformTest, QuaternionDeformMats)
+{
+  float coords[VERTS_NUM][3];
+  float mats[VERTS_NUM][3][3];
+  deform_with_mats(ARM_DEF_VGROUP | ARM_DEF_QUATERNION, coords, mats);
+}
+
+}  // namespace blender::bke::tests
@@ -129,6 +129,20 @@ MemFileUndoData *BKE_memfile_undo_encode(Main *bmain, MemFileUndoData *mfu_prev)
     }
     /* success = */ /* UNUSED */ BLO_write_file_mem(bmain, prevfile, &mfu->memfile, G.fileflags);
     mfu->undo_size = mfu->memfile.size;
+
+    if (G.debug & G_DEBUG_IO) {
+      MemFileStoreStats stats;
+      BLO_memfile_store_stats_get(&mfu->memfile, &stats);
+      printf("Memfile undo: step %.2f MiB, store %zu chunks in %zu buffers, %.2f MiB for %.2f MiB "
+             "(dedupe ratio %.2f, %.2f MiB saved)\n",
+             (double)mfu->undo_size / (1024.0 * 1024.0),
+             stats.chunks_num,
+             stats.buffers_num,
+             (double)stats.size_buffers / (1024.0 * 1024.0),
+             (double)stats.size_chunks / (1024.0 * 1024.0),
+             stats.size_buffers ? (double)stats.size_chunks / (double)stats.size_buffers : 1.0,
+             (double)(stats.size_chunks - stats.size_buffers) / (1024.0 * 1024.0));
+    }
   }
 
   bmain->is_memfile_undo_written = true;
@@ -29,8 +29,10 @@
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
 
+#include "BLI_hash_mm2a.h"
 #include "BLI_linklist.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
@@ -48,11 +50,21 @@
 typedef struct BVHCacheItem {
   bool is_filled;
   BVHTree *tree;
+  /**
+   * Tree of a previously evaluated mesh with the same topology,
+   * its bounds are refitted to the current coordinates when it is requested.
+   * See #bvhcache_detach_for_reuse.
+   */
+  BVHTree *tree_refit;
 } BVHCacheItem;
 
 typedef struct BVHCache {
   BVHCacheItem items[BVHTREE_MAX_ITEM];
   ThreadMutex mutex;
+
+  /** Topology of the mesh the trees were built for, only set while detached for reuse. */
+  int totvert, totedge, totloop, totpoly;
+  uint32_t topology_hash;
 } BVHCache;
 
 /**
@@ -155,11 +167,183 @@ void bvhcache_free(BVHCache *bvh_cache)
     BVHCacheItem *item = &bvh_cache->items[index];
     BLI_bvhtree_free(item->tree);
     item->tree = NULL;
+    BLI_bvhtree_free(item->tree_refit);
+    item->tree_refit = NULL;
   }
   BLI_mutex_end(&bvh_cache->mutex);
   MEM_freeN(bvh_cache);
 }
 
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name BVHCache Reuse
+ *
+ * Evaluated meshes are created again on every evaluation, also when only the vertex positions
+ * changed (armature deformed shrink-wrap targets for example). Instead of building their trees
+ * from scratch every time, the cache of the freed mesh is kept by the object along with its
+ * topology. When the next evaluated mesh has the same topology, the cache is handed over and
+ * the bounds of its trees are refitted the first time they are requested.
+ *
+ * Only trees that contain every element of their type can be refitted,
+ * as the leaf index is the element index for those.
+ * \{ */
+
+static bool bvhcache_type_supports_refit(const BVHCacheType type)
+{
+  return ELEM(type, BVHTREE_FROM_VERTS, BVHTREE_FROM_EDGES, BVHTREE_FROM_LOOPTRI);
+}
+
+static uint32_t bvhcache_topology_hash(const Mesh *mesh)
+{
+  uint32_t hash = 0;
+  if (mesh->medge) {
+    hash = BLI_hash_mm2((const uchar *)mesh->medge, sizeof(*mesh->medge) * mesh->totedge, hash);
+  }
+  if (mesh->mloop) {
+    hash = BLI_hash_mm2((const uchar *)mesh->mloop, sizeof(*mesh->mloop) * mesh->totloop, hash);
+  }
+  if (mesh->mpoly) {
+    hash = BLI_hash_mm2((const uchar *)mesh->mpoly, sizeof(*mesh->mpoly) * mesh->totpoly, hash);
+  }
+  return hash;
+}
+
+/**
+ * Takes the cache of an evaluated mesh that is about to be freed, so its trees can be
+ * reused by the next evaluated mesh with the same topology, see #bvhcache_reuse.
+ *
+ * \return NULL when the mesh has no trees that can be reused.
+ */
+BVHCache *bvhcache_detach_for_reuse(Mesh *mesh)
+{
+  BVHCache *bvh_cache = mesh->runtime.bvh_cache;
+  if (bvh_cache == NULL || mesh->runtime.wrapper_type != ME_WRAPPER_TYPE_MDATA) {
+    return NULL;
+  }
+
+  bool has_tree = false;
+  for (BVHCacheType type = 0; type < BVHTREE_MAX_ITEM; type++) {
+    BVHCacheItem *item = &bvh_cache->items[type];
+    if (item->is_filled && item->tree && bvhcache_type_supports_refit(type)) {
+      /* Trees that were not requested since the last reuse are kept as they are. */
+      BLI_bvhtree_free(item->tree_refit);
+      item->tree_refit = item->tree;
+    }
+    else {
+      BLI_bvhtree_free(item->tree);
+    }
+    item->tree = NULL;
+    item->is_filled = false;
+    has_tree |= (item->tree_refit != NULL);
+  }
+
+  if (!has_tree) {
+    return NULL;
+  }
+
+  bvh_cache->totvert = mesh->totvert;
+  bvh_cache->totedge = mesh->totedge;
+  bvh_cache->totloop = mesh->totloop;
+  bvh_cache->totpoly = mesh->totpoly;
+  bvh_cache->topology_hash = bvhcache_topology_hash(mesh);
+  mesh->runtime.bvh_cache = NULL;
+  return bvh_cache;
+}
+
+/**
+ * Hands the cache taken by #bvhcache_detach_for_reuse over to \a mesh when the topology
+ * matches, otherwise it's freed. Either way \a bvh_cache_reuse_p is cleared.
+ */
+void bvhcache_reuse(Mesh *mesh, BVHCache **bvh_cache_reuse_p)
+{
+  BVHCache *bvh_cache = *bvh_cache_reuse_p;
+  if (bvh_cache == NULL) {
+    return;
+  }
+  *bvh_cache_reuse_p = NULL;
+
+  if (mesh->runtime.bvh_cache == NULL && mesh->runtime.wrapper_type == ME_WRAPPER_TYPE_MDATA &&
+      bvh_cache->totvert == mesh->totvert && bvh_cache->totedge == mesh->totedge &&
+      bvh_cache->totloop == mesh->totloop && bvh_cache->totpoly == mesh->totpoly &&
+      bvh_cache->topology_hash == bvhcache_topology_hash(mesh)) {
+    mesh->runtime.bvh_cache = bvh_cache;
+  }
+  else {
+    bvhcache_free(bvh_cache);
+  }
+}
+
+/**
+ * Returns the tree kept for reuse of the given type, when it has \a leafs_num leafs.
+ * The caller is responsible for refitting it and inserting it back into the cache.
+ *
+ * \note Must be called with the cache locked.
+ */
+static BVHTree *bvhcache_refit_take(BVHCache *bvh_cache, BVHCacheType type, int leafs_num)
+{
+  BVHCacheItem *item = &bvh_cache->items[type];
+  BVHTree *tree = item->tree_refit;
+  item->tree_refit = NULL;
+  if (tree && BLI_bvhtree_get_len(tree) != leafs_num) {
+    BLI_bvhtree_free(tree);
+    tree = NULL;
+  }
+  return tree;
+}
+
+typedef struct BVHTreeRefitData {
+  BVHTree *tree;
+  const MVert *vert;
+  const MEdge *edge;
+  const MLoop *loop;
+  const MLoopTri *looptri;
+} BVHTreeRefitData;
+
+static void bvhtree_refit_verts_cb(void *__restrict userdata,
+                                   const int i,
+                                   const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BVHTreeRefitData *data = userdata;
+  BLI_bvhtree_update_node(data->tree, i, data->vert[i].co, NULL, 1);
+}
+
+static void bvhtree_refit_edges_cb(void *__restrict userdata,
+                                   const int i,
+                                   const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BVHTreeRefitData *data = userdata;
+  float co[2][3];
+  copy_v3_v3(co[0], data->vert[data->edge[i].v1].co);
+  copy_v3_v3(co[1], data->vert[data->edge[i].v2].co);
+  BLI_bvhtree_update_node(data->tree, i, co[0], NULL, 2);
+}
+
+static void bvhtree_refit_looptri_cb(void *__restrict userdata,
+                                     const int i,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BVHTreeRefitData *data = userdata;
+  const MLoopTri *lt = &data->looptri[i];
+  float co[3][3];
+  copy_v3_v3(co[0], data->vert[data->loop[lt->tri[0]].v].co);
+  copy_v3_v3(co[1], data->vert[data->loop[lt->tri[1]].v].co);
+  copy_v3_v3(co[2], data->vert[data->loop[lt->tri[2]].v].co);
+  BLI_bvhtree_update_node(data->tree, i, co[0], NULL, 3);
+}
+
+/**
+ * Updates the bounds of every leaf in parallel, then the branches bottom-up.
+ */
+static void bvhtree_refit(BVHTreeRefitData *data, TaskParallelRangeFunc func)
+{
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
+  BLI_task_parallel_range(0, BLI_bvhtree_get_len(data->tree), data, func, &settings);
+  BLI_bvhtree_update_tree(data->tree);
+}
+
 /** \} */
 /* -------------------------------------------------------------------- */
 /** \name Local Callbacks
@@ -708,9 +892,20 @@ BVHTree *bvhtree_from_mesh_verts_ex(BVHTreeFromMesh *data,
     in_cache = bvhcache_find(bvh_cache_p, bvh_cache_type, &tree, &lock_started, mesh_eval_mutex);
   }
 
-  if (in_cache == false) {
+  if (in_cache == false && bvh_cache_p && verts_mask == NULL) {
+    tree = bvhcache_refit_take(*bvh_cache_p, bvh_cache_type, verts_num);
+    if (tree) {
+      BVHTreeRefitData refit_data = {.tree = tree, .vert = vert};
+      bvhtree_refit(&refit_data, bvhtree_refit_verts_cb);
+    }
+  }
+
+  if (in_cache == false && tree == NULL) {
     tree = bvhtree_from_mesh_verts_create_tree(
         epsilon, tree_type, axis, vert, verts_num, verts_mask, verts_num_active);
+  }
+
+  if (in_cache == false) {
 
     if (bvh_cache_p) {
       /* Save on cache for later use */
@@ -923,9 +1118,20 @@ BVHTree *bvhtree_from_mesh_edges_ex(BVHTreeFromMesh *data,
     in_cache = bvhcache_find(bvh_cache_p, bvh_cache_type, &tree, &lock_started, mesh_eval_mutex);
   }
 
-  if (in_cache == false) {
+  if (in_cache == false && bvh_cache_p && edges_mask == NULL) {
+    tree = bvhcache_refit_take(*bvh_cache_p, bvh_cache_type, edges_num);
+    if (tree) {
+      BVHTreeRefitData refit_data = {.tree = tree, .vert = vert, .edge = edge};
+      bvhtree_refit(&refit_data, bvhtree_refit_edges_cb);
+    }
+  }
+
+  if (in_cache == false && tree == NULL) {
     tree = bvhtree_from_mesh_edges_create_tree(
         vert, edge, edges_num, edges_mask, edges_num_active, epsilon, tree_type, axis);
+  }
+
+  if (in_cache == false) {
 
     if (bvh_cache_p) {
       BVHCache *bvh_cache = *bvh_cache_p;
@@ -1291,8 +1497,16 @@ BVHTree *bvhtree_from_mesh_looptri_ex(BVHTreeFromMesh *data,
     in_cache = bvhcache_find(bvh_cache_p, bvh_cache_type, &tree, &lock_started, mesh_eval_mutex);
   }
 
-  if (in_cache == false) {
-    /* Setup BVHTreeFromMesh */
+  if (in_cache == false && bvh_cache_p && looptri_mask == NULL && vert && looptri) {
+    tree = bvhcache_refit_take(*bvh_cache_p, bvh_cache_type, looptri_num);
+    if (tree) {
+      BVHTreeRefitData refit_data = {
+          .tree = tree, .vert = vert, .loop = mloop, .looptri = looptri};
+      bvhtree_refit(&refit_data, bvhtree_refit_looptri_cb);
+    }
+  }
+
+  if (in_cache == false && tree == NULL) {
     tree = bvhtree_from_mesh_looptri_create_tree(epsilon,
                                                  tree_type,
                                                  axis,
@@ -1302,6 +1516,9 @@ BVHTree *bvhtree_from_mesh_looptri_ex(BVHTreeFromMesh *data,
                                                  looptri_num,
                                                  looptri_mask,
                                                  looptri_num_active);
+  }
+
+  if (in_cache == false) {
 
     if (bvh_cache_p) {
       BVHCache *bvh_cache = *bvh_cache_p;
@@ -3660,7 +3660,12 @@ void CustomData_bmesh_free_block_data(CustomData *data, void *block)
   }
 }
 
-static void CustomData_bmesh_alloc_block(CustomData *data, void **block)
+/**
+ * Allocate a block from the pool of \a data (freeing an existing one), without initializing it.
+ * This allows to allocate the blocks of many elements first, and fill them from multiple
+ * threads afterwards, since the pool isn't thread-safe.
+ */
+void CustomData_bmesh_alloc_block(CustomData *data, void **block)
 {
   if (*block) {
     CustomData_bmesh_free_block(data, block);
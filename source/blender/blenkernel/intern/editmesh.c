@@ -136,6 +136,9 @@ void BKE_editmesh_looptri_calc(BMEditMesh *em)
 {
   editmesh_tessface_calc_intern(em);
 
+  /* The mesh may have changed since the last undo push or restore. */
+  em->undo_state_id = 0;
+
   /* commented because editbmesh_build_data() ensures we get tessfaces */
 #if 0
   if (em->mesh_eval_final && em->mesh_eval_final == em->mesh_eval_cage) {
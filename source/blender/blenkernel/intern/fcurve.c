@@ -1538,7 +1538,71 @@ static float fcurve_eval_keyframes_extrapolate(
   return endpoint_bezt->vec[1][1] - (fac * dx);
 }
 
-static float fcurve_eval_keyframes_interpolate(FCurve *fcu, BezTriple *bezts, float evaltime)
+/* Check whether binarysearch_bezt_index_ex() gives the index for keyframes sorted by time.
+ * That's the case when it's the only keyframe within the threshold of the frame, or when no
+ * keyframe is within the threshold and it's the first keyframe after the frame. */
+static bool bezt_index_is_search_result(
+    const BezTriple *bezts, int arraylen, int index, float frame, float threshold, bool *r_replace)
+{
+  if ((index < 0) || (index >= arraylen)) {
+    return false;
+  }
+
+  /* Comparisons are written so they fail for NaN, which is left to the binary search. */
+  if (index > 0) {
+    const float prevfra = bezts[index - 1].vec[1][0];
+    if (!(prevfra < frame) || IS_EQT(frame, prevfra, threshold)) {
+      return false;
+    }
+  }
+
+  const float framenum = bezts[index].vec[1][0];
+  if (IS_EQT(frame, framenum, threshold)) {
+    if (index + 1 < arraylen) {
+      const float nextfra = bezts[index + 1].vec[1][0];
+      if (!(frame < nextfra) || IS_EQT(frame, nextfra, threshold)) {
+        return false;
+      }
+    }
+    *r_replace = true;
+    return true;
+  }
+
+  if (!(frame < framenum)) {
+    return false;
+  }
+  *r_replace = false;
+  return true;
+}
+
+/* Same as binarysearch_bezt_index_ex(), but tries the keyframe found by the previous evaluation
+ * and the one after it first, as the evaluation time mostly advances gradually. */
+static int binarysearch_bezt_index_hinted(BezTriple array[],
+                                          float frame,
+                                          int arraylen,
+                                          float threshold,
+                                          FCurveEvalHint *hint,
+                                          bool *r_replace)
+{
+  if (hint == NULL) {
+    return binarysearch_bezt_index_ex(array, frame, arraylen, threshold, r_replace);
+  }
+
+  int index = hint->bezt_index;
+  if (!bezt_index_is_search_result(array, arraylen, index, frame, threshold, r_replace)) {
+    index++;
+    if (!bezt_index_is_search_result(array, arraylen, index, frame, threshold, r_replace)) {
+      index = binarysearch_bezt_index_ex(array, frame, arraylen, threshold, r_replace);
+    }
+  }
+  hint->bezt_index = index;
+  return index;
+}
+
+static float fcurve_eval_keyframes_interpolate(FCurve *fcu,
+                                               BezTriple *bezts,
+                                               float evaltime,
+                                               FCurveEvalHint *hint)
 {
   const float eps = 1.e-8f;
   BezTriple *bezt, *prevbezt;
@@ -1557,7 +1621,7 @@ static float fcurve_eval_keyframes_interpolate(FCurve *fcu, BezTriple *bezts, fl
    *   Weird errors, like selecting the wrong keyframe range (see T39207), occur.
    *   This lower bound was established in b888a32eee8147b028464336ad2404d8155c64dd.
    */
-  a = binarysearch_bezt_index_ex(bezts, evaltime, fcu->totvert, 0.0001, &exact);
+  a = binarysearch_bezt_index_hinted(bezts, evaltime, fcu->totvert, 0.0001, hint, &exact);
   bezt = bezts + a;
 
   if (exact) {
@@ -1609,27 +1673,44 @@ static float fcurve_eval_keyframes_interpolate(FCurve *fcu, BezTriple *bezts, fl
     case BEZT_IPO_BEZ: {
       float v1[2], v2[2], v3[2], v4[2], opl[32];
 
-      /* bezier interpolation */
-      /* (v1, v2) are the first keyframe and its 2nd handle */
-      v1[0] = prevbezt->vec[1][0];
-      v1[1] = prevbezt->vec[1][1];
-      v2[0] = prevbezt->vec[2][0];
-      v2[1] = prevbezt->vec[2][1];
-      /* (v3, v4) are the last keyframe's 1st handle + the last keyframe */
-      v3[0] = bezt->vec[0][0];
-      v3[1] = bezt->vec[0][1];
-      v4[0] = bezt->vec[1][0];
-      v4[1] = bezt->vec[1][1];
-
-      if (fabsf(v1[1] - v4[1]) < FLT_EPSILON && fabsf(v2[1] - v3[1]) < FLT_EPSILON &&
-          fabsf(v3[1] - v4[1]) < FLT_EPSILON) {
-        /* Optimization: If all the handles are flat/at the same values,
-         * the value is simply the shared value (see T40372 -> F91346)
-         */
-        return v1[1];
+      if ((hint != NULL) && (hint->bezier_index == (int)a)) {
+        /* Same segment as the previous evaluation, flat segments are never stored. */
+        copy_v2_v2(v1, hint->bezier[0]);
+        copy_v2_v2(v2, hint->bezier[1]);
+        copy_v2_v2(v3, hint->bezier[2]);
+        copy_v2_v2(v4, hint->bezier[3]);
+      }
+      else {
+        /* bezier interpolation */
+        /* (v1, v2) are the first keyframe and its 2nd handle */
+        v1[0] = prevbezt->vec[1][0];
+        v1[1] = prevbezt->vec[1][1];
+        v2[0] = prevbezt->vec[2][0];
+        v2[1] = prevbezt->vec[2][1];
+        /* (v3, v4) are the last keyframe's 1st handle + the last keyframe */
+        v3[0] = bezt->vec[0][0];
+        v3[1] = bezt->vec[0][1];
+        v4[0] = bezt->vec[1][0];
+        v4[1] = bezt->vec[1][1];
+
+        if (fabsf(v1[1] - v4[1]) < FLT_EPSILON && fabsf(v2[1] - v3[1]) < FLT_EPSILON &&
+            fabsf(v3[1] - v4[1]) < FLT_EPSILON) {
+          /* Optimization: If all the handles are flat/at the same values,
+           * the value is simply the shared value (see T40372 -> F91346)
+           */
+          return v1[1];
+        }
+        /* adjust handles so that they don't overlap (forming a loop) */
+        correct_bezpart(v1, v2, v3, v4);
+
+        if (hint != NULL) {
+          hint->bezier_index = (int)a;
+          copy_v2_v2(hint->bezier[0], v1);
+          copy_v2_v2(hint->bezier[1], v2);
+          copy_v2_v2(hint->bezier[2], v3);
+          copy_v2_v2(hint->bezier[3], v4);
+        }
       }
-      /* adjust handles so that they don't overlap (forming a loop) */
-      correct_bezpart(v1, v2, v3, v4);
 
       /* try to get a value for this position - if failure, try another set of points */
       if (!findzero(evaltime, v1[0], v2[0], v3[0], v4[0], opl)) {
@@ -1800,7 +1881,10 @@ static float fcurve_eval_keyframes_interpolate(FCurve *fcu, BezTriple *bezts, fl
 }
 
 /* Calculate F-Curve value for 'evaltime' using BezTriple keyframes */
-static float fcurve_eval_keyframes(FCurve *fcu, BezTriple *bezts, float evaltime)
+static float fcurve_eval_keyframes(FCurve *fcu,
+                                   BezTriple *bezts,
+                                   float evaltime,
+                                   FCurveEvalHint *hint)
 {
   if (evaltime <= bezts->vec[1][0]) {
     return fcurve_eval_keyframes_extrapolate(fcu, bezts, evaltime, 0, +1);
@@ -1811,7 +1895,7 @@ static float fcurve_eval_keyframes(FCurve *fcu, BezTriple *bezts, float evaltime
     return fcurve_eval_keyframes_extrapolate(fcu, bezts, evaltime, fcu->totvert - 1, -1);
   }
 
-  return fcurve_eval_keyframes_interpolate(fcu, bezts, evaltime);
+  return fcurve_eval_keyframes_interpolate(fcu, bezts, evaltime, hint);
 }
 
 /* Calculate F-Curve value for 'evaltime' using FPoint samples */
@@ -1861,7 +1945,7 @@ static float fcurve_eval_samples(FCurve *fcu, FPoint *fpts, float evaltime)
 /* Evaluate and return the value of the given F-Curve at the specified frame ("evaltime")
  * Note: this is also used for drivers
  */
-static float evaluate_fcurve_ex(FCurve *fcu, float evaltime, float cvalue)
+static float evaluate_fcurve_ex(FCurve *fcu, float evaltime, float cvalue, FCurveEvalHint *hint)
 {
   float devaltime;
 
@@ -1878,7 +1962,7 @@ static float evaluate_fcurve_ex(FCurve *fcu, float evaltime, float cvalue)
    *   F-Curve modifier on the stack requested the curve to be evaluated at
    */
   if (fcu->bezt) {
-    cvalue = fcurve_eval_keyframes(fcu, fcu->bezt, devaltime);
+    cvalue = fcurve_eval_keyframes(fcu, fcu->bezt, devaltime, hint);
   }
   else if (fcu->fpt) {
     cvalue = fcurve_eval_samples(fcu, fcu->fpt, devaltime);
@@ -1902,7 +1986,7 @@ float evaluate_fcurve(FCurve *fcu, float evaltime)
 {
   BLI_assert(fcu->driver == NULL);
 
-  return evaluate_fcurve_ex(fcu, evaltime, 0.0);
+  return evaluate_fcurve_ex(fcu, evaltime, 0.0, NULL);
 }
 
 float evaluate_fcurve_only_curve(FCurve *fcu, float evaltime)
@@ -1910,7 +1994,7 @@ float evaluate_fcurve_only_curve(FCurve *fcu, float evaltime)
   /* Can be used to evaluate the (keyframed) fcurve only.
    * Also works for driver-fcurves when the driver itself is not relevant.
    * E.g. when inserting a keyframe in a driver fcurve. */
-  return evaluate_fcurve_ex(fcu, evaltime, 0.0);
+  return evaluate_fcurve_ex(fcu, evaltime, 0.0, NULL);
 }
 
 float evaluate_fcurve_driver(PathResolvedRNA *anim_rna,
@@ -1958,7 +2042,7 @@ float evaluate_fcurve_driver(PathResolvedRNA *anim_rna,
     }
   }
 
-  return evaluate_fcurve_ex(fcu, evaltime, cvalue);
+  return evaluate_fcurve_ex(fcu, evaltime, cvalue, NULL);
 }
 
 /* Checks if the curve has valid keys, drivers or modifiers that produce an actual curve. */
@@ -1972,6 +2056,16 @@ bool BKE_fcurve_is_empty(FCurve *fcu)
 float calculate_fcurve(PathResolvedRNA *anim_rna,
                        FCurve *fcu,
                        const AnimationEvalContext *anim_eval_context)
+{
+  return calculate_fcurve_hinted(anim_rna, fcu, anim_eval_context, NULL);
+}
+
+/* Same as calculate_fcurve(), using and updating the hint of an earlier evaluation.
+ * The hint is not used for drivers, their evaluation time isn't related to the previous one. */
+float calculate_fcurve_hinted(PathResolvedRNA *anim_rna,
+                              FCurve *fcu,
+                              const AnimationEvalContext *anim_eval_context,
+                              FCurveEvalHint *hint)
 {
   /* only calculate + set curval (overriding the existing value) if curve has
    * any data which warrants this...
@@ -1986,7 +2080,7 @@ float calculate_fcurve(PathResolvedRNA *anim_rna,
     curval = evaluate_fcurve_driver(anim_rna, fcu, fcu->driver, anim_eval_context);
   }
   else {
-    curval = evaluate_fcurve(fcu, anim_eval_context->eval_time);
+    curval = evaluate_fcurve_ex(fcu, anim_eval_context->eval_time, 0.0, hint);
   }
   fcu->curval = curval; /* debug display only, not thread safe! */
   return curval;
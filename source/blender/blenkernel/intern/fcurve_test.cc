@@ -19,6 +19,7 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "BKE_animsys.h"
 #include "BKE_fcurve.h"
 
 #include "ED_keyframing.h"
@@ -210,4 +211,45 @@ TEST(evaluate_fcurve, ExtrapolationBezierKeys)
   BKE_fcurve_free(fcu);
 }
 
+TEST(evaluate_fcurve, HintedEvaluation)
+{
+  FCurve *fcu = BKE_fcurve_create();
+
+  insert_vert_fcurve(fcu, 1.0f, 7.0f, BEZT_KEYTYPE_KEYFRAME, INSERTKEY_NO_USERPREF);
+  insert_vert_fcurve(fcu, 2.0f, 13.0f, BEZT_KEYTYPE_KEYFRAME, INSERTKEY_NO_USERPREF);
+  insert_vert_fcurve(fcu, 3.5f, 13.0f, BEZT_KEYTYPE_KEYFRAME, INSERTKEY_NO_USERPREF);
+  insert_vert_fcurve(fcu, 6.0f, -2.0f, BEZT_KEYTYPE_KEYFRAME, INSERTKEY_NO_USERPREF);
+  insert_vert_fcurve(fcu, 10.0f, 4.0f, BEZT_KEYTYPE_KEYFRAME, INSERTKEY_NO_USERPREF);
+  fcu->bezt[3].ipo = BEZT_IPO_LIN;
+
+  /* The hint must never change the result, whichever way the evaluation time moves. */
+  FCurveEvalHint hint = {0};
+  for (int i = -20; i <= 240; i++) {
+    const float evaltime = i * 0.05f;
+    const AnimationEvalContext anim_eval_context = BKE_animsys_eval_context_construct(nullptr,
+                                                                                      evaltime);
+    EXPECT_EQ(calculate_fcurve_hinted(nullptr, fcu, &anim_eval_context, &hint),
+              evaluate_fcurve(fcu, evaltime));
+  }
+  for (int i = 240; i >= -20; i -= 7) {
+    const float evaltime = i * 0.05f;
+    const AnimationEvalContext anim_eval_context = BKE_animsys_eval_context_construct(nullptr,
+                                                                                      evaltime);
+    EXPECT_EQ(calculate_fcurve_hinted(nullptr, fcu, &anim_eval_context, &hint),
+              evaluate_fcurve(fcu, evaltime));
+  }
+
+  /* Within the threshold of a key, like the OnKeys test. */
+  const float time_epsilon = 0.00008f;
+  const float times[] = {2.0f - time_epsilon, 2.0f, 2.0f + time_epsilon, 5.0f, 1.0f};
+  for (const float evaltime : times) {
+    const AnimationEvalContext anim_eval_context = BKE_animsys_eval_context_construct(nullptr,
+                                                                                      evaltime);
+    EXPECT_EQ(calculate_fcurve_hinted(nullptr, fcu, &anim_eval_context, &hint),
+              evaluate_fcurve(fcu, evaltime));
+  }
+
+  BKE_fcurve_free(fcu);
+}
+
 }  // namespace blender::bke::tests
@@ -2285,6 +2285,19 @@ void BKE_keyblock_mesh_calc_normals(struct KeyBlock *kb,
     return;
   }
 
+  if (r_loopnors == NULL && kb->totelem == mesh->totvert) {
+    /* Vertex and poly normals only need the positions, use the shape key data directly. */
+    BKE_mesh_calc_normals_poly_coords(kb->data,
+                                      mesh->totvert,
+                                      mesh->mloop,
+                                      mesh->mpoly,
+                                      mesh->totloop,
+                                      mesh->totpoly,
+                                      r_vertnors,
+                                      r_polynors);
+    return;
+  }
+
   me = *mesh;
   me.mvert = MEM_dupallocN(mesh->mvert);
   CustomData_reset(&me.vdata);
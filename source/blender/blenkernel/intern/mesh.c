@@ -39,6 +39,7 @@
 #include "BLI_ghash.h"
 #include "BLI_hash.h"
 #include "BLI_linklist.h"
+#include "BLI_listbase.h"
 #include "BLI_math.h"
 #include "BLI_memarena.h"
 #include "BLI_string.h"
@@ -1429,6 +1430,102 @@ void BKE_mesh_smooth_flag_set(Mesh *me, const bool use_smooth)
   }
 }
 
+/**
+ * Reorder the vertices and polygons of a mesh (`xxx_idx[org_index] = new_index`).
+ *
+ * All custom-data layers, shape keys and the selection history are reordered too,
+ * edges keep their order and loops follow their polygons.
+ *
+ * \note Vertex indices stored outside of the mesh (hooks, vertex parents) aren't updated.
+ */
+void BKE_mesh_remap(Mesh *me, const uint *vert_idx, const uint *poly_idx)
+{
+  BLI_assert(me->edit_mesh == NULL);
+
+  /* Vertices. */
+  {
+    CustomData vdata;
+    CustomData_copy(&me->vdata, &vdata, CD_MASK_ALL, CD_CALLOC, me->totvert);
+    for (int i = 0; i < me->totvert; i++) {
+      CustomData_copy_data(&me->vdata, &vdata, i, (int)vert_idx[i], 1);
+    }
+    CustomData_free(&me->vdata, me->totvert);
+    me->vdata = vdata;
+  }
+
+  /* Polygons and their loops. */
+  {
+    uint *poly_order = MEM_mallocN(sizeof(*poly_order) * (size_t)me->totpoly, __func__);
+    for (int i = 0; i < me->totpoly; i++) {
+      poly_order[poly_idx[i]] = (uint)i;
+    }
+
+    CustomData pdata, ldata;
+    CustomData_copy(&me->pdata, &pdata, CD_MASK_ALL, CD_CALLOC, me->totpoly);
+    CustomData_copy(&me->ldata, &ldata, CD_MASK_ALL, CD_CALLOC, me->totloop);
+    int *loopstart = MEM_mallocN(sizeof(*loopstart) * (size_t)me->totpoly, __func__);
+    int loop_len = 0;
+    for (int i = 0; i < me->totpoly; i++) {
+      const MPoly *mp = &me->mpoly[poly_order[i]];
+      CustomData_copy_data(&me->pdata, &pdata, (int)poly_order[i], i, 1);
+      CustomData_copy_data(&me->ldata, &ldata, mp->loopstart, loop_len, mp->totloop);
+      loopstart[i] = loop_len;
+      loop_len += mp->totloop;
+    }
+    CustomData_free(&me->pdata, me->totpoly);
+    CustomData_free(&me->ldata, me->totloop);
+    me->pdata = pdata;
+    me->ldata = ldata;
+    BKE_mesh_update_customdata_pointers(me, false);
+
+    for (int i = 0; i < me->totpoly; i++) {
+      me->mpoly[i].loopstart = loopstart[i];
+    }
+    MEM_freeN(loopstart);
+    MEM_freeN(poly_order);
+  }
+
+  for (int i = 0; i < me->totedge; i++) {
+    MEdge *med = &me->medge[i];
+    med->v1 = vert_idx[med->v1];
+    med->v2 = vert_idx[med->v2];
+  }
+  for (int i = 0; i < me->totloop; i++) {
+    MLoop *ml = &me->mloop[i];
+    ml->v = vert_idx[ml->v];
+  }
+
+  if (me->key) {
+    const size_t stride = (size_t)me->key->elemsize;
+    LISTBASE_FOREACH (KeyBlock *, kb, &me->key->block) {
+      if (kb->data && (kb->totelem == me->totvert)) {
+        char *data = MEM_mallocN(stride * (size_t)kb->totelem, __func__);
+        for (int i = 0; i < kb->totelem; i++) {
+          memcpy(data + stride * vert_idx[i], (char *)kb->data + stride * (size_t)i, stride);
+        }
+        MEM_freeN(kb->data);
+        kb->data = data;
+      }
+    }
+  }
+
+  for (int i = 0; i < me->totselect; i++) {
+    MSelect *msel = &me->mselect[i];
+    if (msel->type == ME_VSEL) {
+      msel->index = (int)vert_idx[msel->index];
+    }
+    else if (msel->type == ME_FSEL) {
+      msel->index = (int)poly_idx[msel->index];
+    }
+  }
+  if (me->act_face != -1) {
+    me->act_face = (int)poly_idx[me->act_face];
+  }
+
+  BKE_mesh_tessface_clear(me);
+  BKE_mesh_runtime_clear_geometry(me);
+}
+
 /**
  * Find the index of the loop in 'poly' which references vertex,
  * returns -1 if not found
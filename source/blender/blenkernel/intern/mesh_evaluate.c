@@ -209,12 +209,20 @@ void BKE_mesh_calc_normals_mapping_ex(MVert *mverts,
 typedef struct MeshCalcNormalsData {
   const MPoly *mpolys;
   const MLoop *mloop;
+  /** Vertices to write the normals into, NULL when only \a vert_coords are given. */
   MVert *mverts;
+  /** Optional vertex positions, used instead of the positions in \a mverts. */
+  const float (*vert_coords)[3];
   float (*pnors)[3];
   float (*lnors_weighted)[3];
   float (*vnors)[3];
 } MeshCalcNormalsData;
 
+BLI_INLINE const float *mesh_calc_normals_vert_co(const MeshCalcNormalsData *data, const uint v)
+{
+  return data->vert_coords ? data->vert_coords[v] : data->mverts[v].co;
+}
+
 static void mesh_calc_normals_poly_cb(void *__restrict userdata,
                                       const int pidx,
                                       const TaskParallelTLS *__restrict UNUSED(tls))
@@ -222,7 +230,13 @@ static void mesh_calc_normals_poly_cb(void *__restrict userdata,
   MeshCalcNormalsData *data = userdata;
   const MPoly *mp = &data->mpolys[pidx];
 
-  BKE_mesh_calc_poly_normal(mp, data->mloop + mp->loopstart, data->mverts, data->pnors[pidx]);
+  if (data->vert_coords) {
+    BKE_mesh_calc_poly_normal_coords(
+        mp, data->mloop + mp->loopstart, data->vert_coords, data->pnors[pidx]);
+  }
+  else {
+    BKE_mesh_calc_poly_normal(mp, data->mloop + mp->loopstart, data->mverts, data->pnors[pidx]);
+  }
 }
 
 static void mesh_calc_normals_poly_prepare_cb(void *__restrict userdata,
@@ -232,7 +246,6 @@ static void mesh_calc_normals_poly_prepare_cb(void *__restrict userdata,
   MeshCalcNormalsData *data = userdata;
   const MPoly *mp = &data->mpolys[pidx];
   const MLoop *ml = &data->mloop[mp->loopstart];
-  const MVert *mverts = data->mverts;
 
   float pnor_temp[3];
   float *pnor = data->pnors ? data->pnors[pidx] : pnor_temp;
@@ -245,13 +258,13 @@ static void mesh_calc_normals_poly_prepare_cb(void *__restrict userdata,
   /* inline version of #BKE_mesh_calc_poly_normal, also does edge-vectors */
   {
     int i_prev = nverts - 1;
-    const float *v_prev = mverts[ml[i_prev].v].co;
+    const float *v_prev = mesh_calc_normals_vert_co(data, ml[i_prev].v);
     const float *v_curr;
 
     zero_v3(pnor);
     /* Newell's Method */
     for (int i = 0; i < nverts; i++) {
-      v_curr = mverts[ml[i].v].co;
+      v_curr = mesh_calc_normals_vert_co(data, ml[i].v);
       add_newell_cross_v3_v3v3(pnor, v_prev, v_curr);
 
       /* Unrelated to normalize, calculate edge-vector */
@@ -294,26 +307,28 @@ static void mesh_calc_normals_poly_finalize_cb(void *__restrict userdata,
 {
   MeshCalcNormalsData *data = userdata;
 
-  MVert *mv = &data->mverts[vidx];
   float *no = data->vnors[vidx];
 
   if (UNLIKELY(normalize_v3(no) == 0.0f)) {
     /* following Mesh convention; we use vertex coordinate itself for normal in this case */
-    normalize_v3_v3(no, mv->co);
+    normalize_v3_v3(no, mesh_calc_normals_vert_co(data, (uint)vidx));
   }
 
-  normal_float_to_short_v3(mv->no, no);
+  if (data->mverts) {
+    normal_float_to_short_v3(data->mverts[vidx].no, no);
+  }
 }
 
-void BKE_mesh_calc_normals_poly(MVert *mverts,
-                                float (*r_vertnors)[3],
-                                int numVerts,
-                                const MLoop *mloop,
-                                const MPoly *mpolys,
-                                int numLoops,
-                                int numPolys,
-                                float (*r_polynors)[3],
-                                const bool only_face_normals)
+static void mesh_calc_normals_poly_ex(MVert *mverts,
+                                      const float (*vert_coords)[3],
+                                      float (*r_vertnors)[3],
+                                      int numVerts,
+                                      const MLoop *mloop,
+                                      const MPoly *mpolys,
+                                      int numLoops,
+                                      int numPolys,
+                                      float (*r_polynors)[3],
+                                      const bool only_face_normals)
 {
   float(*pnors)[3] = r_polynors;
 
@@ -329,6 +344,7 @@ void BKE_mesh_calc_normals_poly(MVert *mverts,
         .mpolys = mpolys,
         .mloop = mloop,
         .mverts = mverts,
+        .vert_coords = vert_coords,
         .pnors = pnors,
     };
 
@@ -354,6 +370,7 @@ void BKE_mesh_calc_normals_poly(MVert *mverts,
       .mpolys = mpolys,
       .mloop = mloop,
       .mverts = mverts,
+      .vert_coords = vert_coords,
       .pnors = pnors,
       .lnors_weighted = lnors_weighted,
       .vnors = vnors,
@@ -379,6 +396,58 @@ void BKE_mesh_calc_normals_poly(MVert *mverts,
   MEM_freeN(lnors_weighted);
 }
 
+void BKE_mesh_calc_normals_poly(MVert *mverts,
+                                float (*r_vertnors)[3],
+                                int numVerts,
+                                const MLoop *mloop,
+                                const MPoly *mpolys,
+                                int numLoops,
+                                int numPolys,
+                                float (*r_polynors)[3],
+                                const bool only_face_normals)
+{
+  mesh_calc_normals_poly_ex(mverts,
+                            NULL,
+                            r_vertnors,
+                            numVerts,
+                            mloop,
+                            mpolys,
+                            numLoops,
+                            numPolys,
+                            r_polynors,
+                            only_face_normals);
+}
+
+/**
+ * Same as #BKE_mesh_calc_normals_poly, but takes the vertex positions as a separate array and
+ * only writes float normals, leaving the vertices untouched.
+ *
+ * \param r_vertnors: Vertex normals to calculate, may be NULL to only calculate poly normals.
+ * \param r_polynors: Poly normals to calculate, may be NULL.
+ */
+void BKE_mesh_calc_normals_poly_coords(const float (*vert_coords)[3],
+                                       int numVerts,
+                                       const MLoop *mloop,
+                                       const MPoly *mpolys,
+                                       int numLoops,
+                                       int numPolys,
+                                       float (*r_vertnors)[3],
+                                       float (*r_polynors)[3])
+{
+  BLI_assert((r_vertnors != NULL) || (r_polynors != NULL));
+
+  mesh_calc_normals_poly_ex(NULL,
+                            vert_coords,
+                            r_vertnors,
+                            numVerts,
+                            mloop,
+                            mpolys,
+                            numLoops,
+                            numPolys,
+                            r_polynors,
+                            r_vertnors == NULL);
+}
+
 void BKE_mesh_ensure_normals(Mesh *mesh)
 {
   if (mesh->runtime.cd_dirty_vert & CD_MASK_NORMAL) {
@@ -1594,6 +1663,196 @@ static void loop_split_generator(TaskPool *pool, LoopSplitTaskDataCommon *common
 #endif
 }
 
+static int loop_split_fan_find(int *loop_fans, int ml_index)
+{
+  while (loop_fans[ml_index] != ml_index) {
+    /* Path halving, keeps the next lookups short. */
+    loop_fans[ml_index] = loop_fans[loop_fans[ml_index]];
+    ml_index = loop_fans[ml_index];
+  }
+  return ml_index;
+}
+
+static void loop_split_fan_join(int *loop_fans, int ml_index_a, int ml_index_b)
+{
+  ml_index_a = loop_split_fan_find(loop_fans, ml_index_a);
+  ml_index_b = loop_split_fan_find(loop_fans, ml_index_b);
+  /* The lowest loop of a fan is its root. */
+  if (ml_index_a < ml_index_b) {
+    loop_fans[ml_index_b] = ml_index_a;
+  }
+  else if (ml_index_b < ml_index_a) {
+    loop_fans[ml_index_a] = ml_index_b;
+  }
+}
+
+typedef struct LoopSplitFansData {
+  LoopSplitTaskDataCommon *common_data;
+  /** Root loop of the fan of each loop, INDEX_INVALID for loops with both edges sharp. */
+  int *loop_fans;
+} LoopSplitFansData;
+
+static void loop_split_fans_weights_cb(void *__restrict userdata,
+                                       const int mp_index,
+                                       const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  LoopSplitFansData *data = userdata;
+  float(*loopnors)[3] = data->common_data->loopnors;
+  const MVert *mverts = data->common_data->mverts;
+  const MLoop *mloops = data->common_data->mloops;
+  const int(*edge_to_loops)[2] = data->common_data->edge_to_loops;
+  const MPoly *mp = &data->common_data->mpolys[mp_index];
+  const float *polynor = data->common_data->polynors[mp_index];
+  int *loop_fans = data->loop_fans;
+
+  const int ml_last_index = (mp->loopstart + mp->totloop) - 1;
+  const int *e2l_prev = edge_to_loops[mloops[ml_last_index].e];
+  float vec_prev[3], vec_curr[3];
+
+  sub_v3_v3v3(vec_prev, mverts[mloops[mp->loopstart].v].co, mverts[mloops[ml_last_index].v].co);
+  normalize_v3(vec_prev);
+
+  for (int ml_index = mp->loopstart; ml_index <= ml_last_index; ml_index++) {
+    const int ml_next_index = (ml_index == ml_last_index) ? mp->loopstart : ml_index + 1;
+    const int *e2l_curr = edge_to_loops[mloops[ml_index].e];
+
+    sub_v3_v3v3(vec_curr, mverts[mloops[ml_next_index].v].co, mverts[mloops[ml_index].v].co);
+    normalize_v3(vec_curr);
+
+    if (IS_EDGE_SHARP(e2l_curr) && IS_EDGE_SHARP(e2l_prev)) {
+      /* Same as #split_loop_nor_single_do, no other loop is in this fan. */
+      copy_v3_v3(loopnors[ml_index], polynor);
+      loop_fans[ml_index] = INDEX_INVALID;
+    }
+    else {
+      /* Code similar to accumulate_vertex_normals_poly_v3. */
+      const float fac = saacos(-dot_v3v3(vec_curr, vec_prev));
+      mul_v3_v3fl(loopnors[ml_index], polynor, fac);
+    }
+
+    copy_v3_v3(vec_prev, vec_curr);
+    e2l_prev = e2l_curr;
+  }
+}
+
+static void loop_split_fans_normalize_cb(void *__restrict userdata,
+                                         const int ml_index,
+                                         const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  LoopSplitFansData *data = userdata;
+  float *lnor = data->common_data->loopnors[ml_index];
+
+  if (data->loop_fans[ml_index] == ml_index) {
+    if (UNLIKELY(normalize_v3(lnor) == 0.0f)) {
+      /* Use vertex normal as fallback, like #split_loop_nor_fan_do. */
+      const MLoop *ml = &data->common_data->mloops[ml_index];
+      normal_short_to_float_v3(lnor, data->common_data->mverts[ml->v].no);
+    }
+  }
+}
+
+static void loop_split_fans_copy_cb(void *__restrict userdata,
+                                    const int ml_index,
+                                    const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  LoopSplitFansData *data = userdata;
+  float(*loopnors)[3] = data->common_data->loopnors;
+  const int ml_root_index = data->loop_fans[ml_index];
+
+  if (!ELEM(ml_root_index, ml_index, INDEX_INVALID)) {
+    copy_v3_v3(loopnors[ml_index], loopnors[ml_root_index]);
+  }
+}
+
+/**
+ * Compute loop normals when no lnor space is needed, without walking around each vertex.
+ *
+ * Loops are joined into smooth fans across the smooth edges of their polygons, the same fans
+ * #loop_split_generator walks, so a vertex with several fans (e.g. a bowtie one) gets a normal
+ * per fan. Normals are the angle weighted polygon normals of each fan,
+ * vertex normals are only used as fallback for degenerate fans, like #split_loop_nor_fan_do.
+ */
+static void loop_split_fans_calc(LoopSplitTaskDataCommon *common_data)
+{
+  float(*loopnors)[3] = common_data->loopnors;
+
+  const MLoop *mloops = common_data->mloops;
+  const MPoly *mpolys = common_data->mpolys;
+  const int(*edge_to_loops)[2] = common_data->edge_to_loops;
+  const int *loop_to_poly = common_data->loop_to_poly;
+  const int numLoops = common_data->numLoops;
+  const int numPolys = common_data->numPolys;
+
+  int *loop_fans = MEM_malloc_arrayN((size_t)numLoops, sizeof(*loop_fans), __func__);
+  int mp_index, ml_index;
+
+  LoopSplitFansData data = {
+      .common_data = common_data,
+      .loop_fans = loop_fans,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
+
+#ifdef DEBUG_TIME
+  TIMEIT_START_AVERAGED(loop_split_fans_calc);
+#endif
+
+  for (ml_index = 0; ml_index < numLoops; ml_index++) {
+    loop_fans[ml_index] = ml_index;
+  }
+
+  /* Both loops of a smooth edge go in opposite directions,
+   * each one is in the same fan as the next loop of the other one. */
+  for (mp_index = 0; mp_index < numPolys; mp_index++) {
+    const MPoly *mp = &mpolys[mp_index];
+    const int ml_last_index = (mp->loopstart + mp->totloop) - 1;
+
+    for (ml_index = mp->loopstart; ml_index <= ml_last_index; ml_index++) {
+      const int *e2l = edge_to_loops[mloops[ml_index].e];
+      if (IS_EDGE_SHARP(e2l) || (e2l[0] != ml_index)) {
+        continue;
+      }
+      const int ml_other_index = e2l[1];
+      const MPoly *mp_other = &mpolys[loop_to_poly[ml_other_index]];
+      const int ml_next_index = (ml_index == ml_last_index) ? mp->loopstart : ml_index + 1;
+      const int ml_other_next_index = (ml_other_index ==
+                                       (mp_other->loopstart + mp_other->totloop) - 1) ?
+                                          mp_other->loopstart :
+                                          ml_other_index + 1;
+
+      loop_split_fan_join(loop_fans, ml_index, ml_other_next_index);
+      loop_split_fan_join(loop_fans, ml_next_index, ml_other_index);
+    }
+  }
+
+  /* Compute weighted polygon normals of all loops. */
+  BLI_task_parallel_range(0, numPolys, &data, loop_split_fans_weights_cb, &settings);
+
+  /* Accumulate them into the root loop of their fan, which comes first in it.
+   * Not threaded, since several loops add to the same root. */
+  for (ml_index = 0; ml_index < numLoops; ml_index++) {
+    if (loop_fans[ml_index] == INDEX_INVALID) {
+      continue;
+    }
+    const int ml_root_index = loop_split_fan_find(loop_fans, ml_index);
+    if (ml_root_index != ml_index) {
+      add_v3_v3(loopnors[ml_root_index], loopnors[ml_index]);
+      loop_fans[ml_index] = ml_root_index;
+    }
+  }
+
+  BLI_task_parallel_range(0, numLoops, &data, loop_split_fans_normalize_cb, &settings);
+  BLI_task_parallel_range(0, numLoops, &data, loop_split_fans_copy_cb, &settings);
+
+  MEM_freeN(loop_fans);
+
+#ifdef DEBUG_TIME
+  TIMEIT_END_AVERAGED(loop_split_fans_calc);
+#endif
+}
+
 /**
  * Compute split normals, i.e. vertex normals associated with each poly (hence 'loop normals').
  * Useful to materialize sharp edges (or non-smooth faces) without actually modifying the geometry
@@ -1705,10 +1964,17 @@ void BKE_mesh_normals_loop_split(const MVert *mverts,
       .numPolys = numPolys,
   };
 
-  /* This first loop check which edges are actually smooth, and compute edge vectors. */
+  /* This first loop check which edges are actually smooth, and compute edge vectors.
+   * Loop normals are only pre-populated with vertex normals when walking fans. */
+  common_data.loopnors = r_lnors_spacearr ? r_loopnors : NULL;
   mesh_edges_sharp_tag(&common_data, check_angle, split_angle, false);
+  common_data.loopnors = r_loopnors;
 
-  if (numLoops < LOOP_SPLIT_TASK_BLOCK_SIZE * 8) {
+  if (!r_lnors_spacearr) {
+    /* Only loop normals are needed, see #loop_split_fans_calc. */
+    loop_split_fans_calc(&common_data);
+  }
+  else if (numLoops < LOOP_SPLIT_TASK_BLOCK_SIZE * 8) {
     /* Not enough loops to be worth the whole threading overhead... */
     loop_split_generator(NULL, &common_data);
   }
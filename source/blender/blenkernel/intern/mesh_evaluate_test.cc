@@ -0,0 +1,278 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation
+ * All rights reserved.
+ */
+
+#include "DNA_meshdata_types.h"
+
+#include "BLI_math.h"
+#include "BLI_utildefines.h"
+
+#include "BKE_mesh.h"
+
+#include "testing/testing.h"
+
+namespace blender::bke::tests {
+
+static const float FLOAT_EPSILON = 1e-6f;
+
+/**
+ * Calculate split normals of smooth polygons, from polygon normals calculated here.
+ * The vertex normals are set to point the wrong way first, split normals must not use them.
+ */
+static void loop_split_normals_calc(MVert *mverts,
+                                    const int verts_num,
+                                    MEdge *medges,
+                                    const int edges_num,
+                                    MLoop *mloops,
+                                    const int loops_num,
+                                    MPoly *mpolys,
+                                    const int polys_num,
+                                    float (*r_polynors)[3],
+                                    float (*r_loopnors)[3],
+                                    MLoopNorSpaceArray *r_lnors_spacearr = NULL)
+{
+  BKE_mesh_calc_normals_poly(
+      mverts, NULL, verts_num, mloops, mpolys, loops_num, polys_num, r_polynors, true);
+
+  for (int i = 0; i < verts_num; i++) {
+    const short stale_no[3] = {0, 0, -32767};
+    copy_v3_v3_short(mverts[i].no, stale_no);
+  }
+
+  BKE_mesh_normals_loop_split(mverts,
+                              verts_num,
+                              medges,
+                              edges_num,
+                              mloops,
+                              r_loopnors,
+                              loops_num,
+                              mpolys,
+                              r_polynors,
+                              polys_num,
+                              true,
+                              (float)M_PI,
+                              r_lnors_spacearr,
+                              NULL,
+                              NULL);
+}
+
+/* Fill polygons of the same size from their vertices, with the edges they use. */
+static void mesh_polys_fill(const int (*edge_verts)[2],
+                            MEdge *medges,
+                            const int edges_num,
+                            const int *poly_verts,
+                            const int poly_size,
+                            MLoop *mloops,
+                            MPoly *mpolys,
+                            const int polys_num)
+{
+  for (int i = 0; i < edges_num; i++) {
+    medges[i].v1 = edge_verts[i][0];
+    medges[i].v2 = edge_verts[i][1];
+  }
+  for (int i = 0; i < polys_num; i++) {
+    mpolys[i].loopstart = i * poly_size;
+    mpolys[i].totloop = poly_size;
+    mpolys[i].flag = ME_SMOOTH;
+    for (int j = 0; j < poly_size; j++) {
+      const int v1 = poly_verts[i * poly_size + j];
+      const int v2 = poly_verts[i * poly_size + (j + 1) % poly_size];
+      MLoop *ml = &mloops[i * poly_size + j];
+      ml->v = v1;
+      for (int e = 0; e < edges_num; e++) {
+        if ((edge_verts[e][0] == v1 && edge_verts[e][1] == v2) ||
+            (edge_verts[e][0] == v2 && edge_verts[e][1] == v1)) {
+          ml->e = e;
+        }
+      }
+    }
+  }
+}
+
+static void expect_v3_near(const float a[3], const float b[3])
+{
+  EXPECT_NEAR(a[0], b[0], FLOAT_EPSILON);
+  EXPECT_NEAR(a[1], b[1], FLOAT_EPSILON);
+  EXPECT_NEAR(a[2], b[2], FLOAT_EPSILON);
+}
+
+/* Two quads folded along a shared edge, without any sharp edge. */
+TEST(mesh_normals_loop_split, SmoothStaleVertexNormals)
+{
+  MVert mverts[6] = {};
+  const float co[6][3] = {{0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0}, {1, 0, 1}, {1, 1, 1}};
+  for (int i = 0; i < 6; i++) {
+    copy_v3_v3(mverts[i].co, co[i]);
+  }
+  MEdge medges[7] = {};
+  const int edge_verts[7][2] = {{0, 1}, {1, 2}, {2, 3}, {3, 0}, {1, 4}, {4, 5}, {5, 2}};
+  for (int i = 0; i < 7; i++) {
+    medges[i].v1 = edge_verts[i][0];
+    medges[i].v2 = edge_verts[i][1];
+  }
+  MLoop mloops[8] = {{0, 0}, {1, 1}, {2, 2}, {3, 3}, {2, 1}, {1, 4}, {4, 5}, {5, 6}};
+  MPoly mpolys[2] = {};
+  for (int i = 0; i < 2; i++) {
+    mpolys[i].loopstart = i * 4;
+    mpolys[i].totloop = 4;
+    mpolys[i].flag = ME_SMOOTH;
+  }
+
+  float polynors[2][3];
+  float loopnors[8][3];
+  loop_split_normals_calc(mverts, 6, medges, 7, mloops, 8, mpolys, 2, polynors, loopnors);
+
+  /* Vertices of the shared edge have the same angle in both quads. */
+  float fold_no[3];
+  add_v3_v3v3(fold_no, polynors[0], polynors[1]);
+  normalize_v3(fold_no);
+
+  expect_v3_near(loopnors[0], polynors[0]);
+  expect_v3_near(loopnors[1], fold_no);
+  expect_v3_near(loopnors[2], fold_no);
+  expect_v3_near(loopnors[3], polynors[0]);
+  expect_v3_near(loopnors[4], fold_no);
+  expect_v3_near(loopnors[5], fold_no);
+  expect_v3_near(loopnors[6], polynors[1]);
+  expect_v3_near(loopnors[7], polynors[1]);
+}
+
+/* Two triangles only sharing a vertex, each has its own smooth fan around it. */
+TEST(mesh_normals_loop_split, SmoothBowtieVertex)
+{
+  MVert mverts[5] = {};
+  const float co[5][3] = {{0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {-1, 0, 0}, {0, 0, 1}};
+  for (int i = 0; i < 5; i++) {
+    copy_v3_v3(mverts[i].co, co[i]);
+  }
+  MEdge medges[6] = {};
+  const int edge_verts[6][2] = {{0, 1}, {1, 2}, {2, 0}, {0, 3}, {3, 4}, {4, 0}};
+  for (int i = 0; i < 6; i++) {
+    medges[i].v1 = edge_verts[i][0];
+    medges[i].v2 = edge_verts[i][1];
+  }
+  MLoop mloops[6] = {{0, 0}, {1, 1}, {2, 2}, {0, 3}, {3, 4}, {4, 5}};
+  MPoly mpolys[2] = {};
+  for (int i = 0; i < 2; i++) {
+    mpolys[i].loopstart = i * 3;
+    mpolys[i].totloop = 3;
+    mpolys[i].flag = ME_SMOOTH;
+  }
+
+  float polynors[2][3];
+  float loopnors[6][3];
+  loop_split_normals_calc(mverts, 5, medges, 6, mloops, 6, mpolys, 2, polynors, loopnors);
+
+  for (int i = 0; i < 6; i++) {
+    expect_v3_near(loopnors[i], polynors[i / 3]);
+  }
+}
+
+/* Two cones sharing their apex, each has a closed smooth fan around it. */
+TEST(mesh_normals_loop_split, SmoothDoubleConeVertex)
+{
+  MVert mverts[9] = {};
+  const float co[9][3] = {{0, 0, 0},
+                          {1, 0, 1},
+                          {0, 1, 1},
+                          {-1, 0, 1},
+                          {0, -1, 1},
+                          {1, 0, -1},
+                          {0, 1, -1},
+                          {-1, 0, -1},
+                          {0, -1, -1}};
+  for (int i = 0; i < 9; i++) {
+    copy_v3_v3(mverts[i].co, co[i]);
+  }
+  const int edge_verts[16][2] = {{0, 1},
+                                 {0, 2},
+                                 {0, 3},
+                                 {0, 4},
+                                 {1, 2},
+                                 {2, 3},
+                                 {3, 4},
+                                 {4, 1},
+                                 {0, 5},
+                                 {0, 6},
+                                 {0, 7},
+                                 {0, 8},
+                                 {5, 6},
+                                 {6, 7},
+                                 {7, 8},
+                                 {8, 5}};
+  /* The bottom cone goes the other way around, both point outwards. */
+  const int poly_verts[8][3] = {
+      {0, 1, 2}, {0, 2, 3}, {0, 3, 4}, {0, 4, 1}, {0, 6, 5}, {0, 7, 6}, {0, 8, 7}, {0, 5, 8}};
+  MEdge medges[16] = {};
+  MLoop mloops[24] = {};
+  MPoly mpolys[8] = {};
+  mesh_polys_fill(edge_verts, medges, 16, &poly_verts[0][0], 3, mloops, mpolys, 8);
+
+  float polynors[8][3];
+  float loopnors[24][3];
+  loop_split_normals_calc(mverts, 9, medges, 16, mloops, 24, mpolys, 8, polynors, loopnors);
+
+  const float top_no[3] = {0, 0, 1};
+  const float bottom_no[3] = {0, 0, -1};
+  for (int i = 0; i < 8; i++) {
+    expect_v3_near(loopnors[i * 3], (i < 4) ? top_no : bottom_no);
+  }
+}
+
+/* Cube with a flat polygon and a sharp edge, normals must be the same as when computing their
+ * lnor spaces, which walks around vertices. */
+TEST(mesh_normals_loop_split, SharpSameAsLnorSpaces)
+{
+  MVert mverts[8] = {};
+  const float co[8][3] = {
+      {0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0}, {0, 0, 1}, {1, 0, 1}, {1, 1, 1}, {0, 1, 2}};
+  for (int i = 0; i < 8; i++) {
+    copy_v3_v3(mverts[i].co, co[i]);
+  }
+  const int edge_verts[12][2] = {
+      {0, 1}, {1, 2}, {2, 3}, {3, 0}, {4, 5}, {5, 6}, {6, 7}, {7, 4}, {0, 4}, {1, 5}, {2, 6},
+      {3, 7}};
+  const int poly_verts[6][4] = {
+      {0, 3, 2, 1}, {4, 5, 6, 7}, {0, 1, 5, 4}, {1, 2, 6, 5}, {2, 3, 7, 6}, {3, 0, 4, 7}};
+  MEdge medges[12] = {};
+  MLoop mloops[24] = {};
+  MPoly mpolys[6] = {};
+  mesh_polys_fill(edge_verts, medges, 12, &poly_verts[0][0], 4, mloops, mpolys, 6);
+  mpolys[0].flag &= ~ME_SMOOTH;
+  medges[8].flag |= ME_SHARP;
+
+  float polynors[6][3];
+  float loopnors[24][3];
+  loop_split_normals_calc(mverts, 8, medges, 12, mloops, 24, mpolys, 6, polynors, loopnors);
+
+  MLoopNorSpaceArray lnors_spacearr = {NULL};
+  float loopnors_spaces[24][3];
+  loop_split_normals_calc(
+      mverts, 8, medges, 12, mloops, 24, mpolys, 6, polynors, loopnors_spaces, &lnors_spacearr);
+  BKE_lnor_spacearr_free(&lnors_spacearr);
+
+  for (int i = 0; i < 24; i++) {
+    expect_v3_near(loopnors[i], loopnors_spaces[i]);
+  }
+  /* Loops of the flat polygon. */
+  for (int i = 0; i < 4; i++) {
+    expect_v3_near(loopnors[i], polynors[0]);
+  }
+}
+
+}  // namespace blender::bke::tests
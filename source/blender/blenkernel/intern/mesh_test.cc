@@ -0,0 +1,155 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation
+ * All rights reserved.
+ */
+
+#include "CLG_log.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BLI_math.h"
+#include "BLI_utildefines.h"
+
+#include "BKE_customdata.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+
+#include "testing/testing.h"
+
+namespace blender::bke::tests {
+
+#define VERTS_NUM 7
+#define LOOPS_NUM 11
+#define POLYS_NUM 3
+
+class MeshRemapTest : public testing::Test {
+ public:
+  static void SetUpTestCase()
+  {
+    /* Validation logs the errors it finds. */
+    CLG_init();
+    BKE_idtype_init();
+  }
+
+  static void TearDownTestCase()
+  {
+    CLG_exit();
+  }
+};
+
+/**
+ * Two quads and a triangle in a row, with distinct per-element data:
+ *
+ * <pre>
+ * 3---4---5
+ * |   |   | \
+ * 0---1---2--6
+ * </pre>
+ */
+static Mesh *mesh_quads_tri_create()
+{
+  const float co[VERTS_NUM][3] = {
+      {0, 0, 0}, {1, 0, 0}, {2, 0, 0}, {0, 1, 0}, {1, 1, 0}, {2, 1, 0}, {3, 0, 0}};
+  const int poly_sizes[POLYS_NUM] = {4, 4, 3};
+  const uint loop_verts[LOOPS_NUM] = {0, 1, 4, 3, 1, 2, 5, 4, 2, 6, 5};
+
+  Mesh *me = BKE_mesh_new_nomain(VERTS_NUM, 0, 0, LOOPS_NUM, POLYS_NUM);
+  for (int i = 0; i < VERTS_NUM; i++) {
+    copy_v3_v3(me->mvert[i].co, co[i]);
+    me->mvert[i].bweight = (char)(i * 10);
+  }
+  for (int i = 0; i < LOOPS_NUM; i++) {
+    me->mloop[i].v = loop_verts[i];
+  }
+  int loopstart = 0;
+  for (int i = 0; i < POLYS_NUM; i++) {
+    me->mpoly[i].loopstart = loopstart;
+    me->mpoly[i].totloop = poly_sizes[i];
+    me->mpoly[i].mat_nr = (short)i;
+    loopstart += poly_sizes[i];
+  }
+  BKE_mesh_calc_edges(me, false, false);
+  BKE_mesh_calc_normals(me);
+
+  MLoopUV *mloopuv = (MLoopUV *)CustomData_add_layer(
+      &me->ldata, CD_MLOOPUV, CD_CALLOC, NULL, me->totloop);
+  for (int i = 0; i < LOOPS_NUM; i++) {
+    mloopuv[i].uv[0] = (float)i;
+    mloopuv[i].uv[1] = -(float)i;
+  }
+  me->act_face = 2;
+
+  return me;
+}
+
+TEST_F(MeshRemapTest, VertsAndPolys)
+{
+  Mesh *me = mesh_quads_tri_create();
+  ASSERT_FALSE(BKE_mesh_validate(me, false, true));
+
+  MVert mvert_orig[VERTS_NUM];
+  MLoop mloop_orig[LOOPS_NUM];
+  MPoly mpoly_orig[POLYS_NUM];
+  MLoopUV mloopuv_orig[LOOPS_NUM];
+  memcpy(mvert_orig, me->mvert, sizeof(mvert_orig));
+  memcpy(mloop_orig, me->mloop, sizeof(mloop_orig));
+  memcpy(mpoly_orig, me->mpoly, sizeof(mpoly_orig));
+  memcpy(mloopuv_orig, CustomData_get_layer(&me->ldata, CD_MLOOPUV), sizeof(mloopuv_orig));
+
+  const uint vert_idx[VERTS_NUM] = {3, 0, 6, 1, 5, 2, 4};
+  const uint poly_idx[POLYS_NUM] = {2, 0, 1};
+  BKE_mesh_remap(me, vert_idx, poly_idx);
+
+  EXPECT_FALSE(BKE_mesh_validate(me, false, true));
+
+  for (int i = 0; i < VERTS_NUM; i++) {
+    const MVert *mv = &me->mvert[vert_idx[i]];
+    EXPECT_V3_NEAR(mv->co, mvert_orig[i].co, 0.0f);
+    EXPECT_EQ(mv->bweight, mvert_orig[i].bweight);
+  }
+
+  const MLoopUV *mloopuv = (const MLoopUV *)CustomData_get_layer(&me->ldata, CD_MLOOPUV);
+  for (int i = 0; i < POLYS_NUM; i++) {
+    const MPoly *mp_orig = &mpoly_orig[i];
+    const MPoly *mp = &me->mpoly[poly_idx[i]];
+    EXPECT_EQ(mp->mat_nr, mp_orig->mat_nr);
+    ASSERT_EQ(mp->totloop, mp_orig->totloop);
+
+    /* Loops keep their order in the polygon, with the vertices remapped. */
+    for (int j = 0; j < mp->totloop; j++) {
+      const int l = mp->loopstart + j;
+      const int l_orig = mp_orig->loopstart + j;
+      EXPECT_EQ(me->mloop[l].v, vert_idx[mloop_orig[l_orig].v]);
+      EXPECT_FLOAT_EQ(mloopuv[l].uv[0], mloopuv_orig[l_orig].uv[0]);
+      EXPECT_FLOAT_EQ(mloopuv[l].uv[1], mloopuv_orig[l_orig].uv[1]);
+
+      /* The edge of the loop still joins its vertex to the next one. */
+      const MEdge *med = &me->medge[me->mloop[l].e];
+      const uint v_next = me->mloop[mp->loopstart + (j + 1) % mp->totloop].v;
+      EXPECT_TRUE((med->v1 == me->mloop[l].v && med->v2 == v_next) ||
+                  (med->v2 == me->mloop[l].v && med->v1 == v_next));
+    }
+  }
+
+  EXPECT_EQ(me->act_face, (int)poly_idx[2]);
+
+  BKE_id_free(NULL, me);
+}
+
+}  // namespace blender::bke::tests
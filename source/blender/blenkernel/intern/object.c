@@ -75,6 +75,7 @@
 #include "BKE_anim_visualization.h"
 #include "BKE_animsys.h"
 #include "BKE_armature.h"
+#include "BKE_bvhutils.h"
 #include "BKE_camera.h"
 #include "BKE_collection.h"
 #include "BKE_constraint.h"
@@ -324,6 +325,11 @@ static void object_free_data(ID *id)
     ob->runtime.curve_cache = NULL;
   }
 
+  if (ob->runtime.bvh_cache_reuse) {
+    bvhcache_free(ob->runtime.bvh_cache_reuse);
+    ob->runtime.bvh_cache_reuse = NULL;
+  }
+
   BKE_previewimg_free(&ob->preview);
 }
 
@@ -879,6 +885,10 @@ void BKE_object_eval_assign_data(Object *object_eval, ID *data_eval, bool is_own
   object_eval->runtime.data_eval = data_eval;
   object_eval->runtime.is_data_eval_owned = is_owned;
 
+  if (GS(data_eval->name) == ID_ME && is_owned) {
+    bvhcache_reuse((Mesh *)data_eval, &object_eval->runtime.bvh_cache_reuse);
+  }
+
   /* Overwrite data of evaluated object, if the datablock types match. */
   ID *data = object_eval->data;
   if (GS(data->name) == GS(data_eval->name)) {
@@ -903,6 +913,14 @@ void BKE_object_free_derived_caches(Object *ob)
     if (ob->runtime.is_data_eval_owned) {
       ID *data_eval = ob->runtime.data_eval;
       if (GS(data_eval->name) == ID_ME) {
+        /* Keep the trees around, the next evaluation likely has the same topology. */
+        struct BVHCache *bvh_cache = bvhcache_detach_for_reuse((Mesh *)data_eval);
+        if (bvh_cache != NULL) {
+          if (ob->runtime.bvh_cache_reuse != NULL) {
+            bvhcache_free(ob->runtime.bvh_cache_reuse);
+          }
+          ob->runtime.bvh_cache_reuse = bvh_cache;
+        }
         BKE_mesh_eval_delete((Mesh *)data_eval);
       }
       else {
@@ -4265,6 +4283,7 @@ void BKE_object_runtime_reset_on_copy(Object *object, const int UNUSED(flag))
   runtime->data_eval = NULL;
   runtime->mesh_deform_eval = NULL;
   runtime->curve_cache = NULL;
+  runtime->bvh_cache_reuse = NULL;
 }
 
 /**
@@ -622,6 +622,71 @@ void BKE_pbvh_build_mesh(PBVH *pbvh,
   MEM_freeN(pbvh->vert_bitmap);
 }
 
+/**
+ * Calculate an order for the vertices and polygons of the mesh a #PBVH_FACES tree was built from,
+ * where the vertices owned by each leaf (and the polygons of its triangles) are contiguous,
+ * with leaves ordered depth first so nearby leaves are also close in memory.
+ *
+ * The result is written as `r_xxx_idx[org_index] = new_index`, see #BKE_mesh_remap.
+ * Rebuilding the tree after reordering the mesh gives leaves which each read
+ * a single range of vertices.
+ */
+void BKE_pbvh_mesh_leaf_order_calc(const PBVH *pbvh,
+                                   const int totpoly,
+                                   uint *r_vert_idx,
+                                   uint *r_poly_idx)
+{
+  BLI_assert(pbvh->type == PBVH_FACES);
+
+  /* Fill with #UINT_MAX for unassigned elements. */
+  memset(r_vert_idx, 0xff, sizeof(*r_vert_idx) * (size_t)pbvh->totvert);
+  memset(r_poly_idx, 0xff, sizeof(*r_poly_idx) * (size_t)totpoly);
+
+  uint vert_len = 0, poly_len = 0;
+
+  if (pbvh->totnode) {
+    int *stack = MEM_mallocN(sizeof(*stack) * pbvh->totnode, __func__);
+    int stack_len = 0;
+    stack[stack_len++] = 0;
+
+    while (stack_len) {
+      const PBVHNode *node = &pbvh->nodes[stack[--stack_len]];
+
+      if (node->flag & PBVH_Leaf) {
+        for (int i = 0; i < node->uniq_verts; i++) {
+          const int v = node->vert_indices[i];
+          BLI_assert(r_vert_idx[v] == UINT_MAX);
+          r_vert_idx[v] = vert_len++;
+        }
+        for (int i = 0; i < node->totprim; i++) {
+          const int p = pbvh->looptri[node->prim_indices[i]].poly;
+          if (r_poly_idx[p] == UINT_MAX) {
+            r_poly_idx[p] = poly_len++;
+          }
+        }
+      }
+      else {
+        /* Push the second child first, so the first one is visited first. */
+        stack[stack_len++] = node->children_offset + 1;
+        stack[stack_len++] = node->children_offset;
+      }
+    }
+    MEM_freeN(stack);
+  }
+
+  /* Loose vertices and polygons without triangles aren't in the tree, keep them at the end. */
+  for (int i = 0; i < pbvh->totvert; i++) {
+    if (r_vert_idx[i] == UINT_MAX) {
+      r_vert_idx[i] = vert_len++;
+    }
+  }
+  for (int i = 0; i < totpoly; i++) {
+    if (r_poly_idx[i] == UINT_MAX) {
+      r_poly_idx[i] = poly_len++;
+    }
+  }
+}
+
 /* Do a full rebuild with on Grids data structure */
 void BKE_pbvh_build_grids(PBVH *pbvh,
                           CCGElem **grids,
@@ -20,10 +20,22 @@
  * \ingroup bke
  */
 
+#include <ctype.h>
+#include <float.h>
 #include <memory.h>
 #include <stddef.h>
 #include <time.h>
 
+#include "zlib.h"
+
+#ifdef WITH_LZO
+#  ifdef WITH_SYSTEM_LZO
+#    include <lzo/lzo1x.h>
+#  else
+#    include "minilzo.h"
+#  endif
+#endif
+
 #include "MEM_guardedalloc.h"
 
 #include "DNA_scene_types.h"
@@ -40,10 +52,14 @@
 #include "BLI_fileops_types.h"
 #include "BLI_ghash.h"
 #include "BLI_listbase.h"
+#include "BLI_math_base.h"
 #include "BLI_mempool.h"
 #include "BLI_path_util.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 
+#include "atomic_ops.h"
+
 #include "BKE_global.h"
 #include "BKE_main.h"
 #include "BKE_scene.h"
@@ -71,6 +87,12 @@
  * Once again, this is to reduce number of iterations, but also more controllable than removing
  * entries one by one in reverse order to their creation.
  *
+ * By default the frame furthest from current frame is recycled. With #SEQ_CACHE_RECYCLE_BY_COST
+ * the GreedyDual-Size policy is used instead: each frame has priority of its render cost divided
+ * by memory it uses, plus the "inflation" value at the time it was last accessed. Frame with
+ * lowest priority is recycled and its priority becomes the new inflation value. This way frames
+ * which are expensive to render are kept longer, but not forever when they are not used.
+ *
  * User can exclude caching of some images. Such entries will have is_temp_cache set.
  *
  *
@@ -81,11 +103,16 @@
  * For each cached non-temp image, image data and supplementary info are written to HDD.
  * Multiple(DCACHE_IMAGES_PER_FILE) images share the same file.
  * Each of these files contains header DiskCacheHeader followed by image data.
- * Zlib compression with user definable level can be used to compress image data(per image)
+ * Zlib or LZO compression selected by user can be used to compress image data(per image)
  * Images are written in order in which they are rendered.
  * Overwriting of individual entry is not possible.
  * Stored images are deleted by invalidation, or when size of all files exceeds maximum
- * size specified in user preferences.
+ * size specified in user preferences. Files are kept in order of last access, so the least
+ * recently used file can be deleted without searching.
+ *
+ * Compressing and writing images is done by a background task, so rendering doesn't wait on it.
+ * When more than DCACHE_WRITE_QUEUE_MAX images are waiting to be written (slow storage), new
+ * images are not written to disk cache.
  * To distinguish 2 blend files with same name, scene->ed->disk_cache_timestamp
  * is used as UID. Blend file can still be copied manually which may cause conflict.
  *
@@ -95,10 +122,19 @@
 #define DCACHE_FNAME_FORMAT "%d-%dx%d-%d%%(%d)-%d.dcf"
 #define DCACHE_IMAGES_PER_FILE 100
 #define DCACHE_CURRENT_VERSION 1
+#define DCACHE_WRITE_QUEUE_MAX 16
 #define COLORSPACE_NAME_MAX 64 /* XXX: defined in imb intern */
 
+/* #DiskCacheHeaderEntry.codec */
+enum {
+  DCACHE_CODEC_ZLIB = 0,
+  DCACHE_CODEC_LZO = 1,
+};
+
 typedef struct DiskCacheHeaderEntry {
   unsigned char encoding;
+  /* Zero (zlib) for files written before the codec was stored, this used to be padding. */
+  unsigned char codec;
   uint64_t frameno;
   uint64_t size_compressed;
   uint64_t size_raw;
@@ -113,9 +149,18 @@ typedef struct DiskCacheHeader {
 typedef struct SeqDiskCache {
   Main *bmain;
   int64_t timestamp;
+  /* Ordered by last access, least recently used file first. */
   ListBase files;
+  /* Maps file path to #DiskCacheFile. */
+  struct GHash *files_map;
   ThreadMutex read_write_mutex;
   size_t size_total;
+  /* Background task writing images, see #seq_disk_cache_write_push. */
+  struct TaskPool *write_pool;
+  /* Number of images waiting to be written, accessed atomically. */
+  int write_queue_len;
+  /* Incremented on invalidation, so pending writes of invalid images are skipped. */
+  int write_generation;
 } SeqDiskCache;
 
 typedef struct DiskCacheFile {
@@ -141,11 +186,18 @@ typedef struct SeqCache {
   struct SeqCacheKey *last_key;
   size_t memory_used;
   SeqDiskCache *disk_cache;
+  /* Priority of the last frame recycled by #SEQ_CACHE_RECYCLE_BY_COST policy. */
+  float recycle_inflation;
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t recycled;
 } SeqCache;
 
 typedef struct SeqCacheItem {
   struct SeqCache *cache_owner;
   struct ImBuf *ibuf;
+  /* Value of #SeqCache.recycle_inflation when item was last accessed. */
+  float recycle_inflation;
 } SeqCacheItem;
 
 typedef struct SeqCacheKey {
@@ -177,6 +229,7 @@ static int seq_disk_cache_compression_level(void)
   switch (U.sequencer_disk_cache_compression) {
     case USER_SEQ_DISK_CACHE_COMPRESSION_NONE:
       return 0;
+    case USER_SEQ_DISK_CACHE_COMPRESSION_FAST:
     case USER_SEQ_DISK_CACHE_COMPRESSION_LOW:
       return 1;
     case USER_SEQ_DISK_CACHE_COMPRESSION_HIGH:
@@ -186,6 +239,16 @@ static int seq_disk_cache_compression_level(void)
   return U.sequencer_disk_cache_compression;
 }
 
+static int seq_disk_cache_codec(void)
+{
+#ifdef WITH_LZO
+  if (U.sequencer_disk_cache_compression == USER_SEQ_DISK_CACHE_COMPRESSION_FAST) {
+    return DCACHE_CODEC_LZO;
+  }
+#endif
+  return DCACHE_CODEC_ZLIB;
+}
+
 static size_t seq_disk_cache_size_limit(void)
 {
   return (size_t)U.sequencer_disk_cache_size_limit * (1024 * 1024 * 1024);
@@ -198,6 +261,21 @@ static bool seq_disk_cache_is_enabled(Main *bmain)
           bmain->name[0] != '\0');
 }
 
+/* Paths are compared case insensitive. */
+static unsigned int seq_disk_cache_path_hash(const void *key)
+{
+  unsigned int hash = 5381;
+  for (const char *p = key; *p; p++) {
+    hash = (hash << 5) + hash + (unsigned int)tolower(*p);
+  }
+  return hash;
+}
+
+static bool seq_disk_cache_path_cmp(const void *a, const void *b)
+{
+  return BLI_strcasecmp(a, b) != 0;
+}
+
 static DiskCacheFile *seq_disk_cache_add_file_to_list(SeqDiskCache *disk_cache, const char *path)
 {
 
@@ -217,6 +295,7 @@ static DiskCacheFile *seq_disk_cache_add_file_to_list(SeqDiskCache *disk_cache,
          &cache_file->start_frame);
   cache_file->start_frame *= DCACHE_IMAGES_PER_FILE;
   BLI_addtail(&disk_cache->files, cache_file);
+  BLI_ghash_insert(disk_cache->files_map, cache_file->path, cache_file);
   return cache_file;
 }
 
@@ -224,7 +303,6 @@ static void seq_disk_cache_get_files(SeqDiskCache *disk_cache, char *path)
 {
   struct direntry *filelist, *fl;
   uint nbr, i;
-  disk_cache->size_total = 0;
 
   i = nbr = BLI_filelist_dir_contents(path, &filelist);
   fl = filelist;
@@ -260,25 +338,38 @@ static void seq_disk_cache_get_files(SeqDiskCache *disk_cache, char *path)
   BLI_filelist_free(filelist, nbr);
 }
 
-static DiskCacheFile *seq_disk_cache_get_oldest_file(SeqDiskCache *disk_cache)
+static int seq_disk_cache_file_cmp_mtime(const void *a, const void *b)
 {
-  DiskCacheFile *oldest_file = disk_cache->files.first;
-  if (oldest_file == NULL) {
-    return NULL;
-  }
-  for (DiskCacheFile *cache_file = oldest_file->next; cache_file; cache_file = cache_file->next) {
-    if (cache_file->fstat.st_mtime < oldest_file->fstat.st_mtime) {
-      oldest_file = cache_file;
-    }
-  }
+  const DiskCacheFile *file_a = a;
+  const DiskCacheFile *file_b = b;
+  return file_a->fstat.st_mtime > file_b->fstat.st_mtime;
+}
 
-  return oldest_file;
+static void seq_disk_cache_clear_files(SeqDiskCache *disk_cache)
+{
+  BLI_ghash_clear(disk_cache->files_map, NULL, NULL);
+  BLI_freelistN(&disk_cache->files);
+  disk_cache->size_total = 0;
+}
+
+/* (Re)build the list of cache files from the files on disk. */
+static void seq_disk_cache_scan_files(SeqDiskCache *disk_cache)
+{
+  seq_disk_cache_clear_files(disk_cache);
+  seq_disk_cache_get_files(disk_cache, seq_disk_cache_base_dir());
+  BLI_listbase_sort(&disk_cache->files, seq_disk_cache_file_cmp_mtime);
+}
+
+static DiskCacheFile *seq_disk_cache_get_oldest_file(SeqDiskCache *disk_cache)
+{
+  return disk_cache->files.first;
 }
 
 static void seq_disk_cache_delete_file(SeqDiskCache *disk_cache, DiskCacheFile *file)
 {
   disk_cache->size_total -= file->fstat.st_size;
   BLI_delete(file->path, false, false);
+  BLI_ghash_remove(disk_cache->files_map, file->path, NULL, NULL);
   BLI_remlink(&disk_cache->files, file);
   MEM_freeN(file);
 }
@@ -291,14 +382,13 @@ static bool seq_disk_cache_enforce_limits(SeqDiskCache *disk_cache)
 
     if (!oldest_file) {
       /* We shouldn't enforce limits with no files, do re-scan. */
-      seq_disk_cache_get_files(disk_cache, seq_disk_cache_base_dir());
+      seq_disk_cache_scan_files(disk_cache);
       continue;
     }
 
     if (BLI_exists(oldest_file->path) == 0) {
       /* File may have been manually deleted during runtime, do re-scan. */
-      BLI_freelistN(&disk_cache->files);
-      seq_disk_cache_get_files(disk_cache, seq_disk_cache_base_dir());
+      seq_disk_cache_scan_files(disk_cache);
       continue;
     }
 
@@ -311,18 +401,10 @@ static bool seq_disk_cache_enforce_limits(SeqDiskCache *disk_cache)
 
 static DiskCacheFile *seq_disk_cache_get_file_entry_by_path(SeqDiskCache *disk_cache, char *path)
 {
-  DiskCacheFile *cache_file = disk_cache->files.first;
-
-  for (; cache_file; cache_file = cache_file->next) {
-    if (BLI_strcasecmp(cache_file->path, path) == 0) {
-      return cache_file;
-    }
-  }
-
-  return NULL;
+  return BLI_ghash_lookup(disk_cache->files_map, path);
 }
 
-/* Update file size and timestamp. */
+/* Update file size and timestamp, the file becomes the most recently used one. */
 static void seq_disk_cache_update_file(SeqDiskCache *disk_cache, char *path)
 {
   DiskCacheFile *cache_file;
@@ -330,6 +412,14 @@ static void seq_disk_cache_update_file(SeqDiskCache *disk_cache, char *path)
   int64_t size_after;
 
   cache_file = seq_disk_cache_get_file_entry_by_path(disk_cache, path);
+  if (cache_file == NULL) {
+    /* Created outside of this cache, e.g. by another instance. */
+    cache_file = seq_disk_cache_add_file_to_list(disk_cache, path);
+  }
+  else {
+    BLI_remlink(&disk_cache->files, cache_file);
+    BLI_addtail(&disk_cache->files, cache_file);
+  }
   size_before = cache_file->fstat.st_size;
 
   if (BLI_stat(path, &cache_file->fstat) == -1) {
@@ -466,6 +556,9 @@ static void seq_disk_cache_invalidate(Scene *scene,
 
   BLI_mutex_lock(&disk_cache->read_write_mutex);
 
+  /* Images of the invalidated range may still be waiting to be written. */
+  atomic_add_and_fetch_int32(&disk_cache->write_generation, 1);
+
   start = seq_changed->startdisp - DCACHE_IMAGES_PER_FILE;
   end = seq_changed->enddisp;
 
@@ -474,29 +567,60 @@ static void seq_disk_cache_invalidate(Scene *scene,
   BLI_mutex_unlock(&disk_cache->read_write_mutex);
 }
 
-static size_t deflate_imbuf_to_file(ImBuf *ibuf,
-                                    FILE *file,
-                                    int level,
-                                    DiskCacheHeaderEntry *header_entry)
+/* Compress image data into a new buffer, returns NULL on failure. */
+static void *seq_disk_cache_compress(
+    const void *data, size_t size, int codec, int level, size_t *r_size_compressed)
 {
-  if (ibuf->rect) {
-    return BLI_gzip_mem_to_file_at_pos(
-        ibuf->rect, header_entry->size_raw, file, header_entry->offset, level);
+#ifdef WITH_LZO
+  if (codec == DCACHE_CODEC_LZO) {
+    lzo_uint size_compressed = (lzo_uint)(size + size / 16 + 64 + 3);
+    void *buf = MEM_mallocN(size_compressed, "seq disk cache compressed");
+    void *wrkmem = MEM_mallocN(LZO1X_1_MEM_COMPRESS, "seq disk cache lzo");
+    const int r = lzo1x_1_compress(data, (lzo_uint)size, buf, &size_compressed, wrkmem);
+    MEM_freeN(wrkmem);
+    if (r != LZO_E_OK) {
+      MEM_freeN(buf);
+      return NULL;
+    }
+    *r_size_compressed = (size_t)size_compressed;
+    return buf;
   }
+#endif
+  BLI_assert(codec == DCACHE_CODEC_ZLIB);
+  UNUSED_VARS_NDEBUG(codec);
 
-  return BLI_gzip_mem_to_file_at_pos(
-      ibuf->rect_float, header_entry->size_raw, file, header_entry->offset, level);
+  uLongf size_compressed = compressBound((uLong)size);
+  void *buf = MEM_mallocN(size_compressed, "seq disk cache compressed");
+  if (compress2(buf, &size_compressed, data, (uLong)size, level) != Z_OK) {
+    MEM_freeN(buf);
+    return NULL;
+  }
+  *r_size_compressed = (size_t)size_compressed;
+  return buf;
 }
 
 static size_t inflate_file_to_imbuf(ImBuf *ibuf, FILE *file, DiskCacheHeaderEntry *header_entry)
 {
-  if (ibuf->rect) {
-    return BLI_ungzip_file_to_mem_at_pos(
-        ibuf->rect, header_entry->size_raw, file, header_entry->offset);
+  void *data = (ibuf->rect) ? (void *)ibuf->rect : (void *)ibuf->rect_float;
+
+  if (header_entry->codec == DCACHE_CODEC_LZO) {
+#ifdef WITH_LZO
+    void *buf = MEM_mallocN(header_entry->size_compressed, "seq disk cache compressed");
+    const lzo_uint size_compressed = (lzo_uint)header_entry->size_compressed;
+    lzo_uint size_raw = (lzo_uint)header_entry->size_raw;
+    fseek(file, header_entry->offset, 0);
+    if (fread(buf, size_compressed, 1, file) != 1 ||
+        lzo1x_decompress_safe(buf, size_compressed, data, &size_raw, NULL) != LZO_E_OK) {
+      size_raw = 0;
+    }
+    MEM_freeN(buf);
+    return (size_t)size_raw;
+#else
+    return 0;
+#endif
   }
 
-  return BLI_ungzip_file_to_mem_at_pos(
-      ibuf->rect_float, header_entry->size_raw, file, header_entry->offset);
+  return BLI_ungzip_file_to_mem_at_pos(data, header_entry->size_raw, file, header_entry->offset);
 }
 
 static void seq_disk_cache_read_header(FILE *file, DiskCacheHeader *header)
@@ -520,7 +644,38 @@ static size_t seq_disk_cache_write_header(FILE *file, DiskCacheHeader *header)
   return fwrite(header, sizeof(*header), 1, file);
 }
 
-static int seq_disk_cache_add_header_entry(SeqCacheKey *key, ImBuf *ibuf, DiskCacheHeader *header)
+/* Fill in the information about the image, which doesn't depend on the file it's written to. */
+static void seq_disk_cache_init_header_entry(SeqCacheKey *key,
+                                             ImBuf *ibuf,
+                                             DiskCacheHeaderEntry *entry)
+{
+  memset(entry, 0, sizeof(*entry));
+
+  if (ENDIAN_ORDER == B_ENDIAN) {
+    entry->encoding = 255;
+  }
+  else {
+    entry->encoding = 0;
+  }
+
+  entry->codec = seq_disk_cache_codec();
+  entry->frameno = key->nfra;
+
+  /* Store colorspace name of ibuf. */
+  const char *colorspace_name;
+  if (ibuf->rect) {
+    entry->size_raw = ibuf->x * ibuf->y * ibuf->channels;
+    colorspace_name = IMB_colormanagement_get_rect_colorspace(ibuf);
+  }
+  else {
+    entry->size_raw = ibuf->x * ibuf->y * ibuf->channels * 4;
+    colorspace_name = IMB_colormanagement_get_float_colorspace(ibuf);
+  }
+  BLI_strncpy(entry->colorspace_name, colorspace_name, sizeof(entry->colorspace_name));
+}
+
+static int seq_disk_cache_add_header_entry(const DiskCacheHeaderEntry *entry,
+                                           DiskCacheHeader *header)
 {
   int i;
   uint64_t offset = sizeof(*header);
@@ -545,28 +700,8 @@ static int seq_disk_cache_add_header_entry(SeqCacheKey *key, ImBuf *ibuf, DiskCa
     offset = header->entry[i - 1].offset + header->entry[i - 1].size_compressed;
   }
 
-  if (ENDIAN_ORDER == B_ENDIAN) {
-    header->entry[i].encoding = 255;
-  }
-  else {
-    header->entry[i].encoding = 0;
-  }
-
+  header->entry[i] = *entry;
   header->entry[i].offset = offset;
-  header->entry[i].frameno = key->nfra;
-
-  /* Store colorspace name of ibuf. */
-  const char *colorspace_name;
-  if (ibuf->rect) {
-    header->entry[i].size_raw = ibuf->x * ibuf->y * ibuf->channels;
-    colorspace_name = IMB_colormanagement_get_rect_colorspace(ibuf);
-  }
-  else {
-    header->entry[i].size_raw = ibuf->x * ibuf->y * ibuf->channels * 4;
-    colorspace_name = IMB_colormanagement_get_float_colorspace(ibuf);
-  }
-  BLI_strncpy(
-      header->entry[i].colorspace_name, colorspace_name, sizeof(header->entry[i].colorspace_name));
 
   return i;
 }
@@ -582,11 +717,12 @@ static int seq_disk_cache_get_header_entry(SeqCacheKey *key, DiskCacheHeader *he
   return -1;
 }
 
-static bool seq_disk_cache_write_file(SeqDiskCache *disk_cache, SeqCacheKey *key, ImBuf *ibuf)
+/* Must be called with read_write_mutex locked. */
+static bool seq_disk_cache_write_file(SeqDiskCache *disk_cache,
+                                      char *path,
+                                      const DiskCacheHeaderEntry *entry,
+                                      const void *data_compressed)
 {
-  char path[FILE_MAX];
-
-  seq_disk_cache_get_file_path(disk_cache, key, path, sizeof(path));
   BLI_make_existing_file(path);
 
   FILE *file = BLI_fopen(path, "rb+");
@@ -595,31 +731,105 @@ static bool seq_disk_cache_write_file(SeqDiskCache *disk_cache, SeqCacheKey *key
     if (!file) {
       return false;
     }
-    seq_disk_cache_add_file_to_list(disk_cache, path);
   }
 
   DiskCacheHeader header;
   memset(&header, 0, sizeof(header));
   seq_disk_cache_read_header(file, &header);
-  int entry_index = seq_disk_cache_add_header_entry(key, ibuf, &header);
-  size_t bytes_written = deflate_imbuf_to_file(
-      ibuf, file, seq_disk_cache_compression_level(), &header.entry[entry_index]);
+  int entry_index = seq_disk_cache_add_header_entry(entry, &header);
 
-  if (bytes_written != 0) {
+  fseek(file, header.entry[entry_index].offset, 0);
+  if (fwrite(data_compressed, entry->size_compressed, 1, file) == 1) {
     /* Last step is writing header, as image data can be overwritten,
      * but missing data would cause problems.
      */
-    header.entry[entry_index].size_compressed = bytes_written;
     seq_disk_cache_write_header(file, &header);
-    seq_disk_cache_update_file(disk_cache, path);
     fclose(file);
+    seq_disk_cache_update_file(disk_cache, path);
 
     return true;
   }
 
+  fclose(file);
   return false;
 }
 
+typedef struct DiskCacheWriteTask {
+  char path[FILE_MAX];
+  ImBuf *ibuf;
+  DiskCacheHeaderEntry entry;
+  int compression_level;
+  int generation;
+} DiskCacheWriteTask;
+
+static void seq_disk_cache_write_task_run(TaskPool *__restrict pool, void *taskdata)
+{
+  SeqDiskCache *disk_cache = BLI_task_pool_user_data(pool);
+  DiskCacheWriteTask *task = taskdata;
+  ImBuf *ibuf = task->ibuf;
+  const void *data = (ibuf->rect) ? (void *)ibuf->rect : (void *)ibuf->rect_float;
+
+  /* Compress without holding the lock, so reading from disk cache is not blocked. */
+  void *data_compressed = NULL;
+  if (atomic_add_and_fetch_int32(&disk_cache->write_generation, 0) == task->generation &&
+      !BLI_task_pool_canceled(pool)) {
+    data_compressed = seq_disk_cache_compress(data,
+                                              task->entry.size_raw,
+                                              task->entry.codec,
+                                              task->compression_level,
+                                              &task->entry.size_compressed);
+  }
+
+  if (data_compressed != NULL) {
+    bool written = false;
+    BLI_mutex_lock(&disk_cache->read_write_mutex);
+    /* Images may have been invalidated in the meantime. */
+    if (disk_cache->write_generation == task->generation) {
+      written = seq_disk_cache_write_file(disk_cache, task->path, &task->entry, data_compressed);
+    }
+    BLI_mutex_unlock(&disk_cache->read_write_mutex);
+    MEM_freeN(data_compressed);
+
+    if (written) {
+      seq_disk_cache_enforce_limits(disk_cache);
+    }
+  }
+}
+
+static void seq_disk_cache_write_task_free(TaskPool *__restrict pool, void *taskdata)
+{
+  SeqDiskCache *disk_cache = BLI_task_pool_user_data(pool);
+  DiskCacheWriteTask *task = taskdata;
+  IMB_freeImBuf(task->ibuf);
+  MEM_freeN(task);
+  atomic_sub_and_fetch_int32(&disk_cache->write_queue_len, 1);
+}
+
+/* Queue writing of the image, this doesn't wait on compression or disk access. */
+static void seq_disk_cache_write_push(SeqDiskCache *disk_cache, SeqCacheKey *key, ImBuf *ibuf)
+{
+  if (atomic_add_and_fetch_int32(&disk_cache->write_queue_len, 1) > DCACHE_WRITE_QUEUE_MAX) {
+    /* Storage can't keep up, skip this image rather than blocking rendering. */
+    atomic_sub_and_fetch_int32(&disk_cache->write_queue_len, 1);
+    return;
+  }
+
+  DiskCacheWriteTask *task = MEM_callocN(sizeof(DiskCacheWriteTask), "DiskCacheWriteTask");
+  seq_disk_cache_get_file_path(disk_cache, key, task->path, sizeof(task->path));
+  seq_disk_cache_init_header_entry(key, ibuf, &task->entry);
+  task->compression_level = seq_disk_cache_compression_level();
+  task->generation = atomic_add_and_fetch_int32(&disk_cache->write_generation, 0);
+
+  IMB_refImBuf(ibuf);
+  task->ibuf = ibuf;
+
+  BLI_task_pool_push(disk_cache->write_pool,
+                     seq_disk_cache_write_task_run,
+                     task,
+                     true,
+                     seq_disk_cache_write_task_free);
+}
+
 static ImBuf *seq_disk_cache_read_file(SeqDiskCache *disk_cache, SeqCacheKey *key)
 {
   char path[FILE_MAX];
@@ -681,6 +891,7 @@ static ImBuf *seq_disk_cache_read_file(SeqDiskCache *disk_cache, SeqCacheKey *ke
 #undef DCACHE_IMAGES_PER_FILE
 #undef COLORSPACE_NAME_MAX
 #undef DCACHE_CURRENT_VERSION
+#undef DCACHE_WRITE_QUEUE_MAX
 
 static bool seq_cmp_render_data(const SeqRenderData *a, const SeqRenderData *b)
 {
@@ -793,6 +1004,7 @@ static void seq_cache_put(SeqCache *cache, SeqCacheKey *key, ImBuf *ibuf)
   item = BLI_mempool_alloc(cache->items_pool);
   item->cache_owner = cache;
   item->ibuf = ibuf;
+  item->recycle_inflation = cache->recycle_inflation;
 
   if (BLI_ghash_reinsert(cache->hash, key, item, seq_cache_keyfree, seq_cache_valfree)) {
     IMB_refImBuf(ibuf);
@@ -807,10 +1019,13 @@ static ImBuf *seq_cache_get(SeqCache *cache, SeqCacheKey *key)
 
   if (item && item->ibuf) {
     IMB_refImBuf(item->ibuf);
+    item->recycle_inflation = cache->recycle_inflation;
+    cache->hits++;
 
     return item->ibuf;
   }
 
+  cache->misses++;
   return NULL;
 }
 
@@ -978,6 +1193,81 @@ static SeqCacheKey *seq_cache_get_item_for_removal(Scene *scene)
   return finalkey;
 }
 
+/* GreedyDual-Size priority of a frame, which consists of base key and keys linked to it. */
+static float seq_cache_recycle_priority(SeqCache *cache, SeqCacheKey *base)
+{
+  float inflation = 0.0f;
+  float cost = 0.0f;
+  size_t size = 0;
+
+  for (SeqCacheKey *key = base; key; key = key->link_prev) {
+    SeqCacheItem *item = BLI_ghash_lookup(cache->hash, key);
+    if (item && item->ibuf) {
+      inflation = max_ff(inflation, item->recycle_inflation);
+      size += IMB_get_size_in_memory(item->ibuf);
+    }
+    /* Cost of the last image in stack includes rendering of images it was made from. */
+    cost = max_ff(cost, key->cost);
+  }
+
+  const float size_mb = max_ff((float)size / (1024.0f * 1024.0f), 1.0f / 1024.0f);
+  return inflation + cost / size_mb;
+}
+
+static SeqCacheKey *seq_cache_get_item_for_removal_by_cost(Scene *scene)
+{
+  SeqCache *cache = seq_cache_get_from_scene(scene);
+  SeqCacheKey *finalkey = NULL;
+  float finalkey_priority = FLT_MAX;
+
+  /* Frames which are about to be prefetched are not recycled, see #seq_cache_choose_key. */
+  int pfjob_start = 0, pfjob_end = -1;
+  if (scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE &&
+      BKE_sequencer_prefetch_job_is_running(scene)) {
+    BKE_sequencer_prefetch_get_time_range(scene, &pfjob_start, &pfjob_end);
+  }
+
+  GHashIterator gh_iter;
+  BLI_ghashIterator_init(&gh_iter, cache->hash);
+
+  while (!BLI_ghashIterator_done(&gh_iter)) {
+    SeqCacheKey *key = BLI_ghashIterator_getKey(&gh_iter);
+    SeqCacheItem *item = BLI_ghashIterator_getValue(&gh_iter);
+    BLI_ghashIterator_step(&gh_iter);
+
+    /* This shouldn't happen, but better be safe than sorry. */
+    if (!item->ibuf) {
+      seq_cache_recycle_linked(scene, key);
+      /* Can not continue iterating after linked remove. */
+      BLI_ghashIterator_init(&gh_iter, cache->hash);
+      finalkey = NULL;
+      finalkey_priority = FLT_MAX;
+      continue;
+    }
+
+    if (key->is_temp_cache || key->link_next != NULL || key->cost > scene->ed->recycle_max_cost) {
+      continue;
+    }
+
+    const int key_cfra = seq_cache_frame_index_to_cfra(key->seq, key->nfra);
+    if (key_cfra >= pfjob_start && key_cfra <= pfjob_end) {
+      continue;
+    }
+
+    const float priority = seq_cache_recycle_priority(cache, key);
+    if (priority < finalkey_priority) {
+      finalkey = key;
+      finalkey_priority = priority;
+    }
+  }
+
+  if (finalkey) {
+    cache->recycle_inflation = finalkey_priority;
+  }
+
+  return finalkey;
+}
+
 /* Find only "base" keys.
  * Sources(other types) for a frame must be freed all at once.
  */
@@ -992,10 +1282,13 @@ bool BKE_sequencer_cache_recycle_item(Scene *scene)
   seq_cache_lock(scene);
 
   while (cache->memory_used > memory_total) {
-    SeqCacheKey *finalkey = seq_cache_get_item_for_removal(scene);
+    SeqCacheKey *finalkey = (scene->ed->cache_flag & SEQ_CACHE_RECYCLE_BY_COST) ?
+                                seq_cache_get_item_for_removal_by_cost(scene) :
+                                seq_cache_get_item_for_removal(scene);
 
     if (finalkey) {
       seq_cache_recycle_linked(scene, finalkey);
+      cache->recycled++;
     }
     else {
       seq_cache_unlock(scene);
@@ -1035,20 +1328,21 @@ static void seq_disk_cache_create(Main *bmain, Scene *scene)
   BLI_mutex_lock(&cache_create_lock);
   SeqCache *cache = seq_cache_get_from_scene(scene);
 
-  if (cache == NULL) {
+  if (cache == NULL || cache->disk_cache != NULL) {
+    BLI_mutex_unlock(&cache_create_lock);
     return;
   }
 
-  if (cache->disk_cache != NULL) {
-    return;
-  }
-
-  cache->disk_cache = MEM_callocN(sizeof(SeqDiskCache), "SeqDiskCache");
-  cache->disk_cache->bmain = bmain;
-  BLI_mutex_init(&cache->disk_cache->read_write_mutex);
-  seq_disk_cache_handle_versioning(cache->disk_cache);
-  seq_disk_cache_get_files(cache->disk_cache, seq_disk_cache_base_dir());
-  cache->disk_cache->timestamp = scene->ed->disk_cache_timestamp;
+  SeqDiskCache *disk_cache = MEM_callocN(sizeof(SeqDiskCache), "SeqDiskCache");
+  disk_cache->bmain = bmain;
+  disk_cache->files_map = BLI_ghash_new(
+      seq_disk_cache_path_hash, seq_disk_cache_path_cmp, "SeqDiskCache files");
+  BLI_mutex_init(&disk_cache->read_write_mutex);
+  seq_disk_cache_handle_versioning(disk_cache);
+  seq_disk_cache_scan_files(disk_cache);
+  disk_cache->timestamp = scene->ed->disk_cache_timestamp;
+  disk_cache->write_pool = BLI_task_pool_create_background(disk_cache, TASK_PRIORITY_LOW);
+  cache->disk_cache = disk_cache;
   BLI_mutex_unlock(&cache_create_lock);
 }
 
@@ -1110,6 +1404,10 @@ void BKE_sequencer_cache_destruct(Scene *scene)
   BLI_mutex_end(&cache->iterator_mutex);
 
   if (cache->disk_cache != NULL) {
+    /* Images which are not written yet are discarded. */
+    BLI_task_pool_cancel(cache->disk_cache->write_pool);
+    BLI_task_pool_free(cache->disk_cache->write_pool);
+    BLI_ghash_free(cache->disk_cache->files_map, NULL, NULL);
     BLI_freelistN(&cache->disk_cache->files);
     BLI_mutex_end(&cache->disk_cache->read_write_mutex);
     MEM_freeN(cache->disk_cache);
@@ -1407,10 +1705,7 @@ void BKE_sequencer_cache_put(const SeqRenderData *context,
         seq_disk_cache_create(context->bmain, context->scene);
       }
 
-      BLI_mutex_lock(&cache->disk_cache->read_write_mutex);
-      seq_disk_cache_write_file(cache->disk_cache, key, i);
-      BLI_mutex_unlock(&cache->disk_cache->read_write_mutex);
-      seq_disk_cache_enforce_limits(cache->disk_cache);
+      seq_disk_cache_write_push(cache->disk_cache, key, i);
     }
   }
 }
@@ -1453,3 +1748,21 @@ bool BKE_sequencer_cache_is_full(Scene *scene)
 
   return memory_total < cache->memory_used;
 }
+
+void BKE_sequencer_cache_stats_get(Scene *scene, SeqCacheStats *r_stats)
+{
+  memset(r_stats, 0, sizeof(*r_stats));
+
+  SeqCache *cache = seq_cache_get_from_scene(scene);
+  if (!cache) {
+    return;
+  }
+
+  seq_cache_lock(scene);
+  r_stats->hits = cache->hits;
+  r_stats->misses = cache->misses;
+  r_stats->recycled = cache->recycled;
+  r_stats->memory_used = cache->memory_used;
+  r_stats->items_num = (int)BLI_ghash_len(cache->hash);
+  seq_cache_unlock(scene);
+}
@@ -24,6 +24,7 @@
 #include "DNA_material_types.h"
 #include "DNA_object_types.h"
 #include "DNA_scene_types.h"
+#include "DNA_userdef_types.h"
 #include "DNA_volume_types.h"
 
 #include "BLI_compiler_compat.h"
@@ -32,6 +33,7 @@
 #include "BLI_math.h"
 #include "BLI_path_util.h"
 #include "BLI_string.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_anim_data.h"
@@ -62,10 +64,13 @@ static CLG_LogRef LOG = {"bke.volume"};
 #define VOLUME_FRAME_NONE INT_MAX
 
 #ifdef WITH_OPENVDB
+#  include <algorithm>
 #  include <atomic>
 #  include <list>
 #  include <mutex>
+#  include <unordered_map>
 #  include <unordered_set>
+#  include <vector>
 
 #  include <openvdb/openvdb.h>
 #  include <openvdb/points/PointDataGrid.h>
@@ -82,7 +87,12 @@ static CLG_LogRef LOG = {"bke.volume"};
  * rendering for example. So, depending on the users the grid in the cache may
  * have a tree or not.
  *
- * When the number of users drops to zero, the grid data is immediately deleted.
+ * When the number of tree users drops to zero, the tree is kept in the cache
+ * for users in the near future, for example when going back to a previous frame
+ * of a sequence or when the next frame was prefetched. Trees without users are
+ * deleted least recently used first, when their memory exceeds the memory cache
+ * limit from the user preferences. Leaf buffers are only read from the file when
+ * accessed, as OpenVDB files are opened with delayed loading.
  *
  * TODO: also add a cache for OpenVDB files rather than individual grids,
  * so getting the list of grids is also cached.
@@ -94,29 +104,39 @@ static CLG_LogRef LOG = {"bke.volume"};
 static struct VolumeFileCache {
   /* Cache Entry */
   struct Entry {
-    Entry(const std::string &filepath, const openvdb::GridBase::Ptr &grid)
+    Entry(const std::string &filepath,
+          const int64_t file_mtime,
+          const openvdb::GridBase::Ptr &grid)
         : filepath(filepath),
           grid_name(grid->getName()),
+          file_mtime(file_mtime),
           grid(grid),
           is_loaded(false),
           num_metadata_users(0),
-          num_tree_users(0)
+          num_tree_users(0),
+          is_unused_tree(false),
+          tree_mem_size(0)
     {
     }
 
     Entry(const Entry &other)
         : filepath(other.filepath),
           grid_name(other.grid_name),
+          file_mtime(other.file_mtime),
           grid(other.grid),
           is_loaded(other.is_loaded),
           num_metadata_users(0),
-          num_tree_users(0)
+          num_tree_users(0),
+          is_unused_tree(false),
+          tree_mem_size(0)
     {
     }
 
     /* Unique key: filename + grid name. */
     std::string filepath;
     std::string grid_name;
+    /* File modification time, to detect files written again since the grid was cached. */
+    int64_t file_mtime;
 
     /* OpenVDB grid. */
     openvdb::GridBase::Ptr grid;
@@ -127,6 +147,11 @@ static struct VolumeFileCache {
     /* User counting. */
     int num_metadata_users;
     int num_tree_users;
+    /* Loaded tree without tree users, kept in the unused trees list. */
+    bool is_unused_tree;
+    std::list<Entry *>::iterator unused_tree_it;
+    /* Memory used by the tree, measured when it became unused. */
+    size_t tree_mem_size;
     /* Mutex for on-demand reading of tree. */
     std::mutex mutex;
   };
@@ -167,6 +192,15 @@ static struct VolumeFileCache {
 
     /* Casting const away is weak, but it's convenient having key and value in one. */
     Entry &entry = (Entry &)*it;
+    if (entry.file_mtime != template_entry.file_mtime &&
+        entry.num_metadata_users + entry.num_tree_users == 0) {
+      /* The file was written again since the unused tree was cached, read it again. */
+      remove_unused_tree(entry);
+      entry.grid = template_entry.grid;
+      entry.file_mtime = template_entry.file_mtime;
+      entry.error_msg.clear();
+      entry.is_loaded = false;
+    }
     entry.num_metadata_users++;
 
     /* Note: pointers to unordered_set values are not invalidated when adding
@@ -200,6 +234,7 @@ static struct VolumeFileCache {
   void change_to_tree_user(Entry &entry)
   {
     std::lock_guard<std::mutex> lock(mutex);
+    remove_unused_tree(entry);
     entry.num_tree_users++;
     entry.num_metadata_users--;
     update_for_remove_user(entry);
@@ -213,10 +248,35 @@ static struct VolumeFileCache {
     update_for_remove_user(entry);
   }
 
+  void clear_unused()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    free_unused_trees(0);
+  }
+
+  openvdb::GridBase::Ptr get_grid(const Entry &entry)
+  {
+    /* The grid is replaced when its tree is freed, possibly from another thread like the one
+     * prefetching frames. So only read it with the lock held. */
+    std::lock_guard<std::mutex> lock(mutex);
+    return entry.grid;
+  }
+
  protected:
   void update_for_remove_user(Entry &entry)
   {
-    if (entry.num_metadata_users + entry.num_tree_users == 0) {
+    if (entry.num_tree_users == 0 && entry.is_loaded) {
+      /* Keep the tree for later users, it may be freed immediately if there is no memory left
+       * for it in the cache. */
+      if (!entry.is_unused_tree) {
+        entry.tree_mem_size = entry.grid->memUsage();
+        entry.unused_tree_it = unused_trees.insert(unused_trees.begin(), &entry);
+        entry.is_unused_tree = true;
+        unused_trees_mem_size += entry.tree_mem_size;
+        free_unused_trees(memory_limit());
+      }
+    }
+    else if (entry.num_metadata_users + entry.num_tree_users == 0) {
       cache.erase(entry);
     }
     else if (entry.num_tree_users == 0) {
@@ -227,9 +287,42 @@ static struct VolumeFileCache {
     }
   }
 
+  void remove_unused_tree(Entry &entry)
+  {
+    if (entry.is_unused_tree) {
+      unused_trees.erase(entry.unused_tree_it);
+      entry.is_unused_tree = false;
+      unused_trees_mem_size -= entry.tree_mem_size;
+    }
+  }
+
+  /* Free least recently used trees without users, until they fit in the given memory size. */
+  void free_unused_trees(const size_t mem_size)
+  {
+    while (unused_trees_mem_size > mem_size || (mem_size == 0 && !unused_trees.empty())) {
+      Entry &entry = *unused_trees.back();
+      remove_unused_tree(entry);
+      if (entry.num_metadata_users == 0) {
+        cache.erase(entry);
+      }
+      else {
+        entry.grid = entry.grid->copyGridWithNewTree();
+        entry.is_loaded = false;
+      }
+    }
+  }
+
+  static size_t memory_limit()
+  {
+    return ((size_t)U.memcachelimit) * 1024 * 1024;
+  }
+
   /* Cache contents */
   typedef std::unordered_set<Entry, EntryHasher, EntryEqual> EntrySet;
   EntrySet cache;
+  /* Entries with a loaded tree and no tree users, most recently used first. */
+  std::list<Entry *> unused_trees;
+  size_t unused_trees_mem_size = 0;
   /* Mutex for multithreaded access. */
   std::mutex mutex;
 } GLOBAL_CACHE;
@@ -357,10 +450,15 @@ struct VolumeGrid {
 
   const char *name() const
   {
+    /* The name of a cache entry never changes, unlike its grid. */
+    if (entry) {
+      return entry->grid_name.c_str();
+    }
+
     /* Don't use vdb.getName() since it copies the string, we want a pointer to the
      * original so it doesn't get freed out of scope. */
-    openvdb::StringMetadata::ConstPtr name_meta = grid()->getMetadata<openvdb::StringMetadata>(
-        openvdb::GridBase::META_GRID_NAME);
+    openvdb::StringMetadata::ConstPtr name_meta =
+        local_grid->getMetadata<openvdb::StringMetadata>(openvdb::GridBase::META_GRID_NAME);
     return (name_meta) ? name_meta->value().c_str() : "";
   }
 
@@ -378,9 +476,9 @@ struct VolumeGrid {
     return is_loaded;
   }
 
-  const openvdb::GridBase::Ptr &grid() const
+  openvdb::GridBase::Ptr grid() const
   {
-    return (entry) ? entry->grid : local_grid;
+    return (entry) ? GLOBAL_CACHE.get_grid(*entry) : local_grid;
   }
 
  protected:
@@ -438,6 +536,21 @@ struct VolumeGridVector : public std::list<VolumeGrid> {
 
 /* Module */
 
+#ifdef WITH_OPENVDB
+/* Background loading of the grids of the next frame of sequences during playback. */
+struct VolumePrefetchTask {
+  std::string volume_name;
+  std::string filepath;
+  std::vector<std::string> grid_names;
+};
+
+static TaskPool *volume_prefetch_pool = NULL;
+/* Frame to prefetch for each original volume datablock. Only the last requested frame is kept,
+ * so frames passed before their task ran are not read. */
+static std::unordered_map<const ID *, VolumePrefetchTask> volume_prefetch_pending;
+static std::mutex volume_prefetch_mutex;
+#endif
+
 void BKE_volumes_init()
 {
 #ifdef WITH_OPENVDB
@@ -445,6 +558,25 @@ void BKE_volumes_init()
 #endif
 }
 
+void BKE_volumes_exit()
+{
+#ifdef WITH_OPENVDB
+  /* Canceling waits for the running task, which locks the mutex too. */
+  TaskPool *pool;
+  {
+    std::lock_guard<std::mutex> lock(volume_prefetch_mutex);
+    pool = volume_prefetch_pool;
+    volume_prefetch_pool = NULL;
+    volume_prefetch_pending.clear();
+  }
+  if (pool) {
+    BLI_task_pool_cancel(pool);
+    BLI_task_pool_free(pool);
+  }
+  GLOBAL_CACHE.clear_unused();
+#endif
+}
+
 /* Volume datablock */
 
 static void volume_init_data(ID *id)
@@ -618,7 +750,7 @@ Volume *BKE_volume_copy(Main *bmain, const Volume *volume)
 
 /* Sequence */
 
-static int volume_sequence_frame(const Depsgraph *depsgraph, const Volume *volume)
+static int volume_sequence_frame_at(const Volume *volume, const int scene_frame)
 {
   if (!volume->is_sequence) {
     return 0;
@@ -631,7 +763,6 @@ static int volume_sequence_frame(const Depsgraph *depsgraph, const Volume *volum
     return 0;
   }
 
-  const int scene_frame = DEG_get_ctime(depsgraph);
   const VolumeSequenceMode mode = (VolumeSequenceMode)volume->sequence_mode;
   const int frame_duration = volume->frame_duration;
   const int frame_start = volume->frame_start;
@@ -686,8 +817,16 @@ static int volume_sequence_frame(const Depsgraph *depsgraph, const Volume *volum
   return frame;
 }
 
+static int volume_sequence_frame(const Depsgraph *depsgraph, const Volume *volume)
+{
+  return volume_sequence_frame_at(volume, (int)DEG_get_ctime(depsgraph));
+}
+
 #ifdef WITH_OPENVDB
-static void volume_filepath_get(const Main *bmain, const Volume *volume, char r_filepath[FILE_MAX])
+static void volume_filepath_get_at(const Main *bmain,
+                                   const Volume *volume,
+                                   const int frame,
+                                   char r_filepath[FILE_MAX])
 {
   BLI_strncpy(r_filepath, volume->filepath, FILE_MAX);
   BLI_path_abs(r_filepath, ID_BLEND_PATH(bmain, &volume->id));
@@ -696,10 +835,21 @@ static void volume_filepath_get(const Main *bmain, const Volume *volume, char r_
   if (volume->is_sequence && BLI_path_frame_get(r_filepath, &path_frame, &path_digits)) {
     char ext[32];
     BLI_path_frame_strip(r_filepath, ext);
-    BLI_path_frame(r_filepath, volume->runtime.frame, path_digits);
+    BLI_path_frame(r_filepath, frame, path_digits);
     BLI_path_extension_ensure(r_filepath, FILE_MAX, ext);
   }
 }
+
+static void volume_filepath_get(const Main *bmain, const Volume *volume, char r_filepath[FILE_MAX])
+{
+  volume_filepath_get_at(bmain, volume, volume->runtime.frame, r_filepath);
+}
+
+static int64_t volume_file_mtime(const char *filepath)
+{
+  BLI_stat_t st;
+  return (BLI_stat(filepath, &st) == 0) ? (int64_t)st.st_mtime : 0;
+}
 #endif
 
 /* File Load */
@@ -762,6 +912,7 @@ bool BKE_volume_load(Volume *volume, Main *bmain)
   /* Open OpenVDB file. */
   openvdb::io::File file(grids.filepath);
   openvdb::GridPtrVec vdb_grids;
+  const int64_t file_mtime = volume_file_mtime(grids.filepath);
 
   try {
     file.setCopyMaxBytes(0);
@@ -777,7 +928,7 @@ bool BKE_volume_load(Volume *volume, Main *bmain)
   /* Add grids read from file to own vector, filtering out any NULL pointers. */
   for (const openvdb::GridBase::Ptr &vdb_grid : vdb_grids) {
     if (vdb_grid) {
-      VolumeFileCache::Entry template_entry(grids.filepath, vdb_grid);
+      VolumeFileCache::Entry template_entry(grids.filepath, file_mtime, vdb_grid);
       grids.emplace_back(template_entry);
     }
   }
@@ -887,6 +1038,120 @@ bool BKE_volume_is_points_only(const Volume *volume)
   return true;
 }
 
+/* Prefetch */
+
+#ifdef WITH_OPENVDB
+static bool volume_prefetch_is_pending(const ID *volume_id)
+{
+  std::lock_guard<std::mutex> lock(volume_prefetch_mutex);
+  return volume_prefetch_pending.count(volume_id) != 0;
+}
+
+static void volume_prefetch_task_run(TaskPool *__restrict pool, void *taskdata)
+{
+  const ID *volume_id = (const ID *)taskdata;
+  VolumePrefetchTask task;
+  {
+    std::lock_guard<std::mutex> lock(volume_prefetch_mutex);
+    auto it = volume_prefetch_pending.find(volume_id);
+    if (it == volume_prefetch_pending.end()) {
+      return;
+    }
+    task = std::move(it->second);
+    volume_prefetch_pending.erase(it);
+  }
+
+  const char *volume_name = task.volume_name.c_str();
+  const char *filepath = task.filepath.c_str();
+
+  if (!BLI_exists(filepath)) {
+    return;
+  }
+
+  CLOG_INFO(&LOG, 1, "Volume %s: prefetch %s", volume_name, filepath);
+
+  openvdb::io::File file(task.filepath);
+  openvdb::GridPtrVec vdb_grids;
+  const int64_t file_mtime = volume_file_mtime(filepath);
+
+  try {
+    file.setCopyMaxBytes(0);
+    file.open();
+    vdb_grids = *(file.readAllGridMetadata());
+  }
+  catch (const openvdb::IoError &e) {
+    CLOG_INFO(&LOG, 1, "Volume %s: %s", volume_name, e.what());
+    return;
+  }
+
+  for (const openvdb::GridBase::Ptr &vdb_grid : vdb_grids) {
+    /* Stop when a later frame is requested, it's prefetched by the next task. */
+    if (BLI_task_pool_canceled(pool) || volume_prefetch_is_pending(volume_id)) {
+      break;
+    }
+    if (vdb_grid && std::find(task.grid_names.begin(),
+                              task.grid_names.end(),
+                              vdb_grid->getName()) != task.grid_names.end()) {
+      /* Load the tree as a temporary user, the file cache keeps it as unused tree after. */
+      VolumeGrid grid(VolumeFileCache::Entry(task.filepath, file_mtime, vdb_grid));
+      grid.load(volume_name, filepath);
+    }
+  }
+}
+#endif
+
+/* Read the grids loaded for the current frame of the sequence from the file of the next frame
+ * in the background, when the sequence is played forward. */
+static void volume_prefetch_next_frame(const Depsgraph *depsgraph,
+                                       const Volume *volume,
+                                       const int frame)
+{
+#ifdef WITH_OPENVDB
+  if (!DEG_is_active(depsgraph) || !volume->is_sequence || frame == VOLUME_FRAME_NONE ||
+      volume->runtime.frame == VOLUME_FRAME_NONE || frame != volume->runtime.frame + 1) {
+    return;
+  }
+
+  const int next_frame = volume_sequence_frame_at(volume, (int)DEG_get_ctime(depsgraph) + 1);
+  if (next_frame == VOLUME_FRAME_NONE || next_frame == frame) {
+    return;
+  }
+
+  VolumePrefetchTask task;
+  for (const VolumeGrid &grid : *volume->runtime.grids) {
+    if (grid.grid_is_loaded()) {
+      task.grid_names.push_back(grid.name());
+    }
+  }
+  if (task.grid_names.empty()) {
+    return;
+  }
+
+  char filepath[FILE_MAX];
+  volume_filepath_get_at(DEG_get_bmain(depsgraph), volume, next_frame, filepath);
+  task.volume_name = volume->id.name + 2;
+  task.filepath = filepath;
+
+  const ID *volume_id = DEG_get_original_id((ID *)&volume->id);
+
+  std::lock_guard<std::mutex> lock(volume_prefetch_mutex);
+  /* A task for this volume that didn't start yet reads the new frame instead. */
+  const bool is_pending = volume_prefetch_pending.count(volume_id) != 0;
+  volume_prefetch_pending[volume_id] = std::move(task);
+  if (is_pending) {
+    return;
+  }
+
+  if (volume_prefetch_pool == NULL) {
+    volume_prefetch_pool = BLI_task_pool_create_background(NULL, TASK_PRIORITY_LOW);
+  }
+  BLI_task_pool_push(
+      volume_prefetch_pool, volume_prefetch_task_run, (void *)volume_id, false, NULL);
+#else
+  UNUSED_VARS(depsgraph, volume, frame);
+#endif
+}
+
 /* Dependency Graph */
 
 static Volume *volume_evaluate_modifiers(struct Depsgraph *depsgraph,
@@ -942,6 +1207,7 @@ void BKE_volume_eval_geometry(struct Depsgraph *depsgraph, Volume *volume)
   /* TODO: can we avoid modifier re-evaluation when frame did not change? */
   int frame = volume_sequence_frame(depsgraph, volume);
   if (frame != volume->runtime.frame) {
+    volume_prefetch_next_frame(depsgraph, volume, frame);
     BKE_volume_unload(volume);
     volume->runtime.frame = frame;
   }
@@ -1143,7 +1409,7 @@ const char *BKE_volume_grid_name(const VolumeGrid *volume_grid)
 VolumeGridType BKE_volume_grid_type(const VolumeGrid *volume_grid)
 {
 #ifdef WITH_OPENVDB
-  const openvdb::GridBase::Ptr &grid = volume_grid->grid();
+  const openvdb::GridBase::Ptr grid = volume_grid->grid();
 
   if (grid->isType<openvdb::FloatGrid>()) {
     return VOLUME_GRID_FLOAT;
@@ -1212,7 +1478,7 @@ int BKE_volume_grid_channels(const VolumeGrid *grid)
 void BKE_volume_grid_transform_matrix(const VolumeGrid *volume_grid, float mat[4][4])
 {
 #ifdef WITH_OPENVDB
-  const openvdb::GridBase::Ptr &grid = volume_grid->grid();
+  const openvdb::GridBase::Ptr grid = volume_grid->grid();
   const openvdb::math::Transform &transform = grid->transform();
 
   /* Perspective not supported for now, getAffineMap() will leave out the
@@ -1236,7 +1502,7 @@ bool BKE_volume_grid_bounds(const VolumeGrid *volume_grid, float min[3], float m
 {
 #ifdef WITH_OPENVDB
   /* TODO: we can get this from grid metadata in some cases? */
-  const openvdb::GridBase::Ptr &grid = volume_grid->grid();
+  const openvdb::GridBase::Ptr grid = volume_grid->grid();
   BLI_assert(BKE_volume_grid_is_loaded(volume_grid));
 
   openvdb::CoordBBox coordbbox;
@@ -0,0 +1,196 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation
+ * All rights reserved.
+ */
+
+#include <string>
+#include <vector>
+
+#ifdef WIN32
+#  include <sys/utime.h>
+#else
+#  include <utime.h>
+#endif
+
+#include "CLG_log.h"
+
+#include "DNA_userdef_types.h"
+#include "DNA_volume_types.h"
+
+#include "BLI_fileops.h"
+#include "BLI_string.h"
+#include "BLI_utildefines.h"
+
+#include "BKE_idtype.h"
+#include "BKE_main.h"
+#include "BKE_volume.h"
+
+#include "testing/testing.h"
+
+namespace blender::bke::tests {
+
+/* Voxels along each side of the test grids, with a value for every voxel. */
+static const int GRID_RESOLUTION = 128;
+static const double GRID_VOXELS = (double)GRID_RESOLUTION * GRID_RESOLUTION * GRID_RESOLUTION;
+
+/* Files are written again with other values and the same modification time, which the file
+ * cache can't detect. Reading the old values then tells that the cached tree was used. */
+class VolumeFileCacheTest : public testing::Test {
+ public:
+  static void SetUpTestCase()
+  {
+    CLG_init();
+    BKE_idtype_init();
+    BKE_volumes_init();
+  }
+
+  static void TearDownTestCase()
+  {
+    CLG_exit();
+  }
+
+ protected:
+  void SetUp() override
+  {
+    bmain = BKE_main_new();
+    memcachelimit_prev = U.memcachelimit;
+  }
+
+  void TearDown() override
+  {
+    BKE_main_free(bmain);
+    /* Free the unused trees, so the cache is empty for the next test. */
+    BKE_volumes_exit();
+    U.memcachelimit = memcachelimit_prev;
+
+    for (const std::string &filepath : filepaths) {
+      BLI_delete(filepath.c_str(), false, false);
+    }
+  }
+
+  /* Write a "density" grid with all voxels set to value, returns the memory used by its tree. */
+  size_t file_write(const std::string &filepath, const float value, const time_t mtime)
+  {
+    openvdb::FloatGrid::Ptr grid = openvdb::FloatGrid::create(0.0f);
+    grid->setName("density");
+    grid->denseFill(
+        openvdb::CoordBBox(openvdb::Coord(0), openvdb::Coord(GRID_RESOLUTION - 1)), value, true);
+
+    openvdb::GridPtrVec grids;
+    grids.push_back(grid);
+    openvdb::io::File file(filepath);
+    file.write(grids);
+    file.close();
+
+    struct utimbuf times;
+    times.actime = mtime;
+    times.modtime = mtime;
+    utime(filepath.c_str(), &times);
+
+    filepaths.push_back(filepath);
+    return grid->memUsage();
+  }
+
+  Volume *volume_add(const char *name, const std::string &filepath)
+  {
+    Volume *volume = (Volume *)BKE_volume_add(bmain, name);
+    STRNCPY(volume->filepath, filepath.c_str());
+    return volume;
+  }
+
+  /* Sum of the voxel values of the "density" grid, reading its whole tree. */
+  double volume_grid_sum(Volume *volume)
+  {
+    EXPECT_TRUE(BKE_volume_load(volume, bmain));
+    VolumeGrid *volume_grid = BKE_volume_grid_find(volume, "density");
+    if (volume_grid == NULL) {
+      ADD_FAILURE() << "Grid not found in " << volume->filepath;
+      return 0.0;
+    }
+
+    openvdb::FloatGrid::ConstPtr grid = openvdb::gridConstPtrCast<openvdb::FloatGrid>(
+        BKE_volume_grid_openvdb_for_read(volume, volume_grid));
+    double sum = 0.0;
+    for (openvdb::FloatGrid::ValueOnCIter iter = grid->cbeginValueOn(); iter; ++iter) {
+      sum += (double)*iter * (double)iter.getVoxelCount();
+    }
+    return sum;
+  }
+
+  Main *bmain;
+  int memcachelimit_prev;
+  std::vector<std::string> filepaths;
+};
+
+TEST_F(VolumeFileCacheTest, UnusedTreeReused)
+{
+  const std::string filepath = testing::TempDir() + "volume_cache_reused.vdb";
+  file_write(filepath, 1.0f, 1000000000);
+  U.memcachelimit = 1024;
+
+  Volume *volume = volume_add("Reused", filepath);
+  EXPECT_EQ(volume_grid_sum(volume), GRID_VOXELS);
+  BKE_volume_unload(volume);
+
+  /* Same modification time, the tree without users is still in the cache. */
+  file_write(filepath, 2.0f, 1000000000);
+  EXPECT_EQ(volume_grid_sum(volume), GRID_VOXELS);
+}
+
+TEST_F(VolumeFileCacheTest, FileModifiedReadAgain)
+{
+  const std::string filepath = testing::TempDir() + "volume_cache_modified.vdb";
+  file_write(filepath, 1.0f, 1000000000);
+  U.memcachelimit = 1024;
+
+  Volume *volume = volume_add("Modified", filepath);
+  EXPECT_EQ(volume_grid_sum(volume), GRID_VOXELS);
+  BKE_volume_unload(volume);
+
+  /* Written again after the tree was cached, for example re-baked. */
+  file_write(filepath, 2.0f, 1000000010);
+  EXPECT_EQ(volume_grid_sum(volume), 2.0 * GRID_VOXELS);
+}
+
+TEST_F(VolumeFileCacheTest, LeastRecentlyUsedFreed)
+{
+  const std::string filepath_a = testing::TempDir() + "volume_cache_lru_a.vdb";
+  const std::string filepath_b = testing::TempDir() + "volume_cache_lru_b.vdb";
+  const size_t tree_mem_size = file_write(filepath_a, 1.0f, 1000000000);
+  file_write(filepath_b, 1.0f, 1000000000);
+
+  /* Room for one unused tree but not two. */
+  U.memcachelimit = (int)(tree_mem_size * 3 / 2 / (1024 * 1024));
+  ASSERT_GT((size_t)U.memcachelimit * 1024 * 1024, tree_mem_size);
+  ASSERT_LT((size_t)U.memcachelimit * 1024 * 1024, 2 * tree_mem_size);
+
+  Volume *volume_a = volume_add("A", filepath_a);
+  Volume *volume_b = volume_add("B", filepath_b);
+  EXPECT_EQ(volume_grid_sum(volume_a), GRID_VOXELS);
+  BKE_volume_unload(volume_a);
+  EXPECT_EQ(volume_grid_sum(volume_b), GRID_VOXELS);
+  BKE_volume_unload(volume_b);
+
+  file_write(filepath_a, 2.0f, 1000000000);
+  file_write(filepath_b, 2.0f, 1000000000);
+
+  /* The tree of A was freed to make room for B, while B is still cached. */
+  EXPECT_EQ(volume_grid_sum(volume_a), 2.0 * GRID_VOXELS);
+  EXPECT_EQ(volume_grid_sum(volume_b), GRID_VOXELS);
+}
+
+}  // namespace blender::bke::tests
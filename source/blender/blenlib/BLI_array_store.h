@@ -46,6 +46,15 @@ size_t BLI_array_store_state_size_get(BArrayState *state);
 void BLI_array_store_state_data_get(BArrayState *state, void *data);
 void *BLI_array_store_state_data_get_alloc(BArrayState *state, size_t *r_data_len);
 
+typedef void (*BArrayStateDifferenceFn)(void *user_data,
+                                        size_t offset,
+                                        const void *data,
+                                        size_t data_len);
+size_t BLI_array_store_state_foreach_difference(const BArrayState *state,
+                                                const BArrayState *state_other,
+                                                BArrayStateDifferenceFn diff_fn,
+                                                void *user_data);
+
 /* only for tests */
 bool BLI_array_store_is_valid(BArrayStore *bs);
 
@@ -0,0 +1,69 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#pragma once
+
+/** \file
+ * \ingroup bli
+ *
+ * Block based gzip streams, compressed and decompressed using multiple threads.
+ *
+ * The stream is split into blocks of a fixed uncompressed size, each block is written
+ * as an independent gzip member. Concatenated gzip members are a valid gzip stream,
+ * so files written this way can still be read by `gzread` (and any other gzip reader).
+ *
+ * An index of all blocks is appended as a trailing, empty gzip member that stores the index
+ * in the gzip header "extra" field. Regular gzip readers skip it, #GzipBlockReader uses it to
+ * decompress blocks in parallel and to seek without having to inflate the whole stream.
+ */
+
+#include "BLI_sys_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Default uncompressed size of a single block. */
+#define GZIP_BLOCK_SIZE_DEFAULT (1 << 20)
+
+typedef struct GzipBlockWriter GzipBlockWriter;
+typedef struct GzipBlockReader GzipBlockReader;
+
+/**
+ * \param file: File descriptor opened for writing, not closed by the writer.
+ * \param level: zlib compression level.
+ * \param block_size: Uncompressed size of each block, zero for #GZIP_BLOCK_SIZE_DEFAULT.
+ */
+GzipBlockWriter *BLI_gzip_block_writer_new(int file, int level, size_t block_size);
+bool BLI_gzip_block_writer_write(GzipBlockWriter *writer, const void *data, size_t data_len);
+/** Flush all remaining blocks, write the index and free the writer. */
+bool BLI_gzip_block_writer_free(GzipBlockWriter *writer);
+
+/**
+ * \param file: File descriptor opened for reading, not closed by the reader.
+ * \return NULL when the file isn't a block gzip stream (regular gzip files for example).
+ */
+GzipBlockReader *BLI_gzip_block_reader_new(int file);
+int64_t BLI_gzip_block_reader_read(GzipBlockReader *reader, void *buffer, size_t size);
+/** \return The new uncompressed position or -1 on failure, `whence` is the same as `lseek`. */
+int64_t BLI_gzip_block_reader_seek(GzipBlockReader *reader, int64_t offset, int whence);
+/** Total uncompressed size of the stream. */
+uint64_t BLI_gzip_block_reader_size(const GzipBlockReader *reader);
+void BLI_gzip_block_reader_free(GzipBlockReader *reader);
+
+#ifdef __cplusplus
+}
+#endif
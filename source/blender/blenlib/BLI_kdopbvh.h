@@ -101,6 +101,15 @@ enum {
   /* calculate IsectRayPrecalc data */
   BVH_RAYCAST_WATERTIGHT = (1 << 0),
 };
+enum {
+  /* Split nodes using the surface area heuristic instead of the median,
+   * building is slower but ray-casts and nearest queries visit fewer nodes. */
+  BVH_BUILD_SAH = (1 << 0),
+  /* Keep a flattened copy of the tree with 4 children per node, used by ray-cast and nearest
+   * queries to test all children at once (only for trees with up to 4 children per node,
+   * with bounds along the X, Y and Z axes). */
+  BVH_BUILD_FLAT = (1 << 1),
+};
 #define BVH_RAYCAST_DEFAULT (BVH_RAYCAST_WATERTIGHT)
 #define BVH_RAYCAST_DIST_MAX (FLT_MAX / 2.0f)
 
@@ -142,6 +151,7 @@ typedef bool (*BVHTree_WalkOrderCallback)(const BVHTreeAxisRange *bounds,
                                           char axis,
                                           void *userdata);
 
+BVHTree *BLI_bvhtree_new_ex(int maxsize, float epsilon, char tree_type, char axis, int flag);
 BVHTree *BLI_bvhtree_new(int maxsize, float epsilon, char tree_type, char axis);
 void BLI_bvhtree_free(BVHTree *tree);
 
@@ -49,6 +49,12 @@ int incircle_fast(const double2 &a, const double2 &b, const double2 &c, const do
 int orient3d(const double3 &a, const double3 &b, const double3 &c, const double3 &d);
 int orient3d_fast(const double3 &a, const double3 &b, const double3 &c, const double3 &d);
 
+/* #orient3d_filter is for double approximations of exact (for example mpq3) coordinates.
+ * It returns the sign of the exact orient3d of the approximated coordinates when the double
+ * calculation, including the approximation of the inputs, can not have changed it.
+ * Otherwise it returns 0 and the exact calculation is needed. */
+int orient3d_filter(const double3 &a, const double3 &b, const double3 &c, const double3 &d);
+
 int insphere(
     const double3 &a, const double3 &b, const double3 &c, const double3 &d, const double3 &e);
 int insphere_fast(
@@ -83,6 +83,14 @@ enum {
    * order of allocation when no chunks have been freed.
    */
   BLI_MEMPOOL_ALLOW_ITER = (1 << 0),
+  /** Allow allocating and freeing elements from multiple threads at once.
+   *
+   * Every thread uses its own free list, chunks are handed out and added with atomics.
+   * \note creating, clearing, destroying and iterating over the pool
+   * must not happen while other threads allocate or free elements.
+   * \note elements freed in one thread are only reused by that thread.
+   */
+  BLI_MEMPOOL_ALLOW_THREADS = (1 << 1),
 };
 
 void BLI_mempool_iternew(BLI_mempool *pool, BLI_mempool_iter *iter) ATTR_NONNULL();
@@ -36,12 +36,25 @@
  *   #BLI_bvhtree_overlap, #BVHOverlapData_Shared, #BVHOverlapData_Thread
  * - Range Query:
  *   #BLI_bvhtree_range_query
+ *
+ * Optionally (see #BLI_bvhtree_new_ex):
+ *
+ * - Trees can be built using the surface area heuristic (#BVH_BUILD_SAH)
+ *   instead of the implicit median split tree.
+ * - A flattened copy of the tree with 4 children per node can be kept (#BVH_BUILD_FLAT),
+ *   ray-cast and nearest queries use it to test the bounds of all children at once.
  */
 
 #include <assert.h>
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
 #include "BLI_alloca.h"
 #include "BLI_heap_simple.h"
 #include "BLI_kdopbvh.h"
@@ -72,6 +85,16 @@
 #  define KDOPBVH_THREAD_LEAF_THRESHOLD 1024
 #endif
 
+/* Number of bins used to evaluate the split candidates of #BVH_BUILD_SAH. */
+#define KDOPBVH_SAH_BINS 16
+/* Beyond this depth median splits are used, so degenerate input can't create very deep trees. */
+#define KDOPBVH_SAH_DEPTH_MAX 32
+
+/* Number of children of the nodes of #BVHFlatTree. */
+#define KDOPBVH_FLAT_WIDTH 4
+/* Traversal stack size of #BVHFlatTree, deeper trees don't use the flat layout. */
+#define KDOPBVH_FLAT_STACK_SIZE 256
+
 /* -------------------------------------------------------------------- */
 /** \name Struct Definitions
  * \{ */
@@ -90,23 +113,47 @@ typedef struct BVHNode {
   char main_axis; /* Axis used to split this node */
 } BVHNode;
 
+/**
+ * Node of #BVHFlatTree, bounds of the children are stored next to each other,
+ * so they can be tested at once.
+ */
+typedef struct BVHFlatNode {
+  /* X, Y and Z minimum and maximum (same order as #BVHNode.bv), one column per child.
+   * Unused children have empty bounds. */
+  float bv[6][KDOPBVH_FLAT_WIDTH];
+  /* Index of the child in #BVHFlatTree.nodes,
+   * or `-1 - i` for leafs, where `i` is the index in #BVHTree.nodearray. */
+  int children[KDOPBVH_FLAT_WIDTH];
+} BVHFlatNode;
+
+typedef struct BVHFlatTree {
+  BVHFlatNode *nodes;
+  /* Nodes of the regular tree the bounds of each child are copied from, to refit. */
+  const BVHNode *(*sources)[KDOPBVH_FLAT_WIDTH];
+  int nodes_len;
+  /* Number of levels of branches. */
+  int depth;
+} BVHFlatTree;
+
 /* keep under 26 bytes for speed purposes */
 struct BVHTree {
   BVHNode **nodes;
   BVHNode *nodearray;  /* pre-alloc branch nodes */
   BVHNode **nodechild; /* pre-alloc children for nodes */
   float *nodebv;       /* pre-alloc bounding-volumes for nodes */
+  BVHFlatTree *flat;   /* optional, see #BVH_BUILD_FLAT */
   float epsilon;       /* epslion is used for inflation of the k-dop      */
   int totleaf;         /* leafs */
   int totbranch;
   axis_t start_axis, stop_axis; /* bvhtree_kdop_axes array indices according to axis */
   axis_t axis;                  /* kdop type (6 => OBB, 7 => AABB, ...) */
   char tree_type;               /* type of tree (4 => quadtree) */
+  char build_flag;              /* #BVH_BUILD_SAH, #BVH_BUILD_FLAT */
 };
 
 /* optimization, ensure we stay small */
-BLI_STATIC_ASSERT((sizeof(void *) == 8 && sizeof(BVHTree) <= 48) ||
-                      (sizeof(void *) == 4 && sizeof(BVHTree) <= 32),
+BLI_STATIC_ASSERT((sizeof(void *) == 8 && sizeof(BVHTree) <= 64) ||
+                      (sizeof(void *) == 4 && sizeof(BVHTree) <= 40),
                   "over sized")
 
 /* avoid duplicating vars in BVHOverlapData_Thread */
@@ -865,14 +912,507 @@ static void non_recursive_bvh_div_nodes(const BVHTree *tree,
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Surface Area Heuristic Build
+ *
+ * Alternative to the implicit tree (#BVH_BUILD_SAH). Instead of splitting the leafs into
+ * equally sized groups, splits are chosen to minimize the surface area of the children
+ * multiplied by the number of leafs in them, using binning to quickly evaluate candidates.
+ * For nodes with more than two children, the child with the largest surface area is split
+ * until the node is full.
+ *
+ * Branches are allocated in the order they are created, so like for the implicit tree
+ * all children have a greater index than their parent (#BLI_bvhtree_update_tree relies on it).
+ * \{ */
+
+typedef struct BVHSAHBuildData {
+  BVHTree *tree;
+  BVHNode **leafs_array;
+  TaskPool *task_pool;
+  /* Number of allocated branches, accessed atomically. */
+  int branches_len;
+  /* First of the three #bvhtree_kdop_axes used as a box for centroids and surface areas. */
+  axis_t box_axis;
+} BVHSAHBuildData;
+
+typedef struct BVHSAHBin {
+  float bv[6];
+  int count;
+} BVHSAHBin;
+
+typedef struct BVHSAHTask {
+  BVHNode *node;
+  int begin, end, depth;
+} BVHSAHTask;
+
+static void bvh_sah_bounds_init(float bv[6])
+{
+  for (int i = 0; i < 3; i++) {
+    bv[2 * i] = FLT_MAX;
+    bv[2 * i + 1] = -FLT_MAX;
+  }
+}
+
+static void bvh_sah_bounds_add(float bv[6], const float bv_other[6])
+{
+  for (int i = 0; i < 3; i++) {
+    bv[2 * i] = min_ff(bv[2 * i], bv_other[2 * i]);
+    bv[2 * i + 1] = max_ff(bv[2 * i + 1], bv_other[2 * i + 1]);
+  }
+}
+
+/* Half of the surface area of the box, empty boxes have none. */
+static float bvh_sah_bounds_area(const float bv[6])
+{
+  const float dx = max_ff(bv[1] - bv[0], 0.0f);
+  const float dy = max_ff(bv[3] - bv[2], 0.0f);
+  const float dz = max_ff(bv[5] - bv[4], 0.0f);
+  return dx * dy + dy * dz + dz * dx;
+}
+
+static float bvh_sah_range_area(const BVHSAHBuildData *data, int begin, int end)
+{
+  float bv[6];
+  bvh_sah_bounds_init(bv);
+  for (int i = begin; i < end; i++) {
+    bvh_sah_bounds_add(bv, &data->leafs_array[i]->bv[2 * data->box_axis]);
+  }
+  return bvh_sah_bounds_area(bv);
+}
+
+BLI_INLINE float bvh_sah_centroid(const BVHSAHBuildData *data, const BVHNode *leaf, int axis)
+{
+  const float *bv = &leaf->bv[2 * (data->box_axis + axis)];
+  return (bv[0] + bv[1]) * 0.5f;
+}
+
+/**
+ * Split the leafs in range `[begin, end)` in two, returns the index of the first leaf
+ * of the second half. The surface area of both halves is returned in \a r_area.
+ */
+static int bvh_sah_split(
+    const BVHSAHBuildData *data, int begin, int end, int depth, int *r_axis, float r_area[2])
+{
+  BVHNode **leafs = data->leafs_array;
+  float centroid_min[3], centroid_max[3];
+
+  INIT_MINMAX(centroid_min, centroid_max);
+  for (int i = begin; i < end; i++) {
+    for (int axis = 0; axis < 3; axis++) {
+      const float centroid = bvh_sah_centroid(data, leafs[i], axis);
+      centroid_min[axis] = min_ff(centroid_min[axis], centroid);
+      centroid_max[axis] = max_ff(centroid_max[axis], centroid);
+    }
+  }
+
+  float best_cost = FLT_MAX;
+  int best_axis = -1, best_bin = 0;
+  float best_area[2] = {0.0f, 0.0f};
+
+  for (int axis = 0; axis < 3 && depth < KDOPBVH_SAH_DEPTH_MAX; axis++) {
+    const float extent = centroid_max[axis] - centroid_min[axis];
+    if (!(extent > FLT_EPSILON)) {
+      continue;
+    }
+    const float scale = (float)KDOPBVH_SAH_BINS / extent;
+
+    BVHSAHBin bins[KDOPBVH_SAH_BINS];
+    for (int b = 0; b < KDOPBVH_SAH_BINS; b++) {
+      bvh_sah_bounds_init(bins[b].bv);
+      bins[b].count = 0;
+    }
+    for (int i = begin; i < end; i++) {
+      const float centroid = bvh_sah_centroid(data, leafs[i], axis);
+      const int b = min_ii((int)((centroid - centroid_min[axis]) * scale), KDOPBVH_SAH_BINS - 1);
+      bvh_sah_bounds_add(bins[b].bv, &leafs[i]->bv[2 * data->box_axis]);
+      bins[b].count++;
+    }
+
+    /* Sweep from the right to get the cost of the right side of each split. */
+    float right_area[KDOPBVH_SAH_BINS];
+    int right_count[KDOPBVH_SAH_BINS];
+    float bv[6];
+    int count = 0;
+    bvh_sah_bounds_init(bv);
+    for (int b = KDOPBVH_SAH_BINS - 1; b > 0; b--) {
+      bvh_sah_bounds_add(bv, bins[b].bv);
+      count += bins[b].count;
+      right_area[b] = bvh_sah_bounds_area(bv);
+      right_count[b] = count;
+    }
+
+    /* Sweep from the left, a split at `b` puts bins before `b` on the left side. */
+    count = 0;
+    bvh_sah_bounds_init(bv);
+    for (int b = 1; b < KDOPBVH_SAH_BINS; b++) {
+      bvh_sah_bounds_add(bv, bins[b - 1].bv);
+      count += bins[b - 1].count;
+      if (count == 0 || right_count[b] == 0) {
+        continue;
+      }
+      const float left_area = bvh_sah_bounds_area(bv);
+      const float cost = left_area * (float)count + right_area[b] * (float)right_count[b];
+      if (cost < best_cost) {
+        best_cost = cost;
+        best_axis = axis;
+        best_bin = b;
+        best_area[0] = left_area;
+        best_area[1] = right_area[b];
+      }
+    }
+  }
+
+  int mid;
+  if (best_axis != -1) {
+    const float scale = (float)KDOPBVH_SAH_BINS /
+                        (centroid_max[best_axis] - centroid_min[best_axis]);
+    int i = begin, j = end - 1;
+    while (i <= j) {
+      const float centroid = bvh_sah_centroid(data, leafs[i], best_axis);
+      const int b = min_ii((int)((centroid - centroid_min[best_axis]) * scale),
+                           KDOPBVH_SAH_BINS - 1);
+      if (b < best_bin) {
+        i++;
+      }
+      else {
+        SWAP(BVHNode *, leafs[i], leafs[j]);
+        j--;
+      }
+    }
+    mid = i;
+    BLI_assert(mid > begin && mid < end);
+    copy_v2_v2(r_area, best_area);
+  }
+  else {
+    /* All centroids are in the same place or the tree is too deep, split at the median
+     * along the largest axis like the implicit tree does. */
+    best_axis = 0;
+    for (int axis = 1; axis < 3; axis++) {
+      if (centroid_max[axis] - centroid_min[axis] >
+          centroid_max[best_axis] - centroid_min[best_axis]) {
+        best_axis = axis;
+      }
+    }
+    mid = (begin + end) / 2;
+    partition_nth_element(leafs, begin, end, mid, 2 * (data->box_axis + best_axis) + 1);
+    r_area[0] = bvh_sah_range_area(data, begin, mid);
+    r_area[1] = bvh_sah_range_area(data, mid, end);
+  }
+
+  *r_axis = best_axis;
+  return mid;
+}
+
+static void bvh_sah_build_task_cb(TaskPool *__restrict pool, void *taskdata);
+
+static void bvh_sah_build_node(
+    BVHSAHBuildData *data, BVHNode *node, const int begin, const int end, const int depth)
+{
+  BVHTree *tree = data->tree;
+  /* Children get the leafs in range `[ranges[k], ranges[k + 1])`. */
+  int ranges[MAX_TREETYPE + 1];
+  float areas[MAX_TREETYPE];
+  int ranges_len = 1;
+
+  refit_kdop_hull(tree, node, begin, end);
+
+  ranges[0] = begin;
+  ranges[1] = end;
+  areas[0] = FLT_MAX;
+  node->main_axis = 0;
+
+  while (ranges_len < tree->tree_type) {
+    /* Split the child with the largest surface area. */
+    int k_split = -1;
+    for (int k = 0; k < ranges_len; k++) {
+      if (ranges[k + 1] - ranges[k] > 1 && (k_split == -1 || areas[k] > areas[k_split])) {
+        k_split = k;
+      }
+    }
+    if (k_split == -1) {
+      break;
+    }
+
+    int axis;
+    float area[2];
+    const int mid = bvh_sah_split(
+        data, ranges[k_split], ranges[k_split + 1], depth, &axis, area);
+
+    if (ranges_len == 1) {
+      node->main_axis = (char)axis;
+    }
+
+    for (int k = ranges_len; k > k_split; k--) {
+      ranges[k + 1] = ranges[k];
+      areas[k] = areas[k - 1];
+    }
+    ranges[k_split + 1] = mid;
+    areas[k_split] = area[0];
+    areas[k_split + 1] = area[1];
+    ranges_len++;
+  }
+
+  for (int k = 0; k < ranges_len; k++) {
+    BVHNode *child;
+    if (ranges[k + 1] - ranges[k] == 1) {
+      child = data->leafs_array[ranges[k]];
+    }
+    else {
+      const int branch_index = atomic_fetch_and_add_int32(&data->branches_len, 1);
+      child = &tree->nodearray[tree->totleaf + branch_index];
+    }
+    child->parent = node;
+    node->children[k] = child;
+  }
+  node->totnode = (char)ranges_len;
+
+  for (int k = 0; k < ranges_len; k++) {
+    const int child_len = ranges[k + 1] - ranges[k];
+    if (child_len == 1) {
+      continue;
+    }
+    if (data->task_pool && child_len > KDOPBVH_THREAD_LEAF_THRESHOLD) {
+      BVHSAHTask *task = MEM_mallocN(sizeof(*task), __func__);
+      task->node = node->children[k];
+      task->begin = ranges[k];
+      task->end = ranges[k + 1];
+      task->depth = depth + 1;
+      BLI_task_pool_push(data->task_pool, bvh_sah_build_task_cb, task, true, NULL);
+    }
+    else {
+      bvh_sah_build_node(data, node->children[k], ranges[k], ranges[k + 1], depth + 1);
+    }
+  }
+}
+
+static void bvh_sah_build_task_cb(TaskPool *__restrict pool, void *taskdata)
+{
+  BVHSAHBuildData *data = BLI_task_pool_user_data(pool);
+  BVHSAHTask *task = taskdata;
+  bvh_sah_build_node(data, task->node, task->begin, task->end, task->depth);
+}
+
+/**
+ * Build the tree from all leafs, the root is the first branch after the leafs.
+ * Returns the number of branches.
+ */
+static int bvh_sah_build(BVHTree *tree)
+{
+  BLI_assert(tree->totleaf > 1);
+
+  BVHSAHBuildData data = {
+      .tree = tree,
+      .leafs_array = tree->nodes,
+      .task_pool = NULL,
+      .branches_len = 1,
+      .box_axis = tree->start_axis,
+  };
+
+  BVHNode *root = &tree->nodearray[tree->totleaf];
+  root->parent = NULL;
+
+  if (tree->totleaf > KDOPBVH_THREAD_LEAF_THRESHOLD) {
+    data.task_pool = BLI_task_pool_create(&data, TASK_PRIORITY_HIGH);
+    bvh_sah_build_node(&data, root, 0, tree->totleaf, 0);
+    BLI_task_pool_work_and_wait(data.task_pool);
+    BLI_task_pool_free(data.task_pool);
+  }
+  else {
+    bvh_sah_build_node(&data, root, 0, tree->totleaf, 0);
+  }
+
+  return data.branches_len;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Flat Tree
+ *
+ * Copy of the tree (#BVH_BUILD_FLAT) where each node stores the bounds of its (up to 4)
+ * children, so a ray or point can be tested against all of them at once using SIMD.
+ * For binary trees the children of two levels are collapsed into one node.
+ * \{ */
+
+static bool bvhtree_flat_supported(const BVHTree *tree)
+{
+  /* The bounds of flat nodes are boxes along the X, Y and Z axes. */
+  return tree->tree_type <= KDOPBVH_FLAT_WIDTH && tree->start_axis == 0 &&
+         tree->stop_axis >= 3 && tree->totleaf > 0;
+}
+
+static float bvhtree_flat_node_area(const BVHNode *node)
+{
+  return bvh_sah_bounds_area(node->bv);
+}
+
+/* Collect the nodes which become the children of the flat node for `node`. */
+static int bvhtree_flat_gather_children(const BVHNode *node,
+                                        const BVHNode *r_children[KDOPBVH_FLAT_WIDTH])
+{
+  int children_len = node->totnode;
+  for (int i = 0; i < children_len; i++) {
+    r_children[i] = node->children[i];
+  }
+
+  /* Replace the largest branch by its children, as long as they fit. */
+  while (true) {
+    int i_expand = -1;
+    float area_expand = -1.0f;
+    for (int i = 0; i < children_len; i++) {
+      const BVHNode *child = r_children[i];
+      if (child->totnode > 0 && children_len - 1 + child->totnode <= KDOPBVH_FLAT_WIDTH) {
+        const float area = bvhtree_flat_node_area(child);
+        if (area > area_expand) {
+          i_expand = i;
+          area_expand = area;
+        }
+      }
+    }
+    if (i_expand == -1) {
+      break;
+    }
+
+    const BVHNode *expand = r_children[i_expand];
+    r_children[i_expand] = r_children[children_len - 1];
+    children_len--;
+    for (int i = 0; i < expand->totnode; i++) {
+      r_children[children_len++] = expand->children[i];
+    }
+  }
+
+  return children_len;
+}
+
+static void bvhtree_flat_node_copy_bounds(BVHFlatNode *flat_node, int i, const BVHNode *source)
+{
+  for (int j = 0; j < 6; j++) {
+    flat_node->bv[j][i] = source ? source->bv[j] : ((j & 1) ? -FLT_MAX : FLT_MAX);
+  }
+}
+
+static int bvhtree_flat_build_node(const BVHTree *tree,
+                                   BVHFlatTree *flat,
+                                   const BVHNode *node,
+                                   const int depth)
+{
+  const BVHNode *children[KDOPBVH_FLAT_WIDTH];
+  const int children_len = bvhtree_flat_gather_children(node, children);
+
+  const int index = flat->nodes_len++;
+  BLI_assert(index < tree->totbranch);
+  flat->depth = max_ii(flat->depth, depth);
+
+  for (int i = 0; i < KDOPBVH_FLAT_WIDTH; i++) {
+    const BVHNode *child = (i < children_len) ? children[i] : NULL;
+    flat->sources[index][i] = child;
+    bvhtree_flat_node_copy_bounds(&flat->nodes[index], i, child);
+
+    if (child == NULL) {
+      flat->nodes[index].children[i] = -1;
+    }
+    else if (child->totnode == 0) {
+      flat->nodes[index].children[i] = -1 - (int)(child - tree->nodearray);
+    }
+    else {
+      flat->nodes[index].children[i] = bvhtree_flat_build_node(tree, flat, child, depth + 1);
+    }
+  }
+
+  return index;
+}
+
+static void bvhtree_flat_build(BVHTree *tree)
+{
+  BLI_assert(tree->flat == NULL);
+
+  if (!bvhtree_flat_supported(tree)) {
+    return;
+  }
+
+  BVHFlatTree *flat = MEM_callocN(sizeof(*flat), __func__);
+  flat->nodes = MEM_mallocN_aligned(
+      sizeof(*flat->nodes) * (size_t)tree->totbranch, 16, "BVHFlatNodes");
+  flat->sources = MEM_mallocN(sizeof(*flat->sources) * (size_t)tree->totbranch, __func__);
+
+  bvhtree_flat_build_node(tree, flat, tree->nodes[tree->totleaf], 1);
+
+  /* Each level of branches can add 3 items to the traversal stack. */
+  if (flat->depth * (KDOPBVH_FLAT_WIDTH - 1) + 1 > KDOPBVH_FLAT_STACK_SIZE) {
+    MEM_freeN(flat->nodes);
+    MEM_freeN(flat->sources);
+    MEM_freeN(flat);
+    return;
+  }
+
+  tree->flat = flat;
+}
+
+static void bvhtree_flat_refit(BVHTree *tree)
+{
+  BVHFlatTree *flat = tree->flat;
+  for (int index = 0; index < flat->nodes_len; index++) {
+    for (int i = 0; i < KDOPBVH_FLAT_WIDTH; i++) {
+      bvhtree_flat_node_copy_bounds(&flat->nodes[index], i, flat->sources[index][i]);
+    }
+  }
+}
+
+static void bvhtree_flat_free(BVHFlatTree *flat)
+{
+  MEM_freeN(flat->nodes);
+  MEM_freeN(flat->sources);
+  MEM_freeN(flat);
+}
+
+typedef struct BVHFlatStackItem {
+  /* Index in #BVHFlatTree.nodes, or a leaf (see #BVHFlatNode.children). */
+  int node;
+  /* Distance to the bounds, the item can be skipped when a closer hit was found meanwhile. */
+  float dist;
+} BVHFlatStackItem;
+
+/**
+ * Push the children in `mask` to the stack, so the closest child is on top.
+ */
+static void bvhtree_flat_stack_push(BVHFlatStackItem *stack,
+                                    int *stack_len,
+                                    const BVHFlatNode *node,
+                                    int mask,
+                                    const float dist[KDOPBVH_FLAT_WIDTH])
+{
+  BVHFlatStackItem items[KDOPBVH_FLAT_WIDTH];
+  int items_len = 0;
+
+  for (int i = 0; mask; i++, mask >>= 1) {
+    if (mask & 1) {
+      /* Insertion sort, furthest first. */
+      int j = items_len++;
+      for (; j > 0 && items[j - 1].dist < dist[i]; j--) {
+        items[j] = items[j - 1];
+      }
+      items[j].node = node->children[i];
+      items[j].dist = dist[i];
+    }
+  }
+
+  BLI_assert(*stack_len + items_len <= KDOPBVH_FLAT_STACK_SIZE);
+  memcpy(&stack[*stack_len], items, sizeof(*items) * (size_t)items_len);
+  *stack_len += items_len;
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name BLI_bvhtree API
  * \{ */
 
 /**
+ * \param flag: Optional build modes, #BVH_BUILD_SAH, #BVH_BUILD_FLAT.
+ *
  * \note many callers don't check for ``NULL`` return.
  */
-BVHTree *BLI_bvhtree_new(int maxsize, float epsilon, char tree_type, char axis)
+BVHTree *BLI_bvhtree_new_ex(int maxsize, float epsilon, char tree_type, char axis, int flag)
 {
   BVHTree *tree;
   int numnodes, i;
@@ -891,6 +1431,7 @@ BVHTree *BLI_bvhtree_new(int maxsize, float epsilon, char tree_type, char axis)
     tree->epsilon = epsilon;
     tree->tree_type = tree_type;
     tree->axis = axis;
+    tree->build_flag = (char)flag;
 
     if (axis == 26) {
       tree->start_axis = 0;
@@ -919,8 +1460,11 @@ BVHTree *BLI_bvhtree_new(int maxsize, float epsilon, char tree_type, char axis)
       goto fail;
     }
 
-    /* Allocate arrays */
-    numnodes = maxsize + implicit_needed_branches(tree_type, maxsize) + tree_type;
+    /* Allocate arrays, nodes of SAH trees may have less children than the tree type. */
+    numnodes = maxsize +
+               ((flag & BVH_BUILD_SAH) ? max_ii(1, maxsize - 1) :
+                                         implicit_needed_branches(tree_type, maxsize)) +
+               tree_type;
 
     tree->nodes = MEM_callocN(sizeof(BVHNode *) * (size_t)numnodes, "BVHNodes");
     tree->nodebv = MEM_callocN(sizeof(float) * (size_t)(axis * numnodes), "BVHNodeBV");
@@ -944,9 +1488,17 @@ fail:
   return NULL;
 }
 
+BVHTree *BLI_bvhtree_new(int maxsize, float epsilon, char tree_type, char axis)
+{
+  return BLI_bvhtree_new_ex(maxsize, epsilon, tree_type, axis, 0);
+}
+
 void BLI_bvhtree_free(BVHTree *tree)
 {
   if (tree) {
+    if (tree->flat) {
+      bvhtree_flat_free(tree->flat);
+    }
     MEM_SAFE_FREE(tree->nodes);
     MEM_SAFE_FREE(tree->nodearray);
     MEM_SAFE_FREE(tree->nodebv);
@@ -963,17 +1515,26 @@ void BLI_bvhtree_balance(BVHTree *tree)
    * (some big bug goes here if its being called more than once per tree) */
   BLI_assert(tree->totbranch == 0);
 
-  /* Build the implicit tree */
-  non_recursive_bvh_div_nodes(
-      tree, tree->nodearray + (tree->totleaf - 1), leafs_array, tree->totleaf);
+  if ((tree->build_flag & BVH_BUILD_SAH) && tree->totleaf > 1) {
+    tree->totbranch = bvh_sah_build(tree);
+  }
+  else {
+    /* Build the implicit tree */
+    non_recursive_bvh_div_nodes(
+        tree, tree->nodearray + (tree->totleaf - 1), leafs_array, tree->totleaf);
+    tree->totbranch = implicit_needed_branches(tree->tree_type, tree->totleaf);
+  }
 
   /* current code expects the branches to be linked to the nodes array
    * we perform that linkage here */
-  tree->totbranch = implicit_needed_branches(tree->tree_type, tree->totleaf);
   for (int i = 0; i < tree->totbranch; i++) {
     tree->nodes[tree->totleaf + i] = &tree->nodearray[tree->totleaf + i];
   }
 
+  if (tree->build_flag & BVH_BUILD_FLAT) {
+    bvhtree_flat_build(tree);
+  }
+
 #ifdef USE_SKIP_LINKS
   build_skip_links(tree, tree->nodes[tree->totleaf], NULL, NULL);
 #endif
@@ -1055,6 +1616,10 @@ void BLI_bvhtree_update_tree(BVHTree *tree)
   for (; index >= root; index--) {
     node_join(tree, *index);
   }
+
+  if (tree->flat) {
+    bvhtree_flat_refit(tree);
+  }
 }
 /**
  * Number of times #BLI_bvhtree_insert has been called.
@@ -1585,6 +2150,79 @@ static void heap_find_nearest_begin(BVHNearestData *data, BVHNode *root)
   }
 }
 
+/**
+ * Squared distance from the point to the bounds of each child of the flat node.
+ * Returns the mask of children closer than \a dist_sq.
+ */
+static int flat_nearest_test(const BVHFlatNode *node,
+                             const float co[3],
+                             const float dist_sq,
+                             float r_dist_sq[KDOPBVH_FLAT_WIDTH])
+{
+#ifdef __SSE2__
+  const __m128 zero = _mm_setzero_ps();
+  __m128 sum = zero;
+  for (int axis = 0; axis < 3; axis++) {
+    const __m128 p = _mm_set1_ps(co[axis]);
+    const __m128 below = _mm_sub_ps(_mm_load_ps(node->bv[2 * axis]), p);
+    const __m128 above = _mm_sub_ps(p, _mm_load_ps(node->bv[2 * axis + 1]));
+    const __m128 d = _mm_max_ps(_mm_max_ps(below, above), zero);
+    sum = _mm_add_ps(sum, _mm_mul_ps(d, d));
+  }
+  _mm_storeu_ps(r_dist_sq, sum);
+  return _mm_movemask_ps(_mm_cmplt_ps(sum, _mm_set1_ps(dist_sq)));
+#else
+  int mask = 0;
+  for (int i = 0; i < KDOPBVH_FLAT_WIDTH; i++) {
+    float sum = 0.0f;
+    for (int axis = 0; axis < 3; axis++) {
+      const float d = max_fff(
+          node->bv[2 * axis][i] - co[axis], co[axis] - node->bv[2 * axis + 1][i], 0.0f);
+      sum += d * d;
+    }
+    r_dist_sq[i] = sum;
+    mask |= (sum < dist_sq) << i;
+  }
+  return mask;
+#endif
+}
+
+/* Depth first search using the flat tree, closest children first. */
+static void flat_find_nearest(BVHNearestData *data)
+{
+  const BVHTree *tree = data->tree;
+  const BVHFlatTree *flat = tree->flat;
+
+  BVHFlatStackItem stack[KDOPBVH_FLAT_STACK_SIZE];
+  int stack_len = 1;
+  stack[0].node = 0;
+  stack[0].dist = -FLT_MAX;
+
+  while (stack_len > 0) {
+    const BVHFlatStackItem item = stack[--stack_len];
+    if (item.dist >= data->nearest.dist_sq) {
+      continue;
+    }
+
+    if (item.node < 0) {
+      BVHNode *leaf = &tree->nodearray[-1 - item.node];
+      if (data->callback) {
+        data->callback(data->userdata, leaf->index, data->co, &data->nearest);
+      }
+      else {
+        data->nearest.index = leaf->index;
+        data->nearest.dist_sq = calc_nearest_point_squared(data->proj, leaf, data->nearest.co);
+      }
+    }
+    else {
+      const BVHFlatNode *node = &flat->nodes[item.node];
+      float dist_sq[KDOPBVH_FLAT_WIDTH];
+      const int mask = flat_nearest_test(node, data->co, data->nearest.dist_sq, dist_sq);
+      bvhtree_flat_stack_push(stack, &stack_len, node, mask, dist_sq);
+    }
+  }
+}
+
 int BLI_bvhtree_find_nearest_ex(BVHTree *tree,
                                 const float co[3],
                                 BVHTreeNearest *nearest,
@@ -1621,6 +2259,9 @@ int BLI_bvhtree_find_nearest_ex(BVHTree *tree,
     if (flag & BVH_NEAREST_OPTIMAL_ORDER) {
       heap_find_nearest_begin(&data, root);
     }
+    else if (tree->flat) {
+      flat_find_nearest(&data);
+    }
     else {
       dfs_find_nearest_begin(&data, root);
     }
@@ -1808,6 +2449,130 @@ static float fast_ray_nearest_hit(const BVHRayCastData *data, const BVHNode *nod
   return max_fff(t1x, t1y, t1z);
 }
 
+/* Ray values used by #flat_raycast_test, repeated for each child of the flat node. */
+typedef struct BVHFlatRay {
+  /* Row of #BVHFlatNode.bv with the near and far plane for each axis. */
+  int row_near[3], row_far[3];
+  /* Ray origin, offset by the radius so the planes are moved away from the bounds. */
+  float origin_near[3][KDOPBVH_FLAT_WIDTH];
+  float origin_far[3][KDOPBVH_FLAT_WIDTH];
+  float idot_axis[3][KDOPBVH_FLAT_WIDTH];
+  /* Lowest distance returned, matches #ray_nearest_hit for rays with a radius. */
+  float dist_min[KDOPBVH_FLAT_WIDTH];
+} BVHFlatRay;
+
+static void flat_ray_init(const BVHRayCastData *data, BVHFlatRay *flat_ray)
+{
+  const float radius = data->ray.radius;
+  for (int axis = 0; axis < 3; axis++) {
+    flat_ray->row_near[axis] = data->index[2 * axis];
+    flat_ray->row_far[axis] = data->index[2 * axis + 1];
+    /* Minimum planes (even rows) move down, maximum planes up. */
+    const float origin_near = data->ray.origin[axis] +
+                              ((flat_ray->row_near[axis] & 1) ? -radius : radius);
+    const float origin_far = data->ray.origin[axis] +
+                             ((flat_ray->row_far[axis] & 1) ? -radius : radius);
+    for (int i = 0; i < KDOPBVH_FLAT_WIDTH; i++) {
+      flat_ray->origin_near[axis][i] = origin_near;
+      flat_ray->origin_far[axis][i] = origin_far;
+      flat_ray->idot_axis[axis][i] = data->idot_axis[axis];
+    }
+  }
+  for (int i = 0; i < KDOPBVH_FLAT_WIDTH; i++) {
+    flat_ray->dist_min[i] = (radius == 0.0f) ? -FLT_MAX : 0.0f;
+  }
+}
+
+/**
+ * Distance the ray must travel to hit the bounds of each child of the flat node,
+ * like #fast_ray_nearest_hit and #ray_nearest_hit.
+ * Returns the mask of children hit before \a hit_dist.
+ */
+static int flat_raycast_test(const BVHFlatNode *node,
+                             const BVHFlatRay *ray,
+                             const float hit_dist,
+                             float r_dist[KDOPBVH_FLAT_WIDTH])
+{
+#ifdef __SSE2__
+  __m128 t_near = _mm_loadu_ps(ray->dist_min);
+  __m128 t_far = _mm_set1_ps(FLT_MAX);
+  for (int axis = 0; axis < 3; axis++) {
+    const __m128 idot = _mm_loadu_ps(ray->idot_axis[axis]);
+    const __m128 t1 = _mm_mul_ps(
+        _mm_sub_ps(_mm_load_ps(node->bv[ray->row_near[axis]]),
+                   _mm_loadu_ps(ray->origin_near[axis])),
+        idot);
+    const __m128 t2 = _mm_mul_ps(
+        _mm_sub_ps(_mm_load_ps(node->bv[ray->row_far[axis]]), _mm_loadu_ps(ray->origin_far[axis])),
+        idot);
+    t_near = _mm_max_ps(t_near, t1);
+    t_far = _mm_min_ps(t_far, t2);
+  }
+  const __m128 hit = _mm_and_ps(
+      _mm_and_ps(_mm_cmple_ps(t_near, t_far), _mm_cmpge_ps(t_far, _mm_setzero_ps())),
+      _mm_cmplt_ps(t_near, _mm_set1_ps(hit_dist)));
+  _mm_storeu_ps(r_dist, t_near);
+  return _mm_movemask_ps(hit);
+#else
+  int mask = 0;
+  for (int i = 0; i < KDOPBVH_FLAT_WIDTH; i++) {
+    float t_near = ray->dist_min[i];
+    float t_far = FLT_MAX;
+    for (int axis = 0; axis < 3; axis++) {
+      const float t1 = (node->bv[ray->row_near[axis]][i] - ray->origin_near[axis][i]) *
+                       ray->idot_axis[axis][i];
+      const float t2 = (node->bv[ray->row_far[axis]][i] - ray->origin_far[axis][i]) *
+                       ray->idot_axis[axis][i];
+      t_near = max_ff(t_near, t1);
+      t_far = min_ff(t_far, t2);
+    }
+    r_dist[i] = t_near;
+    mask |= (t_near <= t_far && t_far >= 0.0f && t_near < hit_dist) << i;
+  }
+  return mask;
+#endif
+}
+
+/* Depth first ray-cast using the flat tree, closest children first. */
+static void flat_raycast(BVHRayCastData *data)
+{
+  const BVHTree *tree = data->tree;
+  const BVHFlatTree *flat = tree->flat;
+
+  BVHFlatRay flat_ray;
+  flat_ray_init(data, &flat_ray);
+
+  BVHFlatStackItem stack[KDOPBVH_FLAT_STACK_SIZE];
+  int stack_len = 1;
+  stack[0].node = 0;
+  stack[0].dist = -FLT_MAX;
+
+  while (stack_len > 0) {
+    const BVHFlatStackItem item = stack[--stack_len];
+    if (item.dist >= data->hit.dist) {
+      continue;
+    }
+
+    if (item.node < 0) {
+      const BVHNode *leaf = &tree->nodearray[-1 - item.node];
+      if (data->callback) {
+        data->callback(data->userdata, leaf->index, &data->ray, &data->hit);
+      }
+      else {
+        data->hit.index = leaf->index;
+        data->hit.dist = item.dist;
+        madd_v3_v3v3fl(data->hit.co, data->ray.origin, data->ray.direction, item.dist);
+      }
+    }
+    else {
+      const BVHFlatNode *node = &flat->nodes[item.node];
+      float dist[KDOPBVH_FLAT_WIDTH];
+      const int mask = flat_raycast_test(node, &flat_ray, data->hit.dist, dist);
+      bvhtree_flat_stack_push(stack, &stack_len, node, mask, dist);
+    }
+  }
+}
+
 static void dfs_raycast(BVHRayCastData *data, BVHNode *node)
 {
   int i;
@@ -1953,7 +2718,12 @@ int BLI_bvhtree_ray_cast_ex(BVHTree *tree,
   }
 
   if (root) {
-    dfs_raycast(&data, root);
+    if (tree->flat) {
+      flat_raycast(&data);
+    }
+    else {
+      dfs_raycast(&data, root);
+    }
     //      iterative_raycast(&data, root);
   }
 
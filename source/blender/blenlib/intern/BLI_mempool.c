@@ -27,6 +27,8 @@
  * - Freeing chunks.
  * - Iterating over allocated chunks
  *   (optionally when using the #BLI_MEMPOOL_ALLOW_ITER flag).
+ * - Allocating and freeing from multiple threads
+ *   (optionally when using the #BLI_MEMPOOL_ALLOW_THREADS flag).
  */
 
 #include <stdlib.h>
@@ -106,6 +108,21 @@ typedef struct BLI_mempool_chunk {
   struct BLI_mempool_chunk *next;
 } BLI_mempool_chunk;
 
+/**
+ * The free list of one thread, used instead of #BLI_mempool.free
+ * for pools created with #BLI_MEMPOOL_ALLOW_THREADS.
+ */
+typedef struct BLI_mempool_thread {
+  struct BLI_mempool_thread *next;
+  /** Identifies the thread using this free list, see #mempool_thread_find. */
+  const void *owner;
+  BLI_freenode *free;
+  /** Number of elements allocated minus freed by this thread, can be negative. */
+  int totused;
+  /** Keep the free lists of different threads on separate cache lines. */
+  char _pad[64 - (3 * sizeof(void *)) - sizeof(int)];
+} BLI_mempool_thread;
+
 /**
  * The mempool, stores and tracks memory \a chunks and elements within those chunks \a free.
  */
@@ -131,6 +148,15 @@ struct BLI_mempool {
   uint maxchunks;
   /** Number of elements currently in use. */
   uint totused;
+
+  /** Free lists of the threads using the pool (#BLI_MEMPOOL_ALLOW_THREADS only). */
+  BLI_mempool_thread *threads;
+  /** Pre-allocated chunks which are not handed out to a thread yet,
+   * from \a chunk_unused up to and including \a chunk_unused_last. */
+  BLI_mempool_chunk *chunk_unused;
+  BLI_mempool_chunk *chunk_unused_last;
+  /** Key for the thread local free list lookup, changes when the pool is cleared. */
+  uint thread_uid;
 #ifdef USE_TOTALLOC
   /** Number of elements allocated in total. */
   uint totalloc;
@@ -184,6 +210,41 @@ static BLI_mempool_chunk *mempool_chunk_alloc(BLI_mempool *pool)
   return MEM_mallocN(sizeof(BLI_mempool_chunk) + (size_t)pool->csize, "BLI_Mempool Chunk");
 }
 
+/**
+ * Build the free list of a chunk, terminated by NULL.
+ *
+ * \return The last element of the chunk.
+ */
+static BLI_freenode *mempool_chunk_fill(BLI_mempool *pool, BLI_mempool_chunk *mpchunk)
+{
+  const uint esize = pool->esize;
+  BLI_freenode *curnode = CHUNK_DATA(mpchunk);
+  uint j;
+
+  /* loop through the allocated data, building the pointer structures */
+  j = pool->pchunk;
+  if (pool->flag & BLI_MEMPOOL_ALLOW_ITER) {
+    while (j--) {
+      curnode->next = NODE_STEP_NEXT(curnode);
+      curnode->freeword = FREEWORD;
+      curnode = curnode->next;
+    }
+  }
+  else {
+    while (j--) {
+      curnode->next = NODE_STEP_NEXT(curnode);
+      curnode = curnode->next;
+    }
+  }
+
+  /* terminate the list (rewind one)
+   * will be overwritten if 'curnode' gets passed in again as 'last_tail' */
+  curnode = NODE_STEP_PREV(curnode);
+  curnode->next = NULL;
+
+  return curnode;
+}
+
 /**
  * Initialize a chunk and add into \a pool->chunks
  *
@@ -197,9 +258,7 @@ static BLI_freenode *mempool_chunk_add(BLI_mempool *pool,
                                        BLI_mempool_chunk *mpchunk,
                                        BLI_freenode *last_tail)
 {
-  const uint esize = pool->esize;
-  BLI_freenode *curnode = CHUNK_DATA(mpchunk);
-  uint j;
+  BLI_freenode *curnode;
 
   /* append */
   if (pool->chunk_tail) {
@@ -214,29 +273,10 @@ static BLI_freenode *mempool_chunk_add(BLI_mempool *pool,
   pool->chunk_tail = mpchunk;
 
   if (UNLIKELY(pool->free == NULL)) {
-    pool->free = curnode;
+    pool->free = CHUNK_DATA(mpchunk);
   }
 
-  /* loop through the allocated data, building the pointer structures */
-  j = pool->pchunk;
-  if (pool->flag & BLI_MEMPOOL_ALLOW_ITER) {
-    while (j--) {
-      curnode->next = NODE_STEP_NEXT(curnode);
-      curnode->freeword = FREEWORD;
-      curnode = curnode->next;
-    }
-  }
-  else {
-    while (j--) {
-      curnode->next = NODE_STEP_NEXT(curnode);
-      curnode = curnode->next;
-    }
-  }
-
-  /* terminate the list (rewind one)
-   * will be overwritten if 'curnode' gets passed in again as 'last_tail' */
-  curnode = NODE_STEP_PREV(curnode);
-  curnode->next = NULL;
+  curnode = mempool_chunk_fill(pool, mpchunk);
 
 #ifdef USE_TOTALLOC
   pool->totalloc += pool->pchunk;
@@ -265,6 +305,197 @@ static void mempool_chunk_free_all(BLI_mempool_chunk *mpchunk)
   }
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Threaded Allocation
+ *
+ * Pools created with #BLI_MEMPOOL_ALLOW_THREADS don't use #BLI_mempool.free,
+ * each thread allocates from and frees into its own free list instead,
+ * so allocating and freeing needs no synchronization.
+ * When its free list is empty, a thread takes a pre-allocated chunk or allocates a new one,
+ * both only use atomics on the pool.
+ * \{ */
+
+#ifdef _MSC_VER
+#  define MEMPOOL_THREAD_LOCAL __declspec(thread)
+#else
+#  define MEMPOOL_THREAD_LOCAL __thread
+#endif
+
+/**
+ * Thread local lookup of the free lists, indexed by the pool #BLI_mempool.thread_uid.
+ * An entry for another pool is only overwritten, so pools which were destroyed in the meantime
+ * are never accessed. The address of the array identifies the thread.
+ */
+#define MEMPOOL_THREAD_CACHE_SIZE 16
+static MEMPOOL_THREAD_LOCAL struct {
+  uint pool_uid;
+  BLI_mempool_thread *thread;
+} mempool_thread_cache[MEMPOOL_THREAD_CACHE_SIZE];
+
+static uint mempool_thread_uid_last = 0;
+
+static uint mempool_thread_uid_new(void)
+{
+  uint uid;
+  /* Zero is used for unused cache entries. */
+  do {
+    uid = atomic_add_and_fetch_u(&mempool_thread_uid_last, 1);
+  } while (UNLIKELY(uid == 0));
+  return uid;
+}
+
+/**
+ * Find the free list of the calling thread, add a new one when the thread didn't use
+ * the pool yet. Threads re-use the free lists of exited threads with the same
+ * thread local storage address.
+ */
+static BLI_mempool_thread *mempool_thread_find(BLI_mempool *pool)
+{
+  const void *owner = mempool_thread_cache;
+  BLI_mempool_thread *thread;
+
+  for (thread = pool->threads; thread; thread = thread->next) {
+    if (thread->owner == owner) {
+      return thread;
+    }
+  }
+
+  thread = MEM_mallocN_aligned(sizeof(*thread), 64, "BLI_Mempool Thread");
+  thread->owner = owner;
+  thread->free = NULL;
+  thread->totused = 0;
+  do {
+    thread->next = pool->threads;
+  } while (atomic_cas_ptr((void **)&pool->threads, thread->next, thread) != thread->next);
+
+  return thread;
+}
+
+BLI_INLINE BLI_mempool_thread *mempool_thread_get(BLI_mempool *pool)
+{
+  const uint pool_uid = pool->thread_uid;
+  const uint index = pool_uid % MEMPOOL_THREAD_CACHE_SIZE;
+  if (UNLIKELY(mempool_thread_cache[index].pool_uid != pool_uid)) {
+    mempool_thread_cache[index].thread = mempool_thread_find(pool);
+    mempool_thread_cache[index].pool_uid = pool_uid;
+  }
+  return mempool_thread_cache[index].thread;
+}
+
+/**
+ * Add a chunk which was allocated by a thread into \a pool->chunks.
+ *
+ * \note The previous tail is linked after it was replaced, so the list is only complete
+ * once all threads finished allocating.
+ */
+static void mempool_chunk_append_threaded(BLI_mempool *pool, BLI_mempool_chunk *mpchunk)
+{
+  BLI_mempool_chunk *chunk_tail;
+
+  mpchunk->next = NULL;
+  do {
+    chunk_tail = pool->chunk_tail;
+  } while (atomic_cas_ptr((void **)&pool->chunk_tail, chunk_tail, mpchunk) != chunk_tail);
+
+  if (chunk_tail) {
+    chunk_tail->next = mpchunk;
+  }
+  else {
+    pool->chunks = mpchunk;
+  }
+}
+
+/**
+ * \return The free list of an unused pre-allocated chunk or a newly allocated one.
+ */
+static BLI_freenode *mempool_chunk_take_threaded(BLI_mempool *pool)
+{
+  BLI_mempool_chunk *mpchunk;
+
+  /* The next pointers of pre-allocated chunks don't change, except for the last one. */
+  while ((mpchunk = pool->chunk_unused)) {
+    BLI_mempool_chunk *mpchunk_next = (mpchunk != pool->chunk_unused_last) ? mpchunk->next :
+                                                                               NULL;
+    if (atomic_cas_ptr((void **)&pool->chunk_unused, mpchunk, mpchunk_next) == mpchunk) {
+      /* Pre-allocated chunks are linked into a single free list, terminate it. */
+      const uint esize = pool->esize;
+      BLI_freenode *lastnode = POINTER_OFFSET(CHUNK_DATA(mpchunk), esize * (pool->pchunk - 1));
+      lastnode->next = NULL;
+      return CHUNK_DATA(mpchunk);
+    }
+  }
+
+  mpchunk = mempool_chunk_alloc(pool);
+  mempool_chunk_fill(pool, mpchunk);
+  mempool_chunk_append_threaded(pool, mpchunk);
+  return CHUNK_DATA(mpchunk);
+}
+
+static void *mempool_alloc_threaded(BLI_mempool *pool)
+{
+  BLI_mempool_thread *thread = mempool_thread_get(pool);
+  BLI_freenode *free_pop;
+
+  if (UNLIKELY(thread->free == NULL)) {
+    thread->free = mempool_chunk_take_threaded(pool);
+  }
+
+  free_pop = thread->free;
+
+  if (pool->flag & BLI_MEMPOOL_ALLOW_ITER) {
+    free_pop->freeword = USEDWORD;
+  }
+
+  thread->free = free_pop->next;
+  thread->totused++;
+
+#ifdef WITH_MEM_VALGRIND
+  VALGRIND_MEMPOOL_ALLOC(pool, free_pop, pool->esize);
+#endif
+
+  return (void *)free_pop;
+}
+
+static void mempool_free_threaded(BLI_mempool *pool, BLI_freenode *newhead)
+{
+  BLI_mempool_thread *thread = mempool_thread_get(pool);
+
+  newhead->next = thread->free;
+  thread->free = newhead;
+  thread->totused--;
+}
+
+static void mempool_threads_free_all(BLI_mempool_thread *thread)
+{
+  BLI_mempool_thread *thread_next;
+
+  for (; thread; thread = thread_next) {
+    thread_next = thread->next;
+    MEM_freeN(thread);
+  }
+}
+
+/**
+ * Forget the free lists of all threads and hand out the chunks of \a pool->free again.
+ * Called after creating and clearing the pool.
+ */
+static void mempool_threads_reset(BLI_mempool *pool)
+{
+  BLI_assert(pool->flag & BLI_MEMPOOL_ALLOW_THREADS);
+
+  mempool_threads_free_all(pool->threads);
+  pool->threads = NULL;
+  pool->thread_uid = mempool_thread_uid_new();
+
+  /* All chunks are unused at this point. */
+  BLI_assert(pool->free == ((pool->chunks) ? CHUNK_DATA(pool->chunks) : NULL));
+  pool->free = NULL;
+  pool->chunk_unused = pool->chunks;
+  pool->chunk_unused_last = pool->chunk_tail;
+}
+
+/** \} */
+
 BLI_mempool *BLI_mempool_create(uint esize, uint totelem, uint pchunk, uint flag)
 {
   BLI_mempool *pool;
@@ -315,6 +546,10 @@ BLI_mempool *BLI_mempool_create(uint esize, uint totelem, uint pchunk, uint flag
   pool->totalloc = 0;
 #endif
   pool->totused = 0;
+  pool->threads = NULL;
+  pool->chunk_unused = NULL;
+  pool->chunk_unused_last = NULL;
+  pool->thread_uid = 0;
 
   if (totelem) {
     /* Allocate the actual chunks. */
@@ -324,6 +559,10 @@ BLI_mempool *BLI_mempool_create(uint esize, uint totelem, uint pchunk, uint flag
     }
   }
 
+  if (flag & BLI_MEMPOOL_ALLOW_THREADS) {
+    mempool_threads_reset(pool);
+  }
+
 #ifdef WITH_MEM_VALGRIND
   VALGRIND_CREATE_MEMPOOL(pool, 0, false);
 #endif
@@ -335,6 +574,10 @@ void *BLI_mempool_alloc(BLI_mempool *pool)
 {
   BLI_freenode *free_pop;
 
+  if (pool->flag & BLI_MEMPOOL_ALLOW_THREADS) {
+    return mempool_alloc_threaded(pool);
+  }
+
   if (UNLIKELY(pool->free == NULL)) {
     /* Need to allocate a new chunk. */
     BLI_mempool_chunk *mpchunk = mempool_chunk_alloc(pool);
@@ -376,7 +619,8 @@ void BLI_mempool_free(BLI_mempool *pool, void *addr)
   BLI_freenode *newhead = addr;
 
 #ifndef NDEBUG
-  {
+  /* Chunks may not be linked yet while other threads allocate. */
+  if ((pool->flag & BLI_MEMPOOL_ALLOW_THREADS) == 0) {
     BLI_mempool_chunk *chunk;
     bool found = false;
     for (chunk = pool->chunks; chunk; chunk = chunk->next) {
@@ -404,6 +648,14 @@ void BLI_mempool_free(BLI_mempool *pool, void *addr)
     newhead->freeword = FREEWORD;
   }
 
+  if (pool->flag & BLI_MEMPOOL_ALLOW_THREADS) {
+    mempool_free_threaded(pool, newhead);
+#ifdef WITH_MEM_VALGRIND
+    VALGRIND_MEMPOOL_FREE(pool, addr);
+#endif
+    return;
+  }
+
   newhead->next = pool->free;
   pool->free = newhead;
 
@@ -453,14 +705,18 @@ void BLI_mempool_free(BLI_mempool *pool, void *addr)
 
 int BLI_mempool_len(BLI_mempool *pool)
 {
-  return (int)pool->totused;
+  int totused = (int)pool->totused;
+  for (BLI_mempool_thread *thread = pool->threads; thread; thread = thread->next) {
+    totused += thread->totused;
+  }
+  return totused;
 }
 
 void *BLI_mempool_findelem(BLI_mempool *pool, uint index)
 {
   BLI_assert(pool->flag & BLI_MEMPOOL_ALLOW_ITER);
 
-  if (index < pool->totused) {
+  if (index < (uint)BLI_mempool_len(pool)) {
     /* We could have some faster mem chunk stepping code inline. */
     BLI_mempool_iter iter;
     void *elem;
@@ -491,7 +747,7 @@ void BLI_mempool_as_table(BLI_mempool *pool, void **data)
   while ((elem = BLI_mempool_iterstep(&iter))) {
     *p++ = elem;
   }
-  BLI_assert((uint)(p - data) == pool->totused);
+  BLI_assert((int)(p - data) == BLI_mempool_len(pool));
 }
 
 /**
@@ -499,7 +755,7 @@ void BLI_mempool_as_table(BLI_mempool *pool, void **data)
  */
 void **BLI_mempool_as_tableN(BLI_mempool *pool, const char *allocstr)
 {
-  void **data = MEM_mallocN((size_t)pool->totused * sizeof(void *), allocstr);
+  void **data = MEM_mallocN((size_t)BLI_mempool_len(pool) * sizeof(void *), allocstr);
   BLI_mempool_as_table(pool, data);
   return data;
 }
@@ -518,7 +774,7 @@ void BLI_mempool_as_array(BLI_mempool *pool, void *data)
     memcpy(p, elem, (size_t)esize);
     p = NODE_STEP_NEXT(p);
   }
-  BLI_assert((uint)(p - (char *)data) == pool->totused * esize);
+  BLI_assert((int)(p - (char *)data) == BLI_mempool_len(pool) * (int)esize);
 }
 
 /**
@@ -526,7 +782,7 @@ void BLI_mempool_as_array(BLI_mempool *pool, void *data)
  */
 void *BLI_mempool_as_arrayN(BLI_mempool *pool, const char *allocstr)
 {
-  char *data = MEM_malloc_arrayN(pool->totused, pool->esize, allocstr);
+  char *data = MEM_malloc_arrayN((size_t)BLI_mempool_len(pool), pool->esize, allocstr);
   BLI_mempool_as_array(pool, data);
   return data;
 }
@@ -741,6 +997,10 @@ void BLI_mempool_clear_ex(BLI_mempool *pool, const int totelem_reserve)
     chunks_temp = mpchunk->next;
     last_tail = mempool_chunk_add(pool, mpchunk, last_tail);
   }
+
+  if (pool->flag & BLI_MEMPOOL_ALLOW_THREADS) {
+    mempool_threads_reset(pool);
+  }
 }
 
 /**
@@ -757,6 +1017,7 @@ void BLI_mempool_clear(BLI_mempool *pool)
 void BLI_mempool_destroy(BLI_mempool *pool)
 {
   mempool_chunk_free_all(pool->chunks);
+  mempool_threads_free_all(pool->threads);
 
 #ifdef WITH_MEM_VALGRIND
   VALGRIND_DESTROY_MEMPOOL(pool);
@@ -0,0 +1,262 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup bli
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "atomic_ops.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_fileops.h"
+#include "BLI_mmap.h"
+#include "BLI_threads.h"
+
+#ifdef WIN32
+#  include "BLI_winstuff.h"
+#  include <io.h>
+#  include <windows.h>
+#else
+#  include <signal.h>
+#  include <sys/mman.h>
+#  include <unistd.h>
+#endif
+
+struct BLI_mmap_file {
+  /* The address to which the file was mapped. */
+  char *memory;
+
+  /* The length of the file (and therefore the mapped region). */
+  size_t length;
+
+  /* Platform-specific handle for the mapping. */
+  void *handle;
+
+  /* Flag to indicate IO errors. Needs to be volatile since it's being set from
+   * within the signal handler, which is not part of the normal execution flow. */
+  volatile bool io_error;
+};
+
+#ifndef WIN32
+/* When the file is changed on disk while it's mapped (for example truncated, or when a network
+ * drive disconnects), accessing the mapping raises SIGBUS. The handler checks whether the
+ * address belongs to one of the mapped files, in that case it marks the file as having an
+ * error and replaces the mapping with zeroes, so reading can continue and report the error.
+ *
+ * The open files are kept in a fixed size table that is accessed without locks,
+ * so the signal handler never waits on another thread. */
+#  define MMAP_FILES_MAX 256
+
+static BLI_mmap_file *volatile mmap_files[MMAP_FILES_MAX] = {NULL};
+static struct sigaction mmap_next_handler;
+static bool mmap_handler_configured = false;
+static ThreadMutex mmap_handler_lock = BLI_MUTEX_INITIALIZER;
+
+static void sigbus_handler(int sig, siginfo_t *siginfo, void *ptr)
+{
+  /* We only handle SIGBUS here. */
+  BLI_assert(sig == SIGBUS);
+
+  char *error_addr = (char *)siginfo->si_addr;
+  for (int i = 0; i < MMAP_FILES_MAX; i++) {
+    BLI_mmap_file *file = mmap_files[i];
+    if (file != NULL && error_addr >= file->memory && error_addr < file->memory + file->length) {
+      file->io_error = true;
+      /* Replace the mapped memory with zeroes. */
+      const void *mapped_memory = mmap(file->memory,
+                                       file->length,
+                                       PROT_READ,
+                                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED,
+                                       -1,
+                                       0);
+      if (mapped_memory == MAP_FAILED) {
+        fprintf(stderr, "SIGBUS handler: Error replacing mapped file with zeros\n");
+      }
+      return;
+    }
+  }
+
+  /* Not one of our files, fall back to the previous handler. */
+  if (mmap_next_handler.sa_flags & SA_SIGINFO) {
+    mmap_next_handler.sa_sigaction(sig, siginfo, ptr);
+  }
+  else if (ELEM(mmap_next_handler.sa_handler, SIG_DFL, SIG_IGN)) {
+    /* Restore the default action, the faulting access happens again and terminates. */
+    sigaction(SIGBUS, &mmap_next_handler, NULL);
+  }
+  else {
+    mmap_next_handler.sa_handler(sig);
+  }
+}
+
+static bool sigbus_handler_setup(void)
+{
+  bool ok = true;
+  BLI_mutex_lock(&mmap_handler_lock);
+  if (!mmap_handler_configured) {
+    struct sigaction newact = {0}, oldact = {0};
+
+    newact.sa_sigaction = sigbus_handler;
+    newact.sa_flags = SA_SIGINFO;
+
+    if (sigaction(SIGBUS, &newact, &oldact) == 0) {
+      /* Remember the previous handler to chain to. */
+      mmap_next_handler = oldact;
+      mmap_handler_configured = true;
+    }
+    else {
+      ok = false;
+    }
+  }
+  BLI_mutex_unlock(&mmap_handler_lock);
+  return ok;
+}
+
+static bool sigbus_handler_add(BLI_mmap_file *file)
+{
+  for (int i = 0; i < MMAP_FILES_MAX; i++) {
+    if (atomic_cas_ptr((void **)&mmap_files[i], NULL, file) == NULL) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static void sigbus_handler_remove(BLI_mmap_file *file)
+{
+  for (int i = 0; i < MMAP_FILES_MAX; i++) {
+    if (atomic_cas_ptr((void **)&mmap_files[i], file, NULL) == file) {
+      return;
+    }
+  }
+  BLI_assert(!"Mapped file not registered");
+}
+#endif
+
+BLI_mmap_file *BLI_mmap_open(int fd)
+{
+  void *memory, *handle = NULL;
+  const size_t length = BLI_file_descriptor_size(fd);
+  if (UNLIKELY(length == (size_t)-1)) {
+    return NULL;
+  }
+
+#ifndef WIN32
+  /* Ensure that the SIGBUS handler is configured. */
+  if (!sigbus_handler_setup()) {
+    return NULL;
+  }
+
+  /* Map the given file to memory. */
+  memory = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (memory == MAP_FAILED) {
+    return NULL;
+  }
+#else
+  /* Convert the POSIX-style file descriptor to a Windows handle. */
+  HANDLE file_handle = (HANDLE)_get_osfhandle(fd);
+  /* Memory mapping an empty file does not work on Windows. */
+  if (length == 0) {
+    return NULL;
+  }
+  /* Map the file into the address space. */
+  handle = CreateFileMapping(file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (handle == NULL) {
+    return NULL;
+  }
+  memory = MapViewOfFile(handle, FILE_MAP_READ, 0, 0, 0);
+  if (memory == NULL) {
+    CloseHandle(handle);
+    return NULL;
+  }
+#endif
+
+  /* Now that the mapping was successful, allocate memory and set up the BLI_mmap_file. */
+  BLI_mmap_file *file = MEM_callocN(sizeof(BLI_mmap_file), __func__);
+  file->memory = memory;
+  file->handle = handle;
+  file->length = length;
+
+#ifndef WIN32
+  /* Register the file with the error handler. */
+  if (!sigbus_handler_add(file)) {
+    munmap(memory, length);
+    MEM_freeN(file);
+    return NULL;
+  }
+#endif
+
+  return file;
+}
+
+bool BLI_mmap_read(BLI_mmap_file *file, void *dest, size_t offset, size_t length)
+{
+  /* If a previous read has already failed or we try to read past the end,
+   * don't even attempt to read any further. */
+  if (file->io_error || (offset + length > file->length) || (offset + length < offset)) {
+    return false;
+  }
+
+#ifndef WIN32
+  /* If an error occurs in this call, sigbus_handler will be called and will set
+   * file->io_error to true. */
+  memcpy(dest, file->memory + offset, length);
+#else
+  /* On Windows, we use exception handling to be notified of errors. */
+  __try {
+    memcpy(dest, file->memory + offset, length);
+  }
+  __except (GetExceptionCode() == EXCEPTION_IN_PAGE_ERROR ? EXCEPTION_EXECUTE_HANDLER :
+                                                            EXCEPTION_CONTINUE_SEARCH) {
+    file->io_error = true;
+    return false;
+  }
+#endif
+
+  return !file->io_error;
+}
+
+const void *BLI_mmap_get_pointer(BLI_mmap_file *file)
+{
+  return file->memory;
+}
+
+size_t BLI_mmap_get_length(const BLI_mmap_file *file)
+{
+  return file->length;
+}
+
+bool BLI_mmap_any_io_error(const BLI_mmap_file *file)
+{
+  return file->io_error;
+}
+
+void BLI_mmap_free(BLI_mmap_file *file)
+{
+#ifndef WIN32
+  munmap((void *)file->memory, file->length);
+  sigbus_handler_remove(file);
+#else
+  UnmapViewOfFile(file->memory);
+  CloseHandle(file->handle);
+#endif
+
+  MEM_freeN(file);
+}
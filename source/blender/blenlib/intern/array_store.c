@@ -1651,6 +1651,50 @@ void *BLI_array_store_state_data_get_alloc(BArrayState *state, size_t *r_data_le
   return data;
 }
 
+/**
+ * Call \a diff_fn for each chunk of \a state which isn't shared with \a state_other
+ * at the same offset. Shared chunks are skipped without reading their data,
+ * so comparing states added with one another as a reference
+ * only costs time proportional to the number of chunks.
+ *
+ * \note Chunks which aren't shared may still contain the same data,
+ * so this only gives an upper bound for the data that changed.
+ *
+ * \param diff_fn: Optional callback, NULL when only the size is needed.
+ * \return The number of bytes of \a state which aren't shared with \a state_other.
+ */
+size_t BLI_array_store_state_foreach_difference(const BArrayState *state,
+                                                const BArrayState *state_other,
+                                                BArrayStateDifferenceFn diff_fn,
+                                                void *user_data)
+{
+  if (state->chunk_list == state_other->chunk_list) {
+    return 0;
+  }
+
+  size_t diff_len = 0;
+  size_t offset = 0, offset_other = 0;
+  const BChunkRef *cref_other = state_other->chunk_list->chunk_refs.first;
+  LISTBASE_FOREACH (const BChunkRef *, cref, &state->chunk_list->chunk_refs) {
+    const BChunk *chunk = cref->link;
+
+    /* Step over chunks in the other state that end before this one starts. */
+    while (cref_other && (offset_other + cref_other->link->data_len <= offset)) {
+      offset_other += cref_other->link->data_len;
+      cref_other = cref_other->next;
+    }
+
+    if (!(cref_other && (offset_other == offset) && (cref_other->link == chunk))) {
+      if (diff_fn) {
+        diff_fn(user_data, offset, chunk->data, chunk->data_len);
+      }
+      diff_len += chunk->data_len;
+    }
+    offset += chunk->data_len;
+  }
+  return diff_len;
+}
+
 /** \} */
 
 /** \name Debugging API (for testing).
@@ -0,0 +1,715 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup bli
+ *
+ * Layout of the trailing index member (all integers little endian):
+ *
+ * <pre>
+ * 1f 8b 08 04 00000000 00 ff   gzip header with the FEXTRA flag set.
+ * XLEN                         `uint16` size of the extra field.
+ * 'B' 'I' LEN                  extra sub-field identifier and `uint16` size.
+ * (comp_len, raw_len) * n      `uint32` pairs, one for each block covered by this member.
+ * n, "BGZI"                    `uint32` number of entries and the magic.
+ * 03 00                        empty deflate stream.
+ * 00000000 00000000            CRC32 and size of the (empty) uncompressed data.
+ * </pre>
+ *
+ * Streams with many blocks use multiple index members, written one after another,
+ * so the reader walks them backwards from the end of the file.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "zlib.h"
+
+#ifdef WIN32
+#  include "BLI_winstuff.h"
+#  include <io.h>
+#else
+#  include <unistd.h>
+#endif
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_fileops.h"
+#include "BLI_gzip_blocks.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include "BLI_strict_flags.h"
+
+#define INDEX_MAGIC "BGZI"
+#define INDEX_ENTRY_SIZE 8
+/** Number of entries (and magic) stored after the entries. */
+#define INDEX_FOOTER_SIZE 8
+/** Header, XLEN and the sub-field header. */
+#define INDEX_HEAD_SIZE (10 + 2 + 4)
+/** Empty deflate stream, CRC32 and ISIZE. */
+#define INDEX_TAIL_SIZE (2 + 8)
+/** The sub-field length is stored as `uint16`. */
+#define INDEX_ENTRIES_MAX ((size_t)(0xffff - INDEX_FOOTER_SIZE) / INDEX_ENTRY_SIZE)
+
+#define INDEX_MEMBER_SIZE(entries_len) \
+  (INDEX_HEAD_SIZE + (entries_len)*INDEX_ENTRY_SIZE + INDEX_FOOTER_SIZE + INDEX_TAIL_SIZE)
+
+/* -------------------------------------------------------------------- */
+/** \name Utilities
+ * \{ */
+
+static void write_u16_le(uchar *buf, uint value)
+{
+  buf[0] = (uchar)(value & 0xff);
+  buf[1] = (uchar)((value >> 8) & 0xff);
+}
+
+static void write_u32_le(uchar *buf, uint value)
+{
+  write_u16_le(buf, value & 0xffff);
+  write_u16_le(buf + 2, value >> 16);
+}
+
+static uint read_u16_le(const uchar *buf)
+{
+  return (uint)buf[0] | ((uint)buf[1] << 8);
+}
+
+static uint read_u32_le(const uchar *buf)
+{
+  return read_u16_le(buf) | (read_u16_le(buf + 2) << 16);
+}
+
+static bool write_all(int file, const uchar *data, size_t data_len)
+{
+  while (data_len > 0) {
+    const size_t chunk_len = MIN2(data_len, (size_t)INT_MAX);
+    const int64_t written = (int64_t)write(file, data, (uint)chunk_len);
+    if (written <= 0) {
+      return false;
+    }
+    data += written;
+    data_len -= (size_t)written;
+  }
+  return true;
+}
+
+static bool read_all(int file, uchar *data, size_t data_len)
+{
+  while (data_len > 0) {
+    const size_t chunk_len = MIN2(data_len, (size_t)INT_MAX);
+    const int64_t readsize = (int64_t)read(file, data, (uint)chunk_len);
+    if (readsize <= 0) {
+      return false;
+    }
+    data += readsize;
+    data_len -= (size_t)readsize;
+  }
+  return true;
+}
+
+static int gzip_block_batch_len(void)
+{
+  /* A little over-subscription keeps all threads busy when blocks compress unevenly. */
+  return BLI_system_thread_count() * 2;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Writer
+ *
+ * Blocks are collected into batches, while one batch is compressed by the task scheduler
+ * the next one is filled by the caller. Batches are written to the file in order.
+ * \{ */
+
+typedef struct GzipBlock {
+  uchar *raw;
+  size_t raw_len;
+
+  uchar *comp;
+  size_t comp_len;
+  size_t comp_alloc;
+
+  int level;
+  bool ok;
+} GzipBlock;
+
+struct GzipBlockWriter {
+  int file;
+  int level;
+  size_t block_size;
+
+  /** Two batches of blocks: one being filled, one being compressed. */
+  GzipBlock *batches[2];
+  int batch_len;
+  int batch_fill;
+  /** Number of complete blocks in the batch that is filled. */
+  int block_fill;
+
+  TaskPool *task_pool;
+  /** Number of blocks in the batch that is compressed, zero when idle. */
+  int pending_len;
+
+  /** Pairs of (compressed, uncompressed) sizes for every written block. */
+  uint *index;
+  size_t index_len;
+  size_t index_alloc;
+
+  bool error;
+};
+
+static void gzip_block_compress_task(TaskPool *__restrict UNUSED(pool), void *taskdata)
+{
+  GzipBlock *block = taskdata;
+  z_stream strm = {NULL};
+
+  block->ok = false;
+
+  if (deflateInit2(&strm, block->level, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY) !=
+      Z_OK) {
+    return;
+  }
+
+  const size_t comp_bound = (size_t)deflateBound(&strm, (uLong)block->raw_len);
+  if (comp_bound > block->comp_alloc) {
+    MEM_SAFE_FREE(block->comp);
+    block->comp = MEM_mallocN(comp_bound, __func__);
+    block->comp_alloc = comp_bound;
+  }
+
+  strm.next_in = block->raw;
+  strm.avail_in = (uInt)block->raw_len;
+  strm.next_out = block->comp;
+  strm.avail_out = (uInt)block->comp_alloc;
+
+  if (deflate(&strm, Z_FINISH) == Z_STREAM_END) {
+    block->comp_len = (size_t)strm.total_out;
+    block->ok = true;
+  }
+  deflateEnd(&strm);
+}
+
+GzipBlockWriter *BLI_gzip_block_writer_new(int file, int level, size_t block_size)
+{
+  GzipBlockWriter *writer = MEM_callocN(sizeof(*writer), __func__);
+
+  writer->file = file;
+  writer->level = level;
+  writer->block_size = block_size ? block_size : GZIP_BLOCK_SIZE_DEFAULT;
+  writer->batch_len = gzip_block_batch_len();
+
+  for (int i = 0; i < 2; i++) {
+    writer->batches[i] = MEM_callocN(sizeof(GzipBlock) * (size_t)writer->batch_len, __func__);
+  }
+
+  writer->task_pool = BLI_task_pool_create(writer, TASK_PRIORITY_HIGH);
+
+  return writer;
+}
+
+/**
+ * Wait for the batch being compressed and write it to the file.
+ */
+static void gzip_block_writer_finish_pending(GzipBlockWriter *writer)
+{
+  if (writer->pending_len == 0) {
+    return;
+  }
+
+  BLI_task_pool_work_and_wait(writer->task_pool);
+
+  GzipBlock *batch = writer->batches[writer->batch_fill ^ 1];
+  for (int i = 0; i < writer->pending_len; i++) {
+    GzipBlock *block = &batch[i];
+    if (writer->error) {
+      break;
+    }
+    if (!block->ok || (block->comp_len > UINT_MAX) ||
+        !write_all(writer->file, block->comp, block->comp_len)) {
+      writer->error = true;
+      break;
+    }
+
+    if (writer->index_len + 2 > writer->index_alloc) {
+      writer->index_alloc = MAX2(writer->index_alloc * 2, (size_t)1024);
+      writer->index = MEM_reallocN(writer->index, sizeof(*writer->index) * writer->index_alloc);
+    }
+    writer->index[writer->index_len++] = (uint)block->comp_len;
+    writer->index[writer->index_len++] = (uint)block->raw_len;
+  }
+
+  writer->pending_len = 0;
+}
+
+/**
+ * Start compressing the first `blocks_len` blocks of the batch that is being filled,
+ * then continue filling the other batch.
+ */
+static void gzip_block_writer_submit(GzipBlockWriter *writer, int blocks_len)
+{
+  gzip_block_writer_finish_pending(writer);
+
+  GzipBlock *batch = writer->batches[writer->batch_fill];
+  for (int i = 0; i < blocks_len; i++) {
+    batch[i].level = writer->level;
+    BLI_task_pool_push(writer->task_pool, gzip_block_compress_task, &batch[i], false, NULL);
+  }
+  writer->pending_len = blocks_len;
+
+  writer->batch_fill ^= 1;
+  writer->block_fill = 0;
+  GzipBlock *batch_next = writer->batches[writer->batch_fill];
+  for (int i = 0; i < writer->batch_len; i++) {
+    batch_next[i].raw_len = 0;
+  }
+}
+
+bool BLI_gzip_block_writer_write(GzipBlockWriter *writer, const void *data, size_t data_len)
+{
+  const uchar *data_src = data;
+
+  while ((data_len > 0) && !writer->error) {
+    GzipBlock *block = &writer->batches[writer->batch_fill][writer->block_fill];
+    if (block->raw == NULL) {
+      block->raw = MEM_mallocN(writer->block_size, __func__);
+    }
+
+    const size_t copy_len = MIN2(data_len, writer->block_size - block->raw_len);
+    memcpy(block->raw + block->raw_len, data_src, copy_len);
+    block->raw_len += copy_len;
+    data_src += copy_len;
+    data_len -= copy_len;
+
+    if (block->raw_len == writer->block_size) {
+      writer->block_fill++;
+      if (writer->block_fill == writer->batch_len) {
+        gzip_block_writer_submit(writer, writer->batch_len);
+      }
+    }
+  }
+
+  return !writer->error;
+}
+
+static bool gzip_block_writer_write_index(GzipBlockWriter *writer)
+{
+  const size_t blocks_len = writer->index_len / 2;
+  const size_t member_alloc = INDEX_MEMBER_SIZE(MIN2(blocks_len, INDEX_ENTRIES_MAX));
+  uchar *member = MEM_mallocN(member_alloc, __func__);
+  bool ok = true;
+
+  /* Always write an index member, even when empty, so the reader can detect the format. */
+  size_t block_index = 0;
+  do {
+    const size_t entries_len = MIN2(blocks_len - block_index, INDEX_ENTRIES_MAX);
+    const uint field_len = (uint)(entries_len * INDEX_ENTRY_SIZE + INDEX_FOOTER_SIZE);
+    uchar *cursor = member;
+
+    /* Magic, deflate method, FEXTRA flag, no time-stamp, no extra flags, unknown OS. */
+    const uchar header[10] = {0x1f, 0x8b, 0x08, 0x04, 0, 0, 0, 0, 0, 0xff};
+    memcpy(cursor, header, sizeof(header));
+    cursor += sizeof(header);
+    write_u16_le(cursor, field_len + 4);
+    cursor += 2;
+    cursor[0] = 'B';
+    cursor[1] = 'I';
+    write_u16_le(cursor + 2, field_len);
+    cursor += 4;
+
+    for (size_t i = 0; i < entries_len; i++) {
+      write_u32_le(cursor, writer->index[(block_index + i) * 2]);
+      write_u32_le(cursor + 4, writer->index[(block_index + i) * 2 + 1]);
+      cursor += INDEX_ENTRY_SIZE;
+    }
+    write_u32_le(cursor, (uint)entries_len);
+    memcpy(cursor + 4, INDEX_MAGIC, 4);
+    cursor += INDEX_FOOTER_SIZE;
+
+    /* Empty final deflate block, followed by CRC32 and ISIZE (both zero). */
+    const uchar tail[INDEX_TAIL_SIZE] = {0x03, 0x00};
+    memcpy(cursor, tail, sizeof(tail));
+    cursor += sizeof(tail);
+
+    if (!write_all(writer->file, member, (size_t)(cursor - member))) {
+      ok = false;
+      break;
+    }
+    block_index += entries_len;
+  } while (block_index < blocks_len);
+
+  MEM_freeN(member);
+  return ok;
+}
+
+bool BLI_gzip_block_writer_free(GzipBlockWriter *writer)
+{
+  if (!writer->error) {
+    int blocks_len = writer->block_fill;
+    if ((blocks_len < writer->batch_len) &&
+        (writer->batches[writer->batch_fill][blocks_len].raw_len != 0)) {
+      blocks_len++;
+    }
+    if (blocks_len != 0) {
+      gzip_block_writer_submit(writer, blocks_len);
+    }
+  }
+  gzip_block_writer_finish_pending(writer);
+
+  if (!writer->error) {
+    if (!gzip_block_writer_write_index(writer)) {
+      writer->error = true;
+    }
+  }
+
+  const bool ok = !writer->error;
+
+  BLI_task_pool_free(writer->task_pool);
+  for (int i = 0; i < 2; i++) {
+    for (int j = 0; j < writer->batch_len; j++) {
+      MEM_SAFE_FREE(writer->batches[i][j].raw);
+      MEM_SAFE_FREE(writer->batches[i][j].comp);
+    }
+    MEM_freeN(writer->batches[i]);
+  }
+  MEM_SAFE_FREE(writer->index);
+  MEM_freeN(writer);
+
+  return ok;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Reader
+ *
+ * Keeps a window of consecutive decompressed blocks in memory. Sequential reading
+ * decompresses a whole window at once using all threads, random access (seeking)
+ * only decompresses the block that is needed.
+ * \{ */
+
+typedef struct GzipReadBlock {
+  /** Compressed data, points into #GzipBlockReader.window_comp. */
+  const uchar *comp;
+  size_t comp_len;
+
+  uchar *raw;
+  size_t raw_len;
+  bool ok;
+} GzipReadBlock;
+
+struct GzipBlockReader {
+  int file;
+
+  int blocks_len;
+  /** Offsets of each block, `blocks_len + 1` items so the sizes can be calculated. */
+  uint64_t *comp_offset;
+  uint64_t *raw_offset;
+
+  /** Current uncompressed position. */
+  uint64_t position;
+
+  GzipReadBlock *window;
+  int window_alloc;
+  int window_start;
+  int window_len;
+  uchar *window_comp;
+  size_t window_comp_alloc;
+  /** Largest uncompressed block. */
+  size_t raw_block_max;
+};
+
+/**
+ * Read the index members from the end of the file.
+ *
+ * \return The number of blocks or -1 when this isn't a valid block gzip file.
+ */
+static int gzip_block_reader_read_index(GzipBlockReader *reader)
+{
+  const int file = reader->file;
+  const uint64_t file_size = (uint64_t)BLI_file_descriptor_size(file);
+  uint64_t member_end = file_size;
+
+  /* Entries are collected backwards, as members are read from the end of the file. */
+  uint *entries = NULL;
+  size_t entries_len = 0;
+  uchar *member = MEM_mallocN(INDEX_MEMBER_SIZE(INDEX_ENTRIES_MAX), __func__);
+  bool ok = true;
+
+  while (true) {
+    uchar footer[INDEX_FOOTER_SIZE + INDEX_TAIL_SIZE];
+    if ((member_end < INDEX_MEMBER_SIZE(0)) ||
+        (BLI_lseek(file, (int64_t)(member_end - sizeof(footer)), SEEK_SET) == -1) ||
+        !read_all(file, footer, sizeof(footer))) {
+      break;
+    }
+    if (memcmp(footer + 4, INDEX_MAGIC, 4) != 0) {
+      break;
+    }
+    const uint member_entries_len = read_u32_le(footer);
+    const uint64_t member_size = INDEX_MEMBER_SIZE((uint64_t)member_entries_len);
+    if ((member_entries_len > INDEX_ENTRIES_MAX) || (member_size > member_end)) {
+      ok = false;
+      break;
+    }
+    if ((BLI_lseek(file, (int64_t)(member_end - member_size), SEEK_SET) == -1) ||
+        !read_all(file, member, (size_t)member_size)) {
+      ok = false;
+      break;
+    }
+    if ((member[0] != 0x1f) || (member[1] != 0x8b) || (member[3] != 0x04) ||
+        (member[12] != 'B') || (member[13] != 'I')) {
+      ok = false;
+      break;
+    }
+
+    entries = MEM_reallocN(entries,
+                           sizeof(*entries) * 2 * (entries_len + member_entries_len + 1));
+    /* Make room at the start for the entries of this member. */
+    memmove(entries + member_entries_len * 2, entries, sizeof(*entries) * 2 * entries_len);
+    const uchar *cursor = member + INDEX_HEAD_SIZE;
+    for (uint i = 0; i < member_entries_len; i++) {
+      entries[i * 2] = read_u32_le(cursor);
+      entries[i * 2 + 1] = read_u32_le(cursor + 4);
+      cursor += INDEX_ENTRY_SIZE;
+    }
+    entries_len += member_entries_len;
+    member_end -= member_size;
+  }
+  MEM_freeN(member);
+
+  /* No index at all, regular gzip file. */
+  if (member_end == file_size) {
+    ok = false;
+  }
+
+  int blocks_len = -1;
+  if (ok && (entries_len < INT_MAX)) {
+    reader->comp_offset = MEM_mallocN(sizeof(uint64_t) * (entries_len + 1), __func__);
+    reader->raw_offset = MEM_mallocN(sizeof(uint64_t) * (entries_len + 1), __func__);
+    reader->comp_offset[0] = 0;
+    reader->raw_offset[0] = 0;
+    for (size_t i = 0; i < entries_len; i++) {
+      reader->comp_offset[i + 1] = reader->comp_offset[i] + entries[i * 2];
+      reader->raw_offset[i + 1] = reader->raw_offset[i] + entries[i * 2 + 1];
+      reader->raw_block_max = MAX2(reader->raw_block_max, (size_t)entries[i * 2 + 1]);
+    }
+    /* The blocks must exactly fill the file up to the index. */
+    if (reader->comp_offset[entries_len] == member_end) {
+      blocks_len = (int)entries_len;
+    }
+  }
+
+  MEM_SAFE_FREE(entries);
+  return blocks_len;
+}
+
+GzipBlockReader *BLI_gzip_block_reader_new(int file)
+{
+  GzipBlockReader *reader = MEM_callocN(sizeof(*reader), __func__);
+  reader->file = file;
+
+  reader->blocks_len = gzip_block_reader_read_index(reader);
+  if (reader->blocks_len == -1) {
+    BLI_gzip_block_reader_free(reader);
+    return NULL;
+  }
+
+  reader->window_alloc = gzip_block_batch_len();
+  reader->window = MEM_callocN(sizeof(*reader->window) * (size_t)reader->window_alloc, __func__);
+
+  return reader;
+}
+
+static void gzip_block_decompress_cb(void *__restrict userdata,
+                                     const int iter,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  GzipReadBlock *block = &((GzipReadBlock *)userdata)[iter];
+  z_stream strm = {NULL};
+
+  block->ok = false;
+
+  if (inflateInit2(&strm, MAX_WBITS + 16) != Z_OK) {
+    return;
+  }
+
+  strm.next_in = (Bytef *)block->comp;
+  strm.avail_in = (uInt)block->comp_len;
+  strm.next_out = block->raw;
+  strm.avail_out = (uInt)block->raw_len;
+
+  if ((inflate(&strm, Z_FINISH) == Z_STREAM_END) && (strm.total_out == block->raw_len)) {
+    block->ok = true;
+  }
+  inflateEnd(&strm);
+}
+
+/**
+ * Decompress `window_len` blocks starting at `block_start` into the window.
+ */
+static bool gzip_block_reader_load_window(GzipBlockReader *reader,
+                                          int block_start,
+                                          int window_len)
+{
+  BLI_assert(window_len <= reader->window_alloc);
+  const int block_end = block_start + window_len;
+
+  /* Compressed blocks are stored consecutively, read them all at once. */
+  const size_t comp_len = (size_t)(reader->comp_offset[block_end] -
+                                   reader->comp_offset[block_start]);
+  if (comp_len > reader->window_comp_alloc) {
+    MEM_SAFE_FREE(reader->window_comp);
+    reader->window_comp = MEM_mallocN(comp_len, __func__);
+    reader->window_comp_alloc = comp_len;
+  }
+
+  reader->window_start = block_start;
+  reader->window_len = 0;
+
+  if ((BLI_lseek(reader->file, (int64_t)reader->comp_offset[block_start], SEEK_SET) == -1) ||
+      !read_all(reader->file, reader->window_comp, comp_len)) {
+    return false;
+  }
+
+  for (int i = 0; i < window_len; i++) {
+    GzipReadBlock *block = &reader->window[i];
+    const int block_index = block_start + i;
+    block->comp = reader->window_comp +
+                  (reader->comp_offset[block_index] - reader->comp_offset[block_start]);
+    block->comp_len = (size_t)(reader->comp_offset[block_index + 1] -
+                               reader->comp_offset[block_index]);
+    block->raw_len = (size_t)(reader->raw_offset[block_index + 1] -
+                              reader->raw_offset[block_index]);
+    if (block->raw == NULL) {
+      block->raw = MEM_mallocN(MAX2(reader->raw_block_max, (size_t)1), __func__);
+    }
+  }
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (window_len > 1);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(0, window_len, reader->window, gzip_block_decompress_cb, &settings);
+
+  for (int i = 0; i < window_len; i++) {
+    if (!reader->window[i].ok) {
+      return false;
+    }
+  }
+
+  reader->window_len = window_len;
+  return true;
+}
+
+/**
+ * \return The index of the block containing `position`.
+ */
+static int gzip_block_reader_find_block(const GzipBlockReader *reader, uint64_t position)
+{
+  int low = 0, high = reader->blocks_len;
+  while (high - low > 1) {
+    const int mid = (low + high) / 2;
+    if (reader->raw_offset[mid] <= position) {
+      low = mid;
+    }
+    else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+int64_t BLI_gzip_block_reader_read(GzipBlockReader *reader, void *buffer, size_t size)
+{
+  uchar *buffer_dst = buffer;
+  const uint64_t raw_size = reader->raw_offset[reader->blocks_len];
+  size_t read_len = 0;
+
+  while ((read_len < size) && (reader->position < raw_size)) {
+    const int window_end = reader->window_start + reader->window_len;
+    const int block_index = gzip_block_reader_find_block(reader, reader->position);
+
+    if ((block_index < reader->window_start) || (block_index >= window_end)) {
+      /* Continuing where the previous window ended is sequential reading,
+       * read ahead using all threads, otherwise only decompress what's needed. */
+      const bool is_sequential = (reader->window_len == 0) ? (block_index == 0) :
+                                                             (block_index == window_end);
+      const int window_len = is_sequential ?
+                                 MIN2(reader->window_alloc, reader->blocks_len - block_index) :
+                                 1;
+      if (!gzip_block_reader_load_window(reader, block_index, window_len)) {
+        return -1;
+      }
+    }
+
+    const GzipReadBlock *block = &reader->window[block_index - reader->window_start];
+    const size_t block_offset = (size_t)(reader->position - reader->raw_offset[block_index]);
+    const size_t copy_len = MIN2(size - read_len, block->raw_len - block_offset);
+    memcpy(buffer_dst + read_len, block->raw + block_offset, copy_len);
+    read_len += copy_len;
+    reader->position += copy_len;
+  }
+
+  return (int64_t)read_len;
+}
+
+int64_t BLI_gzip_block_reader_seek(GzipBlockReader *reader, int64_t offset, int whence)
+{
+  int64_t position;
+  switch (whence) {
+    case SEEK_SET:
+      position = offset;
+      break;
+    case SEEK_CUR:
+      position = (int64_t)reader->position + offset;
+      break;
+    case SEEK_END:
+      position = (int64_t)reader->raw_offset[reader->blocks_len] + offset;
+      break;
+    default:
+      return -1;
+  }
+
+  if ((position < 0) || ((uint64_t)position > reader->raw_offset[reader->blocks_len])) {
+    return -1;
+  }
+  reader->position = (uint64_t)position;
+  return position;
+}
+
+uint64_t BLI_gzip_block_reader_size(const GzipBlockReader *reader)
+{
+  return reader->raw_offset[reader->blocks_len];
+}
+
+void BLI_gzip_block_reader_free(GzipBlockReader *reader)
+{
+  if (reader->window) {
+    for (int i = 0; i < reader->window_alloc; i++) {
+      MEM_SAFE_FREE(reader->window[i].raw);
+    }
+    MEM_freeN(reader->window);
+  }
+  MEM_SAFE_FREE(reader->window_comp);
+  MEM_SAFE_FREE(reader->comp_offset);
+  MEM_SAFE_FREE(reader->raw_offset);
+  MEM_freeN(reader);
+}
+
+/** \} */
@@ -2518,6 +2518,47 @@ int orient3d_fast(const double3 &a, const double3 &b, const double3 &c, const do
   return sgn(robust_pred::orient3dfast(a, b, c, d));
 }
 
+/**
+ * The error bound follows "Exact Geometric Computation Using Cascading" by Burnikel, Funke and
+ * Seel: `|E_exact - E| <= supremum(E) * index(E) * DBL_EPSILON`, where the supremum is the
+ * expression evaluated on absolute values with every subtraction replaced by an addition, and
+ * the index is `10 + 4 * index(inputs)`, with index 1 for inputs which may have been rounded.
+ */
+int orient3d_filter(const double3 &a, const double3 &b, const double3 &c, const double3 &d)
+{
+  constexpr double index_orient3d = 14.0;
+
+  const double adx = a[0] - d[0];
+  const double bdx = b[0] - d[0];
+  const double cdx = c[0] - d[0];
+  const double ady = a[1] - d[1];
+  const double bdy = b[1] - d[1];
+  const double cdy = c[1] - d[1];
+  const double adz = a[2] - d[2];
+  const double bdz = b[2] - d[2];
+  const double cdz = c[2] - d[2];
+  const double det = adz * (bdx * cdy - cdx * bdy) + bdz * (cdx * ady - adx * cdy) +
+                     cdz * (adx * bdy - bdx * ady);
+
+  const double sup_adx = fabs(a[0]) + fabs(d[0]);
+  const double sup_bdx = fabs(b[0]) + fabs(d[0]);
+  const double sup_cdx = fabs(c[0]) + fabs(d[0]);
+  const double sup_ady = fabs(a[1]) + fabs(d[1]);
+  const double sup_bdy = fabs(b[1]) + fabs(d[1]);
+  const double sup_cdy = fabs(c[1]) + fabs(d[1]);
+  const double sup_adz = fabs(a[2]) + fabs(d[2]);
+  const double sup_bdz = fabs(b[2]) + fabs(d[2]);
+  const double sup_cdz = fabs(c[2]) + fabs(d[2]);
+  const double supremum = sup_adz * (sup_bdx * sup_cdy + sup_cdx * sup_bdy) +
+                          sup_bdz * (sup_cdx * sup_ady + sup_adx * sup_cdy) +
+                          sup_cdz * (sup_adx * sup_bdy + sup_bdx * sup_ady);
+
+  if (fabs(det) > supremum * index_orient3d * DBL_EPSILON) {
+    return sgn(det);
+  }
+  return 0;
+}
+
 int insphere(
     const double3 &a, const double3 &b, const double3 &c, const double3 &d, const double3 &e)
 {
@@ -1423,60 +1423,6 @@ static double supremum_dot(const double3 &a, const double3 &b)
   return double3::dot(abs_a, abs_b);
 }
 
-static double supremum_orient3d(const double3 &a,
-                                const double3 &b,
-                                const double3 &c,
-                                const double3 &d)
-{
-  double3 abs_a = double3::abs(a);
-  double3 abs_b = double3::abs(b);
-  double3 abs_c = double3::abs(c);
-  double3 abs_d = double3::abs(d);
-  double adx = abs_a[0] + abs_d[0];
-  double bdx = abs_b[0] + abs_d[0];
-  double cdx = abs_c[0] + abs_d[0];
-  double ady = abs_a[1] + abs_d[1];
-  double bdy = abs_b[1] + abs_d[1];
-  double cdy = abs_c[1] + abs_d[1];
-  double adz = abs_a[2] + abs_d[2];
-  double bdz = abs_b[2] + abs_d[2];
-  double cdz = abs_c[2] + abs_d[2];
-
-  double bdxcdy = bdx * cdy;
-  double cdxbdy = cdx * bdy;
-
-  double cdxady = cdx * ady;
-  double adxcdy = adx * cdy;
-
-  double adxbdy = adx * bdy;
-  double bdxady = bdx * ady;
-
-  double det = adz * (bdxcdy + cdxbdy) + bdz * (cdxady + adxcdy) + cdz * (adxbdy + bdxady);
-  return det;
-}
-
-/** Actually index_orient3d = 10 + 4 * (max degree of input coordinates) */
-constexpr int index_orient3d = 14;
-
-/**
- * Return the approximate orient3d of the four double3's, with
- * the guarantee that if the value is -1 or 1 then the underlying
- * mpq3 test would also have returned that value.
- * When the return value is 0, we are not sure of the sign.
- */
-static int filter_orient3d(const double3 &a, const double3 &b, const double3 &c, const double3 &d)
-{
-  double o3dfast = orient3d_fast(a, b, c, d);
-  if (o3dfast == 0.0) {
-    return 0;
-  }
-  double err_bound = supremum_orient3d(a, b, c, d) * index_orient3d * DBL_EPSILON;
-  if (fabs(o3dfast) > err_bound) {
-    return o3dfast > 0.0 ? 1 : -1;
-  }
-  return 0;
-}
-
 /**
  * Return the approximate orient3d of the triangle plane points and v, with
  * the guarantee that if the value is -1 or 1 then the underlying
@@ -1485,7 +1431,7 @@ static int filter_orient3d(const double3 &a, const double3 &b, const double3 &c,
  */
 static int filter_tri_plane_vert_orient3d(const Face &tri, const Vert *v)
 {
-  return filter_orient3d(tri[0]->co, tri[1]->co, tri[2]->co, v->co);
+  return orient3d_filter(tri[0]->co, tri[1]->co, tri[2]->co, v->co);
 }
 
 /**
@@ -1550,7 +1496,7 @@ static int filter_plane_side(const double3 &p,
   }
   double supremum = double3::dot(abs_p + abs_plane_p, abs_plane_no);
   double err_bound = supremum * index_plane_side * DBL_EPSILON;
-  if (d > err_bound) {
+  if (fabs(d) > err_bound) {
     return d > 0 ? 1 : -1;
   }
   return 0;
@@ -1657,14 +1603,20 @@ static inline mpq3 tti_interp(const mpq3 &a, const mpq3 &b, const mpq3 &c, const
 }
 
 /**
- * Return +1, 0, -1 as a + ad is above, on, or below the oriented plane containing a, b, c in CCW
- * order. This is the same as -oriented(a, b, c, a + ad), but uses fewer arithmetic operations.
- * TODO: change arguments to `const Vert *` and use floating filters.
+ * Return +1, 0, -1 as d is above, on, or below the oriented plane containing a, b, c in CCW
+ * order. This is the same as -orient3d(a, b, c, d). The double coordinates decide when their
+ * error bound allows it, the exact coordinates are only used otherwise.
  */
-static inline int tti_above(const mpq3 &a, const mpq3 &b, const mpq3 &c, const mpq3 &ad)
+static inline int tti_above(const Vert *a, const Vert *b, const Vert *c, const Vert *d)
 {
-  mpq3 n = mpq3::cross(b - a, c - a);
-  return sgn(mpq3::dot(ad, n));
+  const int filtered = orient3d_filter(a->co, b->co, c->co, d->co);
+  if (filtered != 0) {
+#  ifdef PERFDEBUG
+    incperfcount(5); /* Tri tri orientation tests decided by the filter. */
+#  endif
+    return -filtered;
+  }
+  return -orient3d(a->co_exact, b->co_exact, c->co_exact, d->co_exact);
 }
 
 /**
@@ -1680,12 +1632,12 @@ static inline int tti_above(const mpq3 &a, const mpq3 &b, const mpq3 &c, const m
  *   of the plane and at least one of q1 and r1 are off the plane.
  * Similarly for p2, q2, r2 with respect to the first triangle's plane.
  */
-static ITT_value itt_canon2(const mpq3 &p1,
-                            const mpq3 &q1,
-                            const mpq3 &r1,
-                            const mpq3 &p2,
-                            const mpq3 &q2,
-                            const mpq3 &r2,
+static ITT_value itt_canon2(const Vert *p1,
+                            const Vert *q1,
+                            const Vert *r1,
+                            const Vert *p2,
+                            const Vert *q2,
+                            const Vert *r2,
                             const mpq3 &n1,
                             const mpq3 &n2)
 {
@@ -1695,33 +1647,23 @@ static ITT_value itt_canon2(const mpq3 &p1,
     std::cout << "p1=" << p1 << " q1=" << q1 << " r1=" << r1 << "\n";
     std::cout << "p2=" << p2 << " q2=" << q2 << " r2=" << r2 << "\n";
     std::cout << "n1=" << n1 << " n2=" << n2 << "\n";
-    std::cout << "approximate values:\n";
-    std::cout << "p1=(" << p1[0].get_d() << "," << p1[1].get_d() << "," << p1[2].get_d() << ")\n";
-    std::cout << "q1=(" << q1[0].get_d() << "," << q1[1].get_d() << "," << q1[2].get_d() << ")\n";
-    std::cout << "r1=(" << r1[0].get_d() << "," << r1[1].get_d() << "," << r1[2].get_d() << ")\n";
-    std::cout << "p2=(" << p2[0].get_d() << "," << p2[1].get_d() << "," << p2[2].get_d() << ")\n";
-    std::cout << "q2=(" << q2[0].get_d() << "," << q2[1].get_d() << "," << q2[2].get_d() << ")\n";
-    std::cout << "r2=(" << r2[0].get_d() << "," << r2[1].get_d() << "," << r2[2].get_d() << ")\n";
-    std::cout << "n1=(" << n1[0].get_d() << "," << n1[1].get_d() << "," << n1[2].get_d() << ")\n";
-    std::cout << "n2=(" << n2[0].get_d() << "," << n2[1].get_d() << "," << n2[2].get_d() << ")\n";
-  }
-  mpq3 p1p2 = p2 - p1;
+  }
   mpq3 intersect_1;
   mpq3 intersect_2;
   bool no_overlap = false;
   /* Top test in classification tree. */
-  if (tti_above(p1, q1, r2, p1p2) > 0) {
+  if (tti_above(p1, q1, r2, p2) > 0) {
     /* Middle right test in classification tree. */
-    if (tti_above(p1, r1, r2, p1p2) <= 0) {
+    if (tti_above(p1, r1, r2, p2) <= 0) {
       /* Bottom right test in classification tree. */
-      if (tti_above(p1, r1, q2, p1p2) > 0) {
+      if (tti_above(p1, r1, q2, p2) > 0) {
         /* Overlap is [k [i l] j]. */
         if (dbg_level > 0) {
           std::cout << "overlap [k [i l] j]\n";
         }
         /* i is intersect with p1r1. l is intersect with p2r2. */
-        intersect_1 = tti_interp(p1, r1, p2, n2);
-        intersect_2 = tti_interp(p2, r2, p1, n1);
+        intersect_1 = tti_interp(p1->co_exact, r1->co_exact, p2->co_exact, n2);
+        intersect_2 = tti_interp(p2->co_exact, r2->co_exact, p1->co_exact, n1);
       }
       else {
         /* Overlap is [i [k l] j]. */
@@ -1729,8 +1671,8 @@ static ITT_value itt_canon2(const mpq3 &p1,
           std::cout << "overlap [i [k l] j]\n";
         }
         /* k is intersect with p2q2. l is intersect is p2r2. */
-        intersect_1 = tti_interp(p2, q2, p1, n1);
-        intersect_2 = tti_interp(p2, r2, p1, n1);
+        intersect_1 = tti_interp(p2->co_exact, q2->co_exact, p1->co_exact, n1);
+        intersect_2 = tti_interp(p2->co_exact, r2->co_exact, p1->co_exact, n1);
       }
     }
     else {
@@ -1743,7 +1685,7 @@ static ITT_value itt_canon2(const mpq3 &p1,
   }
   else {
     /* Middle left test in classification tree. */
-    if (tti_above(p1, q1, q2, p1p2) < 0) {
+    if (tti_above(p1, q1, q2, p2) < 0) {
       /* No overlap: [i j] [k l]. */
       if (dbg_level > 0) {
         std::cout << "no overlap: [i j] [k l]\n";
@@ -1752,14 +1694,14 @@ static ITT_value itt_canon2(const mpq3 &p1,
     }
     else {
       /* Bottom left test in classification tree. */
-      if (tti_above(p1, r1, q2, p1p2) >= 0) {
+      if (tti_above(p1, r1, q2, p2) >= 0) {
         /* Overlap is [k [i j] l]. */
         if (dbg_level > 0) {
           std::cout << "overlap [k [i j] l]\n";
         }
         /* i is intersect with p1r1. j is intersect with p1q1. */
-        intersect_1 = tti_interp(p1, r1, p2, n2);
-        intersect_2 = tti_interp(p1, q1, p2, n2);
+        intersect_1 = tti_interp(p1->co_exact, r1->co_exact, p2->co_exact, n2);
+        intersect_2 = tti_interp(p1->co_exact, q1->co_exact, p2->co_exact, n2);
       }
       else {
         /* Overlap is [i [k j] l]. */
@@ -1767,8 +1709,8 @@ static ITT_value itt_canon2(const mpq3 &p1,
           std::cout << "overlap [i [k j] l]\n";
         }
         /* k is intersect with p2q2. j is intersect with p1q1. */
-        intersect_1 = tti_interp(p2, q2, p1, n1);
-        intersect_2 = tti_interp(p1, q1, p2, n2);
+        intersect_1 = tti_interp(p2->co_exact, q2->co_exact, p1->co_exact, n1);
+        intersect_2 = tti_interp(p1->co_exact, q1->co_exact, p2->co_exact, n2);
       }
     }
   }
@@ -1789,12 +1731,12 @@ static ITT_value itt_canon2(const mpq3 &p1,
 
 /* Helper function for intersect_tri_tri. Args have been canonicalized for triangle 1. */
 
-static ITT_value itt_canon1(const mpq3 &p1,
-                            const mpq3 &q1,
-                            const mpq3 &r1,
-                            const mpq3 &p2,
-                            const mpq3 &q2,
-                            const mpq3 &r2,
+static ITT_value itt_canon1(const Vert *p1,
+                            const Vert *q1,
+                            const Vert *r1,
+                            const Vert *p2,
+                            const Vert *q2,
+                            const Vert *r2,
                             const mpq3 &n1,
                             const mpq3 &n2,
                             int sp2,
@@ -1983,49 +1925,49 @@ static ITT_value intersect_tri_tri(const IMesh &tm, int t1, int t2)
   ITT_value ans;
   if (sp1 > 0) {
     if (sq1 > 0) {
-      ans = itt_canon1(r1, p1, q1, p2, r2, q2, n1, n2, sp2, sr2, sq2);
+      ans = itt_canon1(vr1, vp1, vq1, vp2, vr2, vq2, n1, n2, sp2, sr2, sq2);
     }
     else if (sr1 > 0) {
-      ans = itt_canon1(q1, r1, p1, p2, r2, q2, n1, n2, sp2, sr2, sq2);
+      ans = itt_canon1(vq1, vr1, vp1, vp2, vr2, vq2, n1, n2, sp2, sr2, sq2);
     }
     else {
-      ans = itt_canon1(p1, q1, r1, p2, q2, r2, n1, n2, sp2, sq2, sr2);
+      ans = itt_canon1(vp1, vq1, vr1, vp2, vq2, vr2, n1, n2, sp2, sq2, sr2);
     }
   }
   else if (sp1 < 0) {
     if (sq1 < 0) {
-      ans = itt_canon1(r1, p1, q1, p2, q2, r2, n1, n2, sp2, sq2, sr2);
+      ans = itt_canon1(vr1, vp1, vq1, vp2, vq2, vr2, n1, n2, sp2, sq2, sr2);
     }
     else if (sr1 < 0) {
-      ans = itt_canon1(q1, r1, p1, p2, q2, r2, n1, n2, sp2, sq2, sr2);
+      ans = itt_canon1(vq1, vr1, vp1, vp2, vq2, vr2, n1, n2, sp2, sq2, sr2);
     }
     else {
-      ans = itt_canon1(p1, q1, r1, p2, r2, q2, n1, n2, sp2, sr2, sq2);
+      ans = itt_canon1(vp1, vq1, vr1, vp2, vr2, vq2, n1, n2, sp2, sr2, sq2);
     }
   }
   else {
     if (sq1 < 0) {
       if (sr1 >= 0) {
-        ans = itt_canon1(q1, r1, p1, p2, r2, q2, n1, n2, sp2, sr2, sq2);
+        ans = itt_canon1(vq1, vr1, vp1, vp2, vr2, vq2, n1, n2, sp2, sr2, sq2);
       }
       else {
-        ans = itt_canon1(p1, q1, r1, p2, q2, r2, n1, n2, sp2, sq2, sr2);
+        ans = itt_canon1(vp1, vq1, vr1, vp2, vq2, vr2, n1, n2, sp2, sq2, sr2);
       }
     }
     else if (sq1 > 0) {
       if (sr1 > 0) {
-        ans = itt_canon1(p1, q1, r1, p2, r2, q2, n1, n2, sp2, sr2, sq2);
+        ans = itt_canon1(vp1, vq1, vr1, vp2, vr2, vq2, n1, n2, sp2, sr2, sq2);
       }
       else {
-        ans = itt_canon1(q1, r1, p1, p2, q2, r2, n1, n2, sp2, sq2, sr2);
+        ans = itt_canon1(vq1, vr1, vp1, vp2, vq2, vr2, n1, n2, sp2, sq2, sr2);
       }
     }
     else {
       if (sr1 > 0) {
-        ans = itt_canon1(r1, p1, q1, p2, q2, r2, n1, n2, sp2, sq2, sr2);
+        ans = itt_canon1(vr1, vp1, vq1, vp2, vq2, vr2, n1, n2, sp2, sq2, sr2);
       }
       else if (sr1 < 0) {
-        ans = itt_canon1(r1, p1, q1, p2, r2, q2, n1, n2, sp2, sr2, sq2);
+        ans = itt_canon1(vr1, vp1, vq1, vp2, vr2, vq2, n1, n2, sp2, sr2, sq2);
       }
       else {
         if (dbg_level > 0) {
@@ -3015,6 +2957,33 @@ static IMesh remove_degenerate_tris(const IMesh &tm_in)
   return ans;
 }
 
+/* Data and functions to calculate the exact planes of overlapping triangles in parallel. */
+struct PlaneData {
+  const IMesh &tm;
+  const TriOverlaps &tri_ov;
+};
+
+static void populate_plane_range_func(void *__restrict userdata,
+                                      const int iter,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  PlaneData *data = static_cast<PlaneData *>(userdata);
+  if (data->tri_ov.first_overlap_index(iter) != -1) {
+    data->tm.face(iter)->populate_plane(true);
+  }
+}
+
+/* Only the triangles which overlap others need exact planes, for #intersect_tri_tri. */
+static void populate_overlapping_planes(const IMesh &tm, const TriOverlaps &tri_ov)
+{
+  PlaneData data = {tm, tri_ov};
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1000;
+  settings.use_threading = intersect_use_threading;
+  BLI_task_parallel_range(0, tm.face_size(), &data, populate_plane_range_func, &settings);
+}
+
 /* This is the main routine for calculating the self_intersection of a triangle mesh. */
 IMesh trimesh_self_intersect(const IMesh &tm_in, IMeshArena *arena)
 {
@@ -3077,11 +3046,7 @@ IMesh trimesh_nary_intersect(const IMesh &tm_in,
   double overlap_time = PIL_check_seconds_timer();
   std::cout << "intersect overlaps calculated, time = " << overlap_time - bb_calc_time << "\n";
 #  endif
-  for (int t : tm_clean->face_index_range()) {
-    if (tri_ov.first_overlap_index(t) != -1) {
-      tm_clean->face(t)->populate_plane(true);
-    }
-  }
+  populate_overlapping_planes(*tm_clean, tri_ov);
 #  ifdef PERFDEBUG
   double plane_populate = PIL_check_seconds_timer();
   std::cout << "planes populated, time = " << plane_populate - overlap_time << "\n";
@@ -3276,6 +3241,10 @@ static void perfdata_init(void)
   perfdata->count.append(0);
   perfdata->count_name.append("final non-NONE intersects");
 
+  /* count 5. */
+  perfdata->count.append(0);
+  perfdata->count_name.append("tri tri orientation tests decided by filter");
+
   /* max 0. */
   perfdata->max.append(0);
   perfdata->max_name.append("total faces");
@@ -384,6 +384,48 @@ TEST(array_store, DoubleDiff)
   BLI_array_store_destroy(bs);
 }
 
+static void array_store_diff_fn(void *user_data,
+                                size_t offset,
+                                const void *data,
+                                size_t data_len)
+{
+  /* Copy changed chunks over the (expanded) other state. */
+  memcpy((char *)user_data + offset, data, data_len);
+}
+
+TEST(array_store, StateDifference)
+{
+  const int items_len = 1024;
+  BArrayStore *bs = BLI_array_store_create(sizeof(int), 32);
+  int *data = (int *)MEM_mallocN(sizeof(int) * items_len, __func__);
+  for (int i = 0; i < items_len; i++) {
+    data[i] = i;
+  }
+  const size_t data_len = sizeof(int) * items_len;
+  BArrayState *state_a = BLI_array_store_state_add(bs, data, data_len, NULL);
+  BArrayState *state_b = BLI_array_store_state_add(bs, data, data_len, state_a);
+  EXPECT_EQ(BLI_array_store_state_foreach_difference(state_b, state_a, NULL, NULL), 0);
+
+  data[10] = -1;
+  data[700] = -1;
+  BArrayState *state_c = BLI_array_store_state_add(bs, data, data_len, state_b);
+  const size_t diff_len = BLI_array_store_state_foreach_difference(state_c, state_b, NULL, NULL);
+  EXPECT_GT(diff_len, 0);
+  EXPECT_LT(diff_len, data_len);
+
+  /* Applying the difference to the previous state gives the new state. */
+  size_t data_dst_len;
+  int *data_dst = (int *)BLI_array_store_state_data_get_alloc(state_b, &data_dst_len);
+  EXPECT_EQ(BLI_array_store_state_foreach_difference(
+                state_c, state_b, array_store_diff_fn, data_dst),
+            diff_len);
+  EXPECT_EQ(memcmp(data, data_dst, data_len), 0);
+
+  MEM_freeN(data_dst);
+  MEM_freeN(data);
+  BLI_array_store_destroy(bs);
+}
+
 TEST(array_store, TextMixed)
 {
   TESTBUFFER_STRINGS(1, 4, "", );
@@ -0,0 +1,124 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <stdio.h>
+
+#ifdef WIN32
+#  include <io.h>
+#else
+#  include <unistd.h>
+#endif
+
+#include "zlib.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_fileops.h"
+#include "BLI_gzip_blocks.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+/* Compressible, but not trivially so. */
+static uchar *gzip_blocks_test_data(const size_t data_len)
+{
+  uchar *data = (uchar *)MEM_mallocN(MAX2(data_len, (size_t)1), __func__);
+  uint seed = 1;
+  for (size_t i = 0; i < data_len; i++) {
+    seed = seed * 1103515245 + 12345;
+    data[i] = (uchar)((seed >> 16) % 7);
+  }
+  return data;
+}
+
+static void gzip_blocks_write(FILE *file, const uchar *data, const size_t data_len)
+{
+  GzipBlockWriter *writer = BLI_gzip_block_writer_new(fileno(file), 1, 4096);
+  /* Write in uneven pieces, to cross block boundaries in all possible ways. */
+  size_t offset = 0;
+  while (offset < data_len) {
+    const size_t len = MIN2(data_len - offset, 1 + (offset * 7) % 9000);
+    EXPECT_TRUE(BLI_gzip_block_writer_write(writer, data + offset, len));
+    offset += len;
+  }
+  EXPECT_TRUE(BLI_gzip_block_writer_free(writer));
+  fflush(file);
+}
+
+static void gzip_blocks_roundtrip_test(const size_t data_len)
+{
+  BLI_threadapi_init();
+
+  uchar *data = gzip_blocks_test_data(data_len);
+  uchar *data_read = (uchar *)MEM_mallocN(data_len + 16, __func__);
+
+  FILE *file = tmpfile();
+  ASSERT_NE(file, nullptr);
+  gzip_blocks_write(file, data, data_len);
+
+  /* Regular gzip readers must be able to read the stream too. */
+  BLI_lseek(fileno(file), 0, SEEK_SET);
+  gzFile gzfile = gzdopen(dup(fileno(file)), "rb");
+  EXPECT_EQ(gzread(gzfile, data_read, (uint)data_len + 16), (int)data_len);
+  EXPECT_EQ(memcmp(data, data_read, data_len), 0);
+  gzclose(gzfile);
+
+  GzipBlockReader *reader = BLI_gzip_block_reader_new(fileno(file));
+  ASSERT_NE(reader, nullptr);
+  EXPECT_EQ(BLI_gzip_block_reader_size(reader), data_len);
+
+  memset(data_read, 0, data_len);
+  EXPECT_EQ(BLI_gzip_block_reader_read(reader, data_read, data_len + 16), (int64_t)data_len);
+  EXPECT_EQ(memcmp(data, data_read, data_len), 0);
+
+  /* Random access. */
+  for (int i = 0; i < 100 && data_len > 0; i++) {
+    const size_t offset = ((size_t)i * 7919 * 131) % data_len;
+    const size_t len = MIN2(data_len - offset, (size_t)5000);
+    EXPECT_EQ(BLI_gzip_block_reader_seek(reader, (int64_t)offset, SEEK_SET), (int64_t)offset);
+    EXPECT_EQ(BLI_gzip_block_reader_read(reader, data_read, len), (int64_t)len);
+    EXPECT_EQ(memcmp(data + offset, data_read, len), 0);
+  }
+  EXPECT_EQ(BLI_gzip_block_reader_seek(reader, (int64_t)data_len + 1, SEEK_SET), -1);
+
+  BLI_gzip_block_reader_free(reader);
+  fclose(file);
+
+  MEM_freeN(data);
+  MEM_freeN(data_read);
+
+  BLI_threadapi_exit();
+}
+
+TEST(gzip_blocks, Empty)
+{
+  gzip_blocks_roundtrip_test(0);
+}
+
+TEST(gzip_blocks, SingleBlock)
+{
+  gzip_blocks_roundtrip_test(1000);
+}
+
+TEST(gzip_blocks, ManyBlocks)
+{
+  gzip_blocks_roundtrip_test((5 << 20) + 123);
+}
+
+/* More blocks than fit into a single index member. */
+TEST(gzip_blocks, MultipleIndexMembers)
+{
+  gzip_blocks_roundtrip_test(8191 * 4096 + 7);
+}
+
+TEST(gzip_blocks, RegularGzipHasNoIndex)
+{
+  FILE *file = tmpfile();
+  ASSERT_NE(file, nullptr);
+  gzFile gzfile = gzdopen(dup(fileno(file)), "wb");
+  gzwrite(gzfile, "BLENDER", 7);
+  gzclose(gzfile);
+
+  EXPECT_EQ(BLI_gzip_block_reader_new(fileno(file)), nullptr);
+  fclose(file);
+}
@@ -8,6 +8,7 @@
 
 #include "BLI_compiler_attrs.h"
 #include "BLI_kdopbvh.h"
+#include "BLI_math_geom.h"
 #include "BLI_math_vector.h"
 #include "BLI_rand.h"
 
@@ -66,11 +67,16 @@ static void optimal_check_callback(void *userdata,
  * Note that a small epsilon is added to the BVH nodes bounds, even if we pass in zero.
  * Use rounding to ensure very close nodes don't cause the wrong node to be found as nearest.
  */
-static void find_nearest_points_test(
-    int points_len, float scale, int round, int random_seed, bool optimal = false)
+static void find_nearest_points_test(int points_len,
+                                    float scale,
+                                    int round,
+                                    int random_seed,
+                                    bool optimal = false,
+                                    int tree_type = 8,
+                                    int build_flag = 0)
 {
   struct RNG *rng = BLI_rng_new(random_seed);
-  BVHTree *tree = BLI_bvhtree_new(points_len, 0.0, 8, 8);
+  BVHTree *tree = BLI_bvhtree_new_ex(points_len, 0.0, tree_type, 8, build_flag);
 
   void *mem = MEM_mallocN(sizeof(float[3]) * points_len, __func__);
   float(*points)[3] = (float(*)[3])mem;
@@ -132,3 +138,124 @@ TEST(kdopbvh, OptimalFindNearest_500)
 {
   find_nearest_points_test(500, 1.0, 1000, 12, true);
 }
+
+TEST(kdopbvh, SAHFindNearest_500)
+{
+  find_nearest_points_test(500, 1.0, 1000, 12, false, 8, BVH_BUILD_SAH);
+}
+TEST(kdopbvh, SAHOptimalFindNearest_500)
+{
+  find_nearest_points_test(500, 1.0, 1000, 12, true, 8, BVH_BUILD_SAH);
+}
+TEST(kdopbvh, FlatFindNearest_1)
+{
+  find_nearest_points_test(1, 1.0, 1000, 1234, false, 4, BVH_BUILD_FLAT);
+}
+TEST(kdopbvh, FlatFindNearest_500)
+{
+  find_nearest_points_test(500, 1.0, 1000, 12, false, 4, BVH_BUILD_FLAT);
+}
+TEST(kdopbvh, SAHFlatFindNearest_500)
+{
+  find_nearest_points_test(500, 1.0, 1000, 12, false, 2, BVH_BUILD_SAH | BVH_BUILD_FLAT);
+}
+TEST(kdopbvh, SAHFlatFindNearest_5000)
+{
+  find_nearest_points_test(5000, 1.0, 1000, 12, false, 4, BVH_BUILD_SAH | BVH_BUILD_FLAT);
+}
+
+static void raycast_tris_callback(void *userdata,
+                                  int index,
+                                  const BVHTreeRay *ray,
+                                  BVHTreeRayHit *hit)
+{
+  const float(*tris)[3][3] = (const float(*)[3][3])userdata;
+  float dist;
+  if (isect_ray_tri_v3(ray->origin, ray->direction, UNPACK3(tris[index]), &dist, NULL) &&
+      dist < hit->dist) {
+    hit->index = index;
+    hit->dist = dist;
+  }
+}
+
+/**
+ * Cast rays at random triangles, checking the hits match a tree built without \a build_flag,
+ * also after moving the triangles and updating the tree.
+ */
+static void raycast_tris_test(int tris_len, int tree_type, int build_flag, int random_seed)
+{
+  struct RNG *rng = BLI_rng_new(random_seed);
+  BVHTree *tree_ref = BLI_bvhtree_new(tris_len, 0.0f, tree_type, 6);
+  BVHTree *tree = BLI_bvhtree_new_ex(tris_len, 0.0f, tree_type, 6, build_flag);
+
+  void *mem = MEM_mallocN(sizeof(float[3][3]) * tris_len, __func__);
+  float(*tris)[3][3] = (float(*)[3][3])mem;
+
+  for (int i = 0; i < tris_len; i++) {
+    float center[3], offset[3];
+    rng_v3_round(center, 3, rng, 1000, 10.0f);
+    for (int j = 0; j < 3; j++) {
+      rng_v3_round(offset, 3, rng, 1000, 0.2f);
+      add_v3_v3v3(tris[i][j], center, offset);
+    }
+    BLI_bvhtree_insert(tree_ref, i, tris[i][0], 3);
+    BLI_bvhtree_insert(tree, i, tris[i][0], 3);
+  }
+  BLI_bvhtree_balance(tree_ref);
+  BLI_bvhtree_balance(tree);
+
+  for (int pass = 0; pass < 2; pass++) {
+    if (pass == 1) {
+      for (int i = 0; i < tris_len; i++) {
+        for (int j = 0; j < 3; j++) {
+          tris[i][j][2] += (float)(i % 7);
+        }
+        BLI_bvhtree_update_node(tree_ref, i, tris[i][0], NULL, 3);
+        BLI_bvhtree_update_node(tree, i, tris[i][0], NULL, 3);
+      }
+      BLI_bvhtree_update_tree(tree_ref);
+      BLI_bvhtree_update_tree(tree);
+    }
+
+    for (int i = 0; i < 1000; i++) {
+      float co[3], dir[3];
+      rng_v3_round(co, 3, rng, 1000, 15.0f);
+      rng_v3_round(dir, 3, rng, 1000, 1.0f);
+      if (normalize_v3(dir) == 0.0f) {
+        continue;
+      }
+
+      BVHTreeRayHit hit_ref = {-1}, hit = {-1};
+      hit_ref.dist = hit.dist = BVH_RAYCAST_DIST_MAX;
+      BLI_bvhtree_ray_cast(tree_ref, co, dir, 0.0f, &hit_ref, raycast_tris_callback, tris);
+      BLI_bvhtree_ray_cast(tree, co, dir, 0.0f, &hit, raycast_tris_callback, tris);
+
+      EXPECT_EQ(hit_ref.index, hit.index);
+      if (hit_ref.index != -1) {
+        EXPECT_FLOAT_EQ(hit_ref.dist, hit.dist);
+      }
+    }
+  }
+
+  BLI_bvhtree_free(tree_ref);
+  BLI_bvhtree_free(tree);
+  BLI_rng_free(rng);
+  MEM_freeN(tris);
+}
+
+TEST(kdopbvh, SAHRayCast_1)
+{
+  raycast_tris_test(1, 4, BVH_BUILD_SAH, 10);
+}
+TEST(kdopbvh, SAHRayCast_2000)
+{
+  raycast_tris_test(2000, 2, BVH_BUILD_SAH, 10);
+}
+TEST(kdopbvh, FlatRayCast_2000)
+{
+  raycast_tris_test(2000, 4, BVH_BUILD_FLAT, 11);
+}
+TEST(kdopbvh, SAHFlatRayCast_2000)
+{
+  raycast_tris_test(2000, 4, BVH_BUILD_SAH | BVH_BUILD_FLAT, 12);
+}
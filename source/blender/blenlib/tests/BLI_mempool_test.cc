@@ -0,0 +1,136 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_mempool.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#define NUM_ITEMS 10000
+
+TEST(mempool, AllocFree)
+{
+  BLI_mempool *pool = BLI_mempool_create(sizeof(int), 0, 32, BLI_MEMPOOL_ALLOW_ITER);
+  int *data[NUM_ITEMS];
+
+  for (int i = 0; i < NUM_ITEMS; i++) {
+    data[i] = (int *)BLI_mempool_alloc(pool);
+    *data[i] = i;
+  }
+  EXPECT_EQ(BLI_mempool_len(pool), NUM_ITEMS);
+
+  for (int i = 0; i < NUM_ITEMS; i += 2) {
+    BLI_mempool_free(pool, data[i]);
+  }
+  EXPECT_EQ(BLI_mempool_len(pool), NUM_ITEMS / 2);
+
+  int **table = (int **)BLI_mempool_as_tableN(pool, __func__);
+  for (int i = 0; i < NUM_ITEMS / 2; i++) {
+    EXPECT_EQ(*table[i], i * 2 + 1);
+  }
+  MEM_freeN(table);
+
+  BLI_mempool_clear(pool);
+  EXPECT_EQ(BLI_mempool_len(pool), 0);
+  BLI_mempool_destroy(pool);
+}
+
+/* *** Allocating from multiple threads. *** */
+
+static void mempool_threaded_alloc_func(void *__restrict userdata,
+                                        const int index,
+                                        const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  BLI_mempool *pool = *(BLI_mempool **)userdata;
+  int **data = (int **)userdata + 1;
+  data[index] = (int *)BLI_mempool_alloc(pool);
+  *data[index] = index;
+}
+
+static void mempool_threaded_free_func(void *__restrict userdata,
+                                       const int index,
+                                       const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  BLI_mempool *pool = *(BLI_mempool **)userdata;
+  int **data = (int **)userdata + 1;
+  if (index % 3 == 0) {
+    BLI_mempool_free(pool, data[index]);
+    data[index] = NULL;
+  }
+}
+
+static void mempool_threaded_check(void **userdata, const int num_items)
+{
+  BLI_mempool *pool = (BLI_mempool *)userdata[0];
+  int **data = (int **)userdata + 1;
+
+  /* Every element has to be allocated once, so no other thread overwrote its value. */
+  int num_used = 0;
+  for (int i = 0; i < NUM_ITEMS; i++) {
+    if (data[i] != NULL) {
+      EXPECT_EQ(*data[i], i);
+      num_used++;
+    }
+  }
+  EXPECT_EQ(num_used, num_items);
+  EXPECT_EQ(BLI_mempool_len(pool), num_items);
+
+  BLI_mempool_iter iter;
+  int num_iter = 0;
+  BLI_mempool_iternew(pool, &iter);
+  while (BLI_mempool_iterstep(&iter)) {
+    num_iter++;
+  }
+  EXPECT_EQ(num_iter, num_items);
+}
+
+static void mempool_threaded_test(const int totelem)
+{
+  void **userdata = (void **)MEM_callocN(sizeof(void *) * (NUM_ITEMS + 1), __func__);
+  BLI_mempool *pool = BLI_mempool_create(
+      sizeof(int), totelem, 32, BLI_MEMPOOL_ALLOW_ITER | BLI_MEMPOOL_ALLOW_THREADS);
+  userdata[0] = pool;
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+
+  BLI_task_parallel_range(0, NUM_ITEMS, userdata, mempool_threaded_alloc_func, &settings);
+  mempool_threaded_check(userdata, NUM_ITEMS);
+
+  /* Free every third element from multiple threads. */
+  BLI_task_parallel_range(0, NUM_ITEMS, userdata, mempool_threaded_free_func, &settings);
+  const int num_freed = (NUM_ITEMS + 2) / 3;
+  mempool_threaded_check(userdata, NUM_ITEMS - num_freed);
+
+  /* Allocate them again from this thread. */
+  for (int i = 0; i < NUM_ITEMS; i += 3) {
+    mempool_threaded_alloc_func(userdata, i, NULL);
+  }
+  mempool_threaded_check(userdata, NUM_ITEMS);
+
+  BLI_mempool_clear(pool);
+  EXPECT_EQ(BLI_mempool_len(pool), 0);
+  BLI_task_parallel_range(0, NUM_ITEMS, userdata, mempool_threaded_alloc_func, &settings);
+  mempool_threaded_check(userdata, NUM_ITEMS);
+
+  BLI_mempool_destroy(pool);
+  MEM_freeN(userdata);
+}
+
+TEST(mempool, ThreadedAlloc)
+{
+  BLI_threadapi_init();
+  mempool_threaded_test(0);
+  BLI_threadapi_exit();
+}
+
+TEST(mempool, ThreadedAllocReserved)
+{
+  BLI_threadapi_init();
+  mempool_threaded_test(NUM_ITEMS / 2);
+  BLI_threadapi_exit();
+}
@@ -907,6 +907,7 @@ static void spheresphere_test(int nrings, double y_offset, bool use_self)
   int num_sphere_verts;
   int num_sphere_tris;
   get_sphere_params(nrings, nsegs, true, &num_sphere_verts, &num_sphere_tris);
+  std::cout << "\nSphereSphere: " << 2 * num_sphere_tris << " triangles\n";
   Array<Face *> tris(2 * num_sphere_tris);
   arena.reserve(2 * num_sphere_verts, 2 * num_sphere_tris);
   double3 center1(0.0, 0.0, 0.0);
@@ -1087,7 +1088,9 @@ static void spheregrid_test(int nrings, int grid_level, double z_offset, bool us
 
 TEST(mesh_intersect_perf, SphereSphere)
 {
-  spheresphere_test(512, 0.5, false);
+  /* About 200k and 1M triangles. */
+  spheresphere_test(160, 0.5, false);
+  spheresphere_test(360, 0.5, false);
 }
 
 TEST(mesh_intersect_perf, SphereGrid)
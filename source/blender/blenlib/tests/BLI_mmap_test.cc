@@ -0,0 +1,33 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <stdio.h>
+
+#include "BLI_mmap.h"
+#include "BLI_utildefines.h"
+
+TEST(mmap, ReadAndPointer)
+{
+  FILE *file = tmpfile();
+  ASSERT_NE(file, nullptr);
+  const char data[] = "BLENDER-v291 memory mapped";
+  fwrite(data, 1, sizeof(data), file);
+  fflush(file);
+
+  BLI_mmap_file *mmap_file = BLI_mmap_open(fileno(file));
+  ASSERT_NE(mmap_file, nullptr);
+  EXPECT_EQ(BLI_mmap_get_length(mmap_file), sizeof(data));
+  EXPECT_EQ(memcmp(BLI_mmap_get_pointer(mmap_file), data, sizeof(data)), 0);
+
+  char buffer[8];
+  EXPECT_TRUE(BLI_mmap_read(mmap_file, buffer, 13, 6));
+  EXPECT_EQ(memcmp(buffer, "memory", 6), 0);
+
+  /* Reading past the end fails, without being an IO error. */
+  EXPECT_FALSE(BLI_mmap_read(mmap_file, buffer, sizeof(data) - 2, 4));
+  EXPECT_FALSE(BLI_mmap_any_io_error(mmap_file));
+
+  BLI_mmap_free(mmap_file);
+  fclose(file);
+}
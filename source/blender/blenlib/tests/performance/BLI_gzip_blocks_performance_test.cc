@@ -0,0 +1,144 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <stdio.h>
+
+#ifdef WIN32
+#  include <io.h>
+#else
+#  include <unistd.h>
+#endif
+
+#include "zlib.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_fileops.h"
+#include "BLI_gzip_blocks.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include "PIL_time.h"
+
+/* Optionally benchmark using a real (uncompressed) .blend file. */
+#if 0
+#  define BLEND_FILE_PATH "/path/to/uncompressed.blend"
+#endif
+
+#define DATA_SIZE_DEFAULT (256 << 20)
+/* Size of the pieces written at once, similar to `writefile.c`. */
+#define WRITE_CHUNK_SIZE (1 << 17)
+
+static uchar *gzip_perf_data(size_t *r_data_len)
+{
+#ifdef BLEND_FILE_PATH
+  size_t data_len = 0;
+  uchar *data = (uchar *)BLI_file_read_binary_as_mem(BLEND_FILE_PATH, 0, &data_len);
+  if (data != NULL) {
+    *r_data_len = data_len;
+    return data;
+  }
+#endif
+  /* Mix of repeated structures and noise, roughly similar to mesh data. */
+  const size_t data_len = DATA_SIZE_DEFAULT;
+  uchar *data = (uchar *)MEM_mallocN(data_len, __func__);
+  uint seed = 1;
+  for (size_t i = 0; i < data_len; i += 4) {
+    seed = seed * 1103515245 + 12345;
+    const float value = (float)(i % 4096) + (float)((seed >> 16) & 0xff) / 256.0f;
+    memcpy(data + i, &value, 4);
+  }
+  *r_data_len = data_len;
+  return data;
+}
+
+static size_t gzip_perf_file_size(FILE *file)
+{
+  fflush(file);
+  return BLI_file_descriptor_size(fileno(file));
+}
+
+TEST(gzip_blocks, CompareToGzip)
+{
+  BLI_threadapi_init();
+
+  size_t data_len;
+  uchar *data = gzip_perf_data(&data_len);
+  uchar *data_read = (uchar *)MEM_mallocN(data_len, __func__);
+
+  printf("\n========== STARTING gzip blocks (%d threads, %.1f MB) ==========\n",
+         BLI_system_thread_count(),
+         (double)data_len / (1 << 20));
+
+  /* Regular gzip stream, as written by `writefile.c` before. */
+  {
+    FILE *file = tmpfile();
+    double time = PIL_check_seconds_timer();
+    gzFile gzfile = gzdopen(dup(fileno(file)), "wb1");
+    for (size_t offset = 0; offset < data_len; offset += WRITE_CHUNK_SIZE) {
+      gzwrite(gzfile, data + offset, (uint)MIN2((size_t)WRITE_CHUNK_SIZE, data_len - offset));
+    }
+    gzclose(gzfile);
+    const double time_write = PIL_check_seconds_timer() - time;
+    const size_t file_size = gzip_perf_file_size(file);
+
+    BLI_lseek(fileno(file), 0, SEEK_SET);
+    time = PIL_check_seconds_timer();
+    gzfile = gzdopen(dup(fileno(file)), "rb");
+    size_t read_len = 0;
+    int len;
+    while ((len = gzread(gzfile, data_read + read_len, WRITE_CHUNK_SIZE)) > 0) {
+      read_len += (size_t)len;
+    }
+    gzclose(gzfile);
+    const double time_read = PIL_check_seconds_timer() - time;
+    EXPECT_EQ(read_len, data_len);
+
+    printf("\tgzip:        write %.3fs, read %.3fs, size %.1f%%\n",
+           time_write,
+           time_read,
+           100.0 * (double)file_size / (double)data_len);
+    fclose(file);
+  }
+
+  /* Block gzip stream. */
+  {
+    FILE *file = tmpfile();
+    double time = PIL_check_seconds_timer();
+    GzipBlockWriter *writer = BLI_gzip_block_writer_new(fileno(file), 1, 0);
+    for (size_t offset = 0; offset < data_len; offset += WRITE_CHUNK_SIZE) {
+      BLI_gzip_block_writer_write(
+          writer, data + offset, MIN2((size_t)WRITE_CHUNK_SIZE, data_len - offset));
+    }
+    EXPECT_TRUE(BLI_gzip_block_writer_free(writer));
+    const double time_write = PIL_check_seconds_timer() - time;
+    const size_t file_size = gzip_perf_file_size(file);
+
+    time = PIL_check_seconds_timer();
+    GzipBlockReader *reader = BLI_gzip_block_reader_new(fileno(file));
+    size_t read_len = 0;
+    int64_t len;
+    while ((len = BLI_gzip_block_reader_read(reader, data_read + read_len, WRITE_CHUNK_SIZE)) >
+           0) {
+      read_len += (size_t)len;
+    }
+    BLI_gzip_block_reader_free(reader);
+    const double time_read = PIL_check_seconds_timer() - time;
+    EXPECT_EQ(read_len, data_len);
+    EXPECT_EQ(memcmp(data, data_read, data_len), 0);
+
+    printf("\tgzip blocks: write %.3fs, read %.3fs, size %.1f%%\n",
+           time_write,
+           time_read,
+           100.0 * (double)file_size / (double)data_len);
+    fclose(file);
+  }
+
+  printf("========== ENDED gzip blocks ==========\n\n");
+
+  MEM_freeN(data);
+  MEM_freeN(data_read);
+
+  BLI_threadapi_exit();
+}
@@ -0,0 +1,360 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_float3.hh"
+#include "BLI_kdopbvh.h"
+#include "BLI_math.h"
+#include "BLI_rand.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+#include "BLI_vector.hh"
+
+#include "PIL_time.h"
+
+/* Optionally benchmark using a real mesh, exported as triangulated OBJ file. */
+#if 0
+#  define OBJ_FILE_PATH "/path/to/mesh.obj"
+#endif
+
+/* Same settings as used for triangles in `bvhutils.c`. */
+#define BVH_TREE_TYPE 4
+#define BVH_AXIS 6
+
+#define RAYS_NUM 200000
+#define NEAREST_NUM 50000
+
+struct PerfMesh {
+  const char *name;
+  float (*tris)[3][3];
+  int tris_len;
+};
+
+static void perf_mesh_alloc(PerfMesh *mesh, const char *name, int tris_len)
+{
+  mesh->name = name;
+  mesh->tris = (float(*)[3][3])MEM_mallocN(sizeof(*mesh->tris) * (size_t)tris_len, __func__);
+  mesh->tris_len = tris_len;
+}
+
+/* Evenly tessellated, displaced grid, similar to a sculpt or landscape. */
+static void perf_mesh_terrain(PerfMesh *mesh, const int res)
+{
+  perf_mesh_alloc(mesh, "terrain", res * res * 2);
+  float(*tri)[3] = mesh->tris[0];
+  for (int y = 0; y < res; y++) {
+    for (int x = 0; x < res; x++) {
+      float co[4][3];
+      for (int i = 0; i < 4; i++) {
+        const float u = (float)(x + (i & 1)) / (float)res;
+        const float v = (float)(y + (i >> 1)) / (float)res;
+        co[i][0] = u * 10.0f;
+        co[i][1] = v * 10.0f;
+        co[i][2] = sinf(u * 17.0f) * cosf(v * 13.0f) + 0.2f * sinf(u * v * 91.0f);
+      }
+      copy_v3_v3(tri[0], co[0]);
+      copy_v3_v3(tri[1], co[1]);
+      copy_v3_v3(tri[2], co[3]);
+      tri += 3;
+      copy_v3_v3(tri[0], co[0]);
+      copy_v3_v3(tri[1], co[3]);
+      copy_v3_v3(tri[2], co[2]);
+      tri += 3;
+    }
+  }
+}
+
+/* Dense objects on a ground plane with a few large and long thin triangles,
+ * similar to a scene or an architectural model where triangle sizes differ a lot. */
+static void perf_mesh_scene(PerfMesh *mesh, const int objects_num, const int object_res)
+{
+  const int object_tris = object_res * object_res * 2;
+  const int ground_tris = 2;
+  const int thin_tris = 256;
+  perf_mesh_alloc(mesh, "scene", objects_num * object_tris + ground_tris + thin_tris);
+
+  RNG *rng = BLI_rng_new(5);
+  float(*tri)[3] = mesh->tris[0];
+
+  /* Ground plane. */
+  const float ground[4][3] = {{-50, -50, 0}, {50, -50, 0}, {50, 50, 0}, {-50, 50, 0}};
+  copy_v3_v3(tri[0], ground[0]);
+  copy_v3_v3(tri[1], ground[1]);
+  copy_v3_v3(tri[2], ground[2]);
+  tri += 3;
+  copy_v3_v3(tri[0], ground[0]);
+  copy_v3_v3(tri[1], ground[2]);
+  copy_v3_v3(tri[2], ground[3]);
+  tri += 3;
+
+  /* Long thin triangles, like cables or trims. */
+  for (int i = 0; i < thin_tris; i++) {
+    float start[3], end[3];
+    BLI_rng_get_float_unit_v3(rng, start);
+    BLI_rng_get_float_unit_v3(rng, end);
+    mul_v3_fl(start, 40.0f);
+    mul_v3_fl(end, 40.0f);
+    start[2] = fabsf(start[2]);
+    end[2] = fabsf(end[2]);
+    copy_v3_v3(tri[0], start);
+    copy_v3_v3(tri[1], end);
+    copy_v3_v3(tri[2], end);
+    tri[2][2] += 0.05f;
+    tri += 3;
+  }
+
+  /* UV spheres of different sizes, clustered around a few places. */
+  for (int object = 0; object < objects_num; object++) {
+    float center[3];
+    BLI_rng_get_float_unit_v3(rng, center);
+    mul_v3_fl(center, 5.0f + 30.0f * (float)(object % 4) / 4.0f);
+    center[2] = fabsf(center[2]);
+    const float radius = 0.1f + BLI_rng_get_float(rng);
+
+    for (int y = 0; y < object_res; y++) {
+      for (int x = 0; x < object_res; x++) {
+        float co[4][3];
+        for (int i = 0; i < 4; i++) {
+          const float u = (float)(x + (i & 1)) / (float)object_res * (float)M_PI * 2.0f;
+          const float v = (float)(y + (i >> 1)) / (float)object_res * (float)M_PI;
+          co[i][0] = center[0] + radius * sinf(v) * cosf(u);
+          co[i][1] = center[1] + radius * sinf(v) * sinf(u);
+          co[i][2] = center[2] + radius * cosf(v);
+        }
+        copy_v3_v3(tri[0], co[0]);
+        copy_v3_v3(tri[1], co[1]);
+        copy_v3_v3(tri[2], co[3]);
+        tri += 3;
+        copy_v3_v3(tri[0], co[0]);
+        copy_v3_v3(tri[1], co[3]);
+        copy_v3_v3(tri[2], co[2]);
+        tri += 3;
+      }
+    }
+  }
+
+  BLI_rng_free(rng);
+}
+
+#ifdef OBJ_FILE_PATH
+/* Only vertices and faces are read, faces are triangulated as fans. */
+static bool perf_mesh_obj(PerfMesh *mesh, const char *filepath)
+{
+  FILE *file = fopen(filepath, "r");
+  if (file == NULL) {
+    return false;
+  }
+
+  blender::Vector<blender::float3> verts;
+  blender::Vector<int> tris;
+  char line[4096];
+  while (fgets(line, sizeof(line), file)) {
+    if (line[0] == 'v' && line[1] == ' ') {
+      blender::float3 co;
+      sscanf(line + 2, "%f %f %f", &co.x, &co.y, &co.z);
+      verts.append(co);
+    }
+    else if (line[0] == 'f' && line[1] == ' ') {
+      int face[64], face_len = 0;
+      for (char *token = strtok(line + 2, " \t\r\n"); token && face_len < 64;
+           token = strtok(NULL, " \t\r\n")) {
+        const int index = atoi(token);
+        face[face_len++] = (index < 0) ? (int)verts.size() + index : index - 1;
+      }
+      for (int i = 2; i < face_len; i++) {
+        tris.append(face[0]);
+        tris.append(face[i - 1]);
+        tris.append(face[i]);
+      }
+    }
+  }
+  fclose(file);
+
+  perf_mesh_alloc(mesh, "obj", (int)tris.size() / 3);
+  for (int i = 0; i < mesh->tris_len; i++) {
+    for (int j = 0; j < 3; j++) {
+      copy_v3_v3(mesh->tris[i][j], verts[tris[i * 3 + j]]);
+    }
+  }
+  return mesh->tris_len > 0;
+}
+#endif
+
+static void perf_raycast_callback(void *userdata,
+                                  int index,
+                                  const BVHTreeRay *ray,
+                                  BVHTreeRayHit *hit)
+{
+  const PerfMesh *mesh = (const PerfMesh *)userdata;
+  float dist;
+  if (isect_ray_tri_watertight_v3(
+          ray->origin, ray->isect_precalc, UNPACK3(mesh->tris[index]), &dist, NULL) &&
+      dist < hit->dist) {
+    hit->index = index;
+    hit->dist = dist;
+  }
+}
+
+static void perf_nearest_callback(void *userdata,
+                                  int index,
+                                  const float co[3],
+                                  BVHTreeNearest *nearest)
+{
+  const PerfMesh *mesh = (const PerfMesh *)userdata;
+  float nearest_tmp[3];
+  closest_on_tri_to_point_v3(nearest_tmp, co, UNPACK3(mesh->tris[index]));
+  const float dist_sq = len_squared_v3v3(co, nearest_tmp);
+  if (dist_sq < nearest->dist_sq) {
+    nearest->index = index;
+    nearest->dist_sq = dist_sq;
+    copy_v3_v3(nearest->co, nearest_tmp);
+  }
+}
+
+static void perf_mesh_bounds(const PerfMesh *mesh, float r_min[3], float r_max[3])
+{
+  INIT_MINMAX(r_min, r_max);
+  for (int i = 0; i < mesh->tris_len; i++) {
+    for (int j = 0; j < 3; j++) {
+      minmax_v3v3_v3(r_min, r_max, mesh->tris[i][j]);
+    }
+  }
+}
+
+static void perf_random_point(RNG *rng, const float min[3], const float max[3], float r_co[3])
+{
+  for (int i = 0; i < 3; i++) {
+    r_co[i] = min[i] + (max[i] - min[i]) * BLI_rng_get_float(rng);
+  }
+}
+
+static void perf_mesh_test(PerfMesh *mesh)
+{
+  const struct {
+    const char *name;
+    int flag;
+  } modes[] = {
+      {"median", 0},
+      {"median flat", BVH_BUILD_FLAT},
+      {"sah", BVH_BUILD_SAH},
+      {"sah flat", BVH_BUILD_SAH | BVH_BUILD_FLAT},
+  };
+
+  float min[3], max[3], center[3];
+  perf_mesh_bounds(mesh, min, max);
+  mid_v3_v3v3(center, min, max);
+  const float radius = len_v3v3(min, max) * 0.5f;
+
+  printf("\n========== STARTING %s (%d triangles) ==========\n", mesh->name, mesh->tris_len);
+
+  int ref_hits = -1;
+  float ref_dist_sum = 0.0f;
+
+  for (int mode = 0; mode < (int)ARRAY_SIZE(modes); mode++) {
+    double time = PIL_check_seconds_timer();
+    BVHTree *tree = BLI_bvhtree_new_ex(
+        mesh->tris_len, 0.0f, BVH_TREE_TYPE, BVH_AXIS, modes[mode].flag);
+    for (int i = 0; i < mesh->tris_len; i++) {
+      BLI_bvhtree_insert(tree, i, mesh->tris[i][0], 3);
+    }
+    BLI_bvhtree_balance(tree);
+    const double time_build = PIL_check_seconds_timer() - time;
+
+    /* Rays from outside the mesh towards random points inside its bounds. */
+    RNG *rng = BLI_rng_new(1);
+    int hits = 0;
+    time = PIL_check_seconds_timer();
+    for (int i = 0; i < RAYS_NUM; i++) {
+      float co[3], target[3], dir[3];
+      BLI_rng_get_float_unit_v3(rng, co);
+      madd_v3_v3v3fl(co, center, co, radius * 1.5f);
+      perf_random_point(rng, min, max, target);
+      sub_v3_v3v3(dir, target, co);
+      normalize_v3(dir);
+
+      BVHTreeRayHit hit;
+      hit.index = -1;
+      hit.dist = BVH_RAYCAST_DIST_MAX;
+      if (BLI_bvhtree_ray_cast(tree, co, dir, 0.0f, &hit, perf_raycast_callback, mesh) != -1) {
+        hits++;
+      }
+    }
+    const double time_raycast = PIL_check_seconds_timer() - time;
+
+    /* Points close to the surface. */
+    float dist_sum = 0.0f;
+    time = PIL_check_seconds_timer();
+    for (int i = 0; i < NEAREST_NUM; i++) {
+      float co[3], offset[3];
+      const int tri = (int)(BLI_rng_get_uint(rng) % (uint)mesh->tris_len);
+      mid_v3_v3v3v3(co, UNPACK3(mesh->tris[tri]));
+      BLI_rng_get_float_unit_v3(rng, offset);
+      madd_v3_v3fl(co, offset, radius * 0.01f);
+
+      BVHTreeNearest nearest;
+      nearest.index = -1;
+      nearest.dist_sq = FLT_MAX;
+      BLI_bvhtree_find_nearest(tree, co, &nearest, perf_nearest_callback, mesh);
+      dist_sum += sqrtf(nearest.dist_sq);
+    }
+    const double time_nearest = PIL_check_seconds_timer() - time;
+
+    printf("\t%-12s build %.3fs, ray-cast %.2f M/s, nearest %.2f M/s\n",
+           modes[mode].name,
+           time_build,
+           (double)RAYS_NUM / time_raycast * 1e-6,
+           (double)NEAREST_NUM / time_nearest * 1e-6);
+
+    /* All modes must find the same results. */
+    if (ref_hits == -1) {
+      ref_hits = hits;
+      ref_dist_sum = dist_sum;
+    }
+    else {
+      EXPECT_EQ(hits, ref_hits);
+      EXPECT_NEAR(dist_sum, ref_dist_sum, ref_dist_sum * 1e-4f);
+    }
+
+    BLI_rng_free(rng);
+    BLI_bvhtree_free(tree);
+  }
+
+  printf("========== ENDED %s ==========\n\n", mesh->name);
+
+  MEM_freeN(mesh->tris);
+}
+
+TEST(kdopbvh, Terrain)
+{
+  BLI_threadapi_init();
+  PerfMesh mesh;
+  perf_mesh_terrain(&mesh, 700);
+  perf_mesh_test(&mesh);
+  BLI_threadapi_exit();
+}
+
+TEST(kdopbvh, Scene)
+{
+  BLI_threadapi_init();
+  PerfMesh mesh;
+  perf_mesh_scene(&mesh, 400, 32);
+  perf_mesh_test(&mesh);
+  BLI_threadapi_exit();
+}
+
+#ifdef OBJ_FILE_PATH
+TEST(kdopbvh, OBJ)
+{
+  BLI_threadapi_init();
+  PerfMesh mesh;
+  if (perf_mesh_obj(&mesh, OBJ_FILE_PATH)) {
+    perf_mesh_test(&mesh);
+  }
+  BLI_threadapi_exit();
+}
+#endif
@@ -24,15 +24,18 @@
  * \ingroup blenloader
  */
 
-struct Scene;
 struct GHash;
+struct MemFileChunkStore;
+struct Scene;
 
 typedef struct {
   void *next, *prev;
+  /** Owned by the #MemFileChunkStore, shared by all chunks with the same content. */
   const char *buf;
   /** Size in bytes. */
   size_t size;
-  /** When true, this chunk doesn't own the memory, it's shared with a previous #MemFileChunk */
+  /** When true, this chunk is identical to the matching chunk of the previous #MemFile
+   * (used by undo code to detect unchanged IDs). */
   bool is_identical;
   /** When true, this chunk is also identical to the one in the next step (used by undo code to
    * detect unchanged IDs).
@@ -45,9 +48,24 @@ typedef struct {
 
 typedef struct MemFile {
   ListBase chunks;
+  /** Size of the chunk buffers that were newly allocated for this memfile. */
   size_t size;
+  /** Storage of the chunk buffers, shared with the previous and next undo steps. */
+  struct MemFileChunkStore *store;
 } MemFile;
 
+/** Memory usage of a #MemFileChunkStore, see #BLO_memfile_store_stats_get. */
+typedef struct MemFileStoreStats {
+  /** Number of chunks of all memfiles using the store. */
+  size_t chunks_num;
+  /** Number of distinct buffers stored. */
+  size_t buffers_num;
+  /** Size the memfiles would take without sharing any buffers. */
+  size_t size_chunks;
+  /** Size actually used for the buffers. */
+  size_t size_buffers;
+} MemFileStoreStats;
+
 typedef struct MemFileWriteData {
   MemFile *written_memfile;
   MemFile *reference_memfile;
@@ -78,6 +96,7 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t s
 extern void BLO_memfile_free(MemFile *memfile);
 extern void BLO_memfile_merge(MemFile *first, MemFile *second);
 extern void BLO_memfile_clear_future(MemFile *memfile);
+extern void BLO_memfile_store_stats_get(const MemFile *memfile, MemFileStoreStats *r_stats);
 
 /* utilities */
 extern struct Main *BLO_memfile_main_get(struct MemFile *memfile,
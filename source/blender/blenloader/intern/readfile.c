@@ -103,10 +103,13 @@
 #include "BLI_blenlib.h"
 #include "BLI_endian_switch.h"
 #include "BLI_ghash.h"
+#include "BLI_gzip_blocks.h"
 #include "BLI_linklist.h"
 #include "BLI_math.h"
 #include "BLI_memarena.h"
 #include "BLI_mempool.h"
+#include "BLI_mmap.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 
 #include "BLT_translation.h"
@@ -181,6 +184,8 @@
 
 #include "readfile.h"
 
+#include "PIL_time.h"
+
 #include <errno.h>
 
 /* Make preferences read-only. */
@@ -240,8 +245,9 @@
  * Delay reading blocks we might not use (especially applies to library linking).
  * which keeps large arrays in memory from data-blocks we may not even use.
  *
- * \note This is disabled when using compression,
+ * \note This is disabled when using regular gzip compression,
  * while zlib supports seek it's unusably slow, see: T61880.
+ * Files written in independent blocks (see #BLI_gzip_block_writer_new) support it.
  */
 #define USE_BHEAD_READ_ON_DEMAND
 
@@ -900,7 +906,9 @@ static BHeadN *get_bhead(FileData *fd)
             MEM_freeN(new_bhead);
             new_bhead = NULL;
           }
-          BLI_assert(fd->file_offset == seek_new);
+          else {
+            BLI_assert(fd->file_offset == seek_new);
+          }
         }
         else {
           fd->is_eof = true;
@@ -1034,6 +1042,20 @@ static BHead *blo_bhead_read_full(FileData *fd, BHead *thisblock)
   }
   return &new_bhead_data->bhead;
 }
+
+/**
+ * When the file is memory mapped, access the data of a block that wasn't read yet
+ * directly, instead of reading a copy of it with #blo_bhead_read_full.
+ * Check #BLI_mmap_any_io_error after accessing the data.
+ */
+static const void *blo_bhead_data_mapped(FileData *fd, BHead *thisblock)
+{
+  BHeadN *new_bhead = BHEADN_FROM_BHEAD(thisblock);
+  if ((fd->mmap_file == NULL) || new_bhead->has_data) {
+    return NULL;
+  }
+  return POINTER_OFFSET(BLI_mmap_get_pointer(fd->mmap_file), new_bhead->file_offset);
+}
 #endif /* USE_BHEAD_READ_ON_DEMAND */
 
 /* Warning! Caller's responsibility to ensure given bhead **is** and ID one! */
@@ -1202,6 +1224,53 @@ static off64_t fd_seek_data_from_file(FileData *filedata, off64_t offset, int wh
   return filedata->file_offset;
 }
 
+/* Memory mapped file reading. */
+
+static ssize_t fd_read_from_mmap(FileData *filedata,
+                                 void *buffer,
+                                 size_t size,
+                                 bool *UNUSED(r_is_memchunck_identical))
+{
+  /* Don't read more bytes than there are available in the file. */
+  const size_t file_len = BLI_mmap_get_length(filedata->mmap_file);
+  size_t readsize = (size_t)filedata->file_offset < file_len ?
+                        MIN2(size, file_len - (size_t)filedata->file_offset) :
+                        0;
+
+  if (!BLI_mmap_read(filedata->mmap_file, buffer, (size_t)filedata->file_offset, readsize)) {
+    return EOF;
+  }
+  filedata->file_offset += readsize;
+
+  return (ssize_t)readsize;
+}
+
+static off64_t fd_seek_from_mmap(FileData *filedata, off64_t offset, int whence)
+{
+  const off64_t file_len = (off64_t)BLI_mmap_get_length(filedata->mmap_file);
+  off64_t new_offset;
+
+  switch (whence) {
+    case SEEK_SET:
+      new_offset = offset;
+      break;
+    case SEEK_CUR:
+      new_offset = filedata->file_offset + offset;
+      break;
+    case SEEK_END:
+      new_offset = file_len + offset;
+      break;
+    default:
+      return -1;
+  }
+
+  if (new_offset < 0 || new_offset > file_len) {
+    return -1;
+  }
+  filedata->file_offset = new_offset;
+  return filedata->file_offset;
+}
+
 /* GZip file reading. */
 
 static ssize_t fd_read_gzip_from_file(FileData *filedata,
@@ -1223,6 +1292,31 @@ static ssize_t fd_read_gzip_from_file(FileData *filedata,
   return readsize;
 }
 
+/* Block GZip file reading (decompressed in parallel). */
+
+static ssize_t fd_read_gzip_blocks_from_file(FileData *filedata,
+                                             void *buffer,
+                                             size_t size,
+                                             bool *UNUSED(r_is_memchunck_identical))
+{
+  ssize_t readsize = (ssize_t)BLI_gzip_block_reader_read(filedata->gzblocks, buffer, size);
+
+  if (readsize < 0) {
+    readsize = EOF;
+  }
+  else {
+    filedata->file_offset += readsize;
+  }
+
+  return readsize;
+}
+
+static off64_t fd_seek_gzip_blocks_from_file(FileData *filedata, off64_t offset, int whence)
+{
+  filedata->file_offset = BLI_gzip_block_reader_seek(filedata->gzblocks, offset, whence);
+  return filedata->file_offset;
+}
+
 /* Memory reading. */
 
 static ssize_t fd_read_from_memory(FileData *filedata,
@@ -1368,6 +1462,8 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
   FileDataSeekFn *seek_fn = NULL; /* Optional. */
 
   gzFile gzfile = (gzFile)Z_NULL;
+  GzipBlockReader *gzblocks = NULL;
+  BLI_mmap_file *mmap_file = NULL;
 
   char header[7];
 
@@ -1386,8 +1482,20 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
 
   /* Regular file. */
   if (memcmp(header, "BLENDER", sizeof(header)) == 0) {
-    read_fn = fd_read_data_from_file;
-    seek_fn = fd_seek_data_from_file;
+    /* Opt-in: reading through a memory mapping avoids a system call (and a copy) for every
+     * block, data is read straight from the page cache into its final allocation. */
+    if (U.experimental.use_mmap_file_read) {
+      mmap_file = BLI_mmap_open(file);
+    }
+
+    if (mmap_file != NULL) {
+      read_fn = fd_read_from_mmap;
+      seek_fn = fd_seek_from_mmap;
+    }
+    else {
+      read_fn = fd_read_data_from_file;
+      seek_fn = fd_seek_data_from_file;
+    }
   }
 
   /* Gzip file. */
@@ -1395,20 +1503,28 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
   if ((read_fn == NULL) &&
       /* Check header magic. */
       (header[0] == 0x1f && header[1] == 0x8b)) {
-    gzfile = BLI_gzopen(filepath, "rb");
-    if (gzfile == (gzFile)Z_NULL) {
-      BKE_reportf(reports,
-                  RPT_WARNING,
-                  "Unable to open '%s': %s",
-                  filepath,
-                  errno ? strerror(errno) : TIP_("unknown error reading file"));
-      return NULL;
+    /* Written in independent blocks, these can be decompressed in parallel and seek. */
+    gzblocks = BLI_gzip_block_reader_new(file);
+    if (gzblocks != NULL) {
+      read_fn = fd_read_gzip_blocks_from_file;
+      seek_fn = fd_seek_gzip_blocks_from_file;
     }
+    else {
+      gzfile = BLI_gzopen(filepath, "rb");
+      if (gzfile == (gzFile)Z_NULL) {
+        BKE_reportf(reports,
+                    RPT_WARNING,
+                    "Unable to open '%s': %s",
+                    filepath,
+                    errno ? strerror(errno) : TIP_("unknown error reading file"));
+        return NULL;
+      }
 
-    /* 'seek_fn' is too slow for gzip, don't set it. */
-    read_fn = fd_read_gzip_from_file;
-    /* Caller must close. */
-    file = -1;
+      /* 'seek_fn' is too slow for gzip, don't set it. */
+      read_fn = fd_read_gzip_from_file;
+      /* Caller must close. */
+      file = -1;
+    }
   }
 
   if (read_fn == NULL) {
@@ -1420,6 +1536,8 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
 
   fd->filedes = file;
   fd->gzfiledes = gzfile;
+  fd->gzblocks = gzblocks;
+  fd->mmap_file = mmap_file;
 
   fd->read = read_fn;
   fd->seek = seek_fn;
@@ -1487,20 +1605,26 @@ static ssize_t fd_read_gzip_from_memory(FileData *filedata,
   filedata->strm.next_out = (Bytef *)buffer;
   filedata->strm.avail_out = (uint)size;
 
-  // Inflate another chunk.
-  err = inflate(&filedata->strm, Z_SYNC_FLUSH);
+  while (filedata->strm.avail_out != 0) {
+    // Inflate another chunk.
+    err = inflate(&filedata->strm, Z_SYNC_FLUSH);
 
-  if (err == Z_STREAM_END) {
-    return 0;
-  }
-  if (err != Z_OK) {
-    printf("fd_read_gzip_from_memory: zlib error\n");
-    return 0;
+    if (err == Z_STREAM_END) {
+      /* The stream may consist of multiple gzip members, see #BLI_gzip_block_writer_new. */
+      if (filedata->strm.avail_in == 0 || inflateReset(&filedata->strm) != Z_OK) {
+        break;
+      }
+    }
+    else if (err != Z_OK) {
+      printf("fd_read_gzip_from_memory: zlib error\n");
+      return 0;
+    }
   }
 
-  filedata->file_offset += size;
+  const size_t readsize = size - filedata->strm.avail_out;
+  filedata->file_offset += readsize;
 
-  return (ssize_t)size;
+  return (ssize_t)readsize;
 }
 
 static int fd_read_gzip_from_memory_init(FileData *fd)
@@ -1580,6 +1704,14 @@ void blo_filedata_free(FileData *fd)
       gzclose(fd->gzfiledes);
     }
 
+    if (fd->gzblocks != NULL) {
+      BLI_gzip_block_reader_free(fd->gzblocks);
+    }
+
+    if (fd->mmap_file != NULL) {
+      BLI_mmap_free(fd->mmap_file);
+    }
+
     if (fd->strm.next_in) {
       if (inflateEnd(&fd->strm) != Z_OK) {
         printf("close gzip stream error\n");
@@ -2168,17 +2300,27 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
 
     if (fd->compflags[bh->SDNAnr] != SDNA_CMP_REMOVED) {
       if (fd->compflags[bh->SDNAnr] == SDNA_CMP_NOT_EQUAL) {
+        const void *data = (bh + 1);
 #ifdef USE_BHEAD_READ_ON_DEMAND
         if (BHEADN_FROM_BHEAD(bh)->has_data == false) {
-          bh = blo_bhead_read_full(fd, bh);
-          if (UNLIKELY(bh == NULL)) {
-            fd->flags &= ~FD_FLAGS_FILE_OK;
-            return NULL;
+          data = blo_bhead_data_mapped(fd, bh);
+          if (data == NULL) {
+            bh = blo_bhead_read_full(fd, bh);
+            if (UNLIKELY(bh == NULL)) {
+              fd->flags &= ~FD_FLAGS_FILE_OK;
+              return NULL;
+            }
+            data = (bh + 1);
           }
         }
 #endif
         temp = DNA_struct_reconstruct(
-            fd->memsdna, fd->filesdna, fd->compflags, bh->SDNAnr, bh->nr, (bh + 1));
+            fd->memsdna, fd->filesdna, fd->compflags, bh->SDNAnr, bh->nr, data);
+#ifdef USE_BHEAD_READ_ON_DEMAND
+        if (UNLIKELY(fd->mmap_file && BLI_mmap_any_io_error(fd->mmap_file))) {
+          fd->flags &= ~FD_FLAGS_FILE_OK;
+        }
+#endif
       }
       else {
         /* SDNA_CMP_EQUAL */
@@ -8855,16 +8997,28 @@ static void read_library_clear_weak_links(FileData *basefd, ListBase *mainlist,
 static FileData *read_library_file_data(FileData *basefd,
                                         ListBase *mainlist,
                                         Main *mainl,
-                                        Main *mainptr)
+                                        Main *mainptr,
+                                        FileData *fd_opened)
 {
   FileData *fd = mainptr->curlib->filedata;
 
   if (fd != NULL) {
     /* File already open. */
+    BLI_assert(fd_opened == NULL);
     return fd;
   }
 
-  if (mainptr->curlib->packedfile) {
+  if (fd_opened != NULL) {
+    /* Read file on disk, opened in advance by #read_libraries_open_parallel. */
+    blo_reportf_wrap(basefd->reports,
+                     RPT_INFO,
+                     TIP_("Read library:  '%s', '%s', parent '%s'"),
+                     mainptr->curlib->filepath_abs,
+                     mainptr->curlib->filepath,
+                     library_parent_filepath(mainptr->curlib));
+    fd = fd_opened;
+  }
+  else if (mainptr->curlib->packedfile) {
     /* Read packed file. */
     PackedFile *pf = mainptr->curlib->packedfile;
 
@@ -8929,6 +9083,98 @@ static FileData *read_library_file_data(FileData *basefd,
   return fd;
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Parallel Library Opening
+ *
+ * Opening a library reads the header, DNA and all block headers of the file (decompressing it
+ * entirely when it's compressed). This doesn't depend on any other library, so all libraries
+ * that are going to be read are opened at once using the task scheduler. Reading the linked
+ * data-blocks modifies the shared `mainlist` and is still done one library after another.
+ * \{ */
+
+typedef struct LibraryOpenTask {
+  struct LibraryOpenTask *next, *prev;
+  Main *mainptr;
+  FileData *fd;
+  double time_open;
+} LibraryOpenTask;
+
+static bool read_library_can_open_parallel(Main *mainptr)
+{
+  const Library *lib = mainptr->curlib;
+  /* Missing files are left to #read_library_file_data, which reports them. */
+  return (lib->filedata == NULL) && (lib->packedfile == NULL) && BLI_exists(lib->filepath_abs) &&
+         has_linked_ids_to_read(mainptr);
+}
+
+static void read_library_open_task(TaskPool *__restrict UNUSED(pool), void *taskdata)
+{
+  LibraryOpenTask *task = taskdata;
+  const double time_start = PIL_check_seconds_timer();
+
+  /* Report lists are not thread-safe. In case of failure the library is opened again
+   * by #read_library_file_data, which takes care of reporting the error. */
+  ReportList reports;
+  BKE_reports_init(&reports, RPT_STORE);
+  task->fd = blo_filedata_from_file(task->mainptr->curlib->filepath_abs, &reports);
+  BKE_reports_clear(&reports);
+
+  task->time_open = PIL_check_seconds_timer() - time_start;
+}
+
+/**
+ * Open the files of all libraries that have linked data-blocks to read, in parallel.
+ * The opened libraries are added to \a r_tasks.
+ */
+static void read_libraries_open_parallel(Main *mainl, ListBase *r_tasks)
+{
+  BLI_listbase_clear(r_tasks);
+
+  for (Main *mainptr = mainl->next; mainptr; mainptr = mainptr->next) {
+    if (read_library_can_open_parallel(mainptr)) {
+      LibraryOpenTask *task = MEM_callocN(sizeof(*task), __func__);
+      task->mainptr = mainptr;
+      BLI_addtail(r_tasks, task);
+    }
+  }
+
+  /* Not worth the overhead for a single library. */
+  if (BLI_listbase_count_at_most(r_tasks, 2) < 2) {
+    BLI_freelistN(r_tasks);
+    return;
+  }
+
+  TaskPool *task_pool = BLI_task_pool_create(NULL, TASK_PRIORITY_HIGH);
+  LISTBASE_FOREACH (LibraryOpenTask *, task, r_tasks) {
+    BLI_task_pool_push(task_pool, read_library_open_task, task, false, NULL);
+  }
+  BLI_task_pool_work_and_wait(task_pool);
+  BLI_task_pool_free(task_pool);
+}
+
+static LibraryOpenTask *read_libraries_open_task_find(ListBase *tasks, Main *mainptr)
+{
+  LISTBASE_FOREACH (LibraryOpenTask *, task, tasks) {
+    if (task->mainptr == mainptr) {
+      return task;
+    }
+  }
+  return NULL;
+}
+
+static void read_libraries_open_tasks_free(ListBase *tasks)
+{
+  LISTBASE_FOREACH (LibraryOpenTask *, task, tasks) {
+    /* Only remains set if the library was not read after all. */
+    if (task->fd != NULL) {
+      blo_filedata_free(task->fd);
+    }
+  }
+  BLI_freelistN(tasks);
+}
+
+/** \} */
+
 static void read_libraries(FileData *basefd, ListBase *mainlist)
 {
   Main *mainl = mainlist->first;
@@ -8947,6 +9193,10 @@ static void read_libraries(FileData *basefd, ListBase *mainlist)
   while (do_it) {
     do_it = false;
 
+    /* Open the files of libraries encountered so far in advance. */
+    ListBase open_tasks;
+    read_libraries_open_parallel(mainl, &open_tasks);
+
     /* Loop over mains of all library blend files encountered so far. Note
      * this list gets longer as more indirectly library blends are found. */
     for (Main *mainptr = mainl->next; mainptr; mainptr = mainptr->next) {
@@ -8957,9 +9207,23 @@ static void read_libraries(FileData *basefd, ListBase *mainlist)
           mainptr->curlib->id.name,
           mainptr->curlib->filepath);
 #endif
+        double time_start = PIL_check_seconds_timer();
+        double time_open;
 
         /* Open file if it has not been done yet. */
-        FileData *fd = read_library_file_data(basefd, mainlist, mainl, mainptr);
+        LibraryOpenTask *open_task = read_libraries_open_task_find(&open_tasks, mainptr);
+        FileData *fd;
+        if (open_task != NULL && open_task->fd != NULL) {
+          fd = read_library_file_data(basefd, mainlist, mainl, mainptr, open_task->fd);
+          open_task->fd = NULL;
+          time_open = open_task->time_open;
+        }
+        else {
+          fd = read_library_file_data(basefd, mainlist, mainl, mainptr, NULL);
+          open_task = NULL;
+          time_open = PIL_check_seconds_timer() - time_start;
+        }
+        time_start = PIL_check_seconds_timer();
 
         if (fd) {
           do_it = true;
@@ -8972,8 +9236,18 @@ static void read_libraries(FileData *basefd, ListBase *mainlist)
         /* Test if linked data-locks need to read further linked data-locks
          * and create link placeholders for them. */
         BLO_expand_main(fd, mainptr);
+
+        if (G.debug & G_DEBUG_IO) {
+          printf("Read library '%s': open %.4fs%s, read %.4fs\n",
+                 mainptr->curlib->filepath_abs,
+                 time_open,
+                 (open_task != NULL) ? " (parallel)" : "",
+                 PIL_check_seconds_timer() - time_start);
+        }
       }
     }
+
+    read_libraries_open_tasks_free(&open_tasks);
   }
 
   Main *main_newid = BKE_main_new();
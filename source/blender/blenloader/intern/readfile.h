@@ -97,6 +97,10 @@ typedef struct FileData {
   gzFile gzfiledes;
   /** Gzip stream for memory decompression. */
   z_stream strm;
+  /** Gzip file written in independent blocks, supports seeking. */
+  struct GzipBlockReader *gzblocks;
+  /** Memory mapped regular file, see #UserDef_Experimental.use_mmap_file_read. */
+  struct BLI_mmap_file *mmap_file;
 
   /** Now only in use for library appending. */
   char relabase[FILE_MAX];
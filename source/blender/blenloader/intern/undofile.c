@@ -42,6 +42,7 @@
 
 #include "BLI_blenlib.h"
 #include "BLI_ghash.h"
+#include "BLI_hash_mm2a.h"
 
 #include "BLO_readfile.h"
 #include "BLO_undofile.h"
@@ -52,6 +53,141 @@
 /* keep last */
 #include "BLI_strict_flags.h"
 
+/* -------------------------------------------------------------------- */
+/** \name Chunk Storage
+ *
+ * Chunk buffers are stored once per content and reference counted, so identical chunks are
+ * shared between all undo steps, regardless of their position in the memfile. A single store is
+ * shared by the whole chain of memfiles written using a reference memfile.
+ * \{ */
+
+typedef struct MemFileBuffer {
+  /** Points to the data following this struct (or to the data to look up). */
+  const char *data;
+  size_t size;
+  uint hash;
+  /** Number of #MemFileChunk using this buffer. */
+  uint users;
+} MemFileBuffer;
+
+#define MEMFILE_BUFFER_FROM_DATA(buf) ((MemFileBuffer *)(buf)-1)
+
+typedef struct MemFileChunkStore {
+  /** Set of #MemFileBuffer, keyed by their content. */
+  GSet *buffers;
+  /** Number of #MemFile using this store. */
+  int users;
+
+  size_t chunks_num;
+  size_t size_chunks;
+  size_t size_buffers;
+} MemFileChunkStore;
+
+static uint memfile_buffer_hash(const void *key)
+{
+  const MemFileBuffer *mbuf = key;
+  return mbuf->hash;
+}
+
+static bool memfile_buffer_cmp(const void *a, const void *b)
+{
+  const MemFileBuffer *mbuf_a = a;
+  const MemFileBuffer *mbuf_b = b;
+  return (mbuf_a->hash != mbuf_b->hash) || (mbuf_a->size != mbuf_b->size) ||
+         (memcmp(mbuf_a->data, mbuf_b->data, mbuf_a->size) != 0);
+}
+
+static MemFileChunkStore *memfile_store_new(void)
+{
+  MemFileChunkStore *store = MEM_callocN(sizeof(MemFileChunkStore), __func__);
+  store->buffers = BLI_gset_new(memfile_buffer_hash, memfile_buffer_cmp, __func__);
+  store->users = 1;
+  return store;
+}
+
+static void memfile_store_free(MemFileChunkStore *store)
+{
+  BLI_assert(BLI_gset_len(store->buffers) == 0);
+  BLI_gset_free(store->buffers, NULL);
+  MEM_freeN(store);
+}
+
+/** Add a user to the buffer of an existing chunk. */
+static void memfile_store_buffer_reuse(MemFileChunkStore *store, const char *buf, size_t size)
+{
+  MemFileBuffer *mbuf = MEMFILE_BUFFER_FROM_DATA(buf);
+  mbuf->users++;
+  store->chunks_num++;
+  store->size_chunks += size;
+}
+
+/**
+ * Return a buffer with the given content, sharing an existing buffer when possible.
+ * \param r_is_new: Set when a new buffer was allocated.
+ */
+static const char *memfile_store_buffer_ensure(MemFileChunkStore *store,
+                                               const char *buf,
+                                               size_t size,
+                                               bool *r_is_new)
+{
+  const MemFileBuffer key = {
+      .data = buf,
+      .size = size,
+      .hash = BLI_hash_mm2((const uchar *)buf, size, 0),
+  };
+
+  MemFileBuffer *mbuf = BLI_gset_lookup(store->buffers, &key);
+  if (mbuf != NULL) {
+    *r_is_new = false;
+    memfile_store_buffer_reuse(store, mbuf->data, size);
+    return mbuf->data;
+  }
+
+  mbuf = MEM_mallocN(sizeof(MemFileBuffer) + size, "Chunk buffer");
+  char *data = (char *)(mbuf + 1);
+  memcpy(data, buf, size);
+  mbuf->data = data;
+  mbuf->size = size;
+  mbuf->hash = key.hash;
+  mbuf->users = 1;
+  BLI_gset_insert(store->buffers, mbuf);
+
+  store->chunks_num++;
+  store->size_chunks += size;
+  store->size_buffers += size;
+  *r_is_new = true;
+  return data;
+}
+
+static void memfile_store_buffer_release(MemFileChunkStore *store, const char *buf)
+{
+  MemFileBuffer *mbuf = MEMFILE_BUFFER_FROM_DATA(buf);
+  BLI_assert(mbuf->users > 0);
+
+  store->chunks_num--;
+  store->size_chunks -= mbuf->size;
+
+  if (--mbuf->users == 0) {
+    store->size_buffers -= mbuf->size;
+    BLI_gset_remove(store->buffers, mbuf, NULL);
+    MEM_freeN(mbuf);
+  }
+}
+
+void BLO_memfile_store_stats_get(const MemFile *memfile, MemFileStoreStats *r_stats)
+{
+  const MemFileChunkStore *store = memfile->store;
+  memset(r_stats, 0, sizeof(*r_stats));
+  if (store != NULL) {
+    r_stats->chunks_num = store->chunks_num;
+    r_stats->buffers_num = BLI_gset_len(store->buffers);
+    r_stats->size_chunks = store->size_chunks;
+    r_stats->size_buffers = store->size_buffers;
+  }
+}
+
+/** \} */
+
 /* **************** support for memory-write, for undo buffers *************** */
 
 /* not memfile itself */
@@ -60,47 +196,41 @@ void BLO_memfile_free(MemFile *memfile)
   MemFileChunk *chunk;
 
   while ((chunk = BLI_pophead(&memfile->chunks))) {
-    if (chunk->is_identical == false) {
-      MEM_freeN((void *)chunk->buf);
-    }
+    memfile_store_buffer_release(memfile->store, chunk->buf);
     MEM_freeN(chunk);
   }
   memfile->size = 0;
+
+  if (memfile->store != NULL) {
+    if (--memfile->store->users == 0) {
+      memfile_store_free(memfile->store);
+    }
+    memfile->store = NULL;
+  }
 }
 
 /* to keep list of memfiles consistent, 'first' is always first in list */
 /* result is that 'first' is being freed */
 void BLO_memfile_merge(MemFile *first, MemFile *second)
 {
-  /* We use this mapping to store the memory buffers from second memfile chunks which are not owned
-   * by it (i.e. shared with some previous memory steps). */
-  GHash *buffer_to_second_memchunk = BLI_ghash_new(
-      BLI_ghashutil_ptrhash, BLI_ghashutil_ptrcmp, __func__);
+  /* Buffers are reference counted, so they remain valid for the second memfile. However, chunks
+   * of the second memfile that were identical to chunks of the first memfile are not identical
+   * to the memfile preceding the first one. */
+  GSet *first_changed_buffers = BLI_gset_ptr_new(__func__);
 
-  /* First, detect all memchunks in second memfile that are not owned by it. */
-  for (MemFileChunk *sc = second->chunks.first; sc != NULL; sc = sc->next) {
-    if (sc->is_identical) {
-      BLI_ghash_insert(buffer_to_second_memchunk, (void *)sc->buf, sc);
+  for (MemFileChunk *fc = first->chunks.first; fc != NULL; fc = fc->next) {
+    if (!fc->is_identical) {
+      BLI_gset_add(first_changed_buffers, (void *)fc->buf);
     }
   }
 
-  /* Now, check all chunks from first memfile (the one we are removing), and if a memchunk owned by
-   * it is also used by the second memfile, transfer the ownership. */
-  for (MemFileChunk *fc = first->chunks.first; fc != NULL; fc = fc->next) {
-    if (!fc->is_identical) {
-      MemFileChunk *sc = BLI_ghash_lookup(buffer_to_second_memchunk, fc->buf);
-      if (sc != NULL) {
-        BLI_assert(sc->is_identical);
-        sc->is_identical = false;
-        fc->is_identical = true;
-      }
-      /* Note that if the second memfile does not use that chunk, we assume that the first one
-       * fully owns it without sharing it with any other memfile, and hence it should be freed with
-       * it. */
+  for (MemFileChunk *sc = second->chunks.first; sc != NULL; sc = sc->next) {
+    if (sc->is_identical && BLI_gset_haskey(first_changed_buffers, sc->buf)) {
+      sc->is_identical = false;
     }
   }
 
-  BLI_ghash_free(buffer_to_second_memchunk, NULL, NULL);
+  BLI_gset_free(first_changed_buffers, NULL);
 
   BLO_memfile_free(first);
 }
@@ -119,6 +249,16 @@ void BLO_memfile_write_init(MemFileWriteData *mem_data,
 {
   mem_data->written_memfile = written_memfile;
   mem_data->reference_memfile = reference_memfile;
+
+  /* Share the chunk storage with the previous undo step, allocating it for the first one. */
+  BLI_assert(written_memfile->store == NULL);
+  if (reference_memfile != NULL && reference_memfile->store != NULL) {
+    written_memfile->store = reference_memfile->store;
+    written_memfile->store->users++;
+  }
+  else {
+    written_memfile->store = memfile_store_new();
+  }
   mem_data->reference_current_chunk = reference_memfile ? reference_memfile->chunks.first : NULL;
 
   /* If we have a reference memfile, we generate a mapping between the session_uuid's of the
@@ -175,6 +315,7 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t s
     MemFileChunk *compchunk = *compchunk_step;
     if (compchunk->size == curchunk->size) {
       if (memcmp(compchunk->buf, buf, size) == 0) {
+        memfile_store_buffer_reuse(memfile->store, compchunk->buf, size);
         curchunk->buf = compchunk->buf;
         curchunk->is_identical = true;
         compchunk->is_identical_future = true;
@@ -183,12 +324,13 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t s
     *compchunk_step = compchunk->next;
   }
 
-  /* not equal... */
+  /* not equal, the same content may still be stored already (from another position or step). */
   if (curchunk->buf == NULL) {
-    char *buf_new = MEM_mallocN(size, "Chunk buffer");
-    memcpy(buf_new, buf, size);
-    curchunk->buf = buf_new;
-    memfile->size += size;
+    bool is_new;
+    curchunk->buf = memfile_store_buffer_ensure(memfile->store, buf, size, &is_new);
+    if (is_new) {
+      memfile->size += size;
+    }
   }
 }
 
@@ -124,6 +124,7 @@
 
 #include "BLI_bitmap.h"
 #include "BLI_blenlib.h"
+#include "BLI_gzip_blocks.h"
 #include "BLI_mempool.h"
 #include "MEM_guardedalloc.h"  // MEM_freeN
 
@@ -203,9 +204,10 @@ struct WriteWrap {
   bool use_buf;
 
   /* internal */
-  union {
+  struct {
     int file_handle;
-    gzFile gz_handle;
+    /** Only for compressed files, writes into #file_handle. */
+    struct GzipBlockWriter *gz_blocks;
   } _user_data;
 };
 
@@ -236,30 +238,37 @@ static size_t ww_write_none(WriteWrap *ww, const char *buf, size_t buf_len)
 #undef FILE_HANDLE
 
 /* zlib */
-#define FILE_HANDLE(ww) (ww)->_user_data.gz_handle
+#define GZ_BLOCKS(ww) (ww)->_user_data.gz_blocks
 
+/**
+ * Compressed in independent blocks using multiple threads, see #BLI_gzip_block_writer_new.
+ * The result is still a regular gzip file, with an index that allows
+ * reading it in parallel and seeking in it.
+ */
 static bool ww_open_zlib(WriteWrap *ww, const char *filepath)
 {
-  gzFile file;
-
-  file = BLI_gzopen(filepath, "wb1");
-
-  if (file != Z_NULL) {
-    FILE_HANDLE(ww) = file;
-    return true;
+  if (!ww_open_none(ww, filepath)) {
+    return false;
   }
 
-  return false;
+  /* Level 1 is very close to 3 (the default) in terms of file size,
+   * but about twice as fast, best use for speedy saving. */
+  GZ_BLOCKS(ww) = BLI_gzip_block_writer_new(ww->_user_data.file_handle, 1, 0);
+  return true;
 }
 static bool ww_close_zlib(WriteWrap *ww)
 {
-  return (gzclose(FILE_HANDLE(ww)) == Z_OK);
+  const bool ok = BLI_gzip_block_writer_free(GZ_BLOCKS(ww));
+  return ww_close_none(ww) && ok;
 }
 static size_t ww_write_zlib(WriteWrap *ww, const char *buf, size_t buf_len)
 {
-  return gzwrite(FILE_HANDLE(ww), buf, buf_len);
+  if (!BLI_gzip_block_writer_write(GZ_BLOCKS(ww), buf, buf_len)) {
+    return 0;
+  }
+  return buf_len;
 }
-#undef FILE_HANDLE
+#undef GZ_BLOCKS
 
 /* --- end compression types --- */
 
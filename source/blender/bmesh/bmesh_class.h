@@ -236,6 +236,7 @@ typedef struct BMesh {
   struct BLI_mempool *vtoolflagpool, *etoolflagpool, *ftoolflagpool;
 
   uint use_toolflags : 1;
+  uint use_threaded_alloc : 1;
 
   int toolflag_index;
   struct BMOperator *currentop;
@@ -48,12 +48,14 @@ const BMAllocTemplate bm_mesh_chunksize_default = {512, 1024, 2048, 512};
 
 static void bm_mempool_init_ex(const BMAllocTemplate *allocsize,
                                const bool use_toolflags,
+                               const bool use_threaded_alloc,
                                BLI_mempool **r_vpool,
                                BLI_mempool **r_epool,
                                BLI_mempool **r_lpool,
                                BLI_mempool **r_fpool)
 {
   size_t vert_size, edge_size, loop_size, face_size;
+  const uint flag_threads = use_threaded_alloc ? BLI_MEMPOOL_ALLOW_THREADS : 0;
 
   if (use_toolflags == true) {
     vert_size = sizeof(BMVert_OFlag);
@@ -70,25 +72,43 @@ static void bm_mempool_init_ex(const BMAllocTemplate *allocsize,
 
   if (r_vpool) {
     *r_vpool = BLI_mempool_create(
-        vert_size, allocsize->totvert, bm_mesh_chunksize_default.totvert, BLI_MEMPOOL_ALLOW_ITER);
+        vert_size,
+        allocsize->totvert,
+        bm_mesh_chunksize_default.totvert,
+        BLI_MEMPOOL_ALLOW_ITER | flag_threads);
   }
   if (r_epool) {
     *r_epool = BLI_mempool_create(
-        edge_size, allocsize->totedge, bm_mesh_chunksize_default.totedge, BLI_MEMPOOL_ALLOW_ITER);
+        edge_size,
+        allocsize->totedge,
+        bm_mesh_chunksize_default.totedge,
+        BLI_MEMPOOL_ALLOW_ITER | flag_threads);
   }
   if (r_lpool) {
     *r_lpool = BLI_mempool_create(
-        loop_size, allocsize->totloop, bm_mesh_chunksize_default.totloop, BLI_MEMPOOL_NOP);
+        loop_size, allocsize->totloop, bm_mesh_chunksize_default.totloop, flag_threads);
   }
   if (r_fpool) {
     *r_fpool = BLI_mempool_create(
-        face_size, allocsize->totface, bm_mesh_chunksize_default.totface, BLI_MEMPOOL_ALLOW_ITER);
+        face_size,
+        allocsize->totface,
+        bm_mesh_chunksize_default.totface,
+        BLI_MEMPOOL_ALLOW_ITER | flag_threads);
   }
 }
 
-static void bm_mempool_init(BMesh *bm, const BMAllocTemplate *allocsize, const bool use_toolflags)
+static void bm_mempool_init(BMesh *bm,
+                            const BMAllocTemplate *allocsize,
+                            const bool use_toolflags,
+                            const bool use_threaded_alloc)
 {
-  bm_mempool_init_ex(allocsize, use_toolflags, &bm->vpool, &bm->epool, &bm->lpool, &bm->fpool);
+  bm_mempool_init_ex(allocsize,
+                     use_toolflags,
+                     use_threaded_alloc,
+                     &bm->vpool,
+                     &bm->epool,
+                     &bm->lpool,
+                     &bm->fpool);
 
 #ifdef USE_BMESH_HOLES
   bm->looplistpool = BLI_mempool_create(sizeof(BMLoopList), 512, 512, BLI_MEMPOOL_NOP);
@@ -160,10 +180,11 @@ BMesh *BM_mesh_create(const BMAllocTemplate *allocsize, const struct BMeshCreate
   BMesh *bm = MEM_callocN(sizeof(BMesh), __func__);
 
   /* allocate the memory pools for the mesh elements */
-  bm_mempool_init(bm, allocsize, params->use_toolflags);
+  bm_mempool_init(bm, allocsize, params->use_toolflags, params->use_threaded_alloc);
 
   /* allocate one flag pool that we don't get rid of. */
   bm->use_toolflags = params->use_toolflags;
+  bm->use_threaded_alloc = params->use_threaded_alloc;
   bm->toolflag_index = 0;
   bm->totflags = 0;
 
@@ -281,15 +302,17 @@ void BM_mesh_data_free(BMesh *bm)
 void BM_mesh_clear(BMesh *bm)
 {
   const bool use_toolflags = bm->use_toolflags;
+  const bool use_threaded_alloc = bm->use_threaded_alloc;
 
   /* free old mesh */
   BM_mesh_data_free(bm);
   memset(bm, 0, sizeof(BMesh));
 
   /* allocate the memory pools for the mesh elements */
-  bm_mempool_init(bm, &bm_mesh_allocsize_default, use_toolflags);
+  bm_mempool_init(bm, &bm_mesh_allocsize_default, use_toolflags, use_threaded_alloc);
 
   bm->use_toolflags = use_toolflags;
+  bm->use_threaded_alloc = use_threaded_alloc;
   bm->toolflag_index = 0;
   bm->totflags = 0;
 
@@ -3014,7 +3037,13 @@ void BM_mesh_toolflags_set(BMesh *bm, bool use_toolflags)
   BLI_mempool *epool_dst = NULL;
   BLI_mempool *fpool_dst = NULL;
 
-  bm_mempool_init_ex(&allocsize, use_toolflags, &vpool_dst, &epool_dst, NULL, &fpool_dst);
+  bm_mempool_init_ex(&allocsize,
+                     use_toolflags,
+                     bm->use_threaded_alloc,
+                     &vpool_dst,
+                     &epool_dst,
+                     NULL,
+                     &fpool_dst);
 
   if (use_toolflags == false) {
     BLI_mempool_destroy(bm->vtoolflagpool);
@@ -3029,6 +3058,7 @@ void BM_mesh_toolflags_set(BMesh *bm, bool use_toolflags)
   BM_mesh_rebuild(bm,
                   &((struct BMeshCreateParams){
                       .use_toolflags = use_toolflags,
+                      .use_threaded_alloc = bm->use_threaded_alloc,
                   }),
                   vpool_dst,
                   epool_dst,
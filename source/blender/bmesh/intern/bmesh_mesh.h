@@ -31,6 +31,9 @@ void BM_mesh_elem_toolflags_clear(BMesh *bm);
 
 struct BMeshCreateParams {
   uint use_toolflags : 1;
+  /** Allow allocating and freeing elements from multiple threads, see #BLI_MEMPOOL_ALLOW_THREADS.
+   * Only the element pools are thread-safe, element counts and custom-data are not. */
+  uint use_threaded_alloc : 1;
 };
 
 BMesh *BM_mesh_create(const struct BMAllocTemplate *allocsize,
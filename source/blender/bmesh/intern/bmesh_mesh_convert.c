@@ -81,6 +81,7 @@
 #include "BLI_alloca.h"
 #include "BLI_listbase.h"
 #include "BLI_math_vector.h"
+#include "BLI_task.h"
 
 #include "BKE_customdata.h"
 #include "BKE_mesh.h"
@@ -95,6 +96,13 @@
 #include "bmesh.h"
 #include "intern/bmesh_private.h" /* For element checking. */
 
+// #define DEBUG_TIME
+
+#ifdef DEBUG_TIME
+#  include "PIL_time.h"
+#  include "PIL_time_utildefines.h"
+#endif
+
 void BM_mesh_cd_flag_ensure(BMesh *bm, Mesh *mesh, const char cd_flag)
 {
   const char cd_flag_all = BM_mesh_cd_flag_from_bmesh(bm) | cd_flag;
@@ -176,6 +184,132 @@ static BMFace *bm_face_create_from_mpoly(
   return BM_face_create(bm, verts, edges, mp->totloop, NULL, BM_CREATE_SKIP_CD);
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Mesh -> BMesh Element Data
+ *
+ * Elements are created (and their custom-data blocks allocated) in order from a single thread,
+ * since the memory pools and the topology links aren't thread-safe.
+ * Everything stored in the elements themselves is then copied from multiple threads.
+ * \{ */
+
+typedef struct BMeshFromMeshData {
+  BMesh *bm;
+  const Mesh *me;
+  BMVert **vtable;
+  BMEdge **etable;
+  /* NULL for polygons which could not be created. */
+  BMFace **ftable;
+
+  const float (**shape_key_table)[3];
+  int tot_shape_keys;
+  bool calc_face_normal;
+
+  int cd_vert_bweight_offset;
+  int cd_edge_bweight_offset;
+  int cd_edge_crease_offset;
+  int cd_shape_key_offset;
+  int cd_shape_keyindex_offset;
+} BMeshFromMeshData;
+
+static void bm_vert_from_mvert_cb(void *__restrict userdata,
+                                  const int i,
+                                  const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BMeshFromMeshData *data = userdata;
+  const Mesh *me = data->me;
+  const MVert *mvert = &me->mvert[i];
+  BMVert *v = data->vtable[i];
+
+  /* Transfer flag, selection is set afterwards. */
+  v->head.hflag = BM_vert_flag_from_mflag(mvert->flag & ~SELECT);
+
+  normal_short_to_float_v3(v->no, mvert->no);
+
+  /* Copy Custom Data */
+  CustomData_to_bmesh_block(&me->vdata, &data->bm->vdata, i, &v->head.data, true);
+
+  if (data->cd_vert_bweight_offset != -1) {
+    BM_ELEM_CD_SET_FLOAT(v, data->cd_vert_bweight_offset, (float)mvert->bweight / 255.0f);
+  }
+
+  /* Set shape key original index. */
+  if (data->cd_shape_keyindex_offset != -1) {
+    BM_ELEM_CD_SET_INT(v, data->cd_shape_keyindex_offset, i);
+  }
+
+  /* Set shape-key data. */
+  if (data->tot_shape_keys) {
+    float(*co_dst)[3] = BM_ELEM_CD_GET_VOID_P(v, data->cd_shape_key_offset);
+    for (int j = 0; j < data->tot_shape_keys; j++, co_dst++) {
+      copy_v3_v3(*co_dst, data->shape_key_table[j][i]);
+    }
+  }
+}
+
+static void bm_edge_from_medge_cb(void *__restrict userdata,
+                                  const int i,
+                                  const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BMeshFromMeshData *data = userdata;
+  const Mesh *me = data->me;
+  const MEdge *medge = &me->medge[i];
+  BMEdge *e = data->etable[i];
+
+  /* Transfer flags, selection is set afterwards. */
+  e->head.hflag = BM_edge_flag_from_mflag(medge->flag & ~SELECT);
+
+  /* Copy Custom Data */
+  CustomData_to_bmesh_block(&me->edata, &data->bm->edata, i, &e->head.data, true);
+
+  if (data->cd_edge_bweight_offset != -1) {
+    BM_ELEM_CD_SET_FLOAT(e, data->cd_edge_bweight_offset, (float)medge->bweight / 255.0f);
+  }
+  if (data->cd_edge_crease_offset != -1) {
+    BM_ELEM_CD_SET_FLOAT(e, data->cd_edge_crease_offset, (float)medge->crease / 255.0f);
+  }
+}
+
+static void bm_face_from_mpoly_cb(void *__restrict userdata,
+                                  const int i,
+                                  const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BMeshFromMeshData *data = userdata;
+  const Mesh *me = data->me;
+  const MPoly *mp = &me->mpoly[i];
+  BMFace *f = data->ftable[i];
+  BMLoop *l_iter, *l_first;
+
+  if (UNLIKELY(f == NULL)) {
+    return;
+  }
+
+  /* Transfer flag, selection is set afterwards. */
+  f->head.hflag = BM_face_flag_from_mflag(mp->flag & ~ME_FACE_SEL);
+  f->mat_nr = mp->mat_nr;
+
+  int j = mp->loopstart;
+  l_iter = l_first = BM_FACE_FIRST_LOOP(f);
+  do {
+    CustomData_to_bmesh_block(&me->ldata, &data->bm->ldata, j++, &l_iter->head.data, true);
+  } while ((l_iter = l_iter->next) != l_first);
+
+  /* Copy Custom Data */
+  CustomData_to_bmesh_block(&me->pdata, &data->bm->pdata, i, &f->head.data, true);
+
+  if (data->calc_face_normal) {
+    BM_face_normal_update(f);
+  }
+}
+
+static void bm_from_me_parallel_settings(TaskParallelSettings *settings, const int totelem)
+{
+  BLI_parallel_range_settings_defaults(settings);
+  settings->use_threading = (totelem >= BM_OMP_LIMIT);
+  settings->min_iter_per_thread = 1024;
+}
+
+/** \} */
+
 /**
  * \brief Mesh -> BMesh
  * \param bm: The mesh to write into, while this is typically a newly created BMesh,
@@ -312,41 +446,17 @@ void BM_mesh_bm_from_me(BMesh *bm, const Mesh *me, const struct BMeshFromMeshPar
                                            CustomData_get_offset(&bm->vdata, CD_SHAPE_KEYINDEX) :
                                            -1;
 
+#ifdef DEBUG_TIME
+  TIMEIT_START(bm_from_me_create);
+#endif
+
+  /* Create the elements and allocate their custom-data, this can't be threaded. */
   vtable = MEM_mallocN(sizeof(BMVert **) * me->totvert, __func__);
 
   for (i = 0, mvert = me->mvert; i < me->totvert; i++, mvert++) {
     v = vtable[i] = BM_vert_create(bm, keyco ? keyco[i] : mvert->co, NULL, BM_CREATE_SKIP_CD);
     BM_elem_index_set(v, i); /* set_ok */
-
-    /* Transfer flag. */
-    v->head.hflag = BM_vert_flag_from_mflag(mvert->flag & ~SELECT);
-
-    /* This is necessary for selection counts to work properly. */
-    if (mvert->flag & SELECT) {
-      BM_vert_select_set(bm, v, true);
-    }
-
-    normal_short_to_float_v3(v->no, mvert->no);
-
-    /* Copy Custom Data */
-    CustomData_to_bmesh_block(&me->vdata, &bm->vdata, i, &v->head.data, true);
-
-    if (cd_vert_bweight_offset != -1) {
-      BM_ELEM_CD_SET_FLOAT(v, cd_vert_bweight_offset, (float)mvert->bweight / 255.0f);
-    }
-
-    /* Set shape key original index. */
-    if (cd_shape_keyindex_offset != -1) {
-      BM_ELEM_CD_SET_INT(v, cd_shape_keyindex_offset, i);
-    }
-
-    /* Set shape-key data. */
-    if (tot_shape_keys) {
-      float(*co_dst)[3] = BM_ELEM_CD_GET_VOID_P(v, cd_shape_key_offset);
-      for (int j = 0; j < tot_shape_keys; j++, co_dst++) {
-        copy_v3_v3(*co_dst, shape_key_table[j][i]);
-      }
-    }
+    CustomData_bmesh_alloc_block(&bm->vdata, &v->head.data);
   }
   if (is_new) {
     bm->elem_index_dirty &= ~BM_VERT; /* Added in order, clear dirty flag. */
@@ -359,33 +469,13 @@ void BM_mesh_bm_from_me(BMesh *bm, const Mesh *me, const struct BMeshFromMeshPar
     e = etable[i] = BM_edge_create(
         bm, vtable[medge->v1], vtable[medge->v2], NULL, BM_CREATE_SKIP_CD);
     BM_elem_index_set(e, i); /* set_ok */
-
-    /* Transfer flags. */
-    e->head.hflag = BM_edge_flag_from_mflag(medge->flag & ~SELECT);
-
-    /* This is necessary for selection counts to work properly. */
-    if (medge->flag & SELECT) {
-      BM_edge_select_set(bm, e, true);
-    }
-
-    /* Copy Custom Data */
-    CustomData_to_bmesh_block(&me->edata, &bm->edata, i, &e->head.data, true);
-
-    if (cd_edge_bweight_offset != -1) {
-      BM_ELEM_CD_SET_FLOAT(e, cd_edge_bweight_offset, (float)medge->bweight / 255.0f);
-    }
-    if (cd_edge_crease_offset != -1) {
-      BM_ELEM_CD_SET_FLOAT(e, cd_edge_crease_offset, (float)medge->crease / 255.0f);
-    }
+    CustomData_bmesh_alloc_block(&bm->edata, &e->head.data);
   }
   if (is_new) {
     bm->elem_index_dirty &= ~BM_EDGE; /* Added in order, clear dirty flag. */
   }
 
-  /* Only needed for selection. */
-  if (me->mselect && me->totselect != 0) {
-    ftable = MEM_mallocN(sizeof(BMFace **) * me->totpoly, __func__);
-  }
+  ftable = MEM_mallocN(sizeof(BMFace **) * me->totpoly, __func__);
 
   mloop = me->mloop;
   mp = me->mpoly;
@@ -393,10 +483,7 @@ void BM_mesh_bm_from_me(BMesh *bm, const Mesh *me, const struct BMeshFromMeshPar
     BMLoop *l_iter;
     BMLoop *l_first;
 
-    f = bm_face_create_from_mpoly(mp, mloop + mp->loopstart, bm, vtable, etable);
-    if (ftable != NULL) {
-      ftable[i] = f;
-    }
+    f = ftable[i] = bm_face_create_from_mpoly(mp, mloop + mp->loopstart, bm, vtable, etable);
 
     if (UNLIKELY(f == NULL)) {
       printf(
@@ -410,41 +497,84 @@ void BM_mesh_bm_from_me(BMesh *bm, const Mesh *me, const struct BMeshFromMeshPar
 
     /* Don't use 'i' since we may have skipped the face. */
     BM_elem_index_set(f, bm->totface - 1); /* set_ok */
+    CustomData_bmesh_alloc_block(&bm->pdata, &f->head.data);
 
-    /* Transfer flag. */
-    f->head.hflag = BM_face_flag_from_mflag(mp->flag & ~ME_FACE_SEL);
-
-    /* This is necessary for selection counts to work properly. */
-    if (mp->flag & ME_FACE_SEL) {
-      BM_face_select_set(bm, f, true);
-    }
-
-    f->mat_nr = mp->mat_nr;
     if (i == me->act_face) {
       bm->act_face = f;
     }
 
-    int j = mp->loopstart;
     l_iter = l_first = BM_FACE_FIRST_LOOP(f);
     do {
       /* Don't use 'j' since we may have skipped some faces, hence some loops. */
       BM_elem_index_set(l_iter, totloops++); /* set_ok */
-
-      /* Save index of corresponding #MLoop. */
-      CustomData_to_bmesh_block(&me->ldata, &bm->ldata, j++, &l_iter->head.data, true);
+      CustomData_bmesh_alloc_block(&bm->ldata, &l_iter->head.data);
     } while ((l_iter = l_iter->next) != l_first);
+  }
+  if (is_new) {
+    bm->elem_index_dirty &= ~(BM_FACE | BM_LOOP); /* Added in order, clear dirty flag. */
+  }
+
+#ifdef DEBUG_TIME
+  TIMEIT_END(bm_from_me_create);
+  TIMEIT_START(bm_from_me_data);
+#endif
+
+  /* Copy flags and custom-data of every element, from multiple threads. */
+  {
+    BMeshFromMeshData data = {
+        .bm = bm,
+        .me = me,
+        .vtable = vtable,
+        .etable = etable,
+        .ftable = ftable,
+        .shape_key_table = shape_key_table,
+        .tot_shape_keys = tot_shape_keys,
+        .calc_face_normal = params->calc_face_normal,
+        .cd_vert_bweight_offset = cd_vert_bweight_offset,
+        .cd_edge_bweight_offset = cd_edge_bweight_offset,
+        .cd_edge_crease_offset = cd_edge_crease_offset,
+        .cd_shape_key_offset = cd_shape_key_offset,
+        .cd_shape_keyindex_offset = cd_shape_keyindex_offset,
+    };
+    TaskParallelSettings settings;
+
+    bm_from_me_parallel_settings(&settings, me->totvert);
+    BLI_task_parallel_range(0, me->totvert, &data, bm_vert_from_mvert_cb, &settings);
+
+    bm_from_me_parallel_settings(&settings, me->totedge);
+    BLI_task_parallel_range(0, me->totedge, &data, bm_edge_from_medge_cb, &settings);
+
+    bm_from_me_parallel_settings(&settings, me->totpoly);
+    BLI_task_parallel_range(0, me->totpoly, &data, bm_face_from_mpoly_cb, &settings);
+  }
 
-    /* Copy Custom Data */
-    CustomData_to_bmesh_block(&me->pdata, &bm->pdata, i, &f->head.data, true);
+#ifdef DEBUG_TIME
+  TIMEIT_END(bm_from_me_data);
+  TIMEIT_START(bm_from_me_select);
+#endif
 
-    if (params->calc_face_normal) {
-      BM_face_normal_update(f);
+  /* This is necessary for selection counts to work properly.
+   * Selecting also flushes to connected elements, so it's done once all flags are set. */
+  for (i = 0, mvert = me->mvert; i < me->totvert; i++, mvert++) {
+    if (mvert->flag & SELECT) {
+      BM_vert_select_set(bm, vtable[i], true);
     }
   }
-  if (is_new) {
-    bm->elem_index_dirty &= ~(BM_FACE | BM_LOOP); /* Added in order, clear dirty flag. */
+  for (i = 0, medge = me->medge; i < me->totedge; i++, medge++) {
+    if (medge->flag & SELECT) {
+      BM_edge_select_set(bm, etable[i], true);
+    }
+  }
+  for (i = 0, mp = me->mpoly; i < me->totpoly; i++, mp++) {
+    if ((mp->flag & ME_FACE_SEL) && ftable[i] != NULL) {
+      BM_face_select_set(bm, ftable[i], true);
+    }
   }
 
+#ifdef DEBUG_TIME
+  TIMEIT_END(bm_from_me_select);
+#endif
+
   /* -------------------------------------------------------------------- */
   /* MSelect clears the array elements (avoid adding multiple times).
    *
@@ -481,9 +611,7 @@ void BM_mesh_bm_from_me(BMesh *bm, const Mesh *me, const struct BMeshFromMeshPar
 
   MEM_freeN(vtable);
   MEM_freeN(etable);
-  if (ftable) {
-    MEM_freeN(ftable);
-  }
+  MEM_freeN(ftable);
 }
 
 /**
@@ -564,15 +692,118 @@ BLI_INLINE void bmesh_quick_edgedraw_flag(MEdge *med, BMEdge *e)
   }
 }
 
+/* -------------------------------------------------------------------- */
+/** \name BMesh -> Mesh Element Data
+ *
+ * Elements are written at their index, so they can be copied from multiple threads.
+ * \{ */
+
+typedef struct BMeshToMeshData {
+  BMesh *bm;
+  Mesh *me;
+  MVert *mvert;
+  MEdge *medge;
+  MLoop *mloop;
+  MPoly *mpoly;
+
+  int cd_vert_bweight_offset;
+  int cd_edge_bweight_offset;
+  int cd_edge_crease_offset;
+} BMeshToMeshData;
+
+static void bm_vert_to_mvert_cb(void *userdata, MempoolIterData *mp_v)
+{
+  const BMeshToMeshData *data = userdata;
+  BMVert *v = (BMVert *)mp_v;
+  const int i = BM_elem_index_get(v);
+  MVert *mvert = &data->mvert[i];
+
+  copy_v3_v3(mvert->co, v->co);
+  normal_float_to_short_v3(mvert->no, v->no);
+
+  mvert->flag = BM_vert_flag_to_mflag(v);
+
+  /* Copy over custom-data. */
+  CustomData_from_bmesh_block(&data->bm->vdata, &data->me->vdata, v->head.data, i);
+
+  if (data->cd_vert_bweight_offset != -1) {
+    mvert->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(v, data->cd_vert_bweight_offset);
+  }
+
+  BM_CHECK_ELEMENT(v);
+}
+
+static void bm_edge_to_medge_cb(void *userdata, MempoolIterData *mp_e)
+{
+  const BMeshToMeshData *data = userdata;
+  BMEdge *e = (BMEdge *)mp_e;
+  const int i = BM_elem_index_get(e);
+  MEdge *med = &data->medge[i];
+
+  med->v1 = BM_elem_index_get(e->v1);
+  med->v2 = BM_elem_index_get(e->v2);
+
+  med->flag = BM_edge_flag_to_mflag(e);
+
+  /* Copy over custom-data. */
+  CustomData_from_bmesh_block(&data->bm->edata, &data->me->edata, e->head.data, i);
+
+  bmesh_quick_edgedraw_flag(med, e);
+
+  if (data->cd_edge_crease_offset != -1) {
+    med->crease = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(e, data->cd_edge_crease_offset);
+  }
+  if (data->cd_edge_bweight_offset != -1) {
+    med->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(e, data->cd_edge_bweight_offset);
+  }
+
+  BM_CHECK_ELEMENT(e);
+}
+
+/* Expects #MPoly.loopstart and #MPoly.totloop to be set already. */
+static void bm_face_to_mpoly_cb(void *userdata, MempoolIterData *mp_f)
+{
+  const BMeshToMeshData *data = userdata;
+  BMFace *f = (BMFace *)mp_f;
+  const int i = BM_elem_index_get(f);
+  MPoly *mpoly = &data->mpoly[i];
+  BMLoop *l_iter, *l_first;
+
+  mpoly->mat_nr = f->mat_nr;
+  mpoly->flag = BM_face_flag_to_mflag(f);
+
+  int j = mpoly->loopstart;
+  MLoop *mloop = &data->mloop[j];
+  l_iter = l_first = BM_FACE_FIRST_LOOP(f);
+  do {
+    mloop->e = BM_elem_index_get(l_iter->e);
+    mloop->v = BM_elem_index_get(l_iter->v);
+
+    /* Copy over custom-data. */
+    CustomData_from_bmesh_block(&data->bm->ldata, &data->me->ldata, l_iter->head.data, j);
+
+    j++;
+    mloop++;
+    BM_CHECK_ELEMENT(l_iter);
+    BM_CHECK_ELEMENT(l_iter->e);
+    BM_CHECK_ELEMENT(l_iter->v);
+  } while ((l_iter = l_iter->next) != l_first);
+
+  /* Copy over custom-data. */
+  CustomData_from_bmesh_block(&data->bm->pdata, &data->me->pdata, f->head.data, i);
+
+  BM_CHECK_ELEMENT(f);
+}
+
+/** \} */
+
 /**
  *
  * \param bmain: May be NULL in case \a calc_object_remap parameter option is not set.
  */
 void BM_mesh_bm_to_me(Main *bmain, BMesh *bm, Mesh *me, const struct BMeshToMeshParams *params)
 {
-  MEdge *med;
-  BMVert *v, *eve;
-  BMEdge *e;
+  BMVert *eve;
   BMFace *f;
   BMIter iter;
   int i, j;
@@ -640,93 +871,50 @@ void BM_mesh_bm_to_me(Main *bmain, BMesh *bm, Mesh *me, const struct BMeshToMesh
   /* This is called again, 'dotess' arg is used there. */
   BKE_mesh_update_customdata_pointers(me, 0);
 
-  i = 0;
-  BM_ITER_MESH (v, &iter, bm, BM_VERTS_OF_MESH) {
-    copy_v3_v3(mvert->co, v->co);
-    normal_float_to_short_v3(mvert->no, v->no);
-
-    mvert->flag = BM_vert_flag_to_mflag(v);
-
-    BM_elem_index_set(v, i); /* set_inline */
-
-    /* Copy over custom-data. */
-    CustomData_from_bmesh_block(&bm->vdata, &me->vdata, v->head.data, i);
-
-    if (cd_vert_bweight_offset != -1) {
-      mvert->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(v, cd_vert_bweight_offset);
-    }
-
-    i++;
-    mvert++;
-
-    BM_CHECK_ELEMENT(v);
-  }
-  bm->elem_index_dirty &= ~BM_VERT;
-
-  med = medge;
-  i = 0;
-  BM_ITER_MESH (e, &iter, bm, BM_EDGES_OF_MESH) {
-    med->v1 = BM_elem_index_get(e->v1);
-    med->v2 = BM_elem_index_get(e->v2);
-
-    med->flag = BM_edge_flag_to_mflag(e);
-
-    BM_elem_index_set(e, i); /* set_inline */
-
-    /* Copy over custom-data. */
-    CustomData_from_bmesh_block(&bm->edata, &me->edata, e->head.data, i);
-
-    bmesh_quick_edgedraw_flag(med, e);
-
-    if (cd_edge_crease_offset != -1) {
-      med->crease = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(e, cd_edge_crease_offset);
-    }
-    if (cd_edge_bweight_offset != -1) {
-      med->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(e, cd_edge_bweight_offset);
-    }
+#ifdef DEBUG_TIME
+  TIMEIT_START(bm_to_me_data);
+#endif
 
-    i++;
-    med++;
-    BM_CHECK_ELEMENT(e);
-  }
-  bm->elem_index_dirty &= ~BM_EDGE;
+  /* Elements are written at their index, from multiple threads. */
+  BM_mesh_elem_index_ensure(bm, BM_VERT | BM_EDGE | BM_FACE);
 
   i = 0;
   j = 0;
   BM_ITER_MESH (f, &iter, bm, BM_FACES_OF_MESH) {
-    BMLoop *l_iter, *l_first;
-    mpoly->loopstart = j;
-    mpoly->totloop = f->len;
-    mpoly->mat_nr = f->mat_nr;
-    mpoly->flag = BM_face_flag_to_mflag(f);
-
-    l_iter = l_first = BM_FACE_FIRST_LOOP(f);
-    do {
-      mloop->e = BM_elem_index_get(l_iter->e);
-      mloop->v = BM_elem_index_get(l_iter->v);
-
-      /* Copy over custom-data. */
-      CustomData_from_bmesh_block(&bm->ldata, &me->ldata, l_iter->head.data, j);
-
-      j++;
-      mloop++;
-      BM_CHECK_ELEMENT(l_iter);
-      BM_CHECK_ELEMENT(l_iter->e);
-      BM_CHECK_ELEMENT(l_iter->v);
-    } while ((l_iter = l_iter->next) != l_first);
-
+    mpoly[i].loopstart = j;
+    mpoly[i].totloop = f->len;
     if (f == bm->act_face) {
       me->act_face = i;
     }
-
-    /* Copy over custom-data. */
-    CustomData_from_bmesh_block(&bm->pdata, &me->pdata, f->head.data, i);
-
+    j += f->len;
     i++;
-    mpoly++;
-    BM_CHECK_ELEMENT(f);
   }
 
+  {
+    BMeshToMeshData data = {
+        .bm = bm,
+        .me = me,
+        .mvert = mvert,
+        .medge = medge,
+        .mloop = mloop,
+        .mpoly = mpoly,
+        .cd_vert_bweight_offset = cd_vert_bweight_offset,
+        .cd_edge_bweight_offset = cd_edge_bweight_offset,
+        .cd_edge_crease_offset = cd_edge_crease_offset,
+    };
+
+    BM_iter_parallel(
+        bm, BM_VERTS_OF_MESH, bm_vert_to_mvert_cb, &data, bm->totvert >= BM_OMP_LIMIT);
+    BM_iter_parallel(
+        bm, BM_EDGES_OF_MESH, bm_edge_to_medge_cb, &data, bm->totedge >= BM_OMP_LIMIT);
+    BM_iter_parallel(
+        bm, BM_FACES_OF_MESH, bm_face_to_mpoly_cb, &data, bm->totface >= BM_OMP_LIMIT);
+  }
+
+#ifdef DEBUG_TIME
+  TIMEIT_END(bm_to_me_data);
+#endif
+
   /* Patch hook indices and vertex parents. */
   if (params->calc_object_remap && (ototvert > 0)) {
     BLI_assert(bmain != NULL);
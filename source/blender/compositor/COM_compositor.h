@@ -359,6 +359,12 @@ void COM_deinitialize(void);
  */
 // void COM_clearCaches(void); // NOT YET WRITTEN
 
+/**
+ * \brief Clear the results of earlier executions that are kept to avoid calculating them again.
+ * Called when a new render result is created, since render layers are read from it.
+ */
+void COM_result_cache_clear(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -58,6 +58,18 @@ typedef enum CompositorPriority {
   COM_PRIORITY_LOW = 0,
 } CompositorPriority;
 
+/**
+ * \brief Possible execution models
+ * \see CompositorContext.execution_model
+ * \ingroup Execution
+ */
+typedef enum ExecutionModel {
+  /** \brief Pixels are pulled through the operations, chunks are scheduled on demand */
+  COM_EM_TILED = 0,
+  /** \brief Every operation writes its whole output buffer before its readers are executed */
+  COM_EM_FULL_FRAME = 1,
+} ExecutionModel;
+
 // configurable items
 
 // chunk size determination
@@ -18,6 +18,8 @@
 
 #include "COM_CPUDevice.h"
 
+#include "PIL_time.h"
+
 CPUDevice::CPUDevice(int thread_id) : Device(), m_thread_id(thread_id)
 {
 }
@@ -27,10 +29,12 @@ void CPUDevice::execute(WorkPackage *work)
   const unsigned int chunkNumber = work->getChunkNumber();
   ExecutionGroup *executionGroup = work->getExecutionGroup();
   rcti rect;
+  const double start_time = PIL_check_seconds_timer();
 
   executionGroup->determineChunkRect(&rect, chunkNumber);
 
   executionGroup->getOutputOperation()->executeRegion(&rect, chunkNumber);
 
+  executionGroup->addExecutionTime(PIL_check_seconds_timer() - start_time);
   executionGroup->finalizeChunkExecution(chunkNumber, NULL);
 }
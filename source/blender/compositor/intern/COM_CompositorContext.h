@@ -267,4 +267,15 @@ class CompositorContext {
   {
     return (this->getbNodeTree()->flag & NTREE_COM_GROUPNODE_BUFFER) != 0;
   }
+
+  /**
+   * \brief get the execution model, see #eNodeTreeExecutionMode
+   */
+  ExecutionModel getExecutionModel() const
+  {
+    if (this->getbNodeTree()->execution_mode == NTREE_EXECUTION_MODE_FULL_FRAME) {
+      return COM_EM_FULL_FRAME;
+    }
+    return COM_EM_TILED;
+  }
 };
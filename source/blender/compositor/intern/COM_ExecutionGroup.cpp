@@ -28,6 +28,7 @@
 #include "COM_ExecutionGroup.h"
 #include "COM_ExecutionSystem.h"
 #include "COM_ReadBufferOperation.h"
+#include "COM_ResultCache.h"
 #include "COM_ViewerOperation.h"
 #include "COM_WorkScheduler.h"
 #include "COM_WriteBufferOperation.h"
@@ -57,8 +58,13 @@ ExecutionGroup::ExecutionGroup()
   this->m_openCL = false;
   this->m_singleThreaded = false;
   this->m_chunksFinished = 0;
+  this->m_executionModel = COM_EM_TILED;
+  this->m_chunkRows = 0;
   BLI_rcti_init(&this->m_viewerBorder, 0, 0, 0, 0);
   this->m_executionStartTime = 0;
+  this->m_cacheKey = 0;
+  this->m_outputCached = false;
+  this->m_executionTime = 0;
 }
 
 CompositorPriority ExecutionGroup::getRenderPriotrity()
@@ -161,6 +167,55 @@ void ExecutionGroup::deinitExecution()
   this->m_numberOfYChunks = 0;
   this->m_cachedReadOperations.clear();
   this->m_bTree = NULL;
+  this->m_outputCached = false;
+  this->m_executionTime = 0;
+}
+
+bool ExecutionGroup::restoreCachedOutput()
+{
+  NodeOperation *operation = this->getOutputOperation();
+  if (this->m_cacheKey == 0 || !operation->isWriteBufferOperation() ||
+      this->m_chunkExecutionStates == NULL) {
+    return false;
+  }
+
+  WriteBufferOperation *writeOperation = (WriteBufferOperation *)operation;
+  MemoryProxy *memoryProxy = writeOperation->getMemoryProxy();
+  if (!ResultCache::restore(this->m_cacheKey, memoryProxy)) {
+    return false;
+  }
+  memoryProxy->getBuffer()->setCreatedState();
+
+  for (unsigned int index = 0; index < this->m_numberOfChunks; index++) {
+    this->m_chunkExecutionStates[index] = COM_ES_EXECUTED;
+  }
+  this->m_outputCached = true;
+  return true;
+}
+
+void ExecutionGroup::storeCachedOutput()
+{
+  NodeOperation *operation = this->getOutputOperation();
+  if (this->m_cacheKey == 0 || this->m_outputCached || !operation->isWriteBufferOperation() ||
+      this->m_chunkExecutionStates == NULL) {
+    return;
+  }
+  /* Parts of the output that weren't needed are not calculated. */
+  for (unsigned int index = 0; index < this->m_numberOfChunks; index++) {
+    if (this->m_chunkExecutionStates[index] != COM_ES_EXECUTED) {
+      return;
+    }
+  }
+
+  MemoryBuffer *buffer = ((WriteBufferOperation *)operation)->getMemoryProxy()->getBuffer();
+  if (buffer) {
+    ResultCache::store(this->m_cacheKey, buffer, this->m_executionTime * 1e-6);
+  }
+}
+
+void ExecutionGroup::addExecutionTime(double seconds)
+{
+  atomic_add_and_fetch_uint64(&this->m_executionTime, (uint64_t)(seconds * 1e6));
 }
 void ExecutionGroup::determineResolution(unsigned int resolution[2])
 {
@@ -178,6 +233,17 @@ void ExecutionGroup::determineNumberOfChunks()
     this->m_numberOfYChunks = 1;
     this->m_numberOfChunks = 1;
   }
+  else if (this->m_executionModel == COM_EM_FULL_FRAME) {
+    /* bands of whole rows with about as many pixels as a tile, so the inner loops of the
+     * operations run over long contiguous rows */
+    const int border_width = BLI_rcti_size_x(&this->m_viewerBorder);
+    const int border_height = BLI_rcti_size_y(&this->m_viewerBorder);
+    this->m_chunkRows = max_ii(
+        1, (int)(this->m_chunkSize * this->m_chunkSize) / max_ii(1, border_width));
+    this->m_numberOfXChunks = 1;
+    this->m_numberOfYChunks = (border_height + this->m_chunkRows - 1) / this->m_chunkRows;
+    this->m_numberOfChunks = this->m_numberOfYChunks;
+  }
   else {
     const float chunkSizef = this->m_chunkSize;
     const int border_width = BLI_rcti_size_x(&this->m_viewerBorder);
@@ -371,6 +437,124 @@ void ExecutionGroup::execute(ExecutionSystem *graph)
   MEM_freeN(chunkOrder);
 }
 
+static void free_full_frame_input_buffers(MemoryBuffer **inputs, unsigned int num_inputs)
+{
+  for (unsigned int index = 0; index < num_inputs; index++) {
+    /* single elements are created for the execution, others belong to their MemoryProxy */
+    if (inputs[index] && inputs[index]->is_a_single_elem()) {
+      delete inputs[index];
+    }
+  }
+  MEM_freeN(inputs);
+}
+
+/**
+ * Gather the input buffers of an operation for full frame execution.
+ * Returns NULL when one of the inputs isn't available as buffer covering the area, the operation
+ * then reads its inputs per pixel.
+ */
+static MemoryBuffer **full_frame_input_buffers(NodeOperation *operation, const rcti *area)
+{
+  const unsigned int num_inputs = operation->getNumberOfInputSockets();
+  MemoryBuffer **inputs = (MemoryBuffer **)MEM_callocN(
+      sizeof(MemoryBuffer *) * max(num_inputs, 1u), __func__);
+
+  for (unsigned int index = 0; index < num_inputs; index++) {
+    NodeOperationInput *input = operation->getInputSocket(index);
+    NodeOperation *inputOperation = input->isConnected() ? &input->getLink()->getOperation() :
+                                                           NULL;
+    MemoryBuffer *buffer = NULL;
+
+    if (inputOperation == NULL) {
+      /* pass */
+    }
+    else if (inputOperation->isSetOperation()) {
+      float elem[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+      inputOperation->readSampled(elem, 0.0f, 0.0f, COM_PS_NEAREST);
+      buffer = new MemoryBuffer(input->getDataType(), elem);
+    }
+    else if (inputOperation->isReadBufferOperation()) {
+      MemoryProxy *memoryProxy = ((ReadBufferOperation *)inputOperation)->getMemoryProxy();
+      MemoryBuffer *proxyBuffer = memoryProxy->getBuffer();
+      if (proxyBuffer == NULL) {
+        /* pass */
+      }
+      else if (memoryProxy->getWriteBufferOperation()->isSingleValue()) {
+        buffer = new MemoryBuffer(memoryProxy->getDataType(), proxyBuffer->getBuffer());
+      }
+      else if (BLI_rcti_inside_rcti(proxyBuffer->getRect(), area)) {
+        buffer = proxyBuffer;
+      }
+    }
+
+    if (buffer == NULL) {
+      free_full_frame_input_buffers(inputs, num_inputs);
+      return NULL;
+    }
+    inputs[index] = buffer;
+  }
+
+  return inputs;
+}
+
+void ExecutionGroup::executeFullFrame(ExecutionSystem *graph)
+{
+  const CompositorContext &context = graph->getContext();
+  const bNodeTree *bTree = context.getbNodeTree();
+  NodeOperation *operation = this->getOutputOperation();
+  WriteBufferOperation *writeOperation = NULL;
+
+  if (operation->isWriteBufferOperation()) {
+    /* buffers are only allocated right before they are written */
+    writeOperation = (WriteBufferOperation *)operation;
+    writeOperation->initExecution();
+  }
+
+  if (this->m_width == 0 || this->m_height == 0 || this->m_numberOfChunks == 0) {
+    return;
+  }
+  if (bTree->test_break && bTree->test_break(bTree->tbh)) {
+    return;
+  }
+
+  this->m_executionStartTime = PIL_check_seconds_timer();
+  this->m_chunksFinished = 0;
+  /* only the output groups report progress */
+  this->m_bTree = this->m_isOutput ? bTree : NULL;
+
+  /* the groups writing the inputs have been executed, their buffers are allocated now */
+  for (unsigned int index = 0; index < this->m_cachedReadOperations.size(); index++) {
+    ReadBufferOperation *readOperation =
+        (ReadBufferOperation *)this->m_cachedReadOperations[index];
+    readOperation->updateMemoryBuffer();
+  }
+
+  MemoryBuffer **inputs = NULL;
+  if (writeOperation) {
+    NodeOperation *inputOperation = writeOperation->getInput();
+    inputs = full_frame_input_buffers(inputOperation, &this->m_viewerBorder);
+    writeOperation->set_full_frame_inputs(inputs);
+  }
+
+  DebugInfo::execution_group_started(this);
+
+  for (unsigned int chunkNumber = 0; chunkNumber < this->m_numberOfChunks; chunkNumber++) {
+    scheduleChunk(chunkNumber);
+  }
+  WorkScheduler::finish();
+
+  if (this->m_bTree && this->m_bTree->update_draw) {
+    this->m_bTree->update_draw(this->m_bTree->udh);
+  }
+
+  DebugInfo::execution_group_finished(this);
+
+  if (inputs) {
+    writeOperation->set_full_frame_inputs(NULL);
+    free_full_frame_input_buffers(inputs, writeOperation->getInput()->getNumberOfInputSockets());
+  }
+}
+
 MemoryBuffer **ExecutionGroup::getInputBuffersOpenCL(int chunkNumber)
 {
   rcti rect;
@@ -449,6 +633,16 @@ inline void ExecutionGroup::determineChunkRect(rcti *rect,
     BLI_rcti_init(
         rect, this->m_viewerBorder.xmin, border_width, this->m_viewerBorder.ymin, border_height);
   }
+  else if (this->m_executionModel == COM_EM_FULL_FRAME) {
+    const unsigned int miny = yChunk * this->m_chunkRows + this->m_viewerBorder.ymin;
+    const unsigned int width = min((unsigned int)this->m_viewerBorder.xmax, this->m_width);
+    const unsigned int height = min((unsigned int)this->m_viewerBorder.ymax, this->m_height);
+    BLI_rcti_init(rect,
+                  min((unsigned int)this->m_viewerBorder.xmin, this->m_width),
+                  width,
+                  min(miny, this->m_height),
+                  min(miny + this->m_chunkRows, height));
+  }
   else {
     const unsigned int minx = xChunk * this->m_chunkSize + this->m_viewerBorder.xmin;
     const unsigned int miny = yChunk * this->m_chunkSize + this->m_viewerBorder.ymin;
@@ -97,6 +97,16 @@ class ExecutionGroup {
    */
   unsigned int m_chunkSize;
 
+  /**
+   * \brief the execution model, in full frame execution chunks are bands of whole rows
+   */
+  ExecutionModel m_executionModel;
+
+  /**
+   * \brief number of rows of a chunk in full frame execution
+   */
+  unsigned int m_chunkRows;
+
   /**
    * \brief number of chunks in the x-axis
    */
@@ -181,6 +191,21 @@ class ExecutionGroup {
    */
   double m_executionStartTime;
 
+  /**
+   * \brief key of the output in the ResultCache, zero when it can't be cached
+   */
+  uint64_t m_cacheKey;
+
+  /**
+   * \brief the output is restored from the ResultCache, nothing has to be calculated
+   */
+  bool m_outputCached;
+
+  /**
+   * \brief total time all devices spent calculating chunks of this group, in microseconds
+   */
+  uint64_t m_executionTime;
+
   // methods
   /**
    * \brief check whether parameter operation can be added to the execution group
@@ -399,6 +424,16 @@ class ExecutionGroup {
    */
   void execute(ExecutionSystem *graph);
 
+  /**
+   * \brief calculate the whole area of the ExecutionGroup at once, used by full frame execution
+   * \note the groups writing the inputs must have been executed before.
+   *
+   * The output buffer is allocated here and all chunks are scheduled without any
+   * dependency checks. When the output is buffered, the input buffers are passed to
+   * #NodeOperation::update_memory_buffer so the operation can process them in tight loops.
+   */
+  void executeFullFrame(ExecutionSystem *graph);
+
   /**
    * \brief this method determines the MemoryProxy's where this execution group depends on.
    * \note After this method determineDependingAreaOfInterest can be called to determine
@@ -425,6 +460,44 @@ class ExecutionGroup {
     this->m_chunkSize = chunksize;
   }
 
+  void setExecutionModel(ExecutionModel model)
+  {
+    this->m_executionModel = model;
+  }
+
+  void setCacheKey(uint64_t key)
+  {
+    this->m_cacheKey = key;
+  }
+
+  uint64_t getCacheKey() const
+  {
+    return this->m_cacheKey;
+  }
+
+  bool isOutputCached() const
+  {
+    return this->m_outputCached;
+  }
+
+  /**
+   * \brief restore the output buffer from the ResultCache and mark all chunks as executed
+   * \note only after #initExecution, in full frame mode the buffer is allocated when needed
+   * \return true when the output is restored
+   */
+  bool restoreCachedOutput();
+
+  /**
+   * \brief store the output buffer in the ResultCache, when all chunks have been calculated
+   */
+  void storeCachedOutput();
+
+  /**
+   * \brief add the time a device spent calculating a chunk, used as cost of the output
+   * \note can be called from multiple threads
+   */
+  void addExecutionTime(double seconds);
+
   /**
    * \brief get the Render priority of this ExecutionGroup
    * \see ExecutionSystem.execute
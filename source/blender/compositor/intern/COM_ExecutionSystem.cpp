@@ -18,6 +18,7 @@
 
 #include "COM_ExecutionSystem.h"
 
+#include "BLI_string.h"
 #include "BLI_utildefines.h"
 #include "PIL_time.h"
 
@@ -31,7 +32,13 @@
 #include "COM_NodeOperation.h"
 #include "COM_NodeOperationBuilder.h"
 #include "COM_ReadBufferOperation.h"
+#include "COM_ResultCache.h"
 #include "COM_WorkScheduler.h"
+#include "COM_WriteBufferOperation.h"
+
+#include <map>
+#include <set>
+#include <typeinfo>
 
 #ifdef WITH_CXX_GUARDEDALLOC
 #  include "MEM_guardedalloc.h"
@@ -59,8 +66,10 @@ ExecutionSystem::ExecutionSystem(RenderData *rd,
     this->m_context.setQuality((CompositorQuality)editingtree->edit_quality);
   }
   this->m_context.setRendering(rendering);
+  /* full frame execution doesn't support OpenCL yet */
   this->m_context.setHasActiveOpenCLDevices(WorkScheduler::hasGPUDevices() &&
-                                            (editingtree->flag & NTREE_COM_OPENCL));
+                                            (editingtree->flag & NTREE_COM_OPENCL) &&
+                                            this->m_context.getExecutionModel() == COM_EM_TILED);
 
   this->m_context.setRenderData(rd);
   this->m_context.setViewSettings(viewSettings);
@@ -146,21 +155,27 @@ void ExecutionSystem::execute()
     }
   }
   unsigned int index;
+  const ExecutionModel executionModel = this->m_context.getExecutionModel();
 
   // First allocale all write buffer
   for (index = 0; index < this->m_operations.size(); index++) {
     NodeOperation *operation = this->m_operations[index];
     if (operation->isWriteBufferOperation()) {
       operation->setbNodeTree(this->m_context.getbNodeTree());
-      operation->initExecution();
+      /* full frame execution allocates the buffers when their group is executed */
+      if (executionModel == COM_EM_TILED) {
+        operation->initExecution();
+      }
     }
   }
   // Connect read buffers to their write buffers
-  for (index = 0; index < this->m_operations.size(); index++) {
-    NodeOperation *operation = this->m_operations[index];
-    if (operation->isReadBufferOperation()) {
-      ReadBufferOperation *readOperation = (ReadBufferOperation *)operation;
-      readOperation->updateMemoryBuffer();
+  if (executionModel == COM_EM_TILED) {
+    for (index = 0; index < this->m_operations.size(); index++) {
+      NodeOperation *operation = this->m_operations[index];
+      if (operation->isReadBufferOperation()) {
+        ReadBufferOperation *readOperation = (ReadBufferOperation *)operation;
+        readOperation->updateMemoryBuffer();
+      }
     }
   }
   // initialize other operations
@@ -174,20 +189,44 @@ void ExecutionSystem::execute()
   for (index = 0; index < this->m_groups.size(); index++) {
     ExecutionGroup *executionGroup = this->m_groups[index];
     executionGroup->setChunksize(this->m_context.getChunksize());
+    executionGroup->setExecutionModel(executionModel);
     executionGroup->initExecution();
   }
 
+  const bool use_cache = ResultCache::is_enabled();
+  unsigned int numCachedGroups = 0;
+  if (use_cache) {
+    determineCacheKeys();
+    numCachedGroups = restoreCachedGroups();
+  }
+  else {
+    ResultCache::clear();
+  }
+
   WorkScheduler::start(this->m_context);
 
-  executeGroups(COM_PRIORITY_HIGH);
-  if (!this->getContext().isFastCalculation()) {
-    executeGroups(COM_PRIORITY_MEDIUM);
-    executeGroups(COM_PRIORITY_LOW);
+  if (executionModel == COM_EM_FULL_FRAME) {
+    executeGroupsFullFrame();
+  }
+  else {
+    executeGroups(COM_PRIORITY_HIGH);
+    if (!this->getContext().isFastCalculation()) {
+      executeGroups(COM_PRIORITY_MEDIUM);
+      executeGroups(COM_PRIORITY_LOW);
+    }
   }
 
   WorkScheduler::finish();
   WorkScheduler::stop();
 
+  /* full frame execution stores the outputs before their buffers are freed */
+  if (use_cache && executionModel == COM_EM_TILED &&
+      !(editingtree->test_break && editingtree->test_break(editingtree->tbh))) {
+    for (index = 0; index < this->m_groups.size(); index++) {
+      this->m_groups[index]->storeCachedOutput();
+    }
+  }
+
   editingtree->stats_draw(editingtree->sdh, TIP_("Compositing | De-initializing execution"));
   for (index = 0; index < this->m_operations.size(); index++) {
     NodeOperation *operation = this->m_operations[index];
@@ -197,6 +236,135 @@ void ExecutionSystem::execute()
     ExecutionGroup *executionGroup = this->m_groups[index];
     executionGroup->deinitExecution();
   }
+
+  if (use_cache) {
+    ResultCacheStatistics stats;
+    ResultCache::get_statistics(&stats);
+    char buf[128];
+    BLI_snprintf(buf,
+                 sizeof(buf),
+                 TIP_("Compositing | Reused %u cached results, cache %.1f MB"),
+                 numCachedGroups,
+                 stats.bytes / (1024.0 * 1024.0));
+    editingtree->stats_draw(editingtree->sdh, buf);
+  }
+}
+
+/* Settings of the context that change the results of operations. */
+static uint64_t context_cache_key(const CompositorContext &context)
+{
+  const RenderData *rd = context.getRenderData();
+  uint64_t key = ResultCache::key_init();
+  key = ResultCache::add_to_key(key, (uint64_t)context.getFramenumber());
+  key = ResultCache::add_to_key(key, (uint64_t)context.getQuality());
+  key = ResultCache::add_to_key(key, (uint64_t)context.isFastCalculation());
+  key = ResultCache::add_to_key(key, context.getViewName() ? context.getViewName() : "");
+  key = ResultCache::add_to_key(key, (uint64_t)rd->xsch);
+  key = ResultCache::add_to_key(key, (uint64_t)rd->ysch);
+  key = ResultCache::add_to_key(key, (uint64_t)rd->size);
+  key = ResultCache::add_to_key(key, (uint64_t)(rd->mode & (R_BORDER | R_CROP)));
+  key = ResultCache::add_to_key(key, (uint64_t)(rd->scemode & R_FULL_SAMPLE));
+  key = ResultCache::add_to_key(key, &rd->border, sizeof(rd->border));
+  return key;
+}
+
+static uint64_t operation_cache_key(std::map<NodeOperation *, uint64_t> &keys,
+                                    NodeOperation *operation,
+                                    uint64_t contextKey)
+{
+  std::map<NodeOperation *, uint64_t>::iterator found = keys.find(operation);
+  if (found != keys.end()) {
+    return found->second;
+  }
+
+  uint64_t key = 0;
+  if (operation->isReadBufferOperation()) {
+    MemoryProxy *memoryProxy = ((ReadBufferOperation *)operation)->getMemoryProxy();
+    key = operation_cache_key(keys, memoryProxy->getWriteBufferOperation(), contextKey);
+  }
+  else if (operation->getNodeCacheKey() != 0) {
+    key = ResultCache::add_to_key(operation->getNodeCacheKey(), contextKey);
+    key = ResultCache::add_to_key(key, typeid(*operation).name());
+    key = ResultCache::add_to_key(key, (uint64_t)operation->getWidth());
+    key = ResultCache::add_to_key(key, (uint64_t)operation->getHeight());
+    if (operation->getNumberOfOutputSockets() > 0) {
+      key = ResultCache::add_to_key(key, (uint64_t)operation->getOutputSocket()->getDataType());
+    }
+    if (operation->isSetOperation()) {
+      float value[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+      operation->readSampled(value, 0, 0, COM_PS_NEAREST);
+      key = ResultCache::add_to_key(key, value, sizeof(value));
+    }
+    for (unsigned int index = 0; index < operation->getNumberOfInputSockets(); index++) {
+      NodeOperationInput *input = operation->getInputSocket(index);
+      const uint64_t inputKey = input->isConnected() ?
+                                    operation_cache_key(
+                                        keys, &input->getLink()->getOperation(), contextKey) :
+                                    0;
+      if (inputKey == 0) {
+        key = 0;
+        break;
+      }
+      key = ResultCache::add_to_key(key, inputKey);
+    }
+  }
+
+  keys[operation] = key;
+  return key;
+}
+
+void ExecutionSystem::determineCacheKeys()
+{
+  const uint64_t contextKey = context_cache_key(this->m_context);
+  std::map<NodeOperation *, uint64_t> keys;
+
+  for (unsigned int index = 0; index < this->m_groups.size(); index++) {
+    ExecutionGroup *group = this->m_groups[index];
+    NodeOperation *operation = group->getOutputOperation();
+    if (operation->isWriteBufferOperation()) {
+      group->setCacheKey(operation_cache_key(keys, operation, contextKey));
+    }
+  }
+}
+
+static unsigned int restore_cached_groups_recursive(std::set<ExecutionGroup *> &visited,
+                                                    ExecutionGroup *group)
+{
+  if (!visited.insert(group).second) {
+    return 0;
+  }
+  if (group->restoreCachedOutput()) {
+    return 1;
+  }
+
+  unsigned int numRestored = 0;
+  vector<MemoryProxy *> memoryProxies;
+  group->determineDependingMemoryProxies(&memoryProxies);
+  for (unsigned int index = 0; index < memoryProxies.size(); index++) {
+    ExecutionGroup *inputGroup = memoryProxies[index]->getExecutor();
+    if (inputGroup) {
+      numRestored += restore_cached_groups_recursive(visited, inputGroup);
+    }
+  }
+  return numRestored;
+}
+
+unsigned int ExecutionSystem::restoreCachedGroups()
+{
+  vector<ExecutionGroup *> outputGroups;
+  if (this->getContext().isFastCalculation()) {
+    this->findOutputExecutionGroup(&outputGroups, COM_PRIORITY_HIGH);
+  }
+  else {
+    this->findOutputExecutionGroup(&outputGroups);
+  }
+
+  unsigned int numRestored = 0;
+  std::set<ExecutionGroup *> visited;
+  for (unsigned int index = 0; index < outputGroups.size(); index++) {
+    numRestored += restore_cached_groups_recursive(visited, outputGroups[index]);
+  }
+  return numRestored;
 }
 
 void ExecutionSystem::executeGroups(CompositorPriority priority)
@@ -211,6 +379,77 @@ void ExecutionSystem::executeGroups(CompositorPriority priority)
   }
 }
 
+static void sort_groups_full_frame_recursive(std::set<ExecutionGroup *> &visited,
+                                             vector<ExecutionGroup *> &order,
+                                             ExecutionGroup *group)
+{
+  /* restored groups and the groups writing their inputs don't have to be executed */
+  if (group->isOutputCached() || !visited.insert(group).second) {
+    return;
+  }
+
+  vector<MemoryProxy *> memoryProxies;
+  group->determineDependingMemoryProxies(&memoryProxies);
+  for (unsigned int index = 0; index < memoryProxies.size(); index++) {
+    ExecutionGroup *inputGroup = memoryProxies[index]->getExecutor();
+    if (inputGroup) {
+      sort_groups_full_frame_recursive(visited, order, inputGroup);
+    }
+  }
+
+  order.push_back(group);
+}
+
+void ExecutionSystem::executeGroupsFullFrame()
+{
+  const bNodeTree *bTree = this->m_context.getbNodeTree();
+
+  /* groups are ordered so every group is executed after the groups writing its inputs,
+   * the outputs in order of their priority */
+  vector<ExecutionGroup *> order;
+  std::set<ExecutionGroup *> visited;
+  const CompositorPriority priorities[] = {
+      COM_PRIORITY_HIGH, COM_PRIORITY_MEDIUM, COM_PRIORITY_LOW};
+  const int numPriorities = this->getContext().isFastCalculation() ? 1 : 3;
+  for (int priority = 0; priority < numPriorities; priority++) {
+    vector<ExecutionGroup *> outputGroups;
+    this->findOutputExecutionGroup(&outputGroups, priorities[priority]);
+    for (unsigned int index = 0; index < outputGroups.size(); index++) {
+      sort_groups_full_frame_recursive(visited, order, outputGroups[index]);
+    }
+  }
+
+  /* count the readers of every buffer, so it can be freed after it has been read for the last
+   * time instead of keeping the buffers of all operations until the end */
+  std::map<MemoryProxy *, int> numReaders;
+  for (unsigned int index = 0; index < order.size(); index++) {
+    vector<MemoryProxy *> memoryProxies;
+    order[index]->determineDependingMemoryProxies(&memoryProxies);
+    for (unsigned int i = 0; i < memoryProxies.size(); i++) {
+      numReaders[memoryProxies[i]]++;
+    }
+  }
+
+  for (unsigned int index = 0; index < order.size(); index++) {
+    if (bTree->test_break && bTree->test_break(bTree->tbh)) {
+      break;
+    }
+    ExecutionGroup *group = order[index];
+    group->executeFullFrame(this);
+    if (!(bTree->test_break && bTree->test_break(bTree->tbh))) {
+      group->storeCachedOutput();
+    }
+
+    vector<MemoryProxy *> memoryProxies;
+    group->determineDependingMemoryProxies(&memoryProxies);
+    for (unsigned int i = 0; i < memoryProxies.size(); i++) {
+      if (--numReaders[memoryProxies[i]] == 0) {
+        memoryProxies[i]->free();
+      }
+    }
+  }
+}
+
 void ExecutionSystem::findOutputExecutionGroup(vector<ExecutionGroup *> *result,
                                                CompositorPriority priority) const
 {
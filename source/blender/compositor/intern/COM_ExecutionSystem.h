@@ -188,6 +188,23 @@ class ExecutionSystem {
  private:
   void executeGroups(CompositorPriority priority);
 
+  /**
+   * \brief execute all groups needed by the outputs one after the other, see #COM_EM_FULL_FRAME
+   */
+  void executeGroupsFullFrame();
+
+  /**
+   * \brief determine the ResultCache keys of the buffered outputs of the groups
+   */
+  void determineCacheKeys();
+
+  /**
+   * \brief restore the groups needed by the outputs from the ResultCache, the groups writing
+   * their inputs don't have to be executed when a group is restored
+   * \return the number of restored groups
+   */
+  unsigned int restoreCachedGroups();
+
   /* allow the DebugInfo class to look at internals */
   friend class DebugInfo;
 
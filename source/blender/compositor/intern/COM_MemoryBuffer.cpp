@@ -62,6 +62,7 @@ MemoryBuffer::MemoryBuffer(MemoryProxy *memoryProxy, unsigned int chunkNumber, r
       sizeof(float) * determineBufferSize() * this->m_num_channels, 16, "COM_MemoryBuffer");
   this->m_state = COM_MB_ALLOCATED;
   this->m_datatype = memoryProxy->getDataType();
+  this->m_is_a_single_elem = false;
 }
 
 MemoryBuffer::MemoryBuffer(MemoryProxy *memoryProxy, rcti *rect)
@@ -76,6 +77,7 @@ MemoryBuffer::MemoryBuffer(MemoryProxy *memoryProxy, rcti *rect)
       sizeof(float) * determineBufferSize() * this->m_num_channels, 16, "COM_MemoryBuffer");
   this->m_state = COM_MB_TEMPORARILY;
   this->m_datatype = memoryProxy->getDataType();
+  this->m_is_a_single_elem = false;
 }
 MemoryBuffer::MemoryBuffer(DataType dataType, rcti *rect)
 {
@@ -90,6 +92,22 @@ MemoryBuffer::MemoryBuffer(DataType dataType, rcti *rect)
       sizeof(float) * determineBufferSize() * this->m_num_channels, 16, "COM_MemoryBuffer");
   this->m_state = COM_MB_TEMPORARILY;
   this->m_datatype = dataType;
+  this->m_is_a_single_elem = false;
+}
+MemoryBuffer::MemoryBuffer(DataType dataType, const float *elem)
+{
+  BLI_rcti_init(&this->m_rect, 0, 1, 0, 1);
+  this->m_width = 1;
+  this->m_height = 1;
+  this->m_memoryProxy = NULL;
+  this->m_chunkNumber = -1;
+  this->m_num_channels = determine_num_channels(dataType);
+  this->m_buffer = (float *)MEM_mallocN_aligned(
+      sizeof(float) * this->m_num_channels, 16, "COM_MemoryBuffer");
+  memcpy(this->m_buffer, elem, sizeof(float) * this->m_num_channels);
+  this->m_state = COM_MB_TEMPORARILY;
+  this->m_datatype = dataType;
+  this->m_is_a_single_elem = true;
 }
 MemoryBuffer *MemoryBuffer::duplicate()
 {
@@ -94,6 +94,11 @@ class MemoryBuffer {
   int m_width;
   int m_height;
 
+  /**
+   * \brief whether the buffer holds a single element that is used for every pixel
+   */
+  bool m_is_a_single_elem;
+
  public:
   /**
    * \brief construct new MemoryBuffer for a chunk
@@ -110,6 +115,11 @@ class MemoryBuffer {
    */
   MemoryBuffer(DataType datatype, rcti *rect);
 
+  /**
+   * \brief construct new temporarily MemoryBuffer holding a single element for all pixels
+   */
+  MemoryBuffer(DataType datatype, const float *elem);
+
   /**
    * \brief destructor
    */
@@ -128,6 +138,11 @@ class MemoryBuffer {
     return this->m_num_channels;
   }
 
+  DataType get_data_type() const
+  {
+    return this->m_datatype;
+  }
+
   /**
    * \brief get the data of this MemoryBuffer
    * \note buffer should already be available in memory
@@ -137,6 +152,38 @@ class MemoryBuffer {
     return this->m_buffer;
   }
 
+  bool is_a_single_elem() const
+  {
+    return this->m_is_a_single_elem;
+  }
+
+  /**
+   * \brief number of floats between two horizontally adjacent elements.
+   * Zero for single element buffers, so loops can read them as if they were full size.
+   */
+  int elem_stride() const
+  {
+    return this->m_is_a_single_elem ? 0 : this->m_num_channels;
+  }
+
+  /**
+   * \brief number of floats between two vertically adjacent elements
+   */
+  int row_stride() const
+  {
+    return this->m_is_a_single_elem ? 0 : this->m_width * this->m_num_channels;
+  }
+
+  /**
+   * \brief get the element at the given pixel, which must be inside the buffer rect
+   */
+  float *get_elem(int x, int y)
+  {
+    BLI_assert(this->m_is_a_single_elem ||
+               (x >= m_rect.xmin && x < m_rect.xmax && y >= m_rect.ymin && y < m_rect.ymax));
+    return this->m_buffer + (y - m_rect.ymin) * row_stride() + (x - m_rect.xmin) * elem_stride();
+  }
+
   /**
    * \brief after execution the state will be set to available by calling this method
    */
@@ -37,6 +37,7 @@ NodeOperation::NodeOperation()
   this->m_isResolutionSet = false;
   this->m_openCL = false;
   this->m_btree = NULL;
+  this->m_nodeCacheKey = 0;
 }
 
 NodeOperation::~NodeOperation()
@@ -139,6 +140,31 @@ SocketReader *NodeOperation::getInputSocketReader(unsigned int inputSocketIndex)
   return this->getInputSocket(inputSocketIndex)->getReader();
 }
 
+void NodeOperation::update_memory_buffer_sampled(MemoryBuffer *output, const rcti *area)
+{
+  rcti rect = *area;
+  void *data = this->isComplex() ? this->initializeTileData(&rect) : NULL;
+  const int elem_stride = output->elem_stride();
+  for (int y = area->ymin; y < area->ymax; y++) {
+    float *elem = output->get_elem(area->xmin, y);
+    for (int x = area->xmin; x < area->xmax; x++) {
+      if (this->isComplex()) {
+        this->read(elem, x, y, data);
+      }
+      else {
+        this->readSampled(elem, x, y, COM_PS_NEAREST);
+      }
+      elem += elem_stride;
+    }
+    if (isBraked()) {
+      break;
+    }
+  }
+  if (data) {
+    this->deinitializeTileData(&rect, data);
+  }
+}
+
 NodeOperation *NodeOperation::getInputOperation(unsigned int inputSocketIndex)
 {
   NodeOperationInput *input = getInputSocket(inputSocketIndex);
@@ -123,6 +123,12 @@ class NodeOperation : public SocketReader {
    */
   bool m_isResolutionSet;
 
+  /**
+   * \brief key of the settings of the node this operation is created for, see ResultCache.
+   * Zero when the results of the operation can't be cached.
+   */
+  uint64_t m_nodeCacheKey;
+
  public:
   virtual ~NodeOperation();
 
@@ -187,6 +193,16 @@ class NodeOperation : public SocketReader {
   {
     this->m_btree = tree;
   }
+
+  void setNodeCacheKey(uint64_t key)
+  {
+    this->m_nodeCacheKey = key;
+  }
+  uint64_t getNodeCacheKey() const
+  {
+    return this->m_nodeCacheKey;
+  }
+
   virtual void initExecution();
 
   /**
@@ -200,6 +216,30 @@ class NodeOperation : public SocketReader {
   {
   }
 
+  /**
+   * \brief calculate the pixels of \a area into \a output, used by full frame execution
+   * \ingroup execution
+   * \param output: buffer to write to, covering at least \a area
+   * \param area: the area to calculate
+   * \param inputs: a buffer per input socket covering \a area, constant inputs are passed as
+   *                single element buffers (see #MemoryBuffer::is_a_single_elem)
+   *
+   * Operations override this with tight loops over the input buffers, the default falls back to
+   * reading the inputs pixel by pixel.
+   */
+  virtual void update_memory_buffer(MemoryBuffer *output,
+                                    const rcti *area,
+                                    MemoryBuffer ** /*inputs*/)
+  {
+    update_memory_buffer_sampled(output, area);
+  }
+
+  /**
+   * \brief calculate the pixels of \a area into \a output by reading the inputs per pixel
+   * \ingroup execution
+   */
+  void update_memory_buffer_sampled(MemoryBuffer *output, const rcti *area);
+
   /**
    * \brief when a chunk is executed by an OpenCLDevice, this method is called
    * \ingroup execution
@@ -18,11 +18,22 @@
 
 #include "BLI_utildefines.h"
 
+#include "DNA_camera_types.h"
+#include "DNA_color_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "BKE_camera.h"
+#include "BKE_node.h"
+
+#include "MEM_guardedalloc.h"
+
 #include "COM_Converter.h"
 #include "COM_Debug.h"
 #include "COM_ExecutionSystem.h"
 #include "COM_Node.h"
 #include "COM_NodeConverter.h"
+#include "COM_ResultCache.h"
 #include "COM_SocketProxyNode.h"
 
 #include "COM_NodeOperation.h"
@@ -38,7 +49,11 @@
 #include "COM_NodeOperationBuilder.h" /* own include */
 
 NodeOperationBuilder::NodeOperationBuilder(const CompositorContext *context, bNodeTree *b_nodetree)
-    : m_context(context), m_current_node(NULL), m_active_viewer(NULL)
+    : m_context(context),
+      m_current_node(NULL),
+      m_current_node_cache_key(0),
+      m_current_node_num_operations(0),
+      m_active_viewer(NULL)
 {
   m_graph.from_bNodeTree(*context, b_nodetree);
 }
@@ -47,6 +62,123 @@ NodeOperationBuilder::~NodeOperationBuilder()
 {
 }
 
+static uint64_t curve_mapping_cache_key(uint64_t key, const CurveMapping *cumap)
+{
+  /* Only the points of the curves, the tables are calculated from them. */
+  CurveMapping cumap_settings = *cumap;
+  for (int i = 0; i < CM_TOT; i++) {
+    cumap_settings.cm[i].curve = NULL;
+    cumap_settings.cm[i].table = NULL;
+    cumap_settings.cm[i].premultable = NULL;
+  }
+  key = ResultCache::add_to_key(key, &cumap_settings, sizeof(cumap_settings));
+  for (int i = 0; i < CM_TOT; i++) {
+    const CurveMap *cuma = &cumap->cm[i];
+    if (cuma->curve) {
+      key = ResultCache::add_to_key(key, cuma->curve, sizeof(CurveMapPoint) * cuma->totpoint);
+    }
+  }
+  return key;
+}
+
+static uint64_t node_storage_cache_key(uint64_t key, const bNode *bnode)
+{
+  switch (bnode->type) {
+    case CMP_NODE_TIME:
+    case CMP_NODE_CURVE_VEC:
+    case CMP_NODE_CURVE_RGB:
+    case CMP_NODE_HUECORRECT:
+      return curve_mapping_cache_key(key, (const CurveMapping *)bnode->storage);
+    case CMP_NODE_CRYPTOMATTE: {
+      NodeCryptomatte crypto_settings = *(const NodeCryptomatte *)bnode->storage;
+      crypto_settings.matte_id = NULL;
+      key = ResultCache::add_to_key(key, &crypto_settings, sizeof(crypto_settings));
+      const char *matte_id = ((const NodeCryptomatte *)bnode->storage)->matte_id;
+      return ResultCache::add_to_key(key, matte_id ? matte_id : "");
+    }
+    default:
+      /* Other storage doesn't contain pointers. */
+      return ResultCache::add_to_key(key, bnode->storage, MEM_allocN_len(bnode->storage));
+  }
+}
+
+/* Scene data read by nodes, it can change without the node tree changing. */
+static uint64_t node_scene_cache_key(uint64_t key,
+                                     const bNode *bnode,
+                                     const CompositorContext &context)
+{
+  if (bnode->type == CMP_NODE_DEFOCUS) {
+    /* The camera of the scene, when the node doesn't use another scene. */
+    const Scene *scene = context.getScene();
+    Object *camob = scene ? scene->camera : NULL;
+    if (camob && camob->type == OB_CAMERA) {
+      const Camera *camera = (const Camera *)camob->data;
+      const float dof_distance = BKE_camera_object_dof_distance(camob);
+      key = ResultCache::add_to_key(key, (uint64_t)camob->id.session_uuid);
+      key = ResultCache::add_to_key(key, &camera->lens, sizeof(camera->lens));
+      key = ResultCache::add_to_key(key, (uint64_t)camera->sensor_fit);
+      key = ResultCache::add_to_key(key, &camera->sensor_x, sizeof(camera->sensor_x));
+      key = ResultCache::add_to_key(key, &camera->sensor_y, sizeof(camera->sensor_y));
+      key = ResultCache::add_to_key(key, &dof_distance, sizeof(dof_distance));
+    }
+    else {
+      key = ResultCache::add_to_key(key, (uint64_t)0);
+    }
+  }
+  return key;
+}
+
+/**
+ * Key of the settings of a node, the operations created for it continue this key with their
+ * own settings and inputs (see ExecutionSystem::determineCacheKeys).
+ * Zero when the results of the node can't be cached.
+ */
+static uint64_t node_cache_key(const Node *node, const CompositorContext &context)
+{
+  const bNode *bnode = node->getbNode();
+  if (bnode == NULL) {
+    return 0;
+  }
+
+  uint64_t key = ResultCache::key_init();
+  key = ResultCache::add_to_key(key, bnode->idname);
+  key = ResultCache::add_to_key(key, &bnode->custom1, sizeof(bnode->custom1));
+  key = ResultCache::add_to_key(key, &bnode->custom2, sizeof(bnode->custom2));
+  key = ResultCache::add_to_key(key, &bnode->custom3, sizeof(bnode->custom3));
+  key = ResultCache::add_to_key(key, &bnode->custom4, sizeof(bnode->custom4));
+
+  if (bnode->id) {
+    /* Data-blocks (images, movie clips, masks...) can change without the node tree changing.
+     * Render layers are the exception, the cache is cleared when a new render result is
+     * created, see #COM_result_cache_clear. */
+    if (bnode->type != CMP_NODE_R_LAYERS) {
+      return 0;
+    }
+    key = ResultCache::add_to_key(key, (uint64_t)bnode->id->session_uuid);
+  }
+  if (bnode->storage) {
+    key = node_storage_cache_key(key, bnode);
+  }
+  key = node_scene_cache_key(key, bnode, context);
+
+  for (unsigned int index = 0; index < node->getNumberOfInputSockets(); index++) {
+    const NodeInput *input = node->getInputSocket(index);
+    const bNodeSocket *bsock = input->getbNodeSocket();
+    key = ResultCache::add_to_key(key, (uint64_t)input->isLinked());
+    if (bsock && bsock->default_value) {
+      key = ResultCache::add_to_key(
+          key, bsock->default_value, MEM_allocN_len(bsock->default_value));
+    }
+  }
+  /* Nodes can create different operations depending on the outputs that are used. */
+  for (unsigned int index = 0; index < node->getNumberOfOutputSockets(); index++) {
+    const bNodeSocket *bsock = node->getOutputSocket(index)->getbNodeSocket();
+    key = ResultCache::add_to_key(key, (uint64_t)(bsock && (bsock->flag & SOCK_IN_USE)));
+  }
+
+  return key;
+}
+
 void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
 {
   /* interface handle for nodes */
@@ -56,6 +188,8 @@ void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
     Node *node = (Node *)m_graph.nodes()[index];
 
     m_current_node = node;
+    m_current_node_cache_key = node_cache_key(node, *m_context);
+    m_current_node_num_operations = 0;
 
     DebugInfo::node_to_operations(node);
     node->convertToOperations(converter, *m_context);
@@ -107,6 +241,11 @@ void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
   /* surround complex ops with read/write buffer */
   add_complex_operation_buffers();
 
+  if (m_context->getExecutionModel() == COM_EM_FULL_FRAME) {
+    /* every operation writes its own buffer */
+    add_full_frame_operation_buffers();
+  }
+
   /* links not available from here on */
   /* XXX make m_links a local variable to avoid confusion! */
   m_links.clear();
@@ -125,6 +264,19 @@ void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
 
 void NodeOperationBuilder::addOperation(NodeOperation *operation)
 {
+  if (m_current_node) {
+    /* Tell apart the operations of a node by their order. */
+    if (m_current_node_cache_key != 0) {
+      operation->setNodeCacheKey(ResultCache::add_to_key(
+          m_current_node_cache_key, (uint64_t)m_current_node_num_operations));
+    }
+    m_current_node_num_operations++;
+  }
+  else {
+    /* Operations added for the whole graph (conversions, constants, buffers), their settings are
+     * part of the keys of their inputs or their class. */
+    operation->setNodeCacheKey(ResultCache::key_init());
+  }
   m_operations.push_back(operation);
 }
 
@@ -597,6 +749,29 @@ void NodeOperationBuilder::add_complex_operation_buffers()
   }
 }
 
+void NodeOperationBuilder::add_full_frame_operation_buffers()
+{
+  /* note: operations are cached first, since adding operations
+   * will invalidate iterators over the main m_operations
+   */
+  Operations ops;
+  for (Operations::const_iterator it = m_operations.begin(); it != m_operations.end(); ++it) {
+    NodeOperation *op = *it;
+    /* constants are passed to readers directly, buffers are written already */
+    if (op->isSetOperation() || op->isReadBufferOperation() || op->isWriteBufferOperation()) {
+      continue;
+    }
+    ops.push_back(op);
+  }
+
+  for (Operations::const_iterator it = ops.begin(); it != ops.end(); ++it) {
+    NodeOperation *op = *it;
+    for (int index = 0; index < op->getNumberOfOutputSockets(); index++) {
+      add_output_buffers(op, op->getOutputSocket(index));
+    }
+  }
+}
+
 typedef std::set<NodeOperation *> Tags;
 
 static void find_reachable_operations_recursive(Tags &reachable, NodeOperation *op)
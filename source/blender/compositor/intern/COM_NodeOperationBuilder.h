@@ -88,6 +88,10 @@ class NodeOperationBuilder {
   OutputSocketMap m_output_map;
 
   Node *m_current_node;
+  /** Key of the settings of #m_current_node, see ResultCache */
+  uint64_t m_current_node_cache_key;
+  /** Number of operations added for #m_current_node */
+  unsigned int m_current_node_num_operations;
 
   /** Operation that will be writing to the viewer image
    *  Only one operation can occupy this place at a time,
@@ -155,6 +159,8 @@ class NodeOperationBuilder {
   WriteBufferOperation *find_attached_write_buffer_operation(NodeOperationOutput *output) const;
   /** Add read/write buffer operations around complex operations */
   void add_complex_operation_buffers();
+  /** Add read/write buffer operations after every operation, for full frame execution */
+  void add_full_frame_operation_buffers();
   void add_input_buffers(NodeOperation *operation, NodeOperationInput *input);
   void add_output_buffers(NodeOperation *operation, NodeOperationOutput *output);
 
@@ -19,6 +19,8 @@
 #include "COM_OpenCLDevice.h"
 #include "COM_WorkScheduler.h"
 
+#include "PIL_time.h"
+
 typedef enum COM_VendorID { NVIDIA = 0x10DE, AMD = 0x1002 } COM_VendorID;
 const cl_image_format IMAGE_FORMAT_COLOR = {
     CL_RGBA,
@@ -64,6 +66,7 @@ void OpenCLDevice::execute(WorkPackage *work)
   const unsigned int chunkNumber = work->getChunkNumber();
   ExecutionGroup *executionGroup = work->getExecutionGroup();
   rcti rect;
+  const double start_time = PIL_check_seconds_timer();
 
   executionGroup->determineChunkRect(&rect, chunkNumber);
   MemoryBuffer **inputBuffers = executionGroup->getInputBuffersOpenCL(chunkNumber);
@@ -74,6 +77,8 @@ void OpenCLDevice::execute(WorkPackage *work)
 
   delete outputBuffer;
 
+  executionGroup->addExecutionTime(PIL_check_seconds_timer() - start_time);
+
   executionGroup->finalizeChunkExecution(chunkNumber, inputBuffers);
 }
 cl_mem OpenCLDevice::COM_clAttachMemoryBufferToKernelParameter(cl_kernel kernel,
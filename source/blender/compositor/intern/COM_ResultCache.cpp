@@ -0,0 +1,205 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2020, Blender Foundation.
+ */
+
+#include <map>
+#include <string.h>
+
+#include "COM_MemoryBuffer.h"
+#include "COM_MemoryProxy.h"
+#include "COM_ResultCache.h"
+
+#include "BLI_math_base.h"
+#include "BLI_rect.h"
+#include "BLI_threads.h"
+
+#include "DNA_userdef_types.h"
+
+typedef struct ResultCacheEntry {
+  MemoryBuffer *buffer;
+  size_t bytes;
+  /** Time in seconds it took to calculate the buffer. */
+  double cost;
+  /** The entry with the lowest priority is recycled first. */
+  double priority;
+} ResultCacheEntry;
+
+typedef std::map<uint64_t, ResultCacheEntry> ResultCacheEntries;
+
+static ResultCacheEntries g_entries;
+static ResultCacheStatistics g_statistics = {0};
+/* Priority of the last recycled entry. It's added to the priority of entries when they're used,
+ * so entries that haven't been used for a while are recycled before more expensive ones. */
+static double g_inflation = 0.0;
+/* The render pipeline clears the cache while the compositor may be executing. */
+static ThreadMutex g_mutex = BLI_MUTEX_INITIALIZER;
+
+/* FNV-1a. */
+#define RESULT_CACHE_KEY_OFFSET 0xcbf29ce484222325ULL
+#define RESULT_CACHE_KEY_PRIME 0x100000001b3ULL
+
+uint64_t ResultCache::key_init()
+{
+  return RESULT_CACHE_KEY_OFFSET;
+}
+
+uint64_t ResultCache::add_to_key(uint64_t key, const void *data, size_t size)
+{
+  const unsigned char *bytes = (const unsigned char *)data;
+  for (size_t i = 0; i < size; i++) {
+    key = (key ^ bytes[i]) * RESULT_CACHE_KEY_PRIME;
+  }
+  /* Zero is reserved for results that can't be cached. */
+  return (key != 0) ? key : RESULT_CACHE_KEY_OFFSET;
+}
+
+uint64_t ResultCache::add_to_key(uint64_t key, const char *str)
+{
+  /* Include the terminator, so concatenated strings give different keys. */
+  return add_to_key(key, str, strlen(str) + 1);
+}
+
+uint64_t ResultCache::add_to_key(uint64_t key, uint64_t value)
+{
+  return add_to_key(key, &value, sizeof(value));
+}
+
+static size_t result_cache_limit()
+{
+  return (size_t)max_ii(U.compositor_cache_limit, 0) * 1024 * 1024;
+}
+
+bool ResultCache::is_enabled()
+{
+  return U.compositor_cache_limit > 0;
+}
+
+static void result_cache_entry_touch(ResultCacheEntry *entry)
+{
+  entry->priority = g_inflation + entry->cost / (double)max_zz(entry->bytes, 1);
+}
+
+static void result_cache_entry_free(ResultCacheEntries::iterator iter)
+{
+  g_statistics.bytes -= iter->second.bytes;
+  g_statistics.num_entries--;
+  delete iter->second.buffer;
+  g_entries.erase(iter);
+}
+
+/* Recycle entries until the given number of bytes fits within the limit. */
+static bool result_cache_make_space(size_t bytes)
+{
+  const size_t limit = result_cache_limit();
+  /* A buffer that doesn't fit at all is not stored, but a lowered limit still applies. */
+  const size_t needed = (bytes <= limit) ? bytes : 0;
+
+  while (!g_entries.empty() && g_statistics.bytes + needed > limit) {
+    ResultCacheEntries::iterator lowest = g_entries.begin();
+    for (ResultCacheEntries::iterator iter = g_entries.begin(); iter != g_entries.end(); ++iter) {
+      if (iter->second.priority < lowest->second.priority) {
+        lowest = iter;
+      }
+    }
+    g_inflation = lowest->second.priority;
+    result_cache_entry_free(lowest);
+    g_statistics.recycled++;
+  }
+
+  return bytes <= limit;
+}
+
+bool ResultCache::restore(uint64_t key, MemoryProxy *proxy)
+{
+  bool restored = false;
+
+  BLI_mutex_lock(&g_mutex);
+  ResultCacheEntries::iterator found = g_entries.find(key);
+  if (found != g_entries.end()) {
+    ResultCacheEntry *entry = &found->second;
+    const bool allocate = (proxy->getBuffer() == NULL);
+    if (allocate) {
+      proxy->allocate(entry->buffer->getWidth(), entry->buffer->getHeight());
+    }
+    MemoryBuffer *buffer = proxy->getBuffer();
+    if (BLI_rcti_compare(buffer->getRect(), entry->buffer->getRect()) &&
+        buffer->get_num_channels() == entry->buffer->get_num_channels()) {
+      buffer->copyContentFrom(entry->buffer);
+      result_cache_entry_touch(entry);
+      restored = true;
+    }
+    else if (allocate) {
+      proxy->free();
+    }
+  }
+  if (restored) {
+    g_statistics.hits++;
+  }
+  else {
+    g_statistics.misses++;
+  }
+  BLI_mutex_unlock(&g_mutex);
+
+  return restored;
+}
+
+void ResultCache::store(uint64_t key, MemoryBuffer *buffer, double cost)
+{
+  const size_t bytes = sizeof(float) * buffer->get_num_channels() * buffer->getWidth() *
+                       buffer->getHeight();
+
+  BLI_mutex_lock(&g_mutex);
+  ResultCacheEntries::iterator found = g_entries.find(key);
+  if (found != g_entries.end()) {
+    /* Calculated again, because the result couldn't be restored. */
+    result_cache_entry_free(found);
+  }
+
+  if (result_cache_make_space(bytes)) {
+    ResultCacheEntry entry;
+    entry.buffer = new MemoryBuffer(buffer->get_data_type(), buffer->getRect());
+    entry.buffer->copyContentFrom(buffer);
+    entry.bytes = bytes;
+    entry.cost = cost;
+    result_cache_entry_touch(&entry);
+    g_entries[key] = entry;
+
+    g_statistics.bytes += bytes;
+    g_statistics.num_entries++;
+    g_statistics.stored++;
+  }
+  BLI_mutex_unlock(&g_mutex);
+}
+
+void ResultCache::clear()
+{
+  BLI_mutex_lock(&g_mutex);
+  for (ResultCacheEntries::iterator iter = g_entries.begin(); iter != g_entries.end(); ++iter) {
+    delete iter->second.buffer;
+  }
+  g_entries.clear();
+  memset(&g_statistics, 0, sizeof(g_statistics));
+  g_inflation = 0.0;
+  BLI_mutex_unlock(&g_mutex);
+}
+
+void ResultCache::get_statistics(ResultCacheStatistics *r_stats)
+{
+  BLI_mutex_lock(&g_mutex);
+  *r_stats = g_statistics;
+  BLI_mutex_unlock(&g_mutex);
+}
@@ -0,0 +1,90 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2020, Blender Foundation.
+ */
+
+#pragma once
+
+#include "BLI_sys_types.h"
+
+class MemoryBuffer;
+class MemoryProxy;
+
+/**
+ * \brief statistics of the ResultCache, see ResultCache::get_statistics
+ * \ingroup Memory
+ */
+typedef struct ResultCacheStatistics {
+  /** Results restored from and stored in the cache since it was last cleared. */
+  unsigned int hits;
+  unsigned int misses;
+  unsigned int stored;
+  /** Results removed to make space for more valuable ones. */
+  unsigned int recycled;
+  unsigned int num_entries;
+  size_t bytes;
+} ResultCacheStatistics;
+
+/**
+ * \brief cache of the buffered results of operations, persistent between executions.
+ * \ingroup Memory
+ *
+ * Every ExecutionSystem is built from scratch, the cache lets it skip the groups whose output
+ * was already calculated by an earlier execution. Results are identified by a key that is a
+ * hash of the settings of the operations writing them and the keys of their inputs
+ * (see ExecutionSystem::determineCacheKeys), so changing a node only changes the keys of the
+ * results depending on it.
+ *
+ * The size of the cache is limited by #UserDef.compositor_cache_limit. When the limit is
+ * reached, results that took long to calculate for their size are kept longest
+ * (GreedyDual-Size, like the sequencer cache).
+ */
+class ResultCache {
+ public:
+  /**
+   * \brief start a key, continue it with the add_to_key functions
+   * \note keys are never zero, zero is used for results that can't be cached
+   */
+  static uint64_t key_init();
+  static uint64_t add_to_key(uint64_t key, const void *data, size_t size);
+  static uint64_t add_to_key(uint64_t key, const char *str);
+  static uint64_t add_to_key(uint64_t key, uint64_t value);
+
+  /**
+   * \brief the cache is disabled by setting its limit to zero
+   */
+  static bool is_enabled();
+
+  /**
+   * \brief copy the cached result of the key into the buffer of the proxy
+   * \note the buffer is only allocated when there is a result, if it isn't already
+   * \return false when there is no cached result for the key
+   */
+  static bool restore(uint64_t key, MemoryProxy *proxy);
+
+  /**
+   * \brief store a copy of the buffer, when it's worth keeping with the current memory limit
+   * \param cost: the time in seconds it took to calculate the buffer
+   */
+  static void store(uint64_t key, MemoryBuffer *buffer, double cost);
+
+  /**
+   * \brief remove all results, for example when the render result they're based on changed
+   */
+  static void clear();
+
+  static void get_statistics(ResultCacheStatistics *r_stats);
+};
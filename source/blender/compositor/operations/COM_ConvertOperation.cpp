@@ -35,6 +35,26 @@ void ConvertBaseOperation::deinitExecution()
   this->m_inputOperation = NULL;
 }
 
+/* Full frame loop of conversions, calls fn(out, in) for every element of the area. */
+template<typename ConvertFn>
+static void convert_memory_buffer(MemoryBuffer *output,
+                                  const rcti *area,
+                                  MemoryBuffer *input,
+                                  const ConvertFn &fn)
+{
+  const int out_stride = output->elem_stride();
+  const int in_stride = input->elem_stride();
+  for (int y = area->ymin; y < area->ymax; y++) {
+    float *out = output->get_elem(area->xmin, y);
+    const float *in = input->get_elem(area->xmin, y);
+    for (int x = area->xmin; x < area->xmax; x++) {
+      fn(out, in);
+      out += out_stride;
+      in += in_stride;
+    }
+  }
+}
+
 /* ******** Value to Color ******** */
 
 ConvertValueToColorOperation::ConvertValueToColorOperation() : ConvertBaseOperation()
@@ -54,6 +74,16 @@ void ConvertValueToColorOperation::executePixelSampled(float output[4],
   output[3] = 1.0f;
 }
 
+void ConvertValueToColorOperation::update_memory_buffer(MemoryBuffer *output,
+                                                        const rcti *area,
+                                                        MemoryBuffer **inputs)
+{
+  convert_memory_buffer(output, area, inputs[0], [](float *out, const float *in) {
+    out[0] = out[1] = out[2] = in[0];
+    out[3] = 1.0f;
+  });
+}
+
 /* ******** Color to Value ******** */
 
 ConvertColorToValueOperation::ConvertColorToValueOperation() : ConvertBaseOperation()
@@ -72,6 +102,15 @@ void ConvertColorToValueOperation::executePixelSampled(float output[4],
   output[0] = (inputColor[0] + inputColor[1] + inputColor[2]) / 3.0f;
 }
 
+void ConvertColorToValueOperation::update_memory_buffer(MemoryBuffer *output,
+                                                        const rcti *area,
+                                                        MemoryBuffer **inputs)
+{
+  convert_memory_buffer(output, area, inputs[0], [](float *out, const float *in) {
+    out[0] = (in[0] + in[1] + in[2]) / 3.0f;
+  });
+}
+
 /* ******** Color to BW ******** */
 
 ConvertColorToBWOperation::ConvertColorToBWOperation() : ConvertBaseOperation()
@@ -90,6 +129,15 @@ void ConvertColorToBWOperation::executePixelSampled(float output[4],
   output[0] = IMB_colormanagement_get_luminance(inputColor);
 }
 
+void ConvertColorToBWOperation::update_memory_buffer(MemoryBuffer *output,
+                                                     const rcti *area,
+                                                     MemoryBuffer **inputs)
+{
+  convert_memory_buffer(output, area, inputs[0], [](float *out, const float *in) {
+    out[0] = IMB_colormanagement_get_luminance(in);
+  });
+}
+
 /* ******** Color to Vector ******** */
 
 ConvertColorToVectorOperation::ConvertColorToVectorOperation() : ConvertBaseOperation()
@@ -108,6 +156,15 @@ void ConvertColorToVectorOperation::executePixelSampled(float output[4],
   copy_v3_v3(output, color);
 }
 
+void ConvertColorToVectorOperation::update_memory_buffer(MemoryBuffer *output,
+                                                         const rcti *area,
+                                                         MemoryBuffer **inputs)
+{
+  convert_memory_buffer(output, area, inputs[0], [](float *out, const float *in) {
+    copy_v3_v3(out, in);
+  });
+}
+
 /* ******** Value to Vector ******** */
 
 ConvertValueToVectorOperation::ConvertValueToVectorOperation() : ConvertBaseOperation()
@@ -126,6 +183,15 @@ void ConvertValueToVectorOperation::executePixelSampled(float output[4],
   output[0] = output[1] = output[2] = value;
 }
 
+void ConvertValueToVectorOperation::update_memory_buffer(MemoryBuffer *output,
+                                                         const rcti *area,
+                                                         MemoryBuffer **inputs)
+{
+  convert_memory_buffer(output, area, inputs[0], [](float *out, const float *in) {
+    out[0] = out[1] = out[2] = in[0];
+  });
+}
+
 /* ******** Vector to Color ******** */
 
 ConvertVectorToColorOperation::ConvertVectorToColorOperation() : ConvertBaseOperation()
@@ -143,6 +209,16 @@ void ConvertVectorToColorOperation::executePixelSampled(float output[4],
   output[3] = 1.0f;
 }
 
+void ConvertVectorToColorOperation::update_memory_buffer(MemoryBuffer *output,
+                                                         const rcti *area,
+                                                         MemoryBuffer **inputs)
+{
+  convert_memory_buffer(output, area, inputs[0], [](float *out, const float *in) {
+    copy_v3_v3(out, in);
+    out[3] = 1.0f;
+  });
+}
+
 /* ******** Vector to Value ******** */
 
 ConvertVectorToValueOperation::ConvertVectorToValueOperation() : ConvertBaseOperation()
@@ -161,6 +237,15 @@ void ConvertVectorToValueOperation::executePixelSampled(float output[4],
   output[0] = (input[0] + input[1] + input[2]) / 3.0f;
 }
 
+void ConvertVectorToValueOperation::update_memory_buffer(MemoryBuffer *output,
+                                                         const rcti *area,
+                                                         MemoryBuffer **inputs)
+{
+  convert_memory_buffer(output, area, inputs[0], [](float *out, const float *in) {
+    out[0] = (in[0] + in[1] + in[2]) / 3.0f;
+  });
+}
+
 /* ******** RGB to YCC ******** */
 
 ConvertRGBToYCCOperation::ConvertRGBToYCCOperation() : ConvertBaseOperation()
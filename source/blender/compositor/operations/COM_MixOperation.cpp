@@ -95,6 +95,47 @@ void MixBaseOperation::deinitExecution()
   this->m_inputColor2Operation = NULL;
 }
 
+typedef void (*MixElemFn)(float out[4],
+                          const float color1[4],
+                          const float color2[4],
+                          const float value);
+
+/* Full frame loop of the mix operations, calls mix_fn for every element of the area, with the
+ * factor already multiplied by the alpha of the second color if needed. */
+template<MixElemFn mix_fn>
+static void mix_memory_buffer(MemoryBuffer *output,
+                              const rcti *area,
+                              MemoryBuffer **inputs,
+                              const bool use_value_alpha_multiply,
+                              const bool use_clamp)
+{
+  MemoryBuffer *value_buffer = inputs[0];
+  MemoryBuffer *color1_buffer = inputs[1];
+  MemoryBuffer *color2_buffer = inputs[2];
+  const int out_stride = output->elem_stride();
+  const int value_stride = value_buffer->elem_stride();
+  const int color1_stride = color1_buffer->elem_stride();
+  const int color2_stride = color2_buffer->elem_stride();
+  for (int y = area->ymin; y < area->ymax; y++) {
+    float *out = output->get_elem(area->xmin, y);
+    const float *value = value_buffer->get_elem(area->xmin, y);
+    const float *color1 = color1_buffer->get_elem(area->xmin, y);
+    const float *color2 = color2_buffer->get_elem(area->xmin, y);
+    for (int x = area->xmin; x < area->xmax; x++) {
+      const float fac = use_value_alpha_multiply ? value[0] * color2[3] : value[0];
+      mix_fn(out, color1, color2, fac);
+      out[3] = color1[3];
+      if (use_clamp) {
+        clamp_v4(out, 0.0f, 1.0f);
+      }
+      out += out_stride;
+      value += value_stride;
+      color1 += color1_stride;
+      color2 += color2_stride;
+    }
+  }
+}
+
 /* ******** Mix Add Operation ******** */
 
 MixAddOperation::MixAddOperation() : MixBaseOperation()
@@ -124,6 +165,24 @@ void MixAddOperation::executePixelSampled(float output[4], float x, float y, Pix
   clampIfNeeded(output);
 }
 
+static void mix_add_elem(float out[4],
+                        const float color1[4],
+                        const float color2[4],
+                        const float value)
+{
+  out[0] = color1[0] + value * color2[0];
+  out[1] = color1[1] + value * color2[1];
+  out[2] = color1[2] + value * color2[2];
+}
+
+void MixAddOperation::update_memory_buffer(MemoryBuffer *output,
+                                           const rcti *area,
+                                           MemoryBuffer **inputs)
+{
+  mix_memory_buffer<mix_add_elem>(
+      output, area, inputs, this->useValueAlphaMultiply(), this->m_useClamp);
+}
+
 /* ******** Mix Blend Operation ******** */
 
 MixBlendOperation::MixBlendOperation() : MixBaseOperation()
@@ -158,6 +217,25 @@ void MixBlendOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+static void mix_blend_elem(float out[4],
+                          const float color1[4],
+                          const float color2[4],
+                          const float value)
+{
+  const float valuem = 1.0f - value;
+  out[0] = valuem * color1[0] + value * color2[0];
+  out[1] = valuem * color1[1] + value * color2[1];
+  out[2] = valuem * color1[2] + value * color2[2];
+}
+
+void MixBlendOperation::update_memory_buffer(MemoryBuffer *output,
+                                             const rcti *area,
+                                             MemoryBuffer **inputs)
+{
+  mix_memory_buffer<mix_blend_elem>(
+      output, area, inputs, this->useValueAlphaMultiply(), this->m_useClamp);
+}
+
 /* ******** Mix Burn Operation ******** */
 
 MixColorBurnOperation::MixColorBurnOperation() : MixBaseOperation()
@@ -705,6 +783,25 @@ void MixMultiplyOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+static void mix_multiply_elem(float out[4],
+                             const float color1[4],
+                             const float color2[4],
+                             const float value)
+{
+  const float valuem = 1.0f - value;
+  out[0] = color1[0] * (valuem + value * color2[0]);
+  out[1] = color1[1] * (valuem + value * color2[1]);
+  out[2] = color1[2] * (valuem + value * color2[2]);
+}
+
+void MixMultiplyOperation::update_memory_buffer(MemoryBuffer *output,
+                                                const rcti *area,
+                                                MemoryBuffer **inputs)
+{
+  mix_memory_buffer<mix_multiply_elem>(
+      output, area, inputs, this->useValueAlphaMultiply(), this->m_useClamp);
+}
+
 /* ******** Mix Ovelray Operation ******** */
 
 MixOverlayOperation::MixOverlayOperation() : MixBaseOperation()
@@ -909,6 +1006,24 @@ void MixSubtractOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+static void mix_subtract_elem(float out[4],
+                             const float color1[4],
+                             const float color2[4],
+                             const float value)
+{
+  out[0] = color1[0] - value * color2[0];
+  out[1] = color1[1] - value * color2[1];
+  out[2] = color1[2] - value * color2[2];
+}
+
+void MixSubtractOperation::update_memory_buffer(MemoryBuffer *output,
+                                                const rcti *area,
+                                                MemoryBuffer **inputs)
+{
+  mix_memory_buffer<mix_subtract_elem>(
+      output, area, inputs, this->useValueAlphaMultiply(), this->m_useClamp);
+}
+
 /* ******** Mix Value Operation ******** */
 
 MixValueOperation::MixValueOperation() : MixBaseOperation()
@@ -29,6 +29,8 @@ class WriteBufferOperation : public NodeOperation {
   MemoryProxy *m_memoryProxy;
   bool m_single_value; /* single value stored in buffer */
   NodeOperation *m_input;
+  /* input buffers of m_input, only set during full frame execution */
+  MemoryBuffer **m_full_frame_inputs;
 
  public:
   WriteBufferOperation(DataType datatype);
@@ -61,4 +63,12 @@ class WriteBufferOperation : public NodeOperation {
   {
     return m_input;
   }
+  /**
+   * \brief let #executeRegion pass buffers to #NodeOperation::update_memory_buffer of the input
+   * \param inputs: a buffer per input socket of the input operation, or NULL to read per pixel
+   */
+  void set_full_frame_inputs(MemoryBuffer **inputs)
+  {
+    m_full_frame_inputs = inputs;
+  }
 };
@@ -21,6 +21,7 @@
 
 #include "PIL_time.h"
 
+#include "BKE_animsys.h"
 #include "BKE_global.h"
 
 #include "DNA_scene_types.h"
@@ -111,6 +112,10 @@ void AbstractBuilderPipeline::build_step_finalize()
     abort();
   }
 #endif
+  /* Data-blocks might have been changed without tagging their copies for an update. */
+  BKE_animsys_eval_plans_invalidate();
+  /* Operations are new, measure their evaluation cost. */
+  deg_graph_->eval_cost_countdown = 0;
   /* Relations are up to date. */
   deg_graph_->need_update = false;
 }
@@ -71,6 +71,7 @@ Depsgraph::Depsgraph(Main *bmain, Scene *scene, ViewLayer *view_layer, eEvaluati
       scene_cow(nullptr),
       is_active(false),
       is_evaluating(false),
+      eval_cost_countdown(0),
       is_render_pipeline_depsgraph(false)
 {
   BLI_spin_init(&lock);
@@ -158,6 +158,10 @@ struct Depsgraph {
 
   bool is_evaluating;
 
+  /* Number of evaluations left until the evaluation cost of operations is measured again.
+   * Zero means the next evaluation measures them, which is the case after relations are built. */
+  int eval_cost_countdown;
+
   /* Is set to truth for dependency graph which are used for post-processing (compositor and
    * sequencer).
    * Such dependency graph needs all view layers (so render pipeline can access names), but it
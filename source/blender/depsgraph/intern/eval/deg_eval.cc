@@ -27,10 +27,13 @@
 
 #include "PIL_time.h"
 
+#include <algorithm>
+
 #include "BLI_compiler_attrs.h"
 #include "BLI_gsqueue.h"
 #include "BLI_task.h"
 #include "BLI_utildefines.h"
+#include "BLI_vector.hh"
 
 #include "BKE_global.h"
 
@@ -57,10 +60,19 @@
 namespace blender {
 namespace deg {
 
+/* Measure the evaluation cost of operations once every this many evaluations. */
+#define EVAL_COST_MEASURE_INTERVAL 32
+/* Operations known to take less time than this (in seconds) are evaluated by the thread which
+ * made them ready, pushing them to the task pool would take longer. */
+#define EVAL_COST_INLINE_THRESHOLD 5e-6f
+
 namespace {
 
 struct DepsgraphEvalState;
 
+/* Operations which became ready for evaluation. */
+typedef Vector<OperationNode *, 16> ReadyOperations;
+
 void deg_task_run_func(TaskPool *pool, void *taskdata);
 
 template<typename ScheduleFunction, typename... ScheduleFunctionArgs>
@@ -74,6 +86,13 @@ void schedule_node_to_pool(OperationNode *node, const int UNUSED(thread_id), Tas
   BLI_task_pool_push(pool, deg_task_run_func, node, false, NULL);
 }
 
+void schedule_node_to_vector(OperationNode *node,
+                             const int UNUSED(thread_id),
+                             ReadyOperations *ready_operations)
+{
+  ready_operations->append(node);
+}
+
 /* Denotes which part of dependency graph is being evaluated. */
 enum class EvaluationStage {
   /* Stage 1: Only  Copy-on-Write operations are to be evaluated, prior to anything else.
@@ -96,6 +115,11 @@ struct DepsgraphEvalState {
   bool do_stats;
   EvaluationStage stage;
   bool need_single_thread_pass;
+  /* Measure operation timing to update their evaluation cost. */
+  bool do_measure_costs;
+  /* Follow the critical path: the ready operation with the highest priority is evaluated next
+   * by the same thread, cheap operations are not pushed to the task pool. */
+  bool use_priorities;
 };
 
 void evaluate_node(const DepsgraphEvalState *state, OperationNode *operation_node)
@@ -105,7 +129,7 @@ void evaluate_node(const DepsgraphEvalState *state, OperationNode *operation_nod
   /* Sanity checks. */
   BLI_assert(!operation_node->is_noop() && "NOOP nodes should not actually be scheduled");
   /* Perform operation. */
-  if (state->do_stats) {
+  if (state->do_stats || state->do_measure_costs) {
     const double start_time = PIL_check_seconds_timer();
     operation_node->evaluate(depsgraph);
     operation_node->stats.current_time += PIL_check_seconds_timer() - start_time;
@@ -115,17 +139,63 @@ void evaluate_node(const DepsgraphEvalState *state, OperationNode *operation_nod
   }
 }
 
+bool is_cheap_operation(const OperationNode *operation_node)
+{
+  return operation_node->eval_cost >= 0.0f &&
+         operation_node->eval_cost < EVAL_COST_INLINE_THRESHOLD;
+}
+
 void deg_task_run_func(TaskPool *pool, void *taskdata)
 {
   void *userdata_v = BLI_task_pool_user_data(pool);
   DepsgraphEvalState *state = (DepsgraphEvalState *)userdata_v;
 
-  /* Evaluate node. */
   OperationNode *operation_node = reinterpret_cast<OperationNode *>(taskdata);
-  evaluate_node(state, operation_node);
+  if (!state->use_priorities) {
+    /* Evaluate node. */
+    evaluate_node(state, operation_node);
+
+    /* Schedule children. */
+    schedule_children(state, operation_node, schedule_node_to_pool, pool);
+    return;
+  }
+
+  /* Operations to be evaluated by this thread, the last one is evaluated first. */
+  ReadyOperations local_operations;
+  ReadyOperations ready_operations;
+  local_operations.append(operation_node);
 
-  /* Schedule children. */
-  schedule_children(state, operation_node, schedule_node_to_pool, pool);
+  while (!local_operations.is_empty()) {
+    operation_node = local_operations.pop_last();
+    evaluate_node(state, operation_node);
+
+    ready_operations.clear();
+    schedule_children(state, operation_node, schedule_node_to_vector, &ready_operations);
+    if (ready_operations.is_empty()) {
+      continue;
+    }
+
+    /* Continue with the child on the critical path, and with the cheap ones afterwards.
+     * Other children are left to other threads. */
+    OperationNode *next_operation = ready_operations[0];
+    for (OperationNode *ready_operation : ready_operations) {
+      if (ready_operation->eval_priority > next_operation->eval_priority) {
+        next_operation = ready_operation;
+      }
+    }
+    for (OperationNode *ready_operation : ready_operations) {
+      if (ready_operation == next_operation) {
+        continue;
+      }
+      if (is_cheap_operation(ready_operation)) {
+        local_operations.append(ready_operation);
+      }
+      else {
+        BLI_task_pool_push(pool, deg_task_run_func, ready_operation, false, NULL);
+      }
+    }
+    local_operations.append(next_operation);
+  }
 }
 
 bool check_operation_node_visible(OperationNode *op_node)
@@ -180,7 +250,7 @@ void calculate_pending_parents(Depsgraph *graph)
 
 void initialize_execution(DepsgraphEvalState *state, Depsgraph *graph)
 {
-  const bool do_stats = state->do_stats;
+  const bool do_stats = state->do_stats || state->do_measure_costs;
   calculate_pending_parents(graph);
   /* Clear tags and other things which needs to be clear. */
   for (OperationNode *node : graph->operations) {
@@ -307,6 +377,27 @@ void schedule_children(DepsgraphEvalState *state,
   }
 }
 
+/* Push all operations which are ready for evaluation to the pool, the ones on the most expensive
+ * paths first. */
+void schedule_graph_to_pool(DepsgraphEvalState *state, TaskPool *pool)
+{
+  if (!state->use_priorities) {
+    schedule_graph(state, schedule_node_to_pool, pool);
+    return;
+  }
+
+  ReadyOperations ready_operations;
+  schedule_graph(state, schedule_node_to_vector, &ready_operations);
+  std::stable_sort(ready_operations.begin(),
+                   ready_operations.end(),
+                   [](const OperationNode *a, const OperationNode *b) {
+                     return a->eval_priority > b->eval_priority;
+                   });
+  for (OperationNode *operation_node : ready_operations) {
+    BLI_task_pool_push(pool, deg_task_run_func, operation_node, false, NULL);
+  }
+}
+
 void schedule_node_to_queue(OperationNode *node,
                             const int /*thread_id*/,
                             GSQueue *evaluation_queue)
@@ -380,6 +471,9 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
   state.graph = graph;
   state.do_stats = graph->debug.do_time_debug();
   state.need_single_thread_pass = false;
+  state.do_measure_costs = (graph->eval_cost_countdown == 0);
+  /* Debug value to compare with the evaluation order of the task pool. */
+  state.use_priorities = (G.debug_value != 798);
   /* Prepare all nodes for evaluation. */
   initialize_execution(&state, graph);
 
@@ -387,14 +481,14 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
   /* First, process all Copy-On-Write nodes. */
   state.stage = EvaluationStage::COPY_ON_WRITE;
   TaskPool *task_pool = deg_evaluate_task_pool_create(&state);
-  schedule_graph(&state, schedule_node_to_pool, task_pool);
+  schedule_graph_to_pool(&state, task_pool);
   BLI_task_pool_work_and_wait(task_pool);
   BLI_task_pool_free(task_pool);
 
   /* After that, process all other nodes. */
   state.stage = EvaluationStage::THREADED_EVALUATION;
   task_pool = deg_evaluate_task_pool_create(&state);
-  schedule_graph(&state, schedule_node_to_pool, task_pool);
+  schedule_graph_to_pool(&state, task_pool);
   BLI_task_pool_work_and_wait(task_pool);
   BLI_task_pool_free(task_pool);
 
@@ -409,6 +503,11 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
   if (state.do_stats) {
     deg_eval_stats_aggregate(graph);
   }
+  if (state.do_measure_costs) {
+    deg_eval_stats_update_priorities(graph);
+    graph->eval_cost_countdown = EVAL_COST_MEASURE_INTERVAL;
+  }
+  graph->eval_cost_countdown--;
   /* Clear any uncleared tags - just in case. */
   deg_graph_clear_tags(graph);
   graph->is_evaluating = false;
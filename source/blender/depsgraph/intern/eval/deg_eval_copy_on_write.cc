@@ -1082,6 +1082,11 @@ void deg_evaluate_copy_on_write(struct ::Depsgraph *graph, const IDNode *id_node
     return;
   }
   deg_update_copy_on_write_datablock(depsgraph, id_node);
+  /* The F-Curves of the previous copy might still be used by animation evaluation plans of the
+   * IDs using the action. */
+  if (GS(id_node->id_orig->name) == ID_AC) {
+    BKE_animsys_eval_plans_invalidate();
+  }
 }
 
 bool deg_validate_copy_on_write_datablock(ID *id_cow)
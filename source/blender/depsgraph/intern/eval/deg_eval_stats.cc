@@ -23,9 +23,12 @@
 
 #include "intern/eval/deg_eval_stats.h"
 
+#include "BLI_math_base.h"
 #include "BLI_utildefines.h"
+#include "BLI_vector.hh"
 
 #include "intern/depsgraph.h"
+#include "intern/depsgraph_relation.h"
 
 #include "intern/node/deg_node.h"
 #include "intern/node/deg_node_component.h"
@@ -55,5 +58,67 @@ void deg_eval_stats_aggregate(Depsgraph *graph)
   }
 }
 
+/* Weight of the latest measurement in the average evaluation cost of an operation. */
+#define EVAL_COST_MEASUREMENT_WEIGHT 0.25f
+
+static void deg_eval_stats_update_costs(Depsgraph *graph)
+{
+  for (OperationNode *op_node : graph->operations) {
+    /* Only operations which were evaluated have a measurement. */
+    if (!op_node->scheduled || op_node->is_noop()) {
+      continue;
+    }
+    const float time = (float)op_node->stats.current_time;
+    if (op_node->eval_cost < 0.0f) {
+      op_node->eval_cost = time;
+    }
+    else {
+      op_node->eval_cost += (time - op_node->eval_cost) * EVAL_COST_MEASUREMENT_WEIGHT;
+    }
+  }
+}
+
+void deg_eval_stats_update_priorities(Depsgraph *graph)
+{
+  deg_eval_stats_update_costs(graph);
+
+  /* Visit operations after all the operations depending on them, starting from the ones nothing
+   * depends on. The number of dependent operations which are not visited yet is stored in the
+   * custom flags. Cyclic relations are ignored, same as during evaluation. */
+  Vector<OperationNode *> queue;
+  for (OperationNode *op_node : graph->operations) {
+    op_node->custom_flags = 0;
+    op_node->eval_priority = 0.0f;
+  }
+  for (OperationNode *op_node : graph->operations) {
+    for (Relation *rel : op_node->inlinks) {
+      if (rel->from->type == NodeType::OPERATION && (rel->flag & RELATION_FLAG_CYCLIC) == 0) {
+        rel->from->custom_flags++;
+      }
+    }
+  }
+  for (OperationNode *op_node : graph->operations) {
+    if (op_node->custom_flags == 0) {
+      queue.append(op_node);
+    }
+  }
+
+  while (!queue.is_empty()) {
+    OperationNode *op_node = queue.pop_last();
+    /* The priority holds the highest priority of the dependent operations at this point. */
+    op_node->eval_priority += max_ff(op_node->eval_cost, 0.0f);
+    for (Relation *rel : op_node->inlinks) {
+      if (rel->from->type != NodeType::OPERATION || (rel->flag & RELATION_FLAG_CYCLIC) != 0) {
+        continue;
+      }
+      OperationNode *from = (OperationNode *)rel->from;
+      from->eval_priority = max_ff(from->eval_priority, op_node->eval_priority);
+      if (--from->custom_flags == 0) {
+        queue.append(from);
+      }
+    }
+  }
+}
+
 }  // namespace deg
 }  // namespace blender
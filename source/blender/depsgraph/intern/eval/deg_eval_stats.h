@@ -31,5 +31,9 @@ struct Depsgraph;
 /* Aggregate operation timings to overall component and ID nodes timing. */
 void deg_eval_stats_aggregate(Depsgraph *graph);
 
+/* Accumulate the measured evaluation time of operations into their average cost, and update
+ * the critical path priorities used to order the evaluation. */
+void deg_eval_stats_update_priorities(Depsgraph *graph);
+
 }  // namespace deg
 }  // namespace blender
@@ -273,6 +273,13 @@ struct OperationNode : public Node {
   /* (OperationFlag) extra settings affecting evaluation. */
   int flag;
 
+  /* Average time in seconds the operation takes to evaluate, negative while it was never
+   * measured. Only measured on some of the evaluations, see Depsgraph::eval_cost_countdown. */
+  float eval_cost;
+  /* Cost of the most expensive chain of operations starting at this one. The evaluation
+   * continues with the ready operation of the highest priority first. */
+  float eval_priority;
+
   DEG_DEPSNODE_DECLARE;
 };
 
@@ -30,6 +30,8 @@
 
 #include "BLI_array_utils.h"
 #include "BLI_listbase.h"
+#include "BLI_math_vector.h"
+#include "BLI_stack.h"
 
 #include "BKE_context.h"
 #include "BKE_editmesh.h"
@@ -64,6 +66,9 @@
 #  define ARRAY_CHUNK_SIZE 256
 
 #  define USE_ARRAY_STORE_THREAD
+
+/* Restore steps which only change vertex data in-place, without rebuilding the BMesh. */
+#  define USE_ARRAY_STORE_RESTORE_INCREMENTAL
 #endif
 
 #ifdef USE_ARRAY_STORE_THREAD
@@ -110,6 +115,9 @@ typedef struct UndoMesh {
     BArrayState **keyblocks;
     BArrayState *mselect;
   } store;
+
+  /** Unique identifier, matched against #BMEditMesh.undo_state_id. */
+  uint state_id;
 #endif /* USE_ARRAY_STORE */
 
   size_t undo_size;
@@ -127,6 +135,9 @@ static struct {
   /* We could have the undo API pass in the previous state, for now store a local list */
   ListBase local_links;
 
+  /* Used to generate #UndoMesh.state_id. */
+  uint state_id_last;
+
 #  ifdef USE_ARRAY_STORE_THREAD
   TaskPool *task_pool;
 #  endif
@@ -494,6 +505,228 @@ static void um_arraystore_free(UndoMesh *um)
 
 /** \} */
 
+#  ifdef USE_ARRAY_STORE_RESTORE_INCREMENTAL
+
+/** \name Incremental Restore
+ *
+ * Steps which keep the same topology and only change vertices (moving them for example),
+ * share all other arrays with their neighbors in the array store.
+ * Restoring such a step only needs to write the vertex chunks which differ from
+ * the state the edit-mesh currently holds, instead of rebuilding the whole #BMesh.
+ *
+ * The state the edit-mesh holds is tracked by #BMEditMesh.undo_state_id.
+ * Changes aren't always followed by an undo push (scripts and operators without undo),
+ * so the functions updating the edit-mesh after changes clear it,
+ * only restoring in-place when the edit-mesh is known to hold that state.
+ * \{ */
+
+static bool um_customdata_layout_equal(const CustomData *cdata, const CustomData *cdata_other)
+{
+  if (cdata->totlayer != cdata_other->totlayer) {
+    return false;
+  }
+  for (int i = 0; i < cdata->totlayer; i++) {
+    const CustomDataLayer *layer = &cdata->layers[i];
+    const CustomDataLayer *layer_other = &cdata_other->layers[i];
+    if ((layer->type != layer_other->type) || (layer->flag != layer_other->flag) ||
+        (layer->active != layer_other->active) ||
+        (layer->active_rnd != layer_other->active_rnd) ||
+        (layer->active_clone != layer_other->active_clone) ||
+        (layer->active_mask != layer_other->active_mask) || (layer->uid != layer_other->uid) ||
+        !STREQ(layer->name, layer_other->name)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool um_arraystore_state_is_shared(const BArrayState *state,
+                                          const BArrayState *state_other)
+{
+  if ((state == NULL) || (state_other == NULL)) {
+    return state == state_other;
+  }
+  return (BLI_array_store_state_size_get((BArrayState *)state) ==
+          BLI_array_store_state_size_get((BArrayState *)state_other)) &&
+         (BLI_array_store_state_foreach_difference(state, state_other, NULL, NULL) == 0);
+}
+
+/**
+ * \return true when all layers besides those of \a type_skip share their data.
+ */
+static bool um_arraystore_cd_is_shared(const BArrayCustomData *bcd,
+                                       const BArrayCustomData *bcd_other,
+                                       const CustomDataType type_skip)
+{
+  while (bcd && bcd_other) {
+    if ((bcd->type != bcd_other->type) || (bcd->states_len != bcd_other->states_len)) {
+      return false;
+    }
+    if (bcd->type != type_skip) {
+      for (int i = 0; i < bcd->states_len; i++) {
+        if (!um_arraystore_state_is_shared(bcd->states[i], bcd_other->states[i])) {
+          return false;
+        }
+      }
+    }
+    bcd = bcd->next;
+    bcd_other = bcd_other->next;
+  }
+  return (bcd == NULL) && (bcd_other == NULL);
+}
+
+static const BArrayState *um_arraystore_cd_state_find(const BArrayCustomData *bcd,
+                                                      const CustomDataType type)
+{
+  for (; bcd; bcd = bcd->next) {
+    if (bcd->type == type) {
+      return bcd->states_len ? bcd->states[0] : NULL;
+    }
+  }
+  return NULL;
+}
+
+static UndoMesh *um_arraystore_find_by_state_id(const uint state_id)
+{
+  LISTBASE_FOREACH (LinkData *, link, &um_arraystore.local_links) {
+    UndoMesh *um = link->data;
+    if (um->state_id == state_id) {
+      return um;
+    }
+  }
+  return NULL;
+}
+
+struct UMRestoreVertsData {
+  BMesh *bm;
+  int cd_vert_bweight_offset;
+  /** Vertices which moved, their faces need their normals recalculated. */
+  BLI_Stack *verts_moved;
+};
+
+static void um_restore_verts_cb(void *user_data,
+                                size_t offset,
+                                const void *data,
+                                size_t data_len)
+{
+  struct UMRestoreVertsData *rd = user_data;
+  BMesh *bm = rd->bm;
+  const MVert *mvert = data;
+  const int index_start = (int)(offset / sizeof(MVert));
+  const int mvert_len = (int)(data_len / sizeof(MVert));
+
+  for (int i = 0; i < mvert_len; i++, mvert++) {
+    BMVert *v = BM_vert_at_index(bm, index_start + i);
+
+    if (!equals_v3v3(v->co, mvert->co)) {
+      copy_v3_v3(v->co, mvert->co);
+      BLI_stack_push(rd->verts_moved, &v);
+    }
+    normal_short_to_float_v3(v->no, mvert->no);
+
+    const char hflag = BM_vert_flag_from_mflag(mvert->flag);
+    if ((v->head.hflag ^ hflag) & BM_ELEM_SELECT) {
+      bm->totvertsel += (hflag & BM_ELEM_SELECT) ? 1 : -1;
+    }
+    v->head.hflag = hflag;
+
+    if (rd->cd_vert_bweight_offset != -1) {
+      BM_ELEM_CD_SET_FLOAT(v, rd->cd_vert_bweight_offset, (float)mvert->bweight / 255.0f);
+    }
+  }
+}
+
+/**
+ * Restore \a um into \a em in-place, when it only differs from \a um_curr
+ * (the state \a em currently holds) in its vertex array.
+ *
+ * \return false when nothing was changed and a full restore is needed.
+ */
+static bool undomesh_to_editmesh_incremental(UndoMesh *um,
+                                             const UndoMesh *um_curr,
+                                             BMEditMesh *em)
+{
+  const Mesh *me = &um->me;
+  const Mesh *me_curr = &um_curr->me;
+  BMesh *bm = em->bm;
+
+  /* Shape keys are stored per vertex too, always do a full restore for them. */
+  if (me->key || me_curr->key || (um->shapenr != um_curr->shapenr)) {
+    return false;
+  }
+  if ((me->totvert != me_curr->totvert) || (me->totedge != me_curr->totedge) ||
+      (me->totloop != me_curr->totloop) || (me->totpoly != me_curr->totpoly) ||
+      (me->totselect != me_curr->totselect) || (me->act_face != me_curr->act_face) ||
+      (me->cd_flag != me_curr->cd_flag)) {
+    return false;
+  }
+  /* Catch edits which didn't push an undo step. */
+  if ((bm->totvert != me->totvert) || (bm->totedge != me->totedge) ||
+      (bm->totloop != me->totloop) || (bm->totface != me->totpoly)) {
+    return false;
+  }
+  if (!(um_customdata_layout_equal(&me->vdata, &me_curr->vdata) &&
+        um_customdata_layout_equal(&me->edata, &me_curr->edata) &&
+        um_customdata_layout_equal(&me->ldata, &me_curr->ldata) &&
+        um_customdata_layout_equal(&me->pdata, &me_curr->pdata))) {
+    return false;
+  }
+  if (!(um_arraystore_cd_is_shared(um->store.vdata, um_curr->store.vdata, CD_MVERT) &&
+        um_arraystore_cd_is_shared(um->store.edata, um_curr->store.edata, -1) &&
+        um_arraystore_cd_is_shared(um->store.ldata, um_curr->store.ldata, -1) &&
+        um_arraystore_cd_is_shared(um->store.pdata, um_curr->store.pdata, -1) &&
+        um_arraystore_state_is_shared(um->store.mselect, um_curr->store.mselect))) {
+    return false;
+  }
+
+  const BArrayState *state = um_arraystore_cd_state_find(um->store.vdata, CD_MVERT);
+  const BArrayState *state_curr = um_arraystore_cd_state_find(um_curr->store.vdata, CD_MVERT);
+  if ((state == NULL) || (state_curr == NULL)) {
+    return false;
+  }
+
+#    ifdef DEBUG_TIME
+  TIMEIT_START(mesh_undo_restore_incremental);
+#    endif
+
+  BM_mesh_elem_table_ensure(bm, BM_VERT);
+
+  struct UMRestoreVertsData rd = {
+      .bm = bm,
+      .cd_vert_bweight_offset = CustomData_get_offset(&bm->vdata, CD_BWEIGHT),
+      .verts_moved = BLI_stack_new(sizeof(BMVert *), __func__),
+  };
+  BLI_array_store_state_foreach_difference(state, state_curr, um_restore_verts_cb, &rd);
+
+  const bool is_moved = !BLI_stack_is_empty(rd.verts_moved);
+  while (!BLI_stack_is_empty(rd.verts_moved)) {
+    BMVert *v;
+    BLI_stack_pop(rd.verts_moved, &v);
+    BMIter iter;
+    BMFace *f;
+    BM_ITER_ELEM (f, &iter, v, BM_FACES_OF_VERT) {
+      BM_face_normal_update(f);
+    }
+  }
+  BLI_stack_free(rd.verts_moved);
+
+  BKE_editmesh_free_derivedmesh(em);
+  if (is_moved) {
+    /* Splitting faces into triangles depends on their shape. */
+    BKE_editmesh_looptri_calc(em);
+  }
+
+#    ifdef DEBUG_TIME
+  TIMEIT_END(mesh_undo_restore_incremental);
+#    endif
+
+  return true;
+}
+
+/** \} */
+
+#  endif /* USE_ARRAY_STORE_RESTORE_INCREMENTAL */
+
 #endif /* USE_ARRAY_STORE */
 
 /* for callbacks */
@@ -527,6 +760,9 @@ static void *undomesh_from_editmesh(UndoMesh *um, BMEditMesh *em, Key *key)
   um->shapenr = em->bm->shapenr;
 
 #ifdef USE_ARRAY_STORE
+  um->state_id = ++um_arraystore.state_id_last;
+  em->undo_state_id = um->state_id;
+
   {
     /* We could be more clever here,
      * the previous undo state may be from a separate mesh. */
@@ -567,6 +803,22 @@ static void undomesh_to_editmesh(UndoMesh *um, Object *ob, BMEditMesh *em, Key *
   BLI_task_pool_work_and_wait(um_arraystore.task_pool);
 #  endif
 
+#  ifdef USE_ARRAY_STORE_RESTORE_INCREMENTAL
+  {
+    const UndoMesh *um_curr = em->undo_state_id ?
+                                  um_arraystore_find_by_state_id(em->undo_state_id) :
+                                  NULL;
+    if (um_curr && undomesh_to_editmesh_incremental(um, um_curr, em)) {
+      em->selectmode = um->selectmode;
+      em->bm->selectmode = um->selectmode;
+      em->bm->spacearr_dirty = BM_SPACEARR_DIRTY_ALL;
+      em->undo_state_id = um->state_id;
+      ob->shapenr = um->shapenr;
+      return;
+    }
+  }
+#  endif
+
 #  ifdef DEBUG_TIME
   TIMEIT_START(mesh_undo_expand);
 #  endif
@@ -632,6 +884,8 @@ static void undomesh_to_editmesh(UndoMesh *um, Object *ob, BMEditMesh *em, Key *
   MEM_freeN(em_tmp);
 
 #ifdef USE_ARRAY_STORE
+  em->undo_state_id = um->state_id;
+
   um_arraystore_expand_clear(um);
 #endif
 }
@@ -1402,6 +1402,9 @@ bool EDBM_mesh_reveal(BMEditMesh *em, bool select)
 void EDBM_mesh_normals_update(BMEditMesh *em)
 {
   BM_mesh_normals_update(em->bm);
+
+  /* The mesh may have changed since the last undo push or restore. */
+  em->undo_state_id = 0;
 }
 
 void EDBM_stats_update(BMEditMesh *em)
@@ -1461,6 +1464,10 @@ void EDBM_update_generic(Mesh *mesh, const bool do_tessellation, const bool is_d
   /* don't keep stale derivedMesh data around, see: [#38872] */
   BKE_editmesh_free_derivedmesh(em);
 
+  /* The mesh may have changed since the last undo push or restore,
+   * so it can't be restored from that state in-place. */
+  em->undo_state_id = 0;
+
 #ifdef DEBUG
   {
     BMEditSelection *ese;
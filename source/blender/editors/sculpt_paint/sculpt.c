@@ -50,6 +50,7 @@
 #include "BKE_ccg.h"
 #include "BKE_colortools.h"
 #include "BKE_context.h"
+#include "BKE_global.h"
 #include "BKE_image.h"
 #include "BKE_kelvinlet.h"
 #include "BKE_key.h"
@@ -5698,10 +5699,16 @@ static void do_brush_action(Sculpt *sd, Object *ob, Brush *brush, UnifiedPaintSe
         .nodes = nodes,
     };
 
+    const double time_start = (G.debug & G_DEBUG_SCULPT_TIME) ? PIL_check_seconds_timer() : 0.0;
+
     TaskParallelSettings settings;
     BKE_pbvh_parallel_range_settings(&settings, true, totnode);
     BLI_task_parallel_range(0, totnode, &task_data, do_brush_action_task_cb, &settings);
 
+    if (G.debug & G_DEBUG_SCULPT_TIME) {
+      ss->cache->time_undo_push += PIL_check_seconds_timer() - time_start;
+    }
+
     if (sculpt_brush_needs_normal(ss, brush)) {
       update_sculpt_normal(sd, ob, nodes, totnode);
     }
@@ -7368,7 +7375,9 @@ static void sculpt_brush_stroke_init(bContext *C, wmOperator *op)
     need_mask = true;
   }
 
-  view3d_operator_needs_opengl(C);
+  if (!G.background) {
+    view3d_operator_needs_opengl(C);
+  }
   sculpt_brush_init_tex(scene, sd, ss);
 
   is_smooth = sculpt_needs_connectivity_info(sd, brush, ss, mode);
@@ -7593,6 +7602,40 @@ static bool sculpt_stroke_test_start(bContext *C, struct wmOperator *op, const f
   return false;
 }
 
+/**
+ * Print how long the parts of a dab took, with `--debug-sculpt-time`.
+ *
+ * Normals and bounds are otherwise updated when drawing, which may not happen for every dab
+ * (or at all in background mode), so update them here to include their cost.
+ */
+static void sculpt_stroke_dab_time_print(Object *ob,
+                                         const double time_topology,
+                                         const double time_brush)
+{
+  SculptSession *ss = ob->sculpt;
+  StrokeCache *cache = ss->cache;
+
+  double time_start = PIL_check_seconds_timer();
+  BKE_pbvh_update_normals(ss->pbvh, ss->subdiv_ccg);
+  const double time_normals = PIL_check_seconds_timer() - time_start;
+
+  time_start = PIL_check_seconds_timer();
+  BKE_pbvh_update_bounds(ss->pbvh, PBVH_UpdateBB);
+  const double time_bounds = PIL_check_seconds_timer() - time_start;
+
+  printf(
+      "sculpt dab %d: brush %.3f ms, undo push %.3f ms, topology %.3f ms, normals %.3f ms, "
+      "bounds %.3f ms\n",
+      cache->dab_index,
+      time_brush * 1000.0,
+      cache->time_undo_push * 1000.0,
+      time_topology * 1000.0,
+      time_normals * 1000.0,
+      time_bounds * 1000.0);
+
+  cache->dab_index++;
+}
+
 static void sculpt_stroke_update_step(bContext *C,
                                       struct PaintStroke *UNUSED(stroke),
                                       PointerRNA *itemptr)
@@ -7602,6 +7645,8 @@ static void sculpt_stroke_update_step(bContext *C,
   Object *ob = CTX_data_active_object(C);
   SculptSession *ss = ob->sculpt;
   const Brush *brush = BKE_paint_brush(&sd->paint);
+  const bool use_time_print = (G.debug & G_DEBUG_SCULPT_TIME) != 0;
+  double time_start = 0.0, time_topology = 0.0, time_brush = 0.0;
 
   SCULPT_stroke_modifiers_check(C, ob, brush);
   sculpt_update_cache_variants(C, sd, ob, itemptr);
@@ -7620,16 +7665,32 @@ static void sculpt_stroke_update_step(bContext *C,
                                        (sd->detail_size * U.pixelsize) / 0.4f);
   }
 
+  if (use_time_print) {
+    ss->cache->time_undo_push = 0.0;
+    time_start = PIL_check_seconds_timer();
+  }
+
   if (SCULPT_stroke_is_dynamic_topology(ss, brush)) {
     do_symmetrical_brush_actions(sd, ob, sculpt_topology_update, ups);
   }
 
+  if (use_time_print) {
+    time_topology = PIL_check_seconds_timer() - time_start;
+    /* Undo pushes for topology changes are counted as part of the topology update. */
+    ss->cache->time_undo_push = 0.0;
+    time_start = PIL_check_seconds_timer();
+  }
+
   do_symmetrical_brush_actions(sd, ob, do_brush_action, ups);
   sculpt_combine_proxies(sd, ob);
 
   /* Hack to fix noise texture tearing mesh. */
   sculpt_fix_noise_tear(sd, ob);
 
+  if (use_time_print) {
+    time_brush = PIL_check_seconds_timer() - time_start - ss->cache->time_undo_push;
+  }
+
   /* TODO(sergey): This is not really needed for the solid shading,
    * which does use pBVH drawing anyway, but texture and wireframe
    * requires this.
@@ -7650,6 +7711,10 @@ static void sculpt_stroke_update_step(bContext *C,
   ss->cache->first_time = false;
   copy_v3_v3(ss->cache->true_last_location, ss->cache->true_location);
 
+  if (use_time_print) {
+    sculpt_stroke_dab_time_print(ob, time_topology, time_brush);
+  }
+
   /* Cleanup. */
   if (brush->sculpt_tool == SCULPT_TOOL_MASK) {
     SCULPT_flush_update_step(C, SCULPT_UPDATE_MASK);
@@ -7815,6 +7880,23 @@ static void sculpt_brush_stroke_cancel(bContext *C, wmOperator *op)
   sculpt_brush_exit_tex(sd);
 }
 
+/**
+ * Strokes can also be replayed from scripts in background mode where there is no active tool,
+ * with a 3D viewport region passed in the context, see `tests/python/sculpt_stroke_benchmark.py`.
+ * The script is responsible for updating the view matrices since nothing is drawn.
+ */
+static bool sculpt_brush_stroke_poll(bContext *C)
+{
+  if (SCULPT_poll(C)) {
+    return true;
+  }
+  if (G.background && SCULPT_mode_poll_view3d(C)) {
+    Sculpt *sd = CTX_data_tool_settings(C)->sculpt;
+    return BKE_paint_brush(&sd->paint) != NULL;
+  }
+  return false;
+}
+
 static void SCULPT_OT_brush_stroke(wmOperatorType *ot)
 {
   /* Identifiers. */
@@ -7826,7 +7908,7 @@ static void SCULPT_OT_brush_stroke(wmOperatorType *ot)
   ot->invoke = sculpt_brush_stroke_invoke;
   ot->modal = paint_stroke_modal;
   ot->exec = sculpt_brush_stroke_exec;
-  ot->poll = SCULPT_poll;
+  ot->poll = sculpt_brush_stroke_poll;
   ot->cancel = sculpt_brush_stroke_cancel;
 
   /* Flags (sculpt does own undo? (ton)). */
@@ -7915,6 +7997,70 @@ static void SCULPT_OT_optimize(wmOperatorType *ot)
   ot->flag = OPTYPE_REGISTER | OPTYPE_UNDO;
 }
 
+/************************* SCULPT_OT_sort_by_bvh *************************/
+
+static bool sculpt_sort_by_bvh_poll(bContext *C)
+{
+  Object *ob = CTX_data_active_object(C);
+  if (SCULPT_mode_poll(C) && ob->sculpt && ob->sculpt->pbvh) {
+    return BKE_pbvh_type(ob->sculpt->pbvh) == PBVH_FACES;
+  }
+  return false;
+}
+
+static int sculpt_sort_by_bvh_exec(bContext *C, wmOperator *UNUSED(op))
+{
+  Object *ob = CTX_data_active_object(C);
+  SculptSession *ss = ob->sculpt;
+  Mesh *mesh = ob->data;
+
+  if (SCULPT_vertex_count_get(ss) != mesh->totvert) {
+    return OPERATOR_CANCELLED;
+  }
+
+  uint *vert_idx = MEM_mallocN(sizeof(*vert_idx) * mesh->totvert, __func__);
+  uint *poly_idx = MEM_mallocN(sizeof(*poly_idx) * mesh->totpoly, __func__);
+  BKE_pbvh_mesh_leaf_order_calc(ss->pbvh, mesh->totpoly, vert_idx, poly_idx);
+
+  ED_sculpt_undo_geometry_begin(ob, "Sort Mesh by BVH");
+  BKE_mesh_remap(mesh, vert_idx, poly_idx);
+  ED_sculpt_undo_geometry_end(ob);
+  BKE_mesh_batch_cache_dirty_tag(mesh, BKE_MESH_BATCH_DIRTY_ALL);
+
+  MEM_freeN(vert_idx);
+  MEM_freeN(poly_idx);
+
+  /* Vertex data of the session is indexed in the old order. The persistent base is freed like
+   * with the PBVH (undo restores the old order), the other arrays are recalculated on demand. */
+  MEM_SAFE_FREE(ss->persistent_base);
+  MEM_SAFE_FREE(ss->vertex_info.connected_component);
+  MEM_SAFE_FREE(ss->vertex_info.boundary);
+
+  /* The rebuilt BVH reads a single range of vertices for each node. */
+  SCULPT_pbvh_clear(ob);
+  WM_event_add_notifier(C, NC_OBJECT | ND_DRAW, ob);
+
+  return OPERATOR_FINISHED;
+}
+
+/* Brushes iterate over the vertices of each BVH node, which are scattered over the whole
+ * vertex array for most meshes. Sorting the mesh by node makes these reads sequential. */
+static void SCULPT_OT_sort_by_bvh(wmOperatorType *ot)
+{
+  /* Identifiers. */
+  ot->name = "Sort Mesh by BVH";
+  ot->idname = "SCULPT_OT_sort_by_bvh";
+  ot->description =
+      "Reorder vertices and faces so the vertices of each BVH node are contiguous in memory, "
+      "improving brush performance on large meshes (changes vertex indices)";
+
+  /* API callbacks. */
+  ot->exec = sculpt_sort_by_bvh_exec;
+  ot->poll = sculpt_sort_by_bvh_poll;
+
+  ot->flag = OPTYPE_REGISTER;
+}
+
 /********************* Dynamic topology symmetrize ********************/
 
 static bool sculpt_no_multires_poll(bContext *C)
@@ -9156,6 +9302,7 @@ void ED_operatortypes_sculpt(void)
   WM_operatortype_append(SCULPT_OT_set_persistent_base);
   WM_operatortype_append(SCULPT_OT_dynamic_topology_toggle);
   WM_operatortype_append(SCULPT_OT_optimize);
+  WM_operatortype_append(SCULPT_OT_sort_by_bvh);
   WM_operatortype_append(SCULPT_OT_symmetrize);
   WM_operatortype_append(SCULPT_OT_detail_flood_fill);
   WM_operatortype_append(SCULPT_OT_sample_detail_size);
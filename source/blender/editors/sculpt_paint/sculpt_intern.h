@@ -963,6 +963,10 @@ typedef struct StrokeCache {
   rcti previous_r; /* previous redraw rectangle */
   rcti current_r;  /* current redraw rectangle */
 
+  /* Timing of the current dab, only gathered with `--debug-sculpt-time`. */
+  int dab_index;
+  double time_undo_push;
+
 } StrokeCache;
 
 /* Sculpt Filters */
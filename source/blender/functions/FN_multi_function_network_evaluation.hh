@@ -39,6 +39,11 @@ class MFNetworkEvaluator : public MultiFunction {
  private:
   using Storage = MFNetworkEvaluationStorage;
 
+  bool can_call_chunked(IndexMask mask) const;
+  void call_chunked(IndexMask mask, MFParams params, MFContext context) const;
+  void call_chunk(IndexMask mask, IndexRange chunk, MFParams params, MFContext context) const;
+  void call_unchunked(IndexMask mask, MFParams params, MFContext context) const;
+
   void copy_inputs_to_storage(MFParams params, Storage &storage) const;
   void copy_outputs_to_storage(
       MFParams params,
@@ -170,6 +170,13 @@ class GMutableSpan {
     BLI_assert(type_->is<T>());
     return MutableSpan<T>(static_cast<T *>(data_), size_);
   }
+  GMutableSpan slice(int64_t start, int64_t size) const
+  {
+    BLI_assert(start >= 0);
+    BLI_assert(size >= 0);
+    BLI_assert(start + size <= size_ || size == 0);
+    return GMutableSpan(*type_, POINTER_OFFSET(data_, type_->size() * start), size);
+  }
 };
 
 enum class VSpanCategory {
@@ -425,6 +432,30 @@ class GVSpan : public VSpanBase<void> {
     return (*this)[0];
   }
 
+  /**
+   * Returns the part of the virtual span starting at the given index. A single value stays a
+   * single value.
+   */
+  GVSpan slice(int64_t start, int64_t size) const
+  {
+    BLI_assert(start >= 0);
+    BLI_assert(size >= 0);
+    BLI_assert(start + size <= this->virtual_size_ || size == 0);
+    switch (this->category_) {
+      case VSpanCategory::Single:
+        return GVSpan::FromSingle(*this->type_, this->data_.single.data, size);
+      case VSpanCategory::FullArray: {
+        const void *data = POINTER_OFFSET(this->data_.full_array.data, start * type_->size());
+        return GVSpan(GSpan(*this->type_, data, size));
+      }
+      case VSpanCategory::FullPointerArray:
+        return GVSpan::FromFullPointerArray(
+            *this->type_, this->data_.full_pointer_array.data + start, size);
+    }
+    BLI_assert(false);
+    return GVSpan(*this->type_);
+  }
+
   GSpan as_full_array() const
   {
     BLI_assert(this->is_full_array());
@@ -28,6 +28,10 @@
  * - Avoids data copies in many cases.
  * - Every node is executed at most once.
  * - Can compute sub-functions on a single element, when the result is the same for all elements.
+ * - Large masks are split into chunks that are evaluated in parallel. All nodes are evaluated on
+ *   one chunk before the next chunk is started, so chains of functions pass their intermediate
+ *   values through buffers that are small enough to stay in the CPU cache. This relies on
+ *   multi-functions computing every element independently of the other elements in the mask.
  *
  * Possible improvements:
  * - Cache and reuse buffers.
@@ -38,9 +42,14 @@
 #include "FN_multi_function_network_evaluation.hh"
 
 #include "BLI_stack.hh"
+#include "BLI_task.h"
 
 namespace blender::fn {
 
+/* Number of elements in a chunk. This keeps the intermediate buffers of a chunk in the cache,
+ * while the overhead of evaluating the network once per chunk stays low. */
+static constexpr int64_t chunk_size = 1024;
+
 struct Value;
 
 /**
@@ -141,6 +150,105 @@ void MFNetworkEvaluator::call(IndexMask mask, MFParams params, MFContext context
     return;
   }
 
+  if (this->can_call_chunked(mask)) {
+    this->call_chunked(mask, params, context);
+  }
+  else {
+    this->call_unchunked(mask, params, context);
+  }
+}
+
+bool MFNetworkEvaluator::can_call_chunked(IndexMask mask) const
+{
+  if (mask.size() < 2 * chunk_size) {
+    return false;
+  }
+  /* Vector arrays provided by the caller can not be split into chunks. */
+  for (int param_index : this->param_indices()) {
+    if (this->param_type(param_index).data_type().category() != MFDataType::Single) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void MFNetworkEvaluator::call_chunked(IndexMask mask, MFParams params, MFContext context) const
+{
+  struct ChunkData {
+    const MFNetworkEvaluator *evaluator;
+    IndexMask mask;
+    MFParams params;
+    MFContext context;
+  } data = {this, mask, params, context};
+
+  const int64_t chunk_amount = (mask.size() + chunk_size - 1) / chunk_size;
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(
+      0,
+      (int)chunk_amount,
+      &data,
+      [](void *__restrict userdata,
+         const int chunk_index,
+         const TaskParallelTLS *__restrict UNUSED(tls)) {
+        ChunkData *data = static_cast<ChunkData *>(userdata);
+        const int64_t start = chunk_index * chunk_size;
+        const IndexRange chunk(start, std::min(chunk_size, data->mask.size() - start));
+        data->evaluator->call_chunk(data->mask, chunk, data->params, data->context);
+      },
+      &settings);
+}
+
+/**
+ * Evaluate the network on a part of the mask, with its own storage for intermediate values.
+ * The parameters are sliced to start at the first index of the chunk, so that intermediate
+ * buffers only have to be as large as the chunk.
+ */
+void MFNetworkEvaluator::call_chunk(IndexMask mask,
+                                    IndexRange chunk,
+                                    MFParams params,
+                                    MFContext context) const
+{
+  Span<int64_t> indices = mask.indices().slice(chunk);
+  const int64_t offset = indices.first();
+  const int64_t size = indices.last() - offset + 1;
+
+  Vector<int64_t> shifted_indices;
+  IndexMask chunk_mask = IndexRange(size);
+  if (size != indices.size()) {
+    shifted_indices.reserve(indices.size());
+    for (int64_t i : indices) {
+      shifted_indices.append_unchecked(i - offset);
+    }
+    chunk_mask = shifted_indices.as_span();
+  }
+
+  MFParamsBuilder chunk_params{*this, size};
+  for (int param_index : this->param_indices()) {
+    switch (this->param_type(param_index).category()) {
+      case MFParamType::SingleInput: {
+        GVSpan values = params.readonly_single_input(param_index);
+        chunk_params.add_readonly_single_input(values.slice(offset, size));
+        break;
+      }
+      case MFParamType::SingleOutput: {
+        GMutableSpan values = params.uninitialized_single_output(param_index);
+        chunk_params.add_uninitialized_single_output(values.slice(offset, size));
+        break;
+      }
+      default:
+        BLI_assert(false);
+        break;
+    }
+  }
+
+  this->call_unchunked(chunk_mask, chunk_params, context);
+}
+
+void MFNetworkEvaluator::call_unchunked(IndexMask mask, MFParams params, MFContext context) const
+{
   const MFNetwork &network = outputs_[0]->node().network();
   Storage storage(mask, network.socket_id_amount());
 
@@ -251,5 +251,72 @@ TEST(multi_function_network, Test2)
   }
 }
 
+TEST(multi_function_network, Chunked)
+{
+  CustomMF_SI_SO<int, int> add_10_fn("add 10", [](int value) { return value + 10; });
+  CustomMF_SI_SI_SO<int, int, int> multiply_fn("multiply", [](int a, int b) { return a * b; });
+
+  MFNetwork network;
+
+  MFNode &node1 = network.add_function(add_10_fn);
+  MFNode &node2 = network.add_function(multiply_fn);
+  MFOutputSocket &input_socket1 = network.add_input("Input 1", MFDataType::ForSingle<int>());
+  MFOutputSocket &input_socket2 = network.add_input("Input 2", MFDataType::ForSingle<int>());
+  MFInputSocket &output_socket = network.add_output("Output", MFDataType::ForSingle<int>());
+  network.add_link(input_socket1, node1.input(0));
+  network.add_link(node1.output(0), node2.input(0));
+  network.add_link(input_socket2, node2.input(1));
+  network.add_link(node2.output(0), output_socket);
+
+  MFNetworkEvaluator network_fn{{&input_socket1, &input_socket2}, {&output_socket}};
+
+  const int size = 10000;
+  Array<int> values(size);
+  for (int i : values.index_range()) {
+    values[i] = i;
+  }
+  int factor = 3;
+  MFContextBuilder context;
+
+  {
+    Array<int> results(size, -1);
+
+    MFParamsBuilder params(network_fn, size);
+    params.add_readonly_single_input(values.as_span());
+    params.add_readonly_single_input(&factor);
+    params.add_uninitialized_single_output(results.as_mutable_span());
+
+    network_fn.call(IndexRange(size), params, context);
+
+    for (int i : results.index_range()) {
+      EXPECT_EQ(results[i], (i + 10) * 3);
+    }
+  }
+  {
+    Array<int> results(size, -1);
+
+    Vector<int64_t> indices;
+    for (int i = 5; i < size; i += 3) {
+      indices.append(i);
+    }
+
+    MFParamsBuilder params(network_fn, size);
+    params.add_readonly_single_input(values.as_span());
+    params.add_readonly_single_input(&factor);
+    params.add_uninitialized_single_output(results.as_mutable_span());
+
+    network_fn.call(indices.as_span(), params, context);
+
+    for (int i : results.index_range()) {
+      if (i >= 5 && (i - 5) % 3 == 0) {
+        EXPECT_EQ(results[i], (i + 10) * 3);
+      }
+      else {
+        EXPECT_EQ(results[i], -1);
+      }
+    }
+  }
+}
+
 }  // namespace
 }  // namespace blender::fn::tests
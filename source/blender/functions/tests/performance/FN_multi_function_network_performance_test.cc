@@ -0,0 +1,120 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <stdio.h>
+
+#include "BLI_array.hh"
+#include "BLI_float3.hh"
+#include "BLI_vector.hh"
+
+#include "FN_multi_function_builder.hh"
+#include "FN_multi_function_network.hh"
+#include "FN_multi_function_network_evaluation.hh"
+
+#include "PIL_time.h"
+
+#define NUM_RUN_AVERAGED 5
+
+namespace blender::fn::tests {
+namespace {
+
+/* A chain of cheap element-wise functions, like a small node tree evaluated on every point. */
+struct FunctionChain {
+  CustomMF_SI_SO<float3, float3> offset_fn{"offset",
+                                           [](float3 a) { return a + float3(1.0f, 2.0f, 3.0f); }};
+  CustomMF_SI_SO<float3, float3> scale_fn{"scale", [](float3 a) { return a * 0.5f; }};
+  CustomMF_SI_SO<float3, float3> square_fn{"square",
+                                           [](float3 a) { return float3(a.x * a.x, a.y, a.z); }};
+  CustomMF_SI_SO<float3, float3> swizzle_fn{"swizzle",
+                                            [](float3 a) { return float3(a.z, a.x, a.y); }};
+
+  Vector<const MultiFunction *> functions()
+  {
+    return {&offset_fn, &scale_fn, &square_fn, &swizzle_fn, &offset_fn, &scale_fn, &swizzle_fn};
+  }
+};
+
+/* Evaluate every function on all elements before the next one, into full size buffers. This is
+ * how the network evaluator works on small masks. */
+static void evaluate_per_function(FunctionChain &chain,
+                                  Span<float3> input,
+                                  MutableSpan<float3> output)
+{
+  MFContextBuilder context;
+  Array<float3> buffer_a(input.size());
+  Array<float3> buffer_b(input.size());
+  Span<float3> src = input;
+  for (const MultiFunction *fn : chain.functions()) {
+    MFParamsBuilder params(*fn, input.size());
+    params.add_readonly_single_input(src);
+    params.add_uninitialized_single_output(buffer_a.as_mutable_span());
+    fn->call(IndexRange(input.size()), params, context);
+    std::swap(buffer_a, buffer_b);
+    src = buffer_b;
+  }
+  output.copy_from(src);
+}
+
+static void multi_function_network_perf(const int64_t size)
+{
+  FunctionChain chain;
+  MFNetwork network;
+  MFOutputSocket &input_socket = network.add_input("Input", MFDataType::ForSingle<float3>());
+  MFInputSocket &output_socket = network.add_output("Output", MFDataType::ForSingle<float3>());
+  MFOutputSocket *previous = &input_socket;
+  for (const MultiFunction *fn : chain.functions()) {
+    MFNode &node = network.add_function(*fn);
+    network.add_link(*previous, node.input(0));
+    previous = &node.output(0);
+  }
+  network.add_link(*previous, output_socket);
+  MFNetworkEvaluator network_fn{{&input_socket}, {&output_socket}};
+
+  Array<float3> input(size);
+  for (int64_t i : input.index_range()) {
+    input[i] = float3(i * 0.001f, i * 0.002f, i * 0.003f);
+  }
+  Array<float3> output_network(size);
+  Array<float3> output_reference(size);
+
+  double time_network = 0.0;
+  double time_reference = 0.0;
+  for (int run = 0; run < NUM_RUN_AVERAGED; run++) {
+    double time_start = PIL_check_seconds_timer();
+    evaluate_per_function(chain, input, output_reference);
+    time_reference += PIL_check_seconds_timer() - time_start;
+
+    time_start = PIL_check_seconds_timer();
+    MFContextBuilder context;
+    MFParamsBuilder params(network_fn, size);
+    params.add_readonly_single_input(input.as_span());
+    params.add_uninitialized_single_output(output_network.as_mutable_span());
+    network_fn.call(IndexRange(size), params, context);
+    time_network += PIL_check_seconds_timer() - time_start;
+  }
+
+  for (int64_t i : input.index_range()) {
+    EXPECT_EQ(output_network[i], output_reference[i]);
+  }
+
+  time_network /= NUM_RUN_AVERAGED;
+  time_reference /= NUM_RUN_AVERAGED;
+  printf("%9d elements: per function %.4fs, network %.4fs (%.2fx)\n",
+         (int)size,
+         time_reference,
+         time_network,
+         time_reference / time_network);
+}
+
+TEST(multi_function_network, ChunkedEvaluation)
+{
+  printf("\n========== STARTING multi-function network ==========\n");
+  multi_function_network_perf(10000);
+  multi_function_network_perf(1000000);
+  multi_function_network_perf(10000000);
+  printf("========== ENDED multi-function network ==========\n\n");
+}
+
+}  // namespace
+}  // namespace blender::fn::tests
@@ -1078,6 +1078,8 @@ typedef struct AnimData {
 
   /** Runtime data, for depsgraph evaluation. */
   FCurve **driver_array;
+  /** Runtime data, resolved paths of the active action (see anim_sys.c). */
+  struct AnimEvalPlan *eval_plan;
 
   /* settings for animation evaluation */
   /** User-defined settings. */
@@ -411,6 +411,14 @@ typedef struct bNodeLink {
 #define NTREE_CHUNKSIZE_512 512
 #define NTREE_CHUNKSIZE_1024 1024
 
+/* tree->execution_mode */
+typedef enum eNodeTreeExecutionMode {
+  /* Operations are evaluated per pixel, for chunks scheduled on demand by the outputs. */
+  NTREE_EXECUTION_MODE_TILED = 0,
+  /* Operations are evaluated for whole buffers, one operation after the other. */
+  NTREE_EXECUTION_MODE_FULL_FRAME = 1,
+} eNodeTreeExecutionMode;
+
 /* the basis for a Node tree, all links and nodes reside internal here */
 /* only re-usable node trees are in the library though,
  * materials and textures allocate own tree struct */
@@ -448,7 +456,8 @@ typedef struct bNodeTree {
   short is_updating;
   /** Generic temporary flag for recursion check (DFS/BFS). */
   short done;
-  char _pad2[4];
+  /** Compositor execution model, see #eNodeTreeExecutionMode. */
+  int execution_mode;
 
   /** Specific node type this tree is used for. */
   int nodetype DNA_DEPRECATED;
@@ -177,6 +177,12 @@ typedef struct Object_Runtime {
   /** Runtime evaluated curve-specific data, not stored in the file. */
   struct CurveCache *curve_cache;
 
+  /**
+   * Trees of the last freed evaluated mesh, reused when the next one has the same topology.
+   * `BVHCache` defined in 'BKE_bvhutil.c'.
+   */
+  struct BVHCache *bvh_cache_reuse;
+
   unsigned short local_collections_bits;
   short _pad2[3];
 } Object_Runtime;
@@ -690,6 +690,7 @@ enum {
 
   SEQ_CACHE_PREFETCH_ENABLE = (1 << 10),
   SEQ_CACHE_DISK_CACHE_ENABLE = (1 << 11),
+  SEQ_CACHE_RECYCLE_BY_COST = (1 << 12),
 };
 
 #ifdef __cplusplus
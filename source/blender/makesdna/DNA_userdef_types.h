@@ -629,8 +629,7 @@ typedef struct UserDef_Experimental {
   char use_sculpt_vertex_colors;
   char use_image_editor_legacy_drawing;
   char use_tools_missing_icons;
-  /** `makesdna` does not allow empty structs. */
-  char _pad[1];
+  char use_mmap_file_read;
 } UserDef_Experimental;
 
 #define USER_EXPERIMENTAL_TEST(userdef, member) \
@@ -757,7 +756,8 @@ typedef struct UserDef {
   int prefetchframes;
   /** Control the rotation step of the view when PAD2, PAD4, PAD6&PAD8 is use. */
   float pad_rot_angle;
-  char _pad12[4];
+  /** Memory limit of the compositor result cache in megabytes, zero disables the cache. */
+  int compositor_cache_limit;
   /** Rotating view icon size. */
   short rvisize;
   /** Rotating view icon brightness. */
@@ -1335,6 +1335,7 @@ typedef enum eUserpref_DiskCacheCompression {
   USER_SEQ_DISK_CACHE_COMPRESSION_NONE = 0,
   USER_SEQ_DISK_CACHE_COMPRESSION_LOW = 1,
   USER_SEQ_DISK_CACHE_COMPRESSION_HIGH = 2,
+  USER_SEQ_DISK_CACHE_COMPRESSION_FAST = 3,
 } eUserpref_DiskCacheCompression;
 
 /* Locale Ids. Auto will try to get local from OS. Our default is English though. */
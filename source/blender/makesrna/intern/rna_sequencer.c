@@ -1138,6 +1138,32 @@ static void rna_SequenceEditor_overlay_frame_set(PointerRNA *ptr, int value)
   }
 }
 
+static int rna_SequenceEditor_cache_stat_clamp(uint64_t value)
+{
+  return (int)MIN2(value, (uint64_t)INT_MAX);
+}
+
+static int rna_SequenceEditor_cache_hits_get(PointerRNA *ptr)
+{
+  SeqCacheStats stats;
+  BKE_sequencer_cache_stats_get((Scene *)ptr->owner_id, &stats);
+  return rna_SequenceEditor_cache_stat_clamp(stats.hits);
+}
+
+static int rna_SequenceEditor_cache_misses_get(PointerRNA *ptr)
+{
+  SeqCacheStats stats;
+  BKE_sequencer_cache_stats_get((Scene *)ptr->owner_id, &stats);
+  return rna_SequenceEditor_cache_stat_clamp(stats.misses);
+}
+
+static int rna_SequenceEditor_cache_recycled_get(PointerRNA *ptr)
+{
+  SeqCacheStats stats;
+  BKE_sequencer_cache_stats_get((Scene *)ptr->owner_id, &stats);
+  return rna_SequenceEditor_cache_stat_clamp(stats.recycled);
+}
+
 static int modifier_seq_cmp_fn(Sequence *seq, void *arg_pt)
 {
   SequenceSearchData *data = arg_pt;
@@ -2101,6 +2127,30 @@ static void rna_def_editor(BlenderRNA *brna)
   RNA_def_property_float_sdna(prop, NULL, "recycle_max_cost");
   RNA_def_property_ui_text(
       prop, "Recycle Up To Cost", "Only frames with cost lower than this value will be recycled");
+
+  prop = RNA_def_property(srna, "use_recycle_by_cost", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "cache_flag", SEQ_CACHE_RECYCLE_BY_COST);
+  RNA_def_property_ui_text(prop,
+                           "Recycle by Cost",
+                           "When cache is full, remove frames which are cheapest to render "
+                           "relative to their size and have not been used recently, instead of "
+                           "frames furthest from current frame");
+
+  prop = RNA_def_property(srna, "cache_hits", PROP_INT, PROP_UNSIGNED);
+  RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+  RNA_def_property_int_funcs(prop, "rna_SequenceEditor_cache_hits_get", NULL, NULL);
+  RNA_def_property_ui_text(prop, "Cache Hits", "Number of images found in memory cache");
+
+  prop = RNA_def_property(srna, "cache_misses", PROP_INT, PROP_UNSIGNED);
+  RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+  RNA_def_property_int_funcs(prop, "rna_SequenceEditor_cache_misses_get", NULL, NULL);
+  RNA_def_property_ui_text(prop, "Cache Misses", "Number of images not found in memory cache");
+
+  prop = RNA_def_property(srna, "cache_recycled", PROP_INT, PROP_UNSIGNED);
+  RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+  RNA_def_property_int_funcs(prop, "rna_SequenceEditor_cache_recycled_get", NULL, NULL);
+  RNA_def_property_ui_text(
+      prop, "Cache Recycled", "Number of frames removed from memory cache to free space");
 }
 
 static void rna_def_filter_video(StructRNA *srna)
@@ -5277,6 +5277,11 @@ static void rna_def_userdef_system(BlenderRNA *brna)
        0,
        "None",
        "Requires fast storage, but uses minimum CPU resources"},
+      {USER_SEQ_DISK_CACHE_COMPRESSION_FAST,
+       "FAST",
+       0,
+       "Fast",
+       "Requires fast storage, uses very little CPU resources (LZO compression)"},
       {USER_SEQ_DISK_CACHE_COMPRESSION_LOW,
        "LOW",
        0,
@@ -5332,6 +5337,16 @@ static void rna_def_userdef_system(BlenderRNA *brna)
   RNA_def_property_ui_text(prop, "Memory Cache Limit", "Memory cache limit (in megabytes)");
   RNA_def_property_update(prop, 0, "rna_Userdef_memcache_update");
 
+  prop = RNA_def_property(srna, "compositor_cache_limit", PROP_INT, PROP_NONE);
+  RNA_def_property_int_sdna(prop, NULL, "compositor_cache_limit");
+  RNA_def_property_range(prop, 0, max_memory_in_megabytes_int());
+  RNA_def_property_ui_text(
+      prop,
+      "Compositor Cache Limit",
+      "Memory limit for results kept by the compositor to avoid calculating unchanged nodes "
+      "again (in megabytes, 0 disables the cache)");
+  RNA_def_property_update(prop, 0, "rna_userdef_update");
+
   /* Sequencer disk cache */
 
   prop = RNA_def_property(srna, "use_sequencer_disk_cache", PROP_BOOLEAN, PROP_NONE);
@@ -6166,6 +6181,13 @@ static void rna_def_userdef_experimental(BlenderRNA *brna)
   prop = RNA_def_property(srna, "use_tools_missing_icons", PROP_BOOLEAN, PROP_NONE);
   RNA_def_property_boolean_sdna(prop, NULL, "use_tools_missing_icons", 1);
   RNA_def_property_ui_text(prop, "Tools with Missing Icons", "Show tools with missing icons");
+
+  prop = RNA_def_property(srna, "use_mmap_file_read", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "use_mmap_file_read", 1);
+  RNA_def_property_ui_text(prop,
+                           "Memory Mapped File Reading",
+                           "Read uncompressed blend files through a memory mapping, "
+                           "avoiding intermediate copies (faster loading of large libraries)");
 }
 
 static void rna_def_userdef_addon_collection(BlenderRNA *brna, PropertyRNA *cprop)
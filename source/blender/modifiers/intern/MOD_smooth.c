@@ -26,6 +26,7 @@
 #include "BLI_utildefines.h"
 
 #include "BLI_math.h"
+#include "BLI_task.h"
 
 #include "BLT_translation.h"
 
@@ -38,6 +39,7 @@
 #include "BKE_editmesh.h"
 #include "BKE_lib_id.h"
 #include "BKE_mesh.h"
+#include "BKE_mesh_mapping.h"
 #include "BKE_mesh_wrapper.h"
 #include "BKE_particle.h"
 #include "BKE_screen.h"
@@ -89,6 +91,73 @@ static void requiredDataMask(Object *UNUSED(ob),
   }
 }
 
+typedef struct SmoothUserdata {
+  const MEdge *medges;
+  const MeshElemMap *vert_edge_map;
+  const MDeformVert *dvert;
+  int defgrp_index;
+  bool invert_vgroup;
+  short flag;
+  float fac_new;
+  float (*vertexCos)[3];
+  float (*accumulated_vecs)[3];
+} SmoothUserdata;
+
+/* Average of the edge centers around each vertex, read from the positions of the previous
+ * iteration, so the vertices can be gathered independently. */
+static void smoothModifier_accumulate_task(void *__restrict userdata,
+                                           const int i,
+                                           const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const SmoothUserdata *data = userdata;
+  const MeshElemMap *vert_edges = &data->vert_edge_map[i];
+  const float(*vertexCos)[3] = data->vertexCos;
+  float *vco_new = data->accumulated_vecs[i];
+
+  zero_v3(vco_new);
+  for (int j = 0; j < vert_edges->count; j++) {
+    const MEdge *medge = &data->medges[vert_edges->indices[j]];
+    float fvec[3];
+    mid_v3_v3v3(fvec, vertexCos[medge->v1], vertexCos[medge->v2]);
+    add_v3_v3(vco_new, fvec);
+  }
+  if (vert_edges->count > 0) {
+    mul_v3_fl(vco_new, 1.0f / (float)vert_edges->count);
+  }
+}
+
+static void smoothModifier_apply_task(void *__restrict userdata,
+                                      const int i,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const SmoothUserdata *data = userdata;
+  float *vco_orig = data->vertexCos[i];
+  const float *vco_new = data->accumulated_vecs[i];
+  const short flag = data->flag;
+  float f_new = data->fac_new;
+
+  if (data->dvert) {
+    const MDeformVert *dv = &data->dvert[i];
+    f_new = data->invert_vgroup ?
+                (1.0f - BKE_defvert_find_weight(dv, data->defgrp_index)) * data->fac_new :
+                BKE_defvert_find_weight(dv, data->defgrp_index) * data->fac_new;
+    if (f_new <= 0.0f) {
+      return;
+    }
+  }
+  const float f_orig = 1.0f - f_new;
+
+  if (flag & MOD_SMOOTH_X) {
+    vco_orig[0] = f_orig * vco_orig[0] + f_new * vco_new[0];
+  }
+  if (flag & MOD_SMOOTH_Y) {
+    vco_orig[1] = f_orig * vco_orig[1] + f_new * vco_new[1];
+  }
+  if (flag & MOD_SMOOTH_Z) {
+    vco_orig[2] = f_orig * vco_orig[2] + f_new * vco_new[2];
+  }
+}
+
 static void smoothModifier_do(
     SmoothModifierData *smd, Object *ob, Mesh *mesh, float (*vertexCos)[3], int numVerts)
 {
@@ -96,104 +165,45 @@ static void smoothModifier_do(
     return;
   }
 
-  float(*accumulated_vecs)[3] = MEM_calloc_arrayN(
+  float(*accumulated_vecs)[3] = MEM_malloc_arrayN(
       (size_t)numVerts, sizeof(*accumulated_vecs), __func__);
   if (!accumulated_vecs) {
     return;
   }
 
-  uint *num_accumulated_vecs = MEM_calloc_arrayN(
-      (size_t)numVerts, sizeof(*num_accumulated_vecs), __func__);
-  if (!num_accumulated_vecs) {
-    if (accumulated_vecs) {
-      MEM_freeN(accumulated_vecs);
-    }
-    return;
-  }
-
-  const float fac_new = smd->fac;
-  const float fac_orig = 1.0f - fac_new;
-  const bool invert_vgroup = (smd->flag & MOD_SMOOTH_INVERT_VGROUP) != 0;
-
-  MEdge *medges = mesh->medge;
-  const int num_edges = mesh->totedge;
+  MeshElemMap *vert_edge_map;
+  int *vert_edge_map_mem;
+  BKE_mesh_vert_edge_map_create(
+      &vert_edge_map, &vert_edge_map_mem, mesh->medge, numVerts, mesh->totedge);
 
   MDeformVert *dvert;
   int defgrp_index;
   MOD_get_vgroup(ob, mesh, smd->defgrp_name, &dvert, &defgrp_index);
 
-  for (int j = 0; j < smd->repeat; j++) {
-    if (j != 0) {
-      memset(accumulated_vecs, 0, sizeof(*accumulated_vecs) * (size_t)numVerts);
-      memset(num_accumulated_vecs, 0, sizeof(*num_accumulated_vecs) * (size_t)numVerts);
-    }
-
-    for (int i = 0; i < num_edges; i++) {
-      float fvec[3];
-      const uint idx1 = medges[i].v1;
-      const uint idx2 = medges[i].v2;
+  SmoothUserdata data = {
+      .medges = mesh->medge,
+      .vert_edge_map = vert_edge_map,
+      .dvert = dvert,
+      .defgrp_index = defgrp_index,
+      .invert_vgroup = (smd->flag & MOD_SMOOTH_INVERT_VGROUP) != 0,
+      .flag = smd->flag,
+      .fac_new = smd->fac,
+      .vertexCos = vertexCos,
+      .accumulated_vecs = accumulated_vecs,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (numVerts > 512);
 
-      mid_v3_v3v3(fvec, vertexCos[idx1], vertexCos[idx2]);
-
-      num_accumulated_vecs[idx1]++;
-      add_v3_v3(accumulated_vecs[idx1], fvec);
-
-      num_accumulated_vecs[idx2]++;
-      add_v3_v3(accumulated_vecs[idx2], fvec);
-    }
-
-    const short flag = smd->flag;
-    if (dvert) {
-      MDeformVert *dv = dvert;
-      for (int i = 0; i < numVerts; i++, dv++) {
-        float *vco_orig = vertexCos[i];
-        if (num_accumulated_vecs[i] > 0) {
-          mul_v3_fl(accumulated_vecs[i], 1.0f / (float)num_accumulated_vecs[i]);
-        }
-        float *vco_new = accumulated_vecs[i];
-
-        const float f_new = invert_vgroup ?
-                                (1.0f - BKE_defvert_find_weight(dv, defgrp_index)) * fac_new :
-                                BKE_defvert_find_weight(dv, defgrp_index) * fac_new;
-        if (f_new <= 0.0f) {
-          continue;
-        }
-        const float f_orig = 1.0f - f_new;
-
-        if (flag & MOD_SMOOTH_X) {
-          vco_orig[0] = f_orig * vco_orig[0] + f_new * vco_new[0];
-        }
-        if (flag & MOD_SMOOTH_Y) {
-          vco_orig[1] = f_orig * vco_orig[1] + f_new * vco_new[1];
-        }
-        if (flag & MOD_SMOOTH_Z) {
-          vco_orig[2] = f_orig * vco_orig[2] + f_new * vco_new[2];
-        }
-      }
-    }
-    else { /* no vertex group */
-      for (int i = 0; i < numVerts; i++) {
-        float *vco_orig = vertexCos[i];
-        if (num_accumulated_vecs[i] > 0) {
-          mul_v3_fl(accumulated_vecs[i], 1.0f / (float)num_accumulated_vecs[i]);
-        }
-        float *vco_new = accumulated_vecs[i];
-
-        if (flag & MOD_SMOOTH_X) {
-          vco_orig[0] = fac_orig * vco_orig[0] + fac_new * vco_new[0];
-        }
-        if (flag & MOD_SMOOTH_Y) {
-          vco_orig[1] = fac_orig * vco_orig[1] + fac_new * vco_new[1];
-        }
-        if (flag & MOD_SMOOTH_Z) {
-          vco_orig[2] = fac_orig * vco_orig[2] + fac_new * vco_new[2];
-        }
-      }
-    }
+  for (int j = 0; j < smd->repeat; j++) {
+    BLI_task_parallel_range(0, numVerts, &data, smoothModifier_accumulate_task, &settings);
+    BLI_task_parallel_range(0, numVerts, &data, smoothModifier_apply_task, &settings);
   }
 
+  MEM_freeN(vert_edge_map);
+  MEM_freeN(vert_edge_map_mem);
   MEM_freeN(accumulated_vecs);
-  MEM_freeN(num_accumulated_vecs);
 }
 
 static void deformVerts(ModifierData *md,
@@ -24,6 +24,7 @@
 #include "BLI_utildefines.h"
 
 #include "BLI_math.h"
+#include "BLI_task.h"
 
 #include "BLT_translation.h"
 
@@ -36,6 +37,7 @@
 #include "BKE_context.h"
 #include "BKE_deform.h"
 #include "BKE_editmesh.h"
+#include "BKE_image.h"
 #include "BKE_lib_id.h"
 #include "BKE_lib_query.h"
 #include "BKE_mesh.h"
@@ -159,6 +161,127 @@ static bool dependsOnNormals(ModifierData *md)
   return (wmd->flag & MOD_WAVE_NORM) != 0;
 }
 
+typedef struct WaveUserdata {
+  const WaveModifierData *wmd;
+  const MVert *mvert;
+  const MDeformVert *dvert;
+  int defgrp_index;
+  bool invert_group;
+  int wmd_axis;
+  float ctime;
+  float minfac;
+  float lifefac;
+  float falloff_inv;
+  Scene *scene;
+  Tex *tex_target;
+  struct ImagePool *pool;
+  float (*tex_co)[3];
+  float (*vertexCos)[3];
+} WaveUserdata;
+
+static void waveModifier_do_task(void *__restrict userdata,
+                                 const int i,
+                                 const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const WaveUserdata *data = userdata;
+  const WaveModifierData *wmd = data->wmd;
+  const int wmd_axis = data->wmd_axis;
+  const float falloff = wmd->falloff;
+  const float lifefac = data->lifefac;
+  float *co = data->vertexCos[i];
+  float x = co[0] - wmd->startx;
+  float y = co[1] - wmd->starty;
+  float amplit = 0.0f;
+  float def_weight = 1.0f;
+  float falloff_fac = 1.0f; /* when falloff == 0.0f this stays at 1.0f */
+
+  /* get weights */
+  if (data->dvert) {
+    def_weight = data->invert_group ?
+                     1.0f - BKE_defvert_find_weight(&data->dvert[i], data->defgrp_index) :
+                     BKE_defvert_find_weight(&data->dvert[i], data->defgrp_index);
+
+    /* if this vert isn't in the vgroup, don't deform it */
+    if (def_weight == 0.0f) {
+      return;
+    }
+  }
+
+  switch (wmd_axis) {
+    case MOD_WAVE_X | MOD_WAVE_Y:
+      amplit = sqrtf(x * x + y * y);
+      break;
+    case MOD_WAVE_X:
+      amplit = x;
+      break;
+    case MOD_WAVE_Y:
+      amplit = y;
+      break;
+  }
+
+  /* this way it makes nice circles */
+  amplit -= (data->ctime - wmd->timeoffs) * wmd->speed;
+
+  if (wmd->flag & MOD_WAVE_CYCL) {
+    amplit = (float)fmodf(amplit - wmd->width, 2.0f * wmd->width) + wmd->width;
+  }
+
+  if (falloff != 0.0f) {
+    float dist = 0.0f;
+
+    switch (wmd_axis) {
+      case MOD_WAVE_X | MOD_WAVE_Y:
+        dist = sqrtf(x * x + y * y);
+        break;
+      case MOD_WAVE_X:
+        dist = fabsf(x);
+        break;
+      case MOD_WAVE_Y:
+        dist = fabsf(y);
+        break;
+    }
+
+    falloff_fac = (1.0f - (dist * data->falloff_inv));
+    CLAMP(falloff_fac, 0.0f, 1.0f);
+  }
+
+  /* GAUSSIAN */
+  if ((falloff_fac != 0.0f) && (amplit > -wmd->width) && (amplit < wmd->width)) {
+    amplit = amplit * wmd->narrow;
+    amplit = (float)(1.0f / expf(amplit * amplit) - data->minfac);
+
+    /*apply texture*/
+    if (data->tex_co) {
+      TexResult texres;
+      texres.nor = NULL;
+      BKE_texture_get_value_ex(
+          data->scene, data->tex_target, data->tex_co[i], &texres, data->pool, false);
+      amplit *= texres.tin;
+    }
+
+    /*apply weight & falloff */
+    amplit *= def_weight * falloff_fac;
+
+    if (data->mvert) {
+      const MVert *mvert = data->mvert;
+      /* move along normals */
+      if (wmd->flag & MOD_WAVE_NORM_X) {
+        co[0] += (lifefac * amplit) * mvert[i].no[0] / 32767.0f;
+      }
+      if (wmd->flag & MOD_WAVE_NORM_Y) {
+        co[1] += (lifefac * amplit) * mvert[i].no[1] / 32767.0f;
+      }
+      if (wmd->flag & MOD_WAVE_NORM_Z) {
+        co[2] += (lifefac * amplit) * mvert[i].no[2] / 32767.0f;
+      }
+    }
+    else {
+      /* move along local z axis */
+      co[2] += lifefac * amplit;
+    }
+  }
+}
+
 static void waveModifier_do(WaveModifierData *md,
                             const ModifierEvalContext *ctx,
                             Object *ob,
@@ -176,7 +299,6 @@ static void waveModifier_do(WaveModifierData *md,
   float(*tex_co)[3] = NULL;
   const int wmd_axis = wmd->flag & (MOD_WAVE_X | MOD_WAVE_Y);
   const float falloff = wmd->falloff;
-  float falloff_fac = 1.0f; /* when falloff == 0.0f this stays at 1.0f */
   const bool invert_group = (wmd->flag & MOD_WAVE_INVERT_VGROUP) != 0;
 
   if ((wmd->flag & MOD_WAVE_NORM) && (mesh != NULL)) {
@@ -224,100 +346,35 @@ static void waveModifier_do(WaveModifierData *md,
   }
 
   if (lifefac != 0.0f) {
-    /* avoid divide by zero checks within the loop */
-    float falloff_inv = falloff != 0.0f ? 1.0f / falloff : 1.0f;
-    int i;
-
-    for (i = 0; i < numVerts; i++) {
-      float *co = vertexCos[i];
-      float x = co[0] - wmd->startx;
-      float y = co[1] - wmd->starty;
-      float amplit = 0.0f;
-      float def_weight = 1.0f;
-
-      /* get weights */
-      if (dvert) {
-        def_weight = invert_group ? 1.0f - BKE_defvert_find_weight(&dvert[i], defgrp_index) :
-                                    BKE_defvert_find_weight(&dvert[i], defgrp_index);
-
-        /* if this vert isn't in the vgroup, don't deform it */
-        if (def_weight == 0.0f) {
-          continue;
-        }
-      }
-
-      switch (wmd_axis) {
-        case MOD_WAVE_X | MOD_WAVE_Y:
-          amplit = sqrtf(x * x + y * y);
-          break;
-        case MOD_WAVE_X:
-          amplit = x;
-          break;
-        case MOD_WAVE_Y:
-          amplit = y;
-          break;
-      }
-
-      /* this way it makes nice circles */
-      amplit -= (ctime - wmd->timeoffs) * wmd->speed;
-
-      if (wmd->flag & MOD_WAVE_CYCL) {
-        amplit = (float)fmodf(amplit - wmd->width, 2.0f * wmd->width) + wmd->width;
-      }
+    WaveUserdata data = {
+        .wmd = wmd,
+        .mvert = mvert,
+        .dvert = dvert,
+        .defgrp_index = defgrp_index,
+        .invert_group = invert_group,
+        .wmd_axis = wmd_axis,
+        .ctime = ctime,
+        .minfac = minfac,
+        .lifefac = lifefac,
+        /* avoid divide by zero checks within the loop */
+        .falloff_inv = falloff != 0.0f ? 1.0f / falloff : 1.0f,
+        .tex_target = tex_target,
+        .tex_co = tex_co,
+        .vertexCos = vertexCos,
+    };
+    if (tex_co) {
+      data.scene = DEG_get_evaluated_scene(ctx->depsgraph);
+      data.pool = BKE_image_pool_new();
+      BKE_texture_fetch_images_for_pool(tex_target, data.pool);
+    }
 
-      if (falloff != 0.0f) {
-        float dist = 0.0f;
-
-        switch (wmd_axis) {
-          case MOD_WAVE_X | MOD_WAVE_Y:
-            dist = sqrtf(x * x + y * y);
-            break;
-          case MOD_WAVE_X:
-            dist = fabsf(x);
-            break;
-          case MOD_WAVE_Y:
-            dist = fabsf(y);
-            break;
-        }
-
-        falloff_fac = (1.0f - (dist * falloff_inv));
-        CLAMP(falloff_fac, 0.0f, 1.0f);
-      }
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.use_threading = (numVerts > 512);
+    BLI_task_parallel_range(0, numVerts, &data, waveModifier_do_task, &settings);
 
-      /* GAUSSIAN */
-      if ((falloff_fac != 0.0f) && (amplit > -wmd->width) && (amplit < wmd->width)) {
-        amplit = amplit * wmd->narrow;
-        amplit = (float)(1.0f / expf(amplit * amplit) - minfac);
-
-        /*apply texture*/
-        if (tex_co) {
-          Scene *scene = DEG_get_evaluated_scene(ctx->depsgraph);
-          TexResult texres;
-          texres.nor = NULL;
-          BKE_texture_get_value(scene, tex_target, tex_co[i], &texres, false);
-          amplit *= texres.tin;
-        }
-
-        /*apply weight & falloff */
-        amplit *= def_weight * falloff_fac;
-
-        if (mvert) {
-          /* move along normals */
-          if (wmd->flag & MOD_WAVE_NORM_X) {
-            co[0] += (lifefac * amplit) * mvert[i].no[0] / 32767.0f;
-          }
-          if (wmd->flag & MOD_WAVE_NORM_Y) {
-            co[1] += (lifefac * amplit) * mvert[i].no[1] / 32767.0f;
-          }
-          if (wmd->flag & MOD_WAVE_NORM_Z) {
-            co[2] += (lifefac * amplit) * mvert[i].no[2] / 32767.0f;
-          }
-        }
-        else {
-          /* move along local z axis */
-          co[2] += lifefac * amplit;
-        }
-      }
+    if (data.pool != NULL) {
+      BKE_image_pool_free(data.pool);
     }
   }
 
@@ -322,6 +322,11 @@ void ntreeCompositTagRender(Scene *scene)
       }
     }
   }
+
+#ifdef WITH_COMPOSITOR
+  /* Cached results are based on the previous render result. */
+  COM_result_cache_clear();
+#endif
 }
 
 /* XXX after render animation system gets a refresh, this call allows composite to end clean */
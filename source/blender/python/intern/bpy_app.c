@@ -460,6 +460,11 @@ static PyGetSetDef bpy_app_getsets[] = {
      bpy_app_debug_doc,
      (void *)G_DEBUG_GPU_MEM},
     {"debug_io", bpy_app_debug_get, bpy_app_debug_set, bpy_app_debug_doc, (void *)G_DEBUG_IO},
+    {"debug_sculpt_time",
+     bpy_app_debug_get,
+     bpy_app_debug_set,
+     bpy_app_debug_doc,
+     (void *)G_DEBUG_SCULPT_TIME},
 
     {"use_event_simulate",
      bpy_app_global_flag_get,
@@ -34,6 +34,7 @@
 #  include "DNA_texture_types.h"
 
 #  include "BLI_math.h"
+#  include "BLI_task.h"
 #  include "BLI_utildefines.h"
 
 #  include "BKE_cloth.h"
@@ -50,6 +51,10 @@
 #    define CLOTH_OPENMP_LIMIT 512
 #  endif
 
+/* Number of vertices processed together by the threaded solver operations. Reductions sum the
+ * results of these chunks in order, so they don't depend on the number of threads. */
+#  define CLOTH_SOLVER_CHUNK_SIZE 1024
+
 //#define DEBUG_TIME
 
 #  ifdef DEBUG_TIME
@@ -642,6 +647,144 @@ DO_INLINE void mul_bfmatrix_lfvector(float (*to)[3], fmatrix3x3 *from, lfVector
   del_lfvector(temp);
 }
 
+/* Rows of a SPARSE SYMMETRIC big matrix, so it can be multiplied with a long vector one vertex
+ * at a time, without several threads writing to the same vertex.
+ * Each row first lists the blocks stored in that row (including the diagonal block), then the
+ * lower triangle blocks stored in that column, which are used transposed. */
+typedef struct BigMatrixRows {
+  unsigned int vcount;
+  /* Start of the blocks of each vertex, vcount + 1 items. */
+  unsigned int *offsets;
+  /* Start of the transposed blocks of each vertex. */
+  unsigned int *transposed;
+  /* Block indices into the big matrix. */
+  unsigned int *blocks;
+} BigMatrixRows;
+
+/* Build the rows of a big matrix, from its diagonal blocks and first num_blocks other blocks.
+ * Blocks keep their order within a row, so sums are the same as in #mul_bfmatrix_lfvector. */
+static void init_bfmatrix_rows(BigMatrixRows *rows, fmatrix3x3 *matrix, unsigned int num_blocks)
+{
+  const unsigned int vcount = matrix[0].vcount;
+  const unsigned int blocks_end = vcount + num_blocks;
+  unsigned int *row_fill = MEM_calloc_arrayN(vcount, sizeof(*row_fill), __func__);
+  unsigned int *col_fill = MEM_calloc_arrayN(vcount, sizeof(*col_fill), __func__);
+
+  for (unsigned int i = 0; i < blocks_end; i++) {
+    row_fill[matrix[i].r]++;
+    if (i >= vcount) {
+      col_fill[matrix[i].c]++;
+    }
+  }
+
+  rows->vcount = vcount;
+  rows->offsets = MEM_malloc_arrayN(vcount + 1, sizeof(*rows->offsets), __func__);
+  rows->transposed = MEM_malloc_arrayN(vcount, sizeof(*rows->transposed), __func__);
+  rows->blocks = MEM_malloc_arrayN(vcount + 2 * num_blocks, sizeof(*rows->blocks), __func__);
+
+  unsigned int offset = 0;
+  for (unsigned int v = 0; v < vcount; v++) {
+    const unsigned int row_len = row_fill[v], col_len = col_fill[v];
+    rows->offsets[v] = offset;
+    rows->transposed[v] = offset + row_len;
+    row_fill[v] = offset;
+    col_fill[v] = offset + row_len;
+    offset += row_len + col_len;
+  }
+  rows->offsets[vcount] = offset;
+
+  for (unsigned int i = 0; i < blocks_end; i++) {
+    rows->blocks[row_fill[matrix[i].r]++] = i;
+    if (i >= vcount) {
+      rows->blocks[col_fill[matrix[i].c]++] = i;
+    }
+  }
+
+  MEM_freeN(row_fill);
+  MEM_freeN(col_fill);
+}
+
+static void free_bfmatrix_rows(BigMatrixRows *rows)
+{
+  MEM_SAFE_FREE(rows->offsets);
+  MEM_SAFE_FREE(rows->transposed);
+  MEM_SAFE_FREE(rows->blocks);
+}
+
+/* Multiply the row of vertex v of a big matrix with a long vector. */
+DO_INLINE void mul_bfmatrix_row_lfvector(float to[3],
+                                         const fmatrix3x3 *from,
+                                         const BigMatrixRows *rows,
+                                         lfVector *fLongVector,
+                                         unsigned int v)
+{
+  float temp[3] = {0.0f, 0.0f, 0.0f};
+  unsigned int i;
+
+  zero_v3(to);
+  for (i = rows->transposed[v]; i < rows->offsets[v + 1]; i++) {
+    const fmatrix3x3 *block = &from[rows->blocks[i]];
+    muladd_fmatrixT_fvector(to, block->m, fLongVector[block->r]);
+  }
+  for (i = rows->offsets[v]; i < rows->transposed[v]; i++) {
+    const fmatrix3x3 *block = &from[rows->blocks[i]];
+    muladd_fmatrix_fvector(temp, block->m, fLongVector[block->c]);
+  }
+  add_v3_v3(to, temp);
+}
+
+BLI_INLINE void cloth_solver_parallel_settings(TaskParallelSettings *settings,
+                                               unsigned int num_chunks)
+{
+  BLI_parallel_range_settings_defaults(settings);
+  settings->use_threading = (num_chunks > 1);
+  settings->min_iter_per_thread = 1;
+}
+
+BLI_INLINE unsigned int cloth_solver_num_chunks(unsigned int verts)
+{
+  return (verts + CLOTH_SOLVER_CHUNK_SIZE - 1) / CLOTH_SOLVER_CHUNK_SIZE;
+}
+
+typedef struct MulBigMatrixData {
+  float (*to)[3];
+  fmatrix3x3 *from;
+  const BigMatrixRows *rows;
+  lfVector *fLongVector;
+} MulBigMatrixData;
+
+static void mul_bfmatrix_rows_lfvector_cb(void *__restrict userdata,
+                                          const int chunk,
+                                          const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  MulBigMatrixData *data = userdata;
+  const unsigned int start = (unsigned int)chunk * CLOTH_SOLVER_CHUNK_SIZE;
+  const unsigned int end = MIN2(start + CLOTH_SOLVER_CHUNK_SIZE, data->rows->vcount);
+
+  for (unsigned int v = start; v < end; v++) {
+    mul_bfmatrix_row_lfvector(data->to[v], data->from, data->rows, data->fLongVector, v);
+  }
+}
+
+/* SPARSE SYMMETRIC multiply big matrix with long vector, threaded over the rows. */
+static void mul_bfmatrix_rows_lfvector(float (*to)[3],
+                                       fmatrix3x3 *from,
+                                       const BigMatrixRows *rows,
+                                       lfVector *fLongVector)
+{
+  MulBigMatrixData data = {
+      .to = to,
+      .from = from,
+      .rows = rows,
+      .fLongVector = fLongVector,
+  };
+  const unsigned int num_chunks = cloth_solver_num_chunks(rows->vcount);
+
+  TaskParallelSettings settings;
+  cloth_solver_parallel_settings(&settings, num_chunks);
+  BLI_task_parallel_range(0, (int)num_chunks, &data, mul_bfmatrix_rows_lfvector_cb, &settings);
+}
+
 /* SPARSE SYMMETRIC sub big matrix with big matrix*/
 /* A -= B * float + C * float --> for big matrix */
 /* VERIFIED */
@@ -848,11 +991,148 @@ static int cg_filtered(lfVector *ldV, fmatrix3x3 *lA, lfVector *lB, lfVector *z,
 }
 #  endif
 
+/* Data shared by the threaded steps of #cg_filtered, which process the vertices in chunks of
+ * #CLOTH_SOLVER_CHUNK_SIZE. */
+typedef struct CGSolverData {
+  unsigned int numverts;
+  const BigMatrixRows *rows;
+  fmatrix3x3 *A, *S, *Pinv;
+  lfVector *dV, *B, *r, *c, *q, *s;
+  float alpha, beta;
+  /* Two partial dot products for each chunk. */
+  float (*chunk_dots)[2];
+} CGSolverData;
+
+BLI_INLINE void cg_chunk_range(const CGSolverData *data,
+                               const int chunk,
+                               unsigned int *r_start,
+                               unsigned int *r_end)
+{
+  *r_start = (unsigned int)chunk * CLOTH_SOLVER_CHUNK_SIZE;
+  *r_end = MIN2(*r_start + CLOTH_SOLVER_CHUNK_SIZE, data->numverts);
+}
+
+/* Check the leading principal minors of a symmetric 3x3 matrix. */
+BLI_INLINE bool is_positive_definite_fmatrix(const float m[3][3])
+{
+  return (m[0][0] > 0.0f) && (m[0][0] * m[1][1] - m[0][1] * m[1][0] > 0.0f) &&
+         (determinant_m3_array(m) > 0.0f);
+}
+
+/* Block Jacobi pre-conditioner, and the initial residual. */
+static void cg_filtered_init_cb(void *__restrict userdata,
+                                const int chunk,
+                                const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  CGSolverData *data = userdata;
+  unsigned int start, end;
+  float bnorm2 = 0.0f, delta = 0.0f;
+
+  cg_chunk_range(data, chunk, &start, &end);
+  for (unsigned int v = start; v < end; v++) {
+    float fB[3], PinvB[3], AdV[3];
+
+    /* The pre-conditioner has to be positive definite, which diagonal blocks of A are not
+     * always (compressed springs for example), skip those. */
+    if (!is_positive_definite_fmatrix(data->A[v].m) ||
+        !invert_m3_m3(data->Pinv[v].m, data->A[v].m)) {
+      unit_m3(data->Pinv[v].m);
+    }
+
+    /* d0 = filter(B)^T * P^-1 * filter(B) */
+    mul_v3_m3v3(fB, data->S[v].m, data->B[v]);
+    mul_v3_m3v3(PinvB, data->Pinv[v].m, fB);
+    bnorm2 += dot_v3v3(fB, PinvB);
+
+    /* r = filter(B - A * dV) */
+    mul_bfmatrix_row_lfvector(AdV, data->A, data->rows, data->dV, v);
+    sub_v3_v3v3(data->r[v], data->B[v], AdV);
+    mul_m3_v3(data->S[v].m, data->r[v]);
+
+    /* c = filter(P^-1 * r) */
+    mul_v3_m3v3(data->c[v], data->Pinv[v].m, data->r[v]);
+    mul_m3_v3(data->S[v].m, data->c[v]);
+
+    /* delta = r^T * c */
+    delta += dot_v3v3(data->r[v], data->c[v]);
+  }
+  data->chunk_dots[chunk][0] = bnorm2;
+  data->chunk_dots[chunk][1] = delta;
+}
+
+/* q = filter(A * c), and c^T * q. */
+static void cg_filtered_step_q_cb(void *__restrict userdata,
+                                  const int chunk,
+                                  const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  CGSolverData *data = userdata;
+  unsigned int start, end;
+  float dot = 0.0f;
+
+  cg_chunk_range(data, chunk, &start, &end);
+  for (unsigned int v = start; v < end; v++) {
+    mul_bfmatrix_row_lfvector(data->q[v], data->A, data->rows, data->c, v);
+    mul_m3_v3(data->S[v].m, data->q[v]);
+    dot += dot_v3v3(data->c[v], data->q[v]);
+  }
+  data->chunk_dots[chunk][0] = dot;
+}
+
+/* Update dV and r, s = P^-1 * r, and r^T * s. */
+static void cg_filtered_step_r_cb(void *__restrict userdata,
+                                  const int chunk,
+                                  const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  CGSolverData *data = userdata;
+  const float alpha = data->alpha;
+  unsigned int start, end;
+  float dot = 0.0f;
+
+  cg_chunk_range(data, chunk, &start, &end);
+  for (unsigned int v = start; v < end; v++) {
+    VECADDS(data->dV[v], data->dV[v], data->c[v], alpha);
+    VECADDS(data->r[v], data->r[v], data->q[v], -alpha);
+    mul_v3_m3v3(data->s[v], data->Pinv[v].m, data->r[v]);
+    dot += dot_v3v3(data->r[v], data->s[v]);
+  }
+  data->chunk_dots[chunk][0] = dot;
+}
+
+/* c = filter(s + c * beta) */
+static void cg_filtered_step_c_cb(void *__restrict userdata,
+                                  const int chunk,
+                                  const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  CGSolverData *data = userdata;
+  const float beta = data->beta;
+  unsigned int start, end;
+
+  cg_chunk_range(data, chunk, &start, &end);
+  for (unsigned int v = start; v < end; v++) {
+    VECADDS(data->c[v], data->s[v], data->c[v], beta);
+    mul_m3_v3(data->S[v].m, data->c[v]);
+  }
+}
+
+/* Sum the partial dot products of all chunks, always in the same order. */
+BLI_INLINE float cg_chunk_dots_sum(const CGSolverData *data, unsigned int num_chunks, int index)
+{
+  float sum = 0.0f;
+  for (unsigned int chunk = 0; chunk < num_chunks; chunk++) {
+    sum += data->chunk_dots[chunk][index];
+  }
+  return sum;
+}
+
+/* Pre-conditioned conjugate gradient, using the inverse diagonal blocks of A (block Jacobi).
+ * The steps are threaded over chunks of vertices. */
 static int cg_filtered(lfVector *ldV,
                        fmatrix3x3 *lA,
+                       const BigMatrixRows *rows,
                        lfVector *lB,
                        lfVector *z,
                        fmatrix3x3 *S,
+                       fmatrix3x3 *Pinv,
                        ImplicitSolverResult *result)
 {
   // Solves for unknown X in equation AX=B
@@ -860,34 +1140,34 @@ static int cg_filtered(lfVector *ldV,
   float conjgrad_epsilon = 0.01f;
 
   unsigned int numverts = lA[0].vcount;
-  lfVector *fB = create_lfvector(numverts);
-  lfVector *AdV = create_lfvector(numverts);
-  lfVector *r = create_lfvector(numverts);
-  lfVector *c = create_lfvector(numverts);
-  lfVector *q = create_lfvector(numverts);
-  lfVector *s = create_lfvector(numverts);
-  float bnorm2, delta_new, delta_old, delta_target, alpha;
+  const unsigned int num_chunks = cloth_solver_num_chunks(numverts);
+  float bnorm2, delta_new, delta_old, delta_target;
+
+  CGSolverData data = {
+      .numverts = numverts,
+      .rows = rows,
+      .A = lA,
+      .S = S,
+      .Pinv = Pinv,
+      .dV = ldV,
+      .B = lB,
+      .r = create_lfvector(numverts),
+      .c = create_lfvector(numverts),
+      .q = create_lfvector(numverts),
+      .s = create_lfvector(numverts),
+      .chunk_dots = MEM_malloc_arrayN(num_chunks, sizeof(*data.chunk_dots), __func__),
+  };
+
+  TaskParallelSettings settings;
+  cloth_solver_parallel_settings(&settings, num_chunks);
 
   cp_lfvector(ldV, z, numverts);
 
-  /* d0 = filter(B)^T * P * filter(B) */
-  cp_lfvector(fB, lB, numverts);
-  filter(fB, S);
-  bnorm2 = dot_lfvector(fB, fB, numverts);
+  BLI_task_parallel_range(0, (int)num_chunks, &data, cg_filtered_init_cb, &settings);
+  bnorm2 = cg_chunk_dots_sum(&data, num_chunks, 0);
+  delta_new = cg_chunk_dots_sum(&data, num_chunks, 1);
   delta_target = conjgrad_epsilon * conjgrad_epsilon * bnorm2;
 
-  /* r = filter(B - A * dV) */
-  mul_bfmatrix_lfvector(AdV, lA, ldV);
-  sub_lfvector_lfvector(r, lB, AdV, numverts);
-  filter(r, S);
-
-  /* c = filter(P^-1 * r) */
-  cp_lfvector(c, r, numverts);
-  filter(c, S);
-
-  /* delta = r^T * c */
-  delta_new = dot_lfvector(r, c, numverts);
-
 #  ifdef IMPLICIT_PRINT_SOLVER_INPUT_OUTPUT
   printf("==== A ====\n");
   print_bfmatrix(lA);
@@ -900,22 +1180,15 @@ static int cg_filtered(lfVector *ldV,
 #  endif
 
   while (delta_new > delta_target && conjgrad_loopcount < conjgrad_looplimit) {
-    mul_bfmatrix_lfvector(q, lA, c);
-    filter(q, S);
-
-    alpha = delta_new / dot_lfvector(c, q, numverts);
-
-    add_lfvector_lfvectorS(ldV, ldV, c, alpha, numverts);
+    BLI_task_parallel_range(0, (int)num_chunks, &data, cg_filtered_step_q_cb, &settings);
+    data.alpha = delta_new / cg_chunk_dots_sum(&data, num_chunks, 0);
 
-    add_lfvector_lfvectorS(r, r, q, -alpha, numverts);
-
-    /* s = P^-1 * r */
-    cp_lfvector(s, r, numverts);
+    BLI_task_parallel_range(0, (int)num_chunks, &data, cg_filtered_step_r_cb, &settings);
     delta_old = delta_new;
-    delta_new = dot_lfvector(r, s, numverts);
+    delta_new = cg_chunk_dots_sum(&data, num_chunks, 0);
 
-    add_lfvector_lfvectorS(c, s, c, delta_new / delta_old, numverts);
-    filter(c, S);
+    data.beta = delta_new / delta_old;
+    BLI_task_parallel_range(0, (int)num_chunks, &data, cg_filtered_step_c_cb, &settings);
 
     conjgrad_loopcount++;
   }
@@ -926,12 +1199,11 @@ static int cg_filtered(lfVector *ldV,
   printf("========\n");
 #  endif
 
-  del_lfvector(fB);
-  del_lfvector(AdV);
-  del_lfvector(r);
-  del_lfvector(c);
-  del_lfvector(q);
-  del_lfvector(s);
+  del_lfvector(data.r);
+  del_lfvector(data.c);
+  del_lfvector(data.q);
+  del_lfvector(data.s);
+  MEM_freeN(data.chunk_dots);
   // printf("W/O conjgrad_loopcount: %d\n", conjgrad_loopcount);
 
   result->status = conjgrad_loopcount < conjgrad_looplimit ? SIM_SOLVER_SUCCESS :
@@ -1160,7 +1432,11 @@ bool SIM_mass_spring_solve_velocities(Implicit_Data *data, float dt, ImplicitSol
 
   subadd_bfmatrixS_bfmatrixS(data->A, data->dFdV, dt, data->dFdX, (dt * dt));
 
-  mul_bfmatrix_lfvector(dFdXmV, data->dFdX, data->V);
+  /* All big matrices share the same blocks. */
+  BigMatrixRows rows;
+  init_bfmatrix_rows(&rows, data->A, (unsigned int)data->num_blocks);
+
+  mul_bfmatrix_rows_lfvector(dFdXmV, data->dFdX, &rows, data->V);
 
   add_lfvectorS_lfvectorS(data->B, data->F, dt, dFdXmV, (dt * dt), numverts);
 
@@ -1169,7 +1445,7 @@ bool SIM_mass_spring_solve_velocities(Implicit_Data *data, float dt, ImplicitSol
 #  endif
 
   /* Conjugate gradient algorithm to solve Ax=b. */
-  cg_filtered(data->dV, data->A, data->B, data->z, data->S, result);
+  cg_filtered(data->dV, data->A, &rows, data->B, data->z, data->S, data->Pinv, result);
 
   // cg_filtered_pre(id->dV, id->A, id->B, id->z, id->S, id->P, id->Pinv, id->bigI);
 
@@ -1182,6 +1458,7 @@ bool SIM_mass_spring_solve_velocities(Implicit_Data *data, float dt, ImplicitSol
   add_lfvector_lfvector(data->Vnew, data->V, data->dV, numverts);
 
   del_lfvector(dFdXmV);
+  free_bfmatrix_rows(&rows);
 
   return result->status == SIM_SOLVER_SUCCESS;
 }
@@ -128,6 +128,7 @@
 
 #include "BKE_sound.h"
 #include "BKE_subdiv.h"
+#include "BKE_volume.h"
 
 #include "COM_compositor.h"
 
@@ -580,6 +581,7 @@ void WM_exit_ex(bContext *C, const bool do_python)
 
   BKE_blender_free(); /* blender.c, does entire library and spacetypes */
                       //  BKE_material_copybuf_free();
+  BKE_volumes_exit();
   ANIM_fcurves_copybuf_free();
   ANIM_drivers_copybuf_free();
   ANIM_driver_vars_copybuf_free();
@@ -603,6 +603,7 @@ static int arg_handle_print_help(int UNUSED(argc), const char **UNUSED(argv), vo
   BLI_argsPrintArgDoc(ba, "--debug-gpu-shaders");
   BLI_argsPrintArgDoc(ba, "--debug-gpu-force-workarounds");
   BLI_argsPrintArgDoc(ba, "--debug-wm");
+  BLI_argsPrintArgDoc(ba, "--debug-sculpt-time");
 #  ifdef WITH_XR_OPENXR
   BLI_argsPrintArgDoc(ba, "--debug-xr");
   BLI_argsPrintArgDoc(ba, "--debug-xr-time");
@@ -961,6 +962,9 @@ static const char arg_handle_debug_mode_generic_set_doc_wm[] =
     "\n\t"
     "Enable debug messages for the window manager, shows all operators in search, shows "
     "keymap errors.";
+static const char arg_handle_debug_mode_generic_set_doc_sculpt_time[] =
+    "\n\t"
+    "Enable per-dab timing messages for sculpt brush strokes.";
 #  ifdef WITH_XR_OPENXR
 static const char arg_handle_debug_mode_generic_set_doc_xr[] =
     "\n\t"
@@ -2124,6 +2128,12 @@ void main_args_setup(bContext *C, bArgs *ba)
               (void *)G_DEBUG_HANDLERS);
   BLI_argsAdd(
       ba, 1, NULL, "--debug-wm", CB_EX(arg_handle_debug_mode_generic_set, wm), (void *)G_DEBUG_WM);
+  BLI_argsAdd(ba,
+              1,
+              NULL,
+              "--debug-sculpt-time",
+              CB_EX(arg_handle_debug_mode_generic_set, sculpt_time),
+              (void *)G_DEBUG_SCULPT_TIME);
 #  ifdef WITH_XR_OPENXR
   BLI_argsAdd(
       ba, 1, NULL, "--debug-xr", CB_EX(arg_handle_debug_mode_generic_set, xr), (void *)G_DEBUG_XR);
@@ -0,0 +1,125 @@
+# ##### BEGIN GPL LICENSE BLOCK #####
+#
+#  This program is free software; you can redistribute it and/or
+#  modify it under the terms of the GNU General Public License
+#  as published by the Free Software Foundation; either version 2
+#  of the License, or (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software Foundation,
+#  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+#
+# ##### END GPL LICENSE BLOCK #####
+
+# <pep8 compliant>
+
+"""
+Measure how many animation channels (F-Curves) are evaluated per second during playback,
+on a generated scene with keyframed objects and armature bones.
+
+The time includes the rest of the dependency graph evaluation, keep the scene simple
+(no modifiers, no constraints) so that animation evaluation dominates.
+
+Example Usage:
+
+./blender.bin --background --factory-startup \
+    --python tests/python/animation_eval_benchmark.py -- \
+    --objects=200 --bones=200 --frames=250 --repeat=3
+"""
+
+import argparse
+import sys
+import time
+
+
+TRANSFORM_PATHS = (
+    ("location", 3),
+    ("rotation_euler", 3),
+    ("scale", 3),
+)
+
+
+def keyframe_transforms(target, frames, phase):
+    num_channels = 0
+    for data_path, array_length in TRANSFORM_PATHS:
+        for frame in range(frames[0], frames[1] + 1, 10):
+            value = [(frame + phase + i) % 7 * 0.1 for i in range(array_length)]
+            setattr(target, data_path, value)
+            target.keyframe_insert(data_path, frame=frame)
+        num_channels += array_length
+    return num_channels
+
+
+def create_scene(num_objects, num_bones, frames):
+    import bpy
+
+    bpy.ops.wm.read_factory_settings(use_empty=True)
+    scene = bpy.context.scene
+    scene.frame_start, scene.frame_end = frames
+
+    num_channels = 0
+    for i in range(num_objects):
+        ob = bpy.data.objects.new("Empty.%d" % i, None)
+        scene.collection.objects.link(ob)
+        num_channels += keyframe_transforms(ob, frames, i)
+
+    if num_bones > 0:
+        arm = bpy.data.armatures.new("Armature")
+        ob = bpy.data.objects.new("Armature", arm)
+        scene.collection.objects.link(ob)
+        bpy.context.view_layer.objects.active = ob
+        bpy.ops.object.mode_set(mode='EDIT')
+        for i in range(num_bones):
+            bone = arm.edit_bones.new("Bone.%d" % i)
+            bone.head = (i * 0.1, 0.0, 0.0)
+            bone.tail = (i * 0.1, 0.0, 1.0)
+        bpy.ops.object.mode_set(mode='OBJECT')
+        for i, pose_bone in enumerate(ob.pose.bones):
+            pose_bone.rotation_mode = 'XYZ'
+            num_channels += keyframe_transforms(pose_bone, frames, i)
+
+    return scene, num_channels
+
+
+def playback_time(scene, repeat):
+    best = sys.float_info.max
+    for _ in range(repeat):
+        time_start = time.perf_counter()
+        for frame in range(scene.frame_start, scene.frame_end + 1):
+            scene.frame_set(frame)
+        best = min(best, time.perf_counter() - time_start)
+    return best
+
+
+def main():
+    argv = sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else []
+
+    parser = argparse.ArgumentParser(
+        description="Measure animation channels evaluated per second during playback.")
+    parser.add_argument("--objects", type=int, default=200, help="Number of animated objects")
+    parser.add_argument("--bones", type=int, default=200, help="Number of animated bones")
+    parser.add_argument("--frames", type=int, default=250, help="Number of frames to play")
+    parser.add_argument("--repeat", type=int, default=3,
+                        help="Number of playbacks per measurement")
+    args = parser.parse_args(argv)
+
+    frames = (1, max(args.frames, 1))
+    scene, num_channels = create_scene(max(args.objects, 0), max(args.bones, 0), frames)
+
+    # The first playback also builds the evaluated data, it's not measured.
+    playback_time(scene, 1)
+    seconds = playback_time(scene, max(args.repeat, 1))
+
+    num_frames = frames[1] - frames[0] + 1
+    print("Channels: %d, frames: %d" % (num_channels, num_frames))
+    print("Playback: %.3fs, %.1f frames per second" % (seconds, num_frames / seconds))
+    print("Channels evaluated per second: %.0f" % (num_channels * num_frames / seconds))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,93 @@
+# ##### BEGIN GPL LICENSE BLOCK #####
+#
+#  This program is free software; you can redistribute it and/or
+#  modify it under the terms of the GNU General Public License
+#  as published by the Free Software Foundation; either version 2
+#  of the License, or (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software Foundation,
+#  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+#
+# ##### END GPL LICENSE BLOCK #####
+
+# <pep8 compliant>
+
+# Edit-mesh undo, which restores steps only moving vertices without rebuilding the mesh.
+
+import unittest
+
+import bmesh
+import bpy
+
+# Enough vertices for the first and last vertex to be stored in separate chunks.
+GRID_SUBDIVISIONS = 100
+
+
+def context_override():
+    window = bpy.context.window_manager.windows[0]
+    return {"window": window, "screen": window.screen}
+
+
+def edit_mesh_coords(me):
+    bm = bmesh.from_edit_mesh(me)
+    return [v.co.copy() for v in bm.verts]
+
+
+def edit_mesh_vert_move(me, index):
+    bm = bmesh.from_edit_mesh(me)
+    bm.verts.ensure_lookup_table()
+    bm.verts[index].co.z += 1.0
+    bmesh.update_edit_mesh(me)
+
+
+class TestEditMeshUndo(unittest.TestCase):
+
+    def setUp(self):
+        bpy.ops.wm.read_factory_settings()
+        for ob in bpy.data.objects[:]:
+            bpy.data.objects.remove(ob)
+        bpy.ops.mesh.primitive_grid_add(
+            x_subdivisions=GRID_SUBDIVISIONS, y_subdivisions=GRID_SUBDIVISIONS)
+        self.me = bpy.context.active_object.data
+
+        bpy.ops.object.mode_set(context_override(), mode='EDIT')
+        # The undo stack isn't created on startup in background mode.
+        bpy.ops.ed.undo_push(context_override(), message="Initial")
+
+    def undo(self):
+        self.assertEqual(bpy.ops.ed.undo(context_override()), {'FINISHED'})
+
+    def test_undo_moved_verts(self):
+        coords_initial = edit_mesh_coords(self.me)
+        edit_mesh_vert_move(self.me, 0)
+        bpy.ops.ed.undo_push(context_override(), message="Move first")
+        coords_first = edit_mesh_coords(self.me)
+        edit_mesh_vert_move(self.me, -1)
+        bpy.ops.ed.undo_push(context_override(), message="Move last")
+
+        self.undo()
+        self.assertEqual(edit_mesh_coords(self.me), coords_first)
+        self.undo()
+        self.assertEqual(edit_mesh_coords(self.me), coords_initial)
+
+    def test_undo_after_change_without_push(self):
+        coords_initial = edit_mesh_coords(self.me)
+        edit_mesh_vert_move(self.me, 0)
+        bpy.ops.ed.undo_push(context_override(), message="Move first")
+        # Moving another vertex without an undo push, undo must not keep it moved.
+        edit_mesh_vert_move(self.me, -1)
+
+        self.undo()
+        self.assertEqual(edit_mesh_coords(self.me), coords_initial)
+
+
+if __name__ == '__main__':
+    import sys
+    sys.argv = [__file__] + (sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else [])
+    unittest.main()
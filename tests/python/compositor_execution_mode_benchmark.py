@@ -0,0 +1,144 @@
+# ##### BEGIN GPL LICENSE BLOCK #####
+#
+#  This program is free software; you can redistribute it and/or
+#  modify it under the terms of the GNU General Public License
+#  as published by the Free Software Foundation; either version 2
+#  of the License, or (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software Foundation,
+#  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+#
+# ##### END GPL LICENSE BLOCK #####
+
+# <pep8 compliant>
+
+"""
+Compare the compositor execution modes (Tiled and Full Frame) side by side,
+on the node trees of existing .blend files.
+
+Every file is rendered without compositing first, the compositing time of each mode
+is the render time minus that baseline (the best of all repetitions is used).
+The results of both modes are compared pixel by pixel.
+
+Example Usage:
+
+./blender.bin --background --factory-startup \
+    --python tests/python/compositor_execution_mode_benchmark.py -- \
+    --repeat=3 \
+    /path/to/shot_010.blend /path/to/shot_020.blend
+"""
+
+import argparse
+import os
+import sys
+import tempfile
+import time
+
+
+EXECUTION_MODES = ('TILED', 'FULL_FRAME')
+
+
+def render_time(scene, repeat, filepath=None):
+    import bpy
+
+    best = sys.float_info.max
+    for _ in range(repeat):
+        time_start = time.perf_counter()
+        bpy.ops.render.render()
+        best = min(best, time.perf_counter() - time_start)
+
+    if filepath:
+        bpy.data.images['Render Result'].save_render(filepath, scene=scene)
+    return best
+
+
+def image_pixels(filepath):
+    import bpy
+    import numpy
+
+    image = bpy.data.images.load(filepath)
+    pixels = numpy.empty(len(image.pixels), dtype=numpy.float32)
+    image.pixels.foreach_get(pixels)
+    bpy.data.images.remove(image)
+    return pixels
+
+
+def benchmark_file(filepath, repeat, tempdir):
+    import bpy
+    import numpy
+
+    bpy.ops.wm.open_mainfile(filepath=filepath)
+    scene = bpy.context.scene
+    tree = scene.node_tree
+    if not scene.use_nodes or tree is None:
+        print("%s: no compositor node tree, skipping" % filepath)
+        return None
+
+    render = scene.render
+    render.image_settings.file_format = 'OPEN_EXR'
+    render.image_settings.color_depth = '32'
+    render.image_settings.exr_codec = 'NONE'
+
+    render.use_compositing = False
+    time_base = render_time(scene, repeat)
+    render.use_compositing = True
+
+    result = {}
+    for mode in EXECUTION_MODES:
+        tree.execution_mode = mode
+        output = os.path.join(tempdir, "%s.exr" % mode.lower())
+        result[mode] = max(render_time(scene, repeat, output) - time_base, 0.0)
+
+    pixels_tiled = image_pixels(os.path.join(tempdir, "tiled.exr"))
+    pixels_full_frame = image_pixels(os.path.join(tempdir, "full_frame.exr"))
+    if len(pixels_tiled) != len(pixels_full_frame):
+        result['max_difference'] = float('inf')
+    elif len(pixels_tiled) == 0:
+        result['max_difference'] = 0.0
+    else:
+        result['max_difference'] = float(numpy.max(numpy.abs(pixels_tiled - pixels_full_frame)))
+    return result
+
+
+def main():
+    argv = sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else []
+
+    parser = argparse.ArgumentParser(
+        description="Compare the compositor execution modes on existing .blend files.")
+    parser.add_argument("--repeat", type=int, default=3, help="Number of renders per measurement")
+    parser.add_argument("--threshold", type=float, default=1e-4,
+                        help="Maximum difference between the modes to consider results equal")
+    parser.add_argument("files", nargs="+", help=".blend files to benchmark")
+    args = parser.parse_args(argv)
+
+    print("%-40s %10s %10s %8s %s" % ("File", "Tiled", "Full Frame", "Speedup", "Result"))
+    num_failed = 0
+    with tempfile.TemporaryDirectory() as tempdir:
+        for filepath in args.files:
+            result = benchmark_file(os.path.abspath(filepath), max(args.repeat, 1), tempdir)
+            if result is None:
+                continue
+
+            matches = result['max_difference'] <= args.threshold
+            if not matches:
+                num_failed += 1
+            speedup = result['TILED'] / result['FULL_FRAME'] if result['FULL_FRAME'] > 0.0 else 0.0
+            print("%-40s %9.3fs %9.3fs %7.2fx %s" % (
+                os.path.basename(filepath)[:40],
+                result['TILED'],
+                result['FULL_FRAME'],
+                speedup,
+                "OK" if matches else "DIFFERENT (max %g)" % result['max_difference'],
+            ))
+
+    sys.exit(1 if num_failed else 0)
+
+
+if __name__ == "__main__":
+    main()
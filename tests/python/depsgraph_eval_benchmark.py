@@ -0,0 +1,96 @@
+# ##### BEGIN GPL LICENSE BLOCK #####
+#
+#  This program is free software; you can redistribute it and/or
+#  modify it under the terms of the GNU General Public License
+#  as published by the Free Software Foundation; either version 2
+#  of the License, or (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software Foundation,
+#  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+#
+# ##### END GPL LICENSE BLOCK #####
+
+# <pep8 compliant>
+
+"""
+Compare the dependency graph evaluation order with critical path priorities against
+the plain task pool order (debug value 798), on the animation of existing .blend files
+(character rigs for example).
+
+Example Usage:
+
+./blender.bin --background --factory-startup \
+    --python tests/python/depsgraph_eval_benchmark.py -- \
+    --frames=100 --repeat=3 \
+    /path/to/rig_a.blend /path/to/rig_b.blend
+"""
+
+import argparse
+import os
+import sys
+import time
+
+
+# Debug value which disables the evaluation priorities.
+DEBUG_VALUE_NO_PRIORITIES = 798
+
+
+def playback_time(scene, frames, repeat):
+    best = sys.float_info.max
+    for _ in range(repeat):
+        time_start = time.perf_counter()
+        for frame in range(frames[0], frames[1] + 1):
+            scene.frame_set(frame)
+        best = min(best, time.perf_counter() - time_start)
+    return best
+
+
+def benchmark_file(filepath, num_frames, repeat):
+    import bpy
+
+    bpy.ops.wm.open_mainfile(filepath=filepath)
+    scene = bpy.context.scene
+    frames = (scene.frame_start, min(scene.frame_end, scene.frame_start + num_frames - 1))
+
+    result = {'frames': frames[1] - frames[0] + 1}
+    for name, debug_value in (('pool', DEBUG_VALUE_NO_PRIORITIES), ('priorities', 0)):
+        bpy.app.debug_value = debug_value
+        # The first playback also measures the evaluation cost of operations, it's not measured.
+        playback_time(scene, frames, 1)
+        result[name] = playback_time(scene, frames, repeat)
+    bpy.app.debug_value = 0
+    return result
+
+
+def main():
+    argv = sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else []
+
+    parser = argparse.ArgumentParser(
+        description="Compare dependency graph evaluation orders on existing .blend files.")
+    parser.add_argument("--frames", type=int, default=100, help="Maximum number of frames to play")
+    parser.add_argument("--repeat", type=int, default=3,
+                        help="Number of playbacks per measurement")
+    parser.add_argument("files", nargs="+", help=".blend files to benchmark")
+    args = parser.parse_args(argv)
+
+    print("%-40s %8s %10s %10s %8s" % ("File", "Frames", "Pool", "Priorities", "Speedup"))
+    for filepath in args.files:
+        result = benchmark_file(os.path.abspath(filepath), max(args.frames, 1), max(args.repeat, 1))
+        speedup = result['pool'] / result['priorities'] if result['priorities'] > 0.0 else 0.0
+        print("%-40s %8d %9.3fs %9.3fs %7.2fx" % (
+            os.path.basename(filepath)[:40],
+            result['frames'],
+            result['pool'],
+            result['priorities'],
+            speedup,
+        ))
+
+
+if __name__ == "__main__":
+    main()
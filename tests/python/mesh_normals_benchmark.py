@@ -0,0 +1,83 @@
+# ##### BEGIN GPL LICENSE BLOCK #####
+#
+#  This program is free software; you can redistribute it and/or
+#  modify it under the terms of the GNU General Public License
+#  as published by the Free Software Foundation; either version 2
+#  of the License, or (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software Foundation,
+#  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+#
+# ##### END GPL LICENSE BLOCK #####
+
+# <pep8 compliant>
+
+"""
+Time vertex normal and split normal computation on a large smooth grid,
+with and without sharp edges.
+
+Example Usage:
+
+./blender.bin --background --factory-startup \
+    --python tests/python/mesh_normals_benchmark.py -- \
+    --vertices=1000000 --repeat=10
+"""
+
+import argparse
+import math
+import sys
+import time
+
+
+def grid_mesh_create(num_vertices):
+    import bpy
+
+    subdivisions = max(int(math.sqrt(num_vertices)), 2)
+    bpy.ops.mesh.primitive_grid_add(x_subdivisions=subdivisions, y_subdivisions=subdivisions)
+    mesh = bpy.context.active_object.data
+    mesh.polygons.foreach_set("use_smooth", [True] * len(mesh.polygons))
+    mesh.use_auto_smooth = True
+    return mesh
+
+
+def best_time(func, repeat):
+    best = sys.float_info.max
+    for _ in range(repeat):
+        time_start = time.perf_counter()
+        func()
+        best = min(best, time.perf_counter() - time_start)
+    return best
+
+
+def main():
+    argv = sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else []
+
+    parser = argparse.ArgumentParser(description="Time mesh normals computation.")
+    parser.add_argument("--vertices", type=int, default=1000000,
+                        help="Approximate number of vertices of the grid")
+    parser.add_argument("--repeat", type=int, default=10,
+                        help="Number of computations per measurement")
+    args = parser.parse_args(argv)
+
+    mesh = grid_mesh_create(args.vertices)
+    repeat = max(args.repeat, 1)
+    print("Vertices: %d, polygons: %d" % (len(mesh.vertices), len(mesh.polygons)))
+
+    print("%-30s %10s" % ("Computation", "Time"))
+    print("%-30s %9.4fs" % ("vertex normals", best_time(mesh.calc_normals, repeat)))
+    print("%-30s %9.4fs" % ("split normals, smooth", best_time(mesh.calc_normals_split, repeat)))
+
+    # Tag some edges sharp, so the smooth fans have to be computed.
+    mesh.edges.foreach_set("use_edge_sharp", [(i % 7) == 0 for i in range(len(mesh.edges))])
+    split_time = best_time(mesh.calc_normals_split, repeat)
+    print("%-30s %9.4fs" % ("split normals, sharp edges", split_time))
+
+
+if __name__ == "__main__":
+    main()
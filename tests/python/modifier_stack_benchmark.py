@@ -0,0 +1,113 @@
+# ##### BEGIN GPL LICENSE BLOCK #####
+#
+#  This program is free software; you can redistribute it and/or
+#  modify it under the terms of the GNU General Public License
+#  as published by the Free Software Foundation; either version 2
+#  of the License, or (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software Foundation,
+#  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+#
+# ##### END GPL LICENSE BLOCK #####
+
+# <pep8 compliant>
+
+"""
+Time the evaluation of deform modifiers on a large grid (5M vertices by default),
+each modifier on its own and the whole stack together.
+
+Example Usage:
+
+./blender.bin --background --factory-startup \
+    --python tests/python/modifier_stack_benchmark.py -- \
+    --vertices=5000000 --repeat=5
+"""
+
+import argparse
+import math
+import sys
+import time
+
+
+# Modifier type and the properties to set on it.
+MODIFIERS = (
+    ('DISPLACE', {'strength': 0.1}),
+    ('SMOOTH', {'factor': 0.5, 'iterations': 2}),
+    ('WARP', {'strength': 0.5, 'falloff_radius': 2.0}),
+    ('WAVE', {'height': 0.2, 'width': 0.5}),
+    ('CAST', {'factor': 0.5}),
+)
+
+
+def grid_object_create(num_vertices):
+    import bpy
+
+    subdivisions = max(int(math.sqrt(num_vertices)), 2)
+    bpy.ops.mesh.primitive_grid_add(x_subdivisions=subdivisions, y_subdivisions=subdivisions)
+    ob = bpy.context.active_object
+
+    # Warp needs two objects to map between.
+    bpy.ops.object.empty_add(location=(-1.0, 0.0, 0.0))
+    warp_from = bpy.context.active_object
+    bpy.ops.object.empty_add(location=(1.0, 0.0, 1.0))
+    warp_to = bpy.context.active_object
+
+    for mod_type, props in MODIFIERS:
+        md = ob.modifiers.new(name=mod_type.lower(), type=mod_type)
+        for key, value in props.items():
+            setattr(md, key, value)
+        if mod_type == 'WARP':
+            md.object_from = warp_from
+            md.object_to = warp_to
+    return ob
+
+
+def evaluation_time(ob, repeat):
+    import bpy
+
+    depsgraph = bpy.context.evaluated_depsgraph_get()
+    best = sys.float_info.max
+    for _ in range(repeat):
+        ob.update_tag(refresh={'DATA'})
+        time_start = time.perf_counter()
+        depsgraph.update()
+        best = min(best, time.perf_counter() - time_start)
+    return best
+
+
+def main():
+    argv = sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else []
+
+    parser = argparse.ArgumentParser(
+        description="Time deform modifier evaluation on a large mesh.")
+    parser.add_argument("--vertices", type=int, default=5000000,
+                        help="Approximate number of vertices of the grid")
+    parser.add_argument("--repeat", type=int, default=5,
+                        help="Number of evaluations per measurement")
+    args = parser.parse_args(argv)
+
+    ob = grid_object_create(args.vertices)
+    repeat = max(args.repeat, 1)
+    print("Vertices: %d" % len(ob.data.vertices))
+
+    print("%-20s %10s" % ("Modifier", "Time"))
+    for md in ob.modifiers:
+        md.show_viewport = False
+    for md in ob.modifiers:
+        md.show_viewport = True
+        print("%-20s %9.3fs" % (md.name, evaluation_time(ob, repeat)))
+        md.show_viewport = False
+
+    for md in ob.modifiers:
+        md.show_viewport = True
+    print("%-20s %9.3fs" % ("stack", evaluation_time(ob, repeat)))
+
+
+if __name__ == "__main__":
+    main()
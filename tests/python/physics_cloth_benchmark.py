@@ -0,0 +1,110 @@
+# ##### BEGIN GPL LICENSE BLOCK #####
+#
+#  This program is free software; you can redistribute it and/or
+#  modify it under the terms of the GNU General Public License
+#  as published by the Free Software Foundation; either version 2
+#  of the License, or (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software Foundation,
+#  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+#
+# ##### END GPL LICENSE BLOCK #####
+
+# <pep8 compliant>
+
+"""
+Time the cloth simulation of a large grid (200k vertices by default), which is dominated by
+the conjugate gradient solver. Optionally simulates the cloth objects of existing .blend files.
+
+Example Usage:
+
+./blender.bin --background --factory-startup \
+    --python tests/python/physics_cloth_benchmark.py -- \
+    --vertices=200000 --frames=10
+
+./blender.bin --background --factory-startup \
+    --python tests/python/physics_cloth_benchmark.py -- \
+    --frames=50 /path/to/cloth_a.blend /path/to/cloth_b.blend
+"""
+
+import argparse
+import math
+import os
+import sys
+import time
+
+
+def grid_cloth_create(num_vertices):
+    import bpy
+
+    bpy.ops.wm.read_factory_settings(use_empty=True)
+    subdivisions = max(int(math.sqrt(num_vertices)), 2)
+    bpy.ops.mesh.primitive_grid_add(
+        x_subdivisions=subdivisions, y_subdivisions=subdivisions, size=4.0)
+    ob = bpy.context.active_object
+
+    # Pin one side of the grid, so the cloth hangs from it.
+    group = ob.vertex_groups.new(name="pin")
+    group.add([i for i in range(subdivisions)], 1.0, 'REPLACE')
+
+    md = ob.modifiers.new(name="cloth", type='CLOTH')
+    md.settings.vertex_group_mass = group.name
+    return bpy.context.scene
+
+
+def simulation_time(scene, num_frames):
+    frame_start = scene.frame_start
+    frame_end = frame_start + num_frames - 1
+    scene.frame_end = max(scene.frame_end, frame_end)
+    for ob in scene.objects:
+        for md in ob.modifiers:
+            if md.type == 'CLOTH':
+                md.point_cache.frame_end = max(md.point_cache.frame_end, frame_end)
+
+    scene.frame_set(frame_start)
+    time_start = time.perf_counter()
+    for frame in range(frame_start + 1, frame_end + 1):
+        scene.frame_set(frame)
+    return time.perf_counter() - time_start
+
+
+def main():
+    argv = sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else []
+
+    parser = argparse.ArgumentParser(description="Time cloth simulation.")
+    parser.add_argument("--vertices", type=int, default=200000,
+                        help="Approximate number of vertices of the generated grid")
+    parser.add_argument("--frames", type=int, default=10, help="Number of frames to simulate")
+    parser.add_argument("files", nargs="*", help=".blend files to simulate instead of a grid")
+    args = parser.parse_args(argv)
+
+    import bpy
+
+    num_frames = max(args.frames, 2)
+    print("%-40s %8s %10s %10s" % ("Scene", "Frames", "Time", "Per frame"))
+
+    if args.files:
+        scenes = []
+        for filepath in args.files:
+            bpy.ops.wm.open_mainfile(filepath=os.path.abspath(filepath))
+            name = os.path.basename(filepath)[:40]
+            sim_time = simulation_time(bpy.context.scene, num_frames)
+            scenes.append((name, sim_time))
+    else:
+        scene = grid_cloth_create(args.vertices)
+        name = "grid (%d vertices)" % len(scene.objects[0].data.vertices)
+        scenes = [(name, simulation_time(scene, num_frames))]
+
+    for name, sim_time in scenes:
+        frames = num_frames - 1
+        print("%-40s %8d %9.3fs %9.3fs" % (name, frames, sim_time, sim_time / frames))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,328 @@
+# ##### BEGIN GPL LICENSE BLOCK #####
+#
+#  This program is free software; you can redistribute it and/or
+#  modify it under the terms of the GNU General Public License
+#  as published by the Free Software Foundation; either version 2
+#  of the License, or (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software Foundation,
+#  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+#
+# ##### END GPL LICENSE BLOCK #####
+
+# <pep8 compliant>
+
+"""
+Replay recorded sculpt strokes in background mode and time them, on a regular mesh,
+a multires object or a dynamic topology object. The object is a generated ico-sphere,
+or an object of a .blend file.
+
+Strokes are stored as JSON, samples are in world space so replaying doesn't depend on the
+size of the viewport:
+
+    {
+        "brush": {"sculpt_tool": "DRAW", "strength": 0.5, "unprojected_radius": 0.2, ...},
+        "view": {"rotation": [w, x, y, z], "location": [x, y, z], "distance": 5.0},
+        "strokes": [
+            [{"location": [x, y, z], "pressure": 1.0, "pen_flip": false}, ...],
+            ...
+        ]
+    }
+
+Any writable brush property can be used in "brush", "view" is optional.
+
+Strokes run from scripts don't apply the brush spacing, every sample is one dab. Samples should
+be recorded at the spacing of the brush, as generated strokes are.
+
+Run with `--debug-sculpt-time` to print the time spent on brush application, normal updates,
+bounding box updates and undo pushes for every dab.
+
+Example Usage:
+
+./blender.bin --background --factory-startup \
+    --python tests/python/sculpt_stroke_benchmark.py -- \
+    --write-stroke=/tmp/stroke.json
+
+./blender.bin --background --factory-startup --debug-sculpt-time \
+    --python tests/python/sculpt_stroke_benchmark.py -- \
+    --object=MULTIRES --levels=4 /tmp/stroke.json
+
+./blender.bin --background --factory-startup --debug-sculpt-time \
+    --python tests/python/sculpt_stroke_benchmark.py -- \
+    --blend=/path/to/sculpt.blend --object-name=Head /tmp/stroke.json
+"""
+
+import argparse
+import json
+import os
+import sys
+import time
+
+VIEW_DEFAULT = {
+    # Front view.
+    "rotation": [0.7071068, 0.7071068, 0.0, 0.0],
+    "location": [0.0, 0.0, 0.0],
+    "distance": 5.0,
+}
+
+
+def context_override():
+    import bpy
+
+    window = bpy.context.window_manager.windows[0]
+    screen = window.screen
+    area = next(area for area in screen.areas if area.type == 'VIEW_3D')
+    region = next(region for region in area.regions if region.type == 'WINDOW')
+    return {
+        "window": window,
+        "screen": screen,
+        "area": area,
+        "region": region,
+        "active_object": bpy.context.view_layer.objects.active,
+    }
+
+
+def view_set(override, view):
+    rv3d = override["area"].spaces.active.region_3d
+    rv3d.view_perspective = 'PERSP'
+    rv3d.view_rotation = view["rotation"]
+    rv3d.view_location = view["location"]
+    rv3d.view_distance = view["distance"]
+    # Nothing is drawn in background mode, update the matrices used for projection.
+    rv3d.update()
+    return rv3d
+
+
+def sculpt_object_create(subdivisions):
+    import bpy
+
+    bpy.ops.wm.read_factory_settings()
+    for ob in bpy.data.objects[:]:
+        bpy.data.objects.remove(ob)
+
+    bpy.ops.mesh.primitive_ico_sphere_add(subdivisions=subdivisions, radius=1.0)
+    return bpy.context.active_object
+
+
+def sculpt_object_load(filepath, object_name):
+    import bpy
+
+    bpy.ops.wm.open_mainfile(filepath=os.path.abspath(filepath))
+    view_layer = bpy.context.view_layer
+    if object_name:
+        ob = view_layer.objects.get(object_name)
+        if ob is None:
+            raise Exception("Object %r not found in the view layer" % object_name)
+    else:
+        ob = view_layer.objects.active
+    if ob is None or ob.type != 'MESH':
+        raise Exception("A mesh object is needed to sculpt on")
+
+    # Files may be saved in sculpt mode, start from object mode so sculpt mode is entered with
+    # the replay settings, like for generated objects.
+    if view_layer.objects.active and view_layer.objects.active.mode != 'OBJECT':
+        bpy.ops.object.mode_set(context_override(), mode='OBJECT')
+    view_layer.objects.active = ob
+    return ob
+
+
+def sculpt_mode_enter(ob, object_type, levels, detail_size):
+    import bpy
+
+    if object_type == 'MULTIRES':
+        md = next((md for md in ob.modifiers if md.type == 'MULTIRES'), None)
+        if md is None:
+            md = ob.modifiers.new(name="Multires", type='MULTIRES')
+        for _ in range(levels - md.total_levels):
+            bpy.ops.object.multires_subdivide(
+                context_override(), modifier=md.name, mode='CATMULL_CLARK')
+        md.sculpt_levels = md.total_levels
+
+    override = context_override()
+    bpy.ops.object.mode_set(override, mode='SCULPT')
+    # The undo stack isn't created on startup in background mode, sculpt undo pushes need it.
+    bpy.ops.ed.undo_push(override, message="Replay")
+
+    if object_type == 'DYNTOPO':
+        if not ob.use_dynamic_topology_sculpting:
+            bpy.ops.sculpt.dynamic_topology_toggle(override)
+        sculpt = bpy.context.scene.tool_settings.sculpt
+        sculpt.detail_type_method = 'CONSTANT'
+        sculpt.constant_detail_resolution = detail_size
+
+
+def brush_setup(brush_settings):
+    import bpy
+
+    # Brush settings are used as-is, not the ones shared between brushes.
+    ups = bpy.context.scene.tool_settings.unified_paint_settings
+    ups.use_unified_size = False
+    ups.use_unified_strength = False
+
+    brush = bpy.data.brushes.new("Replay", mode='SCULPT')
+    # Use a world space radius by default, so the stroke doesn't depend on the viewport.
+    brush.use_locked_size = 'SCENE'
+    for key, value in brush_settings.items():
+        setattr(brush, key, value)
+    bpy.context.scene.tool_settings.sculpt.brush = brush
+    return brush
+
+
+def stroke_generate(num_strokes, radius, spacing):
+    """
+    Wavy strokes over the front of the ico-sphere, as seen from the default view.
+    Samples are placed at the brush spacing, a percentage of the brush diameter.
+    """
+    import math
+    from mathutils import Quaternion, Vector
+
+    rotation = Quaternion(VIEW_DEFAULT["rotation"])
+    side = rotation @ Vector((1.0, 0.0, 0.0))
+    up = rotation @ Vector((0.0, 1.0, 0.0))
+    front = rotation @ Vector((0.0, 0.0, 1.0))
+    step = 2.0 * radius * spacing / 100.0
+    path_resolution = 1000
+
+    strokes = []
+    for stroke_index in range(num_strokes):
+        samples = []
+        co_prev = None
+        length = 0.0
+        for i in range(path_resolution):
+            factor = i / (path_resolution - 1)
+            x = (factor - 0.5) * 1.2
+            y = (stroke_index - (num_strokes - 1) * 0.5) * 0.15 + math.sin(factor * 12.0) * 0.1
+            # Keep samples on the unit sphere, facing the view.
+            co = side * x + up * y
+            co = co + front * math.sqrt(max(1.0 - co.length_squared, 0.0))
+            if co_prev is not None:
+                length += (co - co_prev).length
+            co_prev = co
+            if samples and length < step:
+                continue
+            length = 0.0
+            samples.append({
+                "location": co[:],
+                "pressure": 0.5 + 0.5 * math.sin(factor * math.pi),
+                "pen_flip": False,
+            })
+        strokes.append(samples)
+
+    return {
+        "brush": {
+            "sculpt_tool": 'DRAW',
+            "strength": 0.5,
+            "unprojected_radius": radius,
+            "spacing": spacing,
+        },
+        "view": VIEW_DEFAULT,
+        "strokes": strokes,
+    }
+
+
+def stroke_elements(region, rv3d, samples):
+    from bpy_extras.view3d_utils import location_3d_to_region_2d
+
+    elements = []
+    for i, sample in enumerate(samples):
+        mouse = location_3d_to_region_2d(region, rv3d, sample["location"])
+        if mouse is None:
+            continue
+        elements.append({
+            "location": sample["location"],
+            "mouse": mouse[:],
+            "pressure": sample.get("pressure", 1.0),
+            "size": 0.0,
+            "pen_flip": sample.get("pen_flip", False),
+            "time": float(i),
+            "is_start": not elements,
+        })
+    return elements
+
+
+def stroke_replay(override, stroke_data):
+    import bpy
+
+    rv3d = view_set(override, stroke_data.get("view", VIEW_DEFAULT))
+    region = override["region"]
+
+    times = []
+    for samples in stroke_data["strokes"]:
+        elements = stroke_elements(region, rv3d, samples)
+        time_start = time.perf_counter()
+        result = bpy.ops.sculpt.brush_stroke(override, stroke=elements)
+        stroke_time = time.perf_counter() - time_start
+        # Every element is one dab, unless the stroke doesn't start on the object.
+        num_dabs = len(elements) if result == {'FINISHED'} else 0
+        times.append((num_dabs, stroke_time))
+    return times
+
+
+def main():
+    argv = sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else []
+
+    parser = argparse.ArgumentParser(description="Replay and time sculpt strokes.")
+    parser.add_argument("--object", choices=('MESH', 'MULTIRES', 'DYNTOPO'), default='MESH',
+                        help="Type of object to sculpt on, an object loaded with a multires "
+                        "modifier uses it unless it is sculpted as dynamic topology")
+    parser.add_argument("--blend", metavar="FILE",
+                        help="Sculpt on an object of FILE instead of a generated ico-sphere")
+    parser.add_argument("--object-name",
+                        help="Name of the object of --blend to sculpt on, the active object "
+                        "is used when not set")
+    parser.add_argument("--subdivisions", type=int, default=6,
+                        help="Subdivisions of the ico-sphere to sculpt on")
+    parser.add_argument("--levels", type=int, default=3,
+                        help="Multires subdivision levels, existing levels are kept")
+    parser.add_argument("--detail-size", type=float, default=12.0,
+                        help="Constant detail resolution for dynamic topology")
+    parser.add_argument("--write-stroke", metavar="FILE",
+                        help="Write a generated stroke to FILE and exit")
+    parser.add_argument("--strokes", type=int, default=5, help="Number of generated strokes")
+    parser.add_argument("--radius", type=float, default=0.15,
+                        help="Brush radius of generated strokes")
+    parser.add_argument("--spacing", type=int, default=10,
+                        help="Brush spacing of generated strokes, in percent of the diameter")
+    parser.add_argument("files", nargs="*", help="Stroke files to replay, a generated stroke "
+                        "is replayed when none are given")
+    args = parser.parse_args(argv)
+
+    if args.write_stroke:
+        with open(args.write_stroke, "w", encoding="utf-8") as fh:
+            json.dump(stroke_generate(args.strokes, args.radius, args.spacing), fh, indent=1)
+        return
+
+    if args.files:
+        stroke_files = []
+        for filepath in args.files:
+            with open(filepath, "r", encoding="utf-8") as fh:
+                stroke_files.append((os.path.basename(filepath)[:30], json.load(fh)))
+    else:
+        stroke_files = [("generated", stroke_generate(args.strokes, args.radius, args.spacing))]
+
+    print("%-30s %-10s %8s %10s %10s" % ("Strokes", "Object", "Dabs", "Time", "Per stroke"))
+
+    for name, stroke_data in stroke_files:
+        # Start from the same state for every stroke file.
+        if args.blend:
+            ob = sculpt_object_load(args.blend, args.object_name)
+        else:
+            ob = sculpt_object_create(args.subdivisions)
+        sculpt_mode_enter(ob, args.object, args.levels, args.detail_size)
+        brush_setup(stroke_data["brush"])
+        times = stroke_replay(context_override(), stroke_data)
+
+        num_elements = sum(num for num, _ in times)
+        time_total = sum(stroke_time for _, stroke_time in times)
+        print("%-30s %-10s %8d %9.3fs %9.3fs" % (
+            name, args.object, num_elements, time_total, time_total / max(len(times), 1)))
+
+
+if __name__ == "__main__":
+    main()